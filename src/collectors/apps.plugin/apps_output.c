@@ -60,6 +60,8 @@ void send_resource_usage_to_netdata(usec_t dt) {
                 "DIMENSION fds '' absolute 1 1\n"
                 "DIMENSION targets '' absolute 1 1\n"
                 "DIMENSION new_pids 'new pids' incremental 1 1\n"
+                "DIMENSION taskstats '' incremental 1 1\n"
+                "DIMENSION idle_pids 'idle pids' incremental 1 1\n"
                 , update_every
         );
     }
@@ -79,6 +81,8 @@ void send_resource_usage_to_netdata(usec_t dt) {
             "SET fds = %d\n"
             "SET targets = %zu\n"
             "SET new_pids = %zu\n"
+            "SET taskstats = %zu\n"
+            "SET idle_pids = %zu\n"
             "END\n"
             , dt
             , cpuuser
@@ -93,7 +97,53 @@ void send_resource_usage_to_netdata(usec_t dt) {
             , all_files_len
             , apps_groups_targets_count
             , targets_assignment_counter
+            , taskstats_calls_counter
+            , taskstats_idle_counter
     );
+
+#if !defined(__FreeBSD__) && !defined(__APPLE__)
+    // the fd tables are always scanned entirely without change detection
+    if(enable_file_charts && enable_fds_change_detection) {
+        static bool created_fds_charts = false;
+        if(unlikely(!created_fds_charts)) {
+            created_fds_charts = true;
+
+            fprintf(stdout,
+                    "CHART netdata.apps_fds_scans '' 'Apps Plugin File Descriptor Table Scans' 'processes/s' apps.plugin netdata.apps_fds_scans stacked 140002 %1$d\n"
+                    "DIMENSION full '' incremental 1 1\n"
+                    "DIMENSION sampled '' incremental 1 1\n"
+                    "DIMENSION unchanged '' incremental 1 1\n"
+                    "CHART netdata.apps_fds_scan_time '' 'Apps Plugin File Descriptor Table Scan Time' 'milliseconds' apps.plugin netdata.apps_fds_scan_time line 140003 %1$d\n"
+                    "DIMENSION total '' absolute 1 1000\n"
+                    "DIMENSION slowest 'slowest process' absolute 1 1000\n"
+                    , update_every
+            );
+        }
+
+        fprintf(stdout,
+                "BEGIN netdata.apps_fds_scans %"PRIu64"\n"
+                "SET full = %zu\n"
+                "SET sampled = %zu\n"
+                "SET unchanged = %zu\n"
+                "END\n"
+                "BEGIN netdata.apps_fds_scan_time %"PRIu64"\n"
+                "SET total = %"PRIu64"\n"
+                "SET slowest = %"PRIu64"\n"
+                "END\n"
+                , dt
+                , fds_scans_full_counter
+                , fds_scans_sampled_counter
+                , fds_scans_skipped_counter
+                , dt
+                , fds_scan_ut
+                , fds_scan_max_ut
+        );
+    }
+#endif
+
+    // these are per iteration
+    fds_scan_ut = 0;
+    fds_scan_max_ut = 0;
 }
 
 void send_collected_data_to_netdata(struct target *root, const char *type, usec_t dt) {
@@ -51,7 +51,14 @@ size_t
     inodes_changed_counter = 0,
     links_changed_counter = 0,
     targets_assignment_counter = 0,
-    apps_groups_targets_count = 0;       // # of apps_groups.conf targets
+    apps_groups_targets_count = 0,       // # of apps_groups.conf targets
+    fds_scans_full_counter = 0,          // fd tables read entirely
+    fds_scans_sampled_counter = 0,       // fd tables read partially (too big)
+    fds_scans_skipped_counter = 0;       // fd tables found unchanged
+
+usec_t
+    fds_scan_ut = 0,                     // time spent reading fd tables, this iteration
+    fds_scan_max_ut = 0;                 // the slowest fd table read, this iteration
 
 int
     all_files_len = 0,
@@ -113,6 +120,9 @@ mach_timebase_info_data_t mach_info;
 
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
 int max_fds_cache_seconds = 60;
+bool enable_fds_change_detection = false;
+int fds_rescan_seconds = 60;
+size_t fds_sample_above = 5000;
 proc_state proc_state_count[PROC_STATUS_END];
 const char *proc_states[] = {
     [PROC_STATUS_RUNNING] = "running",
@@ -749,6 +759,59 @@ static void parse_args(int argc, char **argv)
             if(max_fds_cache_seconds < 0) max_fds_cache_seconds = 0;
             continue;
         }
+
+        if(strcmp("with-fds-change-detection", argv[i]) == 0) {
+            enable_fds_change_detection = true;
+            continue;
+        }
+
+        if(strcmp("no-fds-change-detection", argv[i]) == 0 || strcmp("without-fds-change-detection", argv[i]) == 0) {
+            enable_fds_change_detection = false;
+            continue;
+        }
+
+        if(strcmp("fds-rescan-secs", argv[i]) == 0) {
+            if(argc <= i + 1) {
+                fprintf(stderr, "Parameter 'fds-rescan-secs' requires a number as argument.\n");
+                exit(1);
+            }
+            i++;
+            fds_rescan_seconds = str2i(argv[i]);
+            if(fds_rescan_seconds < 0) fds_rescan_seconds = 0;
+            continue;
+        }
+
+        if(strcmp("fds-sample-above", argv[i]) == 0) {
+            if(argc <= i + 1) {
+                fprintf(stderr, "Parameter 'fds-sample-above' requires a number as argument.\n");
+                exit(1);
+            }
+            i++;
+            int n = str2i(argv[i]);
+            fds_sample_above = (n > 0) ? (size_t)n : 0;
+            continue;
+        }
+
+        if(strcmp("with-taskstats", argv[i]) == 0) {
+            enable_taskstats = true;
+            continue;
+        }
+
+        if(strcmp("no-taskstats", argv[i]) == 0 || strcmp("without-taskstats", argv[i]) == 0) {
+            enable_taskstats = false;
+            continue;
+        }
+
+        if(strcmp("taskstats-refresh-every", argv[i]) == 0) {
+            if(argc <= i + 1) {
+                fprintf(stderr, "Parameter 'taskstats-refresh-every' requires a number as argument.\n");
+                exit(1);
+            }
+            i++;
+            taskstats_refresh_iterations = str2i(argv[i]);
+            if(taskstats_refresh_iterations < 1) taskstats_refresh_iterations = 1;
+            continue;
+        }
 #endif
 
         if(strcmp("no-childs", argv[i]) == 0 || strcmp("without-childs", argv[i]) == 0) {
@@ -848,12 +911,42 @@ static void parse_args(int argc, char **argv)
                     "                        max given)\n"
                     "                        (default is %d seconds)\n"
                     "\n"
+                    " with-fds-change-detection\n"
+                    " without-fds-change-detection\n"
+                    "                        enable / disable reading /proc/PID/fd only when\n"
+                    "                        the number of open files or the FDSize of the\n"
+                    "                        process changed (requires Linux 6.2+)\n"
+                    "                        (default is disabled)\n"
+                    "\n"
+                    " fds-rescan-secs N      with fds change detection, read unchanged\n"
+                    "                        fd tables at least every N seconds\n"
+                    "                        (default is %d seconds)\n"
+                    "\n"
+                    " fds-sample-above N     with fds change detection, processes with more\n"
+                    "                        than N open files resolve only a tenth of their\n"
+                    "                        known files per iteration, 0 = never sample\n"
+                    "                        (default is %zu)\n"
+                    "\n"
+                    " with-taskstats\n"
+                    " without-taskstats      enable / disable using netlink taskstats to find\n"
+                    "                        processes that have not run since the last\n"
+                    "                        iteration, and skip reading /proc for them\n"
+                    "                        (requires CAP_NET_ADMIN, default is disabled)\n"
+                    "\n"
+                    " taskstats-refresh-every N\n"
+                    "                        with taskstats, fully read idle processes every\n"
+                    "                        N iterations, to update their memory\n"
+                    "                        (default is %d iterations)\n"
+                    "\n"
 #endif
                     " version or -v or -V print program version and exit\n"
                     "\n"
                     , NETDATA_VERSION
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
                     , max_fds_cache_seconds
+                    , fds_rescan_seconds
+                    , fds_sample_above
+                    , taskstats_refresh_iterations
 #endif
             );
             exit(1);
@@ -1042,6 +1135,10 @@ int main(int argc, char **argv) {
     users_and_groups_init();
     pids_init();
 
+#if !defined(__FreeBSD__) && !defined(__APPLE__)
+    taskstats_init();
+#endif
+
     // ------------------------------------------------------------------------
     // the event loop for functions
 
@@ -69,7 +69,14 @@ extern size_t
     links_changed_counter,
     targets_assignment_counter,
     all_pids_count,
-    apps_groups_targets_count;
+    apps_groups_targets_count,
+    fds_scans_full_counter,
+    fds_scans_sampled_counter,
+    fds_scans_skipped_counter;
+
+extern usec_t
+    fds_scan_ut,
+    fds_scan_max_ut;
 
 extern int
     all_files_len,
@@ -119,8 +126,18 @@ extern size_t pagesize;
 
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
 extern int max_fds_cache_seconds;
+extern bool enable_fds_change_detection;
+extern int fds_rescan_seconds;
+extern size_t fds_sample_above;
 #endif
 
+extern bool enable_taskstats;
+extern int taskstats_refresh_iterations;
+
+extern size_t
+    taskstats_calls_counter,
+    taskstats_idle_counter;
+
 // ----------------------------------------------------------------------------
 // some variables for keeping track of processes count by states
 
@@ -337,7 +354,7 @@ struct pid_stat {
     // int64_t nice;
     int32_t num_threads;
     // int64_t itrealvalue;
-    // kernel_uint_t collected_starttime;
+    kernel_uint_t collected_starttime;
     // kernel_uint_t vsize;
     // kernel_uint_t rss;
     // kernel_uint_t rsslim;
@@ -373,6 +390,7 @@ struct pid_stat {
     kernel_uint_t status_vmswap;
     kernel_uint_t status_voluntary_ctxt_switches;
     kernel_uint_t status_nonvoluntary_ctxt_switches;
+    kernel_uint_t status_fdsize;
 #ifndef __FreeBSD__
     ARL_BASE *status_arl;
 #endif
@@ -398,6 +416,11 @@ struct pid_stat {
     struct pid_fd *fds;             // array of fds it uses
     size_t fds_size;                // the size of the fds array
 
+    size_t fds_scanned_count;       // the number of open fds at the last scan of the fd table
+    kernel_uint_t fds_scanned_fdsize; // the FDSize at the last scan of the fd table
+    usec_t fds_scanned_ut;          // the time of the last full scan of the fd table
+    usec_t fds_scan_cost_ut;        // the time the last scan of the fd table took
+
     struct openfds openfds;
     struct pid_limits limits;
 
@@ -428,6 +451,9 @@ struct pid_stat {
     usec_t last_io_collected_usec;
     usec_t last_limits_collected_usec;
 
+    uint64_t taskstats_signature;           // cpu time + context switches, as reported by taskstats
+    size_t taskstats_full_read_iteration;   // the iteration /proc was last read for this process
+
     char *fds_dirname;              // the full directory name in /proc/PID/fd
 
     char *stat_filename;
@@ -541,6 +567,14 @@ int read_pid_file_descriptors(struct pid_stat *p, void *ptr);
 int read_global_time(void);
 void get_MemTotal(void);
 
+#if !defined(__FreeBSD__) && !defined(__APPLE__)
+void update_proc_state_count(char proc_stt);
+
+void taskstats_init(void);
+bool taskstats_pid_has_not_run(struct pid_stat *p);
+void taskstats_pid_keep_last_values(struct pid_stat *p);
+#endif
+
 bool collect_data_for_all_pids(void);
 void cleanup_exited_pids(void);
 
@@ -611,6 +611,52 @@ static bool read_pid_file_descriptors_per_os(struct pid_stat *p, void *ptr) {
 #endif // __FreeBSD__
 
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
+// the number of known fds of large fd tables resolved per iteration is 1 / FDS_SAMPLING_SLICES
+#define FDS_SAMPLING_SLICES 10
+
+// since Linux 6.2, stat() on /proc/PID/fd reports the number of open fds as its size
+static bool fds_dir_size_is_fds_count(void) {
+    static int supported = -1;
+
+    if(unlikely(supported == -1)) {
+        struct stat st;
+        char filename[FILENAME_MAX + 1];
+        snprintfz(filename, FILENAME_MAX, "%s/proc/self/fd", netdata_configured_host_prefix);
+
+        // we have at least stdin, stdout, stderr open
+        supported = (stat(filename, &st) == 0 && st.st_size > 0) ? 1 : 0;
+
+        if(!supported && enable_fds_change_detection) {
+            netdata_log_error("This kernel does not report the number of open files of processes. "
+                              "fds change detection is disabled.");
+            enable_fds_change_detection = false;
+        }
+    }
+
+    return supported == 1;
+}
+
+// returns true when the fd table of the process has the same size and the
+// same number of open fds as the last time we scanned it, and the scan is
+// still fresh enough
+static bool pid_fds_table_unchanged(struct pid_stat *p, size_t *fds_count) {
+    *fds_count = 0;
+
+    if(!enable_fds_change_detection || !fds_dir_size_is_fds_count())
+        return false;
+
+    struct stat st;
+    if(unlikely(stat(p->fds_dirname, &st) != 0))
+        return false;
+
+    *fds_count = (size_t)st.st_size;
+
+    return p->fds_scanned_ut &&
+           *fds_count == p->fds_scanned_count &&
+           p->status_fdsize == p->fds_scanned_fdsize &&
+           now_monotonic_usec() - p->fds_scanned_ut < (usec_t)fds_rescan_seconds * USEC_PER_SEC;
+}
+
 static bool read_pid_file_descriptors_per_os(struct pid_stat *p, void *ptr __maybe_unused) {
     if(unlikely(!p->fds_dirname)) {
         char dirname[FILENAME_MAX+1];
@@ -618,9 +664,25 @@ static bool read_pid_file_descriptors_per_os(struct pid_stat *p, void *ptr __may
         p->fds_dirname = strdupz(dirname);
     }
 
+    size_t fds_count;
+    if(pid_fds_table_unchanged(p, &fds_count)) {
+        // nothing to do - all our fds are still positive
+        fds_scans_skipped_counter++;
+        return true;
+    }
+
     DIR *fds = opendir(p->fds_dirname);
     if(unlikely(!fds)) return false;
 
+    // on very large tables, resolve again only a slice of the fds we already know
+    bool sampling = enable_fds_change_detection && fds_sample_above && fds_count > fds_sample_above;
+    size_t slice = global_iterations_counter % FDS_SAMPLING_SLICES;
+
+    if(sampling)
+        fds_scans_sampled_counter++;
+    else
+        fds_scans_full_counter++;
+
     struct dirent *de;
     char linkname[FILENAME_MAX + 1];
 
@@ -669,6 +731,12 @@ static bool read_pid_file_descriptors_per_os(struct pid_stat *p, void *ptr __may
             continue;
         }
 
+        if(sampling && p->fds[fdid].fd < 0 && (size_t)fdid % FDS_SAMPLING_SLICES != slice) {
+            // same inode and not in this iteration's slice - trust it
+            p->fds[fdid].fd = -p->fds[fdid].fd;
+            continue;
+        }
+
         if(unlikely(!p->fds[fdid].filename)) {
             filenames_allocated_counter++;
             char fdname[FILENAME_MAX + 1];
@@ -741,13 +809,24 @@ static bool read_pid_file_descriptors_per_os(struct pid_stat *p, void *ptr __may
 
     closedir(fds);
 
+    p->fds_scanned_count = fds_count;
+    p->fds_scanned_fdsize = p->status_fdsize;
+    p->fds_scanned_ut = now_monotonic_usec();
+
     return true;
 }
 #endif // !__FreeBSD__ !__APPLE
 
 int read_pid_file_descriptors(struct pid_stat *p, void *ptr) {
+    usec_t started_ut = now_monotonic_usec();
+
     bool ret = read_pid_file_descriptors_per_os(p, ptr);
     cleanup_negative_pid_fds(p);
 
+    p->fds_scan_cost_ut = now_monotonic_usec() - started_ut;
+    fds_scan_ut += p->fds_scan_cost_ut;
+    if(p->fds_scan_cost_ut > fds_scan_max_ut)
+        fds_scan_max_ut = p->fds_scan_cost_ut;
+
     return ret ? 1 : 0;
 }
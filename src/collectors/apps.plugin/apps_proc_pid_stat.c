@@ -165,7 +165,7 @@ static inline bool read_proc_pid_stat_per_os(struct pid_stat *p, void *ptr) {
 #endif // __APPLE__
 
 #if !defined(__FreeBSD__) && !defined(__APPLE__)
-static inline void update_proc_state_count(char proc_stt) {
+void update_proc_state_count(char proc_stt) {
     switch (proc_stt) {
         case 'S':
             proc_state_count[PROC_STATUS_SLEEPING] += 1;
@@ -232,8 +232,8 @@ static inline bool read_proc_pid_stat_per_os(struct pid_stat *p, void *ptr __may
     // p->nice          = str2kernel_uint_t(procfile_lineword(ff, 0, 18));
     p->num_threads      = (int32_t) str2uint32_t(procfile_lineword(ff, 0, 19), NULL);
     // p->itrealvalue   = str2kernel_uint_t(procfile_lineword(ff, 0, 20));
-    kernel_uint_t collected_starttime = str2kernel_uint_t(procfile_lineword(ff, 0, 21)) / system_hz;
-    p->uptime           = (system_uptime_secs > collected_starttime)?(system_uptime_secs - collected_starttime):0;
+    p->collected_starttime = str2kernel_uint_t(procfile_lineword(ff, 0, 21)) / system_hz;
+    p->uptime           = (system_uptime_secs > p->collected_starttime)?(system_uptime_secs - p->collected_starttime):0;
     // p->vsize         = str2kernel_uint_t(procfile_lineword(ff, 0, 22));
     // p->rss           = str2kernel_uint_t(procfile_lineword(ff, 0, 23));
     // p->rsslim        = str2kernel_uint_t(procfile_lineword(ff, 0, 24));
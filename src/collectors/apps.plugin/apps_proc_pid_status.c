@@ -106,6 +106,14 @@ void arl_callback_status_rssshmem(const char *name, uint32_t hash, const char *v
     aptr->p->status_rssshmem = str2kernel_uint_t(procfile_lineword(aptr->ff, aptr->line, 1));
 }
 
+void arl_callback_status_fdsize(const char *name, uint32_t hash, const char *value, void *dst) {
+    (void)name; (void)hash; (void)value;
+    struct arl_callback_ptr *aptr = (struct arl_callback_ptr *)dst;
+    if(unlikely(procfile_linewords(aptr->ff, aptr->line) < 2)) return;
+
+    aptr->p->status_fdsize = str2kernel_uint_t(procfile_lineword(aptr->ff, aptr->line, 1));
+}
+
 void arl_callback_status_voluntary_ctxt_switches(const char *name, uint32_t hash, const char *value, void *dst) {
     (void)name; (void)hash; (void)value;
     struct arl_callback_ptr *aptr = (struct arl_callback_ptr *)dst;
@@ -137,6 +145,7 @@ static inline bool read_proc_pid_status_per_os(struct pid_stat *p, void *ptr __m
         arl_expect_custom(p->status_arl, "RssFile", arl_callback_status_rssfile, &arl_ptr);
         arl_expect_custom(p->status_arl, "RssShmem", arl_callback_status_rssshmem, &arl_ptr);
         arl_expect_custom(p->status_arl, "VmSwap", arl_callback_status_vmswap, &arl_ptr);
+        arl_expect_custom(p->status_arl, "FDSize", arl_callback_status_fdsize, &arl_ptr);
         arl_expect_custom(p->status_arl, "voluntary_ctxt_switches", arl_callback_status_voluntary_ctxt_switches, &arl_ptr);
         arl_expect_custom(p->status_arl, "nonvoluntary_ctxt_switches", arl_callback_status_nonvoluntary_ctxt_switches, &arl_ptr);
     }
@@ -187,6 +196,7 @@ int read_proc_pid_status(struct pid_stat *p, void *ptr) {
     p->status_vmswap           = 0;
     p->status_voluntary_ctxt_switches = 0;
     p->status_nonvoluntary_ctxt_switches = 0;
+    p->status_fdsize = 0;
 
     return read_proc_pid_status_per_os(p, ptr) ? 1 : 0;
 }
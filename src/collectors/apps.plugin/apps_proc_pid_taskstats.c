@@ -0,0 +1,327 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "apps_plugin.h"
+
+// ----------------------------------------------------------------------------
+// taskstats based change detection
+//
+// Reading /proc/PID/{stat,io,status,fd} for every process on every iteration
+// is the main cost of apps.plugin on hosts with many processes. Most of these
+// processes are idle: they have not been scheduled since the last iteration,
+// so every value we collect for them is the same as last time.
+//
+// The kernel can tell us this with a single netlink request per process:
+// a TASKSTATS_CMD_ATTR_TGID query returns the cpu time and the context
+// switches of the whole thread group. When these have not changed and the
+// process was not running at its last full read, we keep the values of the
+// last iteration and we do not touch /proc for it.
+//
+// Taskstats does not provide memory, children or file descriptor information
+// for thread groups, so it cannot replace /proc. It is only used to decide
+// which processes need to be read again. Memory can change while a process
+// sleeps (reclaim, swap), so every process is fully read again at least once
+// every taskstats_refresh_iterations iterations.
+
+bool enable_taskstats = false;
+int taskstats_refresh_iterations = 10;
+
+size_t
+    taskstats_calls_counter = 0,
+    taskstats_idle_counter = 0;
+
+#if !defined(__FreeBSD__) && !defined(__APPLE__)
+
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/taskstats.h>
+
+#define TASKSTATS_BUFFER_SIZE 4096
+
+static struct {
+    int fd;
+    uint16_t family_id;
+    uint32_t seq;
+    char buffer[TASKSTATS_BUFFER_SIZE];
+} ts = {
+    .fd = -1,
+};
+
+#define GENLMSG_DATA(nlh) ((void *)((char *)NLMSG_DATA(nlh) + GENL_HDRLEN))
+#define NLA_DATA(na) ((void *)((char *)(na) + NLA_HDRLEN))
+
+static bool taskstats_send(uint16_t nlmsg_type, uint8_t cmd, uint16_t nla_type, const void *data, uint16_t data_len) {
+    struct {
+        struct nlmsghdr n;
+        struct genlmsghdr g;
+        char buf[256];
+    } req = { 0 };
+
+    if(NLA_HDRLEN + data_len > sizeof(req.buf))
+        return false;
+
+    req.n.nlmsg_len = NLMSG_LENGTH(GENL_HDRLEN);
+    req.n.nlmsg_type = nlmsg_type;
+    req.n.nlmsg_flags = NLM_F_REQUEST;
+    req.n.nlmsg_seq = ++ts.seq;
+    req.n.nlmsg_pid = 0;
+    req.g.cmd = cmd;
+    req.g.version = 1;
+
+    struct nlattr *na = (struct nlattr *)GENLMSG_DATA(&req.n);
+    na->nla_type = nla_type;
+    na->nla_len = NLA_HDRLEN + data_len;
+    memcpy(NLA_DATA(na), data, data_len);
+    req.n.nlmsg_len += NLA_ALIGN(na->nla_len);
+
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+    char *buf = (char *)&req;
+    size_t len = req.n.nlmsg_len;
+
+    while(len) {
+        ssize_t rc = sendto(ts.fd, buf, len, 0, (struct sockaddr *)&addr, sizeof(addr));
+        if(rc < 0) {
+            if(errno == EINTR || errno == EAGAIN)
+                continue;
+
+            return false;
+        }
+
+        buf += rc;
+        len -= rc;
+    }
+
+    return true;
+}
+
+// receive the reply to the last request sent
+// returns the genetlink message, or NULL with errno set
+static struct nlmsghdr *taskstats_receive(void) {
+    while(true) {
+        ssize_t rc = recv(ts.fd, ts.buffer, sizeof(ts.buffer), 0);
+        if(rc < 0) {
+            if(errno == EINTR)
+                continue;
+
+            return NULL;
+        }
+
+        struct nlmsghdr *nlh = (struct nlmsghdr *)ts.buffer;
+        if(!NLMSG_OK(nlh, (size_t)rc)) {
+            errno = EBADMSG;
+            return NULL;
+        }
+
+        // a late reply to a request we have given up on
+        if(nlh->nlmsg_seq != ts.seq)
+            continue;
+
+        if(nlh->nlmsg_type == NLMSG_ERROR) {
+            struct nlmsgerr *err = NLMSG_DATA(nlh);
+            errno = err->error ? -err->error : EBADMSG;
+            return NULL;
+        }
+
+        return nlh;
+    }
+}
+
+static bool taskstats_resolve_family(void) {
+    static const char name[] = TASKSTATS_GENL_NAME;
+
+    if(!taskstats_send(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, CTRL_ATTR_FAMILY_NAME, name, sizeof(name)))
+        return false;
+
+    struct nlmsghdr *nlh = taskstats_receive();
+    if(!nlh)
+        return false;
+
+    int len = (int)(nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+    struct nlattr *na = GENLMSG_DATA(nlh);
+    while(len >= NLA_HDRLEN && na->nla_len >= NLA_HDRLEN && na->nla_len <= len) {
+        if(na->nla_type == CTRL_ATTR_FAMILY_ID) {
+            ts.family_id = *(uint16_t *)NLA_DATA(na);
+            return true;
+        }
+
+        len -= NLA_ALIGN(na->nla_len);
+        na = (struct nlattr *)((char *)na + NLA_ALIGN(na->nla_len));
+    }
+
+    errno = ENOENT;
+    return false;
+}
+
+// query the kernel for a thread group
+// returns true and fills signature with the sum of its cpu time and context switches
+static bool taskstats_query_tgid(pid_t pid, uint64_t *signature) {
+    uint32_t tgid = (uint32_t)pid;
+
+    taskstats_calls_counter++;
+
+    if(!taskstats_send(ts.family_id, TASKSTATS_CMD_GET, TASKSTATS_CMD_ATTR_TGID, &tgid, sizeof(tgid)))
+        return false;
+
+    struct nlmsghdr *nlh = taskstats_receive();
+    if(!nlh)
+        return false;
+
+    int len = (int)(nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN));
+    struct nlattr *na = GENLMSG_DATA(nlh);
+    while(len >= NLA_HDRLEN && na->nla_len >= NLA_HDRLEN && na->nla_len <= len) {
+        if(na->nla_type == TASKSTATS_TYPE_AGGR_TGID) {
+            int aggr_len = na->nla_len - NLA_HDRLEN;
+            struct nlattr *a = NLA_DATA(na);
+
+            while(aggr_len >= NLA_HDRLEN && a->nla_len >= NLA_HDRLEN && a->nla_len <= aggr_len) {
+                if(a->nla_type == TASKSTATS_TYPE_STATS) {
+                    // older kernels send a shorter structure
+                    size_t size = a->nla_len - NLA_HDRLEN;
+                    if(size < offsetof(struct taskstats, nivcsw) + sizeof(((struct taskstats *)NULL)->nivcsw)) {
+                        errno = EPROTO;
+                        return false;
+                    }
+
+                    struct taskstats *t = NLA_DATA(a);
+                    *signature = t->ac_utime + t->ac_stime + t->nvcsw + t->nivcsw;
+                    return true;
+                }
+
+                aggr_len -= NLA_ALIGN(a->nla_len);
+                a = (struct nlattr *)((char *)a + NLA_ALIGN(a->nla_len));
+            }
+        }
+
+        len -= NLA_ALIGN(na->nla_len);
+        na = (struct nlattr *)((char *)na + NLA_ALIGN(na->nla_len));
+    }
+
+    errno = ENOENT;
+    return false;
+}
+
+static void taskstats_disable(const char *reason) {
+    netdata_log_error("TASKSTATS: %s. Falling back to reading /proc for all processes.", reason);
+
+    if(ts.fd != -1) {
+        close(ts.fd);
+        ts.fd = -1;
+    }
+
+    enable_taskstats = false;
+}
+
+void taskstats_init(void) {
+    if(!enable_taskstats)
+        return;
+
+    if(netdata_configured_host_prefix && *netdata_configured_host_prefix) {
+        // taskstats answers for our own pid namespace, not the one of the host prefix
+        taskstats_disable("taskstats cannot be used when a host prefix is configured");
+        return;
+    }
+
+    ts.fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if(ts.fd == -1) {
+        taskstats_disable("cannot create generic netlink socket");
+        return;
+    }
+
+    struct sockaddr_nl addr = { .nl_family = AF_NETLINK };
+    if(bind(ts.fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        taskstats_disable("cannot bind generic netlink socket");
+        return;
+    }
+
+    if(!taskstats_resolve_family()) {
+        taskstats_disable("cannot find the " TASKSTATS_GENL_NAME " netlink family (is CONFIG_TASKSTATS enabled?)");
+        return;
+    }
+
+    // taskstats requires CAP_NET_ADMIN - find out now, instead of on every process
+    uint64_t signature;
+    if(!taskstats_query_tgid(getpid(), &signature)) {
+        if(errno == EPERM || errno == EACCES)
+            taskstats_disable("apps.plugin needs CAP_NET_ADMIN to query taskstats");
+        else
+            taskstats_disable("cannot query taskstats");
+
+        return;
+    }
+
+    if(taskstats_refresh_iterations < 1)
+        taskstats_refresh_iterations = 1;
+
+    netdata_log_info("TASKSTATS: enabled, idle processes will be fully read every %d iterations", taskstats_refresh_iterations);
+}
+
+// returns true when the process has not run since its last full read,
+// so that all the values collected then are still valid
+bool taskstats_pid_has_not_run(struct pid_stat *p) {
+    if(!enable_taskstats)
+        return false;
+
+    uint64_t signature;
+    if(unlikely(!taskstats_query_tgid(p->pid, &signature))) {
+        // the process may have exited, let /proc decide
+        p->taskstats_full_read_iteration = 0;
+        return false;
+    }
+
+    bool not_run =
+            p->taskstats_full_read_iteration &&
+            p->taskstats_signature == signature &&
+            global_iterations_counter - p->taskstats_full_read_iteration < (size_t)taskstats_refresh_iterations &&
+
+            // a process that was on a cpu may not have been switched out since
+            p->state != 'R' && !p->utime && !p->stime &&
+
+            // reparenting does not require the process to run
+            (!p->ppid || find_pid_entry(p->ppid));
+
+    p->taskstats_signature = signature;
+
+    if(!not_run)
+        p->taskstats_full_read_iteration = global_iterations_counter;
+
+    return not_run;
+}
+
+// the process has not run - carry forward its values, with zero rates
+void taskstats_pid_keep_last_values(struct pid_stat *p) {
+    taskstats_idle_counter++;
+
+    usec_t now_ut = now_monotonic_usec();
+
+    p->last_stat_collected_usec = p->stat_collected_usec;
+    p->stat_collected_usec = now_ut;
+    p->last_io_collected_usec = p->io_collected_usec;
+    p->io_collected_usec = now_ut;
+
+    p->minflt = 0;
+    p->cminflt = 0;
+    p->majflt = 0;
+    p->cmajflt = 0;
+    p->utime = 0;
+    p->stime = 0;
+    p->gtime = 0;
+    p->cutime = 0;
+    p->cstime = 0;
+    p->cgtime = 0;
+
+    p->status_voluntary_ctxt_switches = 0;
+    p->status_nonvoluntary_ctxt_switches = 0;
+
+    p->io_logical_bytes_read = 0;
+    p->io_logical_bytes_written = 0;
+    p->io_read_calls = 0;
+    p->io_write_calls = 0;
+    p->io_storage_bytes_read = 0;
+    p->io_storage_bytes_written = 0;
+    p->io_cancelled_write_bytes = 0;
+
+    p->uptime = (system_uptime_secs > p->collected_starttime) ? (system_uptime_secs - p->collected_starttime) : 0;
+
+    update_proc_state_count(p->state);
+}
+
+#endif // !__FreeBSD__ && !__APPLE__
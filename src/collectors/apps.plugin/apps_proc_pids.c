@@ -94,6 +94,16 @@ static inline int collect_data_for_pid(pid_t pid, void *ptr) {
 
     // debug_log("Reading process %d (%s), sortlist %d", p->pid, p->comm, p->sortlist);
 
+#if !defined(__FreeBSD__) && !defined(__APPLE__)
+    // --------------------------------------------------------------------
+    // taskstats: nothing to read if the process has not run
+
+    if(enable_taskstats && taskstats_pid_has_not_run(p)) {
+        taskstats_pid_keep_last_values(p);
+        goto done;
+    }
+#endif
+
     // --------------------------------------------------------------------
     // /proc/<pid>/stat
 
@@ -130,6 +140,9 @@ static inline int collect_data_for_pid(pid_t pid, void *ptr) {
     // --------------------------------------------------------------------
     // done!
 
+#if !defined(__FreeBSD__) && !defined(__APPLE__)
+done:
+#endif
     if(unlikely(debug_enabled && include_exited_childs && all_pids_count && p->ppid && all_pids[p->ppid] && !all_pids[p->ppid]->read))
         debug_log("Read process %d (%s) sortlisted %d, but its parent %d (%s) sortlisted %d, is not read", p->pid, p->comm, p->sortlist, all_pids[p->ppid]->pid, all_pids[p->ppid]->comm, all_pids[p->ppid]->sortlist);
 
@@ -2,6 +2,8 @@
 
 #include "cgroup-internals.h"
 
+#include <sys/inotify.h>
+
 // discovery cgroup thread worker jobs
 #define WORKER_DISCOVERY_INIT               0
 #define WORKER_DISCOVERY_FIND               1
@@ -21,6 +23,9 @@
 
 struct cgroup *discovered_cgroup_root = NULL;
 
+// the time spent discovering cgroups, for the statistics of the main thread
+usec_t cgroup_discovery_time_ut = 0;
+
 char cgroup_chart_id_prefix[] = "cgroup_";
 char services_chart_id_prefix[] = "systemd_";
 char *cgroups_rename_script = NULL;
@@ -40,6 +45,57 @@ static inline void free_pressure(struct pressure *res) {
     freez(res->filename);
 }
 
+// ----------------------------------------------------------------------------
+// the files of each cgroup are kept open while it exists, and are re-read with pread()
+
+#define CGROUP_FDS_MAX 19
+
+static inline size_t cgroup_fds(struct cgroup *cg, int *fds[CGROUP_FDS_MAX]) {
+    size_t i = 0;
+
+    fds[i++] = &cg->cpuacct_stat.fd;
+    fds[i++] = &cg->cpuacct_usage.fd;
+    fds[i++] = &cg->cpuacct_cpu_throttling.fd;
+    fds[i++] = &cg->cpuacct_cpu_shares.fd;
+    fds[i++] = &cg->memory.fd_usage_in_bytes;
+    fds[i++] = &cg->memory.fd_detailed;
+    fds[i++] = &cg->memory.fd_msw_usage_in_bytes;
+    fds[i++] = &cg->memory.fd_failcnt;
+    fds[i++] = &cg->io_service_bytes.fd;
+    fds[i++] = &cg->io_serviced.fd;
+    fds[i++] = &cg->throttle_io_service_bytes.fd;
+    fds[i++] = &cg->throttle_io_serviced.fd;
+    fds[i++] = &cg->io_merged.fd;
+    fds[i++] = &cg->io_queued.fd;
+    fds[i++] = &cg->pids_current.fd;
+    fds[i++] = &cg->cpu_pressure.fd;
+    fds[i++] = &cg->io_pressure.fd;
+    fds[i++] = &cg->memory_pressure.fd;
+    fds[i++] = &cg->irq_pressure.fd;
+
+    return i;
+}
+
+static inline void cgroup_fds_init(struct cgroup *cg) {
+    int *fds[CGROUP_FDS_MAX];
+    size_t n = cgroup_fds(cg, fds);
+
+    for(size_t i = 0; i < n ;i++)
+        *fds[i] = -1;
+}
+
+static inline void cgroup_fds_close(struct cgroup *cg) {
+    int *fds[CGROUP_FDS_MAX];
+    size_t n = cgroup_fds(cg, fds);
+
+    for(size_t i = 0; i < n ;i++) {
+        if(*fds[i] != -1) {
+            close(*fds[i]);
+            *fds[i] = -1;
+        }
+    }
+}
+
 static inline void cgroup_free_network_interfaces(struct cgroup *cg) {
     while(cg->interfaces) {
         struct cgroup_network_interface *i = cg->interfaces;
@@ -89,6 +145,8 @@ static inline void cgroup_free(struct cgroup *cg) {
 
     cgroup_free_network_interfaces(cg);
 
+    cgroup_fds_close(cg);
+
     freez(cg->cpuacct_usage.cpu_percpu);
 
     freez(cg->cpuacct_stat.filename);
@@ -292,6 +350,7 @@ static inline struct cgroup *discovery_cgroup_add(const char *id) {
     netdata_log_debug(D_CGROUP, "adding to list, cgroup with id '%s'", id);
 
     struct cgroup *cg = callocz(1, sizeof(struct cgroup));
+    cgroup_fds_init(cg);
 
     cg->id = strdupz(id);
     cg->hash = simple_hash(cg->id);
@@ -335,6 +394,87 @@ static inline struct cgroup *discovery_cgroup_find(const char *id) {
     return cg;
 }
 
+// ----------------------------------------------------------------------------
+// inotify based discovery
+//
+// Every directory the discovery walks is watched for subdirectories being
+// created, removed or renamed, so that the main thread can trigger a discovery
+// on its next iteration, instead of waiting for the periodic rescan.
+// inotify is not recursive, so new directories get their watches when the
+// discovery walks them. Watches of removed directories are dropped by the kernel.
+
+bool cgroup_use_inotify = true;
+
+static struct {
+    int fd;
+    bool exhausted; // we run out of inotify watches
+} discovery_inotify = {
+    .fd = -1,
+};
+
+#define CGROUP_INOTIFY_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR)
+
+void cgroup_discovery_inotify_init(void) {
+    if(!cgroup_use_inotify)
+        return;
+
+    discovery_inotify.fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(discovery_inotify.fd == -1) {
+        collector_error("CGROUP: cannot initialize inotify, new cgroups will be found by the periodic rescan only");
+        cgroup_use_inotify = false;
+    }
+}
+
+// true when inotify notifies us about all the directories we walk
+bool cgroup_discovery_inotify_active(void) {
+    return discovery_inotify.fd != -1 && !__atomic_load_n(&discovery_inotify.exhausted, __ATOMIC_RELAXED);
+}
+
+static void discovery_inotify_watch(const char *dirpath) {
+    if(discovery_inotify.fd == -1 || __atomic_load_n(&discovery_inotify.exhausted, __ATOMIC_RELAXED))
+        return;
+
+    // adding a watch to a directory we already watch, just returns its existing watch descriptor
+    if(inotify_add_watch(discovery_inotify.fd, dirpath, CGROUP_INOTIFY_MASK) == -1) {
+        if(errno == ENOSPC) {
+            collector_error("CGROUP: cannot add more inotify watches (%s). "
+                            "Increase fs.inotify.max_user_watches; "
+                            "until netdata is restarted, new cgroups will be found by the periodic rescan only.",
+                            dirpath);
+            __atomic_store_n(&discovery_inotify.exhausted, true, __ATOMIC_RELAXED);
+        }
+        else if(errno != ENOENT)
+            collector_error("CGROUP: cannot add inotify watch for '%s'", dirpath);
+    }
+}
+
+// called by the main thread on every iteration
+// consumes all pending events and returns true when a directory was created, removed or renamed
+bool cgroup_discovery_inotify_changed(void) {
+    if(discovery_inotify.fd == -1)
+        return false;
+
+    char buffer[sizeof(struct inotify_event) + NAME_MAX + 1] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+
+    while(true) {
+        ssize_t len = read(discovery_inotify.fd, buffer, sizeof(buffer));
+        if(len <= 0)
+            break;
+
+        for(char *ptr = buffer; ptr < buffer + len; ) {
+            const struct inotify_event *event = (const struct inotify_event *)ptr;
+
+            if((event->mask & IN_Q_OVERFLOW) || ((event->mask & IN_ISDIR) && (event->mask & CGROUP_INOTIFY_MASK)))
+                changed = true;
+
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
+
 static int calc_cgroup_depth(const char *id) {
     int depth = 0;
     const char *s;
@@ -400,6 +540,9 @@ static inline int discovery_find_walkdir(const char *base, const char *dirpath)
 
     discovery_find_cgroup_in_dir(relative_path);
 
+    if(discovery_inotify.fd != -1 && matches_search_cgroup_paths(relative_path))
+        discovery_inotify_watch(dirpath);
+
     struct dirent *de = NULL;
     while((de = readdir(dir))) {
         if (de->d_type == DT_DIR && ((de->d_name[0] == '.' && de->d_name[1] == '\0') ||
@@ -1290,7 +1433,9 @@ void cgroup_discovery_worker(void *ptr)
         if (unlikely(!service_running(SERVICE_COLLECTORS)))
             break;
 
+        usec_t started_ut = now_monotonic_usec();
         discovery_find_all_cgroups();
+        __atomic_add_fetch(&cgroup_discovery_time_ut, now_monotonic_usec() - started_ut, __ATOMIC_RELAXED);
     }
     collector_info("discovery thread stopped");
     cgroup_cleanup_ebpf_integration();
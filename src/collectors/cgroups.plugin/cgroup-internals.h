@@ -11,6 +11,7 @@
 
 struct blkio {
     char *filename;
+    int fd;
     bool staterr;
 
     int updated;
@@ -21,6 +22,7 @@ struct blkio {
 
 struct pids {
     char *filename;
+    int fd;
     bool staterr;
 
     int updated;
@@ -39,6 +41,11 @@ struct memory {
     char *filename_msw_usage_in_bytes;
     char *filename_failcnt;
 
+    int fd_usage_in_bytes;
+    int fd_detailed;
+    int fd_msw_usage_in_bytes;
+    int fd_failcnt;
+
     bool staterr_mem_current;
     bool staterr_mem_stat;
     bool staterr_failcnt;
@@ -81,6 +88,7 @@ struct memory {
 // https://www.kernel.org/doc/Documentation/cgroup-v1/cpuacct.txt
 struct cpuacct_stat {
     char *filename;
+    int fd;
     bool staterr;
 
     int updated;
@@ -92,6 +100,7 @@ struct cpuacct_stat {
 // https://www.kernel.org/doc/Documentation/cgroup-v1/cpuacct.txt
 struct cpuacct_usage {
     char *filename;
+    int fd;
     bool disabled;
     int updated;
 
@@ -102,6 +111,7 @@ struct cpuacct_usage {
 // represents cpuacct/cpu.stat, for v2 'cpuacct_stat' is used for 'user_usec', 'system_usec'
 struct cpuacct_cpu_throttling {
     char *filename;
+    int fd;
     bool staterr;
 
     int updated;
@@ -117,6 +127,7 @@ struct cpuacct_cpu_throttling {
 // https://access.redhat.com/documentation/en-us/red_hat_enterprise_linux/8/html/managing_monitoring_and_updating_the_kernel/using-cgroups-v2-to-control-distribution-of-cpu-time-for-applications_managing-monitoring-and-updating-the-kernel#proc_controlling-distribution-of-cpu-time-for-applications-by-adjusting-cpu-weight_using-cgroups-v2-to-control-distribution-of-cpu-time-for-applications
 struct cpuacct_cpu_shares {
     char *filename;
+    int fd;
     bool staterr;
 
     int updated;
@@ -280,6 +291,13 @@ extern uv_mutex_t cgroup_root_mutex;
 
 void cgroup_discovery_worker(void *ptr);
 
+extern bool cgroup_use_inotify;
+void cgroup_discovery_inotify_init(void);
+bool cgroup_discovery_inotify_active(void);
+bool cgroup_discovery_inotify_changed(void);
+
+extern usec_t cgroup_discovery_time_ut;
+
 extern bool is_inside_k8s;
 extern long system_page_size;
 
@@ -293,6 +311,7 @@ extern bool cgroup_enable_pressure;
 extern bool cgroup_enable_cpuacct_cpu_shares;
 
 extern int cgroup_check_for_new_every;
+extern int cgroup_check_for_new_with_inotify_every;
 extern int cgroup_update_every;
 
 extern char *cgroup_cpuacct_base;
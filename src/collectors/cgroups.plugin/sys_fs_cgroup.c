@@ -23,6 +23,7 @@ bool cgroup_enable_cpuacct = true;
 bool cgroup_enable_cpuacct_cpu_shares = false;
 
 int cgroup_check_for_new_every = 10;
+int cgroup_check_for_new_with_inotify_every = 60;
 int cgroup_update_every = 1;
 char *cgroup_cpuacct_base = NULL;
 char *cgroup_cpuset_base = NULL;
@@ -237,6 +238,13 @@ void read_cgroup_plugin_configuration() {
     if(cgroup_check_for_new_every < cgroup_update_every)
         cgroup_check_for_new_every = cgroup_update_every;
 
+    // with inotify, new and removed cgroups trigger a discovery immediately,
+    // so the periodic rescan is only a safety net
+    cgroup_use_inotify = config_get_boolean("plugin:cgroups", "detect new cgroups with inotify", cgroup_use_inotify);
+    cgroup_check_for_new_with_inotify_every = (int)config_get_number("plugin:cgroups", "check for new cgroups with inotify every", cgroup_check_for_new_with_inotify_every);
+    if(cgroup_check_for_new_with_inotify_every < cgroup_check_for_new_every)
+        cgroup_check_for_new_with_inotify_every = cgroup_check_for_new_every;
+
     cgroup_use_unified_cgroups = config_get_boolean_ondemand("plugin:cgroups", "use unified cgroups", CONFIG_BOOLEAN_AUTO);
     if (cgroup_use_unified_cgroups == CONFIG_BOOLEAN_AUTO)
         cgroup_use_unified_cgroups = (cgroups_try_detect_version() == CGROUPS_V2);
@@ -459,18 +467,73 @@ static unsigned long long calc_percentage(unsigned long long value, unsigned lon
 // ----------------------------------------------------------------------------
 // read values from /sys
 
-static inline void cgroup_read_cpuacct_stat(struct cpuacct_stat *cp) {
-    static procfile *ff = NULL;
+// The files of each cgroup are opened once and then re-read with pread() on
+// every iteration. The parsing buffers are not kept per file: with thousands
+// of cgroups that would be too much memory, so each reading thread has its own.
+static __thread procfile *cgroup_ff = NULL;
+static __thread procfile *cgroup_ff_pressure = NULL;
+
+static inline bool cgroup_open_file(int *fd, const char *filename) {
+    if(likely(*fd != -1))
+        return true;
+
+    *fd = open(filename, O_RDONLY | O_CLOEXEC, 0666);
+    if(unlikely(*fd == -1)) {
+        if(errno == EMFILE || errno == ENFILE) {
+            nd_log_limit_static_global_var(erl, 60, 0);
+            nd_log_limit(&erl, NDLS_COLLECTORS, NDLP_ERR,
+                         "CGROUP: too many open files, cannot open '%s'. Increase the open files limit of netdata.",
+                         filename);
+        }
+        return false;
+    }
 
-    if(likely(cp->filename)) {
-        ff = procfile_reopen(ff, cp->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if(unlikely(!ff)) {
-            cp->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
+    return true;
+}
 
-        ff = procfile_readall(ff);
+static inline void cgroup_close_file(int *fd) {
+    if(*fd != -1) {
+        close(*fd);
+        *fd = -1;
+    }
+}
+
+// returns the parsed file, or NULL when the file cannot be read
+// (the cgroup may have been removed - its fd is closed to be opened again)
+static inline procfile *cgroup_procfile_read(procfile **ff, int *fd, const char *filename, const char *separators) {
+    if(unlikely(!cgroup_open_file(fd, filename)))
+        return NULL;
+
+    *ff = procfile_readall_fd(*ff, *fd, separators, CGROUP_PROCFILE_FLAG);
+    if(unlikely(!*ff))
+        cgroup_close_file(fd);
+
+    return *ff;
+}
+
+// like read_single_number_file(), on a kept open file
+static inline int cgroup_read_single_number_file(int *fd, const char *filename, unsigned long long *result) {
+    char buffer[30 + 1];
+
+    *result = 0;
+
+    if(unlikely(!cgroup_open_file(fd, filename)))
+        return 1;
+
+    ssize_t r = pread(*fd, buffer, sizeof(buffer) - 1, 0);
+    if(unlikely(r <= 0)) {
+        cgroup_close_file(fd);
+        return 2;
+    }
+
+    buffer[r] = '\0';
+    *result = str2ull(buffer, NULL);
+    return 0;
+}
+
+static inline void cgroup_read_cpuacct_stat(struct cpuacct_stat *cp) {
+    if(likely(cp->filename)) {
+        procfile *ff = cgroup_procfile_read(&cgroup_ff, &cp->fd, cp->filename, NULL);
         if(unlikely(!ff)) {
             cp->updated = 0;
             cgroups_check = 1;
@@ -505,15 +568,7 @@ static inline void cgroup_read_cpuacct_cpu_stat(struct cpuacct_cpu_throttling *c
         return;
     }
 
-    static procfile *ff = NULL;
-    ff = procfile_reopen(ff, cp->filename, NULL, CGROUP_PROCFILE_FLAG);
-    if (unlikely(!ff)) {
-        cp->updated = 0;
-        cgroups_check = 1;
-        return;
-    }
-
-    ff = procfile_readall(ff);
+    procfile *ff = cgroup_procfile_read(&cgroup_ff, &cp->fd, cp->filename, NULL);
     if (unlikely(!ff)) {
         cp->updated = 0;
         cgroups_check = 1;
@@ -549,19 +604,11 @@ static inline void cgroup_read_cpuacct_cpu_stat(struct cpuacct_cpu_throttling *c
 }
 
 static inline void cgroup2_read_cpuacct_cpu_stat(struct cpuacct_stat *cp, struct cpuacct_cpu_throttling *cpt) {
-    static procfile *ff = NULL;
     if (unlikely(!cp->filename)) {
         return;
     }
 
-    ff = procfile_reopen(ff, cp->filename, NULL, CGROUP_PROCFILE_FLAG);
-    if (unlikely(!ff)) {
-        cp->updated = 0;
-        cgroups_check = 1;
-        return;
-    }
-
-    ff = procfile_readall(ff);
+    procfile *ff = cgroup_procfile_read(&cgroup_ff, &cp->fd, cp->filename, NULL);
     if (unlikely(!ff)) {
         cp->updated = 0;
         cgroups_check = 1;
@@ -607,7 +654,7 @@ static inline void cgroup_read_cpuacct_cpu_shares(struct cpuacct_cpu_shares *cp)
         return;
     }
 
-    if (unlikely(read_single_number_file(cp->filename, &cp->shares))) {
+    if (unlikely(cgroup_read_single_number_file(&cp->fd, cp->filename, &cp->shares))) {
         cp->updated = 0;
         cgroups_check = 1;
         return;
@@ -617,17 +664,8 @@ static inline void cgroup_read_cpuacct_cpu_shares(struct cpuacct_cpu_shares *cp)
 }
 
 static inline void cgroup_read_cpuacct_usage(struct cpuacct_usage *ca) {
-    static procfile *ff = NULL;
-
     if(likely(ca->filename)) {
-        ff = procfile_reopen(ff, ca->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if(unlikely(!ff)) {
-            ca->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_procfile_read(&cgroup_ff, &ca->fd, ca->filename, NULL);
         if(unlikely(!ff)) {
             ca->updated = 0;
             cgroups_check = 1;
@@ -672,16 +710,7 @@ static inline void cgroup_read_cpuacct_usage(struct cpuacct_usage *ca) {
 
 static inline void cgroup_read_blkio(struct blkio *io) {
     if (likely(io->filename)) {
-        static procfile *ff = NULL;
-
-        ff = procfile_reopen(ff, io->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if (unlikely(!ff)) {
-            io->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_procfile_read(&cgroup_ff, &io->fd, io->filename, NULL);
         if (unlikely(!ff)) {
             io->updated = 0;
             cgroups_check = 1;
@@ -715,16 +744,7 @@ static inline void cgroup_read_blkio(struct blkio *io) {
 
 static inline void cgroup2_read_blkio(struct blkio *io, unsigned int word_offset) {
     if (likely(io->filename)) {
-        static procfile *ff = NULL;
-
-        ff = procfile_reopen(ff, io->filename, NULL, CGROUP_PROCFILE_FLAG);
-        if (unlikely(!ff)) {
-            io->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_procfile_read(&cgroup_ff, &io->fd, io->filename, NULL);
         if (unlikely(!ff)) {
             io->updated = 0;
             cgroups_check = 1;
@@ -752,17 +772,8 @@ static inline void cgroup2_read_blkio(struct blkio *io, unsigned int word_offset
 }
 
 static inline void cgroup2_read_pressure(struct pressure *res) {
-    static procfile *ff = NULL;
-
     if (likely(res->filename)) {
-        ff = procfile_reopen(ff, res->filename, " =", CGROUP_PROCFILE_FLAG);
-        if (unlikely(!ff)) {
-            res->updated = 0;
-            cgroups_check = 1;
-            return;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_procfile_read(&cgroup_ff_pressure, &res->fd, res->filename, " =");
         if (unlikely(!ff)) {
             res->updated = 0;
             cgroups_check = 1;
@@ -803,17 +814,8 @@ static inline void cgroup2_read_pressure(struct pressure *res) {
 }
 
 static inline void cgroup_read_memory(struct memory *mem, char parent_cg_is_unified) {
-    static procfile *ff = NULL;
-
     if(likely(mem->filename_detailed)) {
-        ff = procfile_reopen(ff, mem->filename_detailed, NULL, CGROUP_PROCFILE_FLAG);
-        if(unlikely(!ff)) {
-            mem->updated_detailed = 0;
-            cgroups_check = 1;
-            goto memory_next;
-        }
-
-        ff = procfile_readall(ff);
+        procfile *ff = cgroup_procfile_read(&cgroup_ff, &mem->fd_detailed, mem->filename_detailed, NULL);
         if(unlikely(!ff)) {
             mem->updated_detailed = 0;
             cgroups_check = 1;
@@ -881,7 +883,7 @@ static inline void cgroup_read_memory(struct memory *mem, char parent_cg_is_unif
 memory_next:
 
     if (likely(mem->filename_usage_in_bytes)) {
-        mem->updated_usage_in_bytes = !read_single_number_file(mem->filename_usage_in_bytes, &mem->usage_in_bytes);
+        mem->updated_usage_in_bytes = !cgroup_read_single_number_file(&mem->fd_usage_in_bytes, mem->filename_usage_in_bytes, &mem->usage_in_bytes);
     }
 
     if (likely(mem->updated_usage_in_bytes && mem->updated_detailed)) {
@@ -891,11 +893,11 @@ memory_next:
 
     if (likely(mem->filename_msw_usage_in_bytes)) {
         mem->updated_msw_usage_in_bytes =
-            !read_single_number_file(mem->filename_msw_usage_in_bytes, &mem->msw_usage_in_bytes);
+            !cgroup_read_single_number_file(&mem->fd_msw_usage_in_bytes, mem->filename_msw_usage_in_bytes, &mem->msw_usage_in_bytes);
     }
 
     if (likely(mem->filename_failcnt)) {
-        mem->updated_failcnt = !read_single_number_file(mem->filename_failcnt, &mem->failcnt);
+        mem->updated_failcnt = !cgroup_read_single_number_file(&mem->fd_failcnt, mem->filename_failcnt, &mem->failcnt);
     }
 }
 
@@ -905,7 +907,7 @@ static void cgroup_read_pids_current(struct pids *pids) {
     if (unlikely(!pids->filename))
         return;
 
-    pids->updated = !read_single_number_file(pids->filename, &pids->pids_current);
+    pids->updated = !cgroup_read_single_number_file(&pids->fd, pids->filename, &pids->pids_current);
 }
 
 static inline void read_cgroup(struct cgroup *cg) {
@@ -937,15 +939,180 @@ static inline void read_cgroup(struct cgroup *cg) {
     }
 }
 
-static inline void read_all_discovered_cgroups(struct cgroup *root) {
+// ----------------------------------------------------------------------------
+// parallel reading of cgroups
+//
+// The main thread collects the cgroups to be read into a batch, and the
+// reader threads (and the main thread itself) pick entries from it, until
+// all of them have been read. The main thread holds cgroup_root_mutex while
+// the batch is being read, so the discovery thread cannot free them.
+
+#define CGROUP_READ_MAX_THREADS 16
+
+// below this, waking up the readers costs more than it saves
+#define CGROUP_READ_PARALLEL_MIN 64
+
+static struct {
+    size_t threads;
+    ND_THREAD *readers[CGROUP_READ_MAX_THREADS];
+
+    netdata_mutex_t mutex;
+    pthread_cond_t cond;        // the readers wait here for a new batch
+    pthread_cond_t cond_done;   // the main thread waits here for the batch to be read
+    bool exit;
+
+    struct cgroup **batch;
+    size_t size;
+    size_t entries;
+    size_t generation;
+    size_t busy;                // readers working on the current batch
+
+    size_t next;                // atomic, the next entry to be read
+    size_t completed;           // atomic, the entries read so far
+} cgroup_readers = {
+    .mutex = NETDATA_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .cond_done = PTHREAD_COND_INITIALIZER,
+};
+
+static void cgroup_read_batch(void) {
+    size_t done = 0, i;
+
+    while((i = __atomic_fetch_add(&cgroup_readers.next, 1, __ATOMIC_RELAXED)) < cgroup_readers.entries) {
+        read_cgroup(cgroup_readers.batch[i]);
+        done++;
+    }
+
+    if(done)
+        __atomic_add_fetch(&cgroup_readers.completed, done, __ATOMIC_RELEASE);
+}
+
+static void *cgroup_reader_thread_main(void *ptr __maybe_unused) {
+    worker_register("CGROUPSREAD");
+    worker_register_job_name(WORKER_CGROUPS_READ, "read");
+
+    size_t generation = 0;
+
+    netdata_mutex_lock(&cgroup_readers.mutex);
+    while(true) {
+        while(cgroup_readers.generation == generation && !cgroup_readers.exit)
+            pthread_cond_wait(&cgroup_readers.cond, &cgroup_readers.mutex);
+
+        if(cgroup_readers.exit)
+            break;
+
+        generation = cgroup_readers.generation;
+
+        // woke up too late, the main thread has already read all of them
+        if(__atomic_load_n(&cgroup_readers.next, __ATOMIC_RELAXED) >= cgroup_readers.entries)
+            continue;
+
+        cgroup_readers.busy++;
+        netdata_mutex_unlock(&cgroup_readers.mutex);
+
+        worker_is_busy(WORKER_CGROUPS_READ);
+        cgroup_read_batch();
+        worker_is_idle();
+
+        netdata_mutex_lock(&cgroup_readers.mutex);
+        cgroup_readers.busy--;
+        if(!cgroup_readers.busy)
+            pthread_cond_signal(&cgroup_readers.cond_done);
+    }
+    netdata_mutex_unlock(&cgroup_readers.mutex);
+
+    procfile_close(cgroup_ff);
+    procfile_close(cgroup_ff_pressure);
+    cgroup_ff = cgroup_ff_pressure = NULL;
+
+    worker_unregister();
+    return NULL;
+}
+
+static void cgroup_readers_start(size_t threads) {
+    // the main thread is also a reader
+    if(threads < 2)
+        return;
+
+    if(threads > CGROUP_READ_MAX_THREADS)
+        threads = CGROUP_READ_MAX_THREADS;
+
+    for(size_t t = 0; t < threads - 1 ;t++) {
+        char tag[NETDATA_THREAD_TAG_MAX + 1];
+        snprintfz(tag, NETDATA_THREAD_TAG_MAX, "P[cgroups #%zu]", t);
+
+        cgroup_readers.readers[t] = nd_thread_create(tag, NETDATA_THREAD_OPTION_JOINABLE, cgroup_reader_thread_main, NULL);
+        if(!cgroup_readers.readers[t]) {
+            collector_error("CGROUP: cannot create reader thread %zu", t);
+            break;
+        }
+
+        cgroup_readers.threads++;
+    }
+
+    collector_info("CGROUP: reading cgroups in parallel on %zu threads", cgroup_readers.threads + 1);
+}
+
+static void cgroup_readers_stop(void) {
+    netdata_mutex_lock(&cgroup_readers.mutex);
+    cgroup_readers.exit = true;
+    pthread_cond_broadcast(&cgroup_readers.cond);
+    netdata_mutex_unlock(&cgroup_readers.mutex);
+
+    for(size_t t = 0; t < cgroup_readers.threads ;t++)
+        nd_thread_join(cgroup_readers.readers[t]);
+
+    cgroup_readers.threads = 0;
+
+    freez(cgroup_readers.batch);
+    cgroup_readers.batch = NULL;
+    cgroup_readers.size = 0;
+}
+
+// returns the number of cgroups waiting for their renames to complete
+static inline size_t read_all_discovered_cgroups(struct cgroup *root) {
     netdata_log_debug(D_CGROUP, "reading metrics for all cgroups");
 
+    size_t entries = 0, pending_renames = 0;
+
     struct cgroup *cg;
     for (cg = root; cg; cg = cg->next) {
-        if (cg->enabled && !cg->pending_renames) {
-            read_cgroup(cg);
+        if (cg->enabled && cg->pending_renames)
+            pending_renames++;
+
+        else if (cg->enabled) {
+            if (unlikely(entries == cgroup_readers.size)) {
+                cgroup_readers.size = cgroup_readers.size ? cgroup_readers.size * 2 : 256;
+                cgroup_readers.batch = reallocz(cgroup_readers.batch, cgroup_readers.size * sizeof(struct cgroup *));
+            }
+            cgroup_readers.batch[entries++] = cg;
         }
     }
+
+    if (!cgroup_readers.threads || entries < CGROUP_READ_PARALLEL_MIN) {
+        for (size_t i = 0; i < entries; i++)
+            read_cgroup(cgroup_readers.batch[i]);
+
+        return pending_renames;
+    }
+
+    netdata_mutex_lock(&cgroup_readers.mutex);
+    cgroup_readers.entries = entries;
+    cgroup_readers.next = 0;
+    cgroup_readers.completed = 0;
+    cgroup_readers.generation++;
+    pthread_cond_broadcast(&cgroup_readers.cond);
+    netdata_mutex_unlock(&cgroup_readers.mutex);
+
+    cgroup_read_batch();
+
+    // wait for the readers to finish, so that no one touches the batch after we return
+    netdata_mutex_lock(&cgroup_readers.mutex);
+    while (cgroup_readers.busy || __atomic_load_n(&cgroup_readers.completed, __ATOMIC_ACQUIRE) < entries)
+        pthread_cond_wait(&cgroup_readers.cond_done, &cgroup_readers.mutex);
+    netdata_mutex_unlock(&cgroup_readers.mutex);
+
+    return pending_renames;
 }
 
 // update CPU and memory limits
@@ -1314,6 +1481,83 @@ void update_cgroup_charts() {
     }
 }
 
+// ----------------------------------------------------------------------------
+// cgroups.plugin statistics
+
+static struct {
+    // cumulative time spent per phase of the main loop
+    usec_t lock_ut;
+    usec_t read_ut;
+    usec_t chart_ut;
+
+    // the reasons the discovery was triggered
+    size_t discoveries_inotify;
+    size_t discoveries_periodic;
+    size_t discoveries_read_errors;
+    size_t discoveries_renames;
+} cgroup_stats = { 0 };
+
+static void cgroups_statistics(void) {
+    static RRDSET *st_phases = NULL, *st_discoveries = NULL;
+    static RRDDIM *rd_discovery, *rd_lock, *rd_read, *rd_chart;
+    static RRDDIM *rd_inotify, *rd_periodic, *rd_read_errors, *rd_renames;
+
+    if(!global_statistics_enabled)
+        return;
+
+    if(unlikely(!st_phases)) {
+        st_phases = rrdset_create_localhost(
+                "netdata"
+                , "plugin_cgroups_phases"
+                , NULL
+                , "cgroups.plugin"
+                , NULL
+                , "cgroups.plugin time spent per phase"
+                , "milliseconds/s"
+                , PLUGIN_CGROUPS_NAME
+                , "stats"
+                , 132210
+                , cgroup_update_every
+                , RRDSET_TYPE_STACKED);
+
+        rd_discovery = rrddim_add(st_phases, "discovery", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+        rd_lock = rrddim_add(st_phases, "lock", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+        rd_read = rrddim_add(st_phases, "read", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+        rd_chart = rrddim_add(st_phases, "chart", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+
+        st_discoveries = rrdset_create_localhost(
+                "netdata"
+                , "plugin_cgroups_discoveries"
+                , NULL
+                , "cgroups.plugin"
+                , NULL
+                , "cgroups.plugin discoveries triggered"
+                , "discoveries/s"
+                , PLUGIN_CGROUPS_NAME
+                , "stats"
+                , 132211
+                , cgroup_update_every
+                , RRDSET_TYPE_STACKED);
+
+        rd_inotify = rrddim_add(st_discoveries, "inotify", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+        rd_periodic = rrddim_add(st_discoveries, "periodic", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+        rd_read_errors = rrddim_add(st_discoveries, "read errors", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+        rd_renames = rrddim_add(st_discoveries, "renames", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+    }
+
+    rrddim_set_by_pointer(st_phases, rd_discovery, (collected_number)__atomic_load_n(&cgroup_discovery_time_ut, __ATOMIC_RELAXED));
+    rrddim_set_by_pointer(st_phases, rd_lock, (collected_number)cgroup_stats.lock_ut);
+    rrddim_set_by_pointer(st_phases, rd_read, (collected_number)cgroup_stats.read_ut);
+    rrddim_set_by_pointer(st_phases, rd_chart, (collected_number)cgroup_stats.chart_ut);
+    rrdset_done(st_phases);
+
+    rrddim_set_by_pointer(st_discoveries, rd_inotify, (collected_number)cgroup_stats.discoveries_inotify);
+    rrddim_set_by_pointer(st_discoveries, rd_periodic, (collected_number)cgroup_stats.discoveries_periodic);
+    rrddim_set_by_pointer(st_discoveries, rd_read_errors, (collected_number)cgroup_stats.discoveries_read_errors);
+    rrddim_set_by_pointer(st_discoveries, rd_renames, (collected_number)cgroup_stats.discoveries_renames);
+    rrdset_done(st_discoveries);
+}
+
 // ----------------------------------------------------------------------------
 // cgroups main
 
@@ -1326,6 +1570,11 @@ static void cgroup_main_cleanup(void *pptr) {
     collector_info("cleaning up...");
     worker_unregister();
 
+    cgroup_readers_stop();
+    procfile_close(cgroup_ff);
+    procfile_close(cgroup_ff_pressure);
+    cgroup_ff = cgroup_ff_pressure = NULL;
+
     usec_t max = 2 * USEC_PER_SEC, step = 50000;
 
     if (!__atomic_load_n(&discovery_thread.exited, __ATOMIC_RELAXED)) {
@@ -1390,6 +1639,8 @@ void *cgroups_main(void *ptr) {
         goto exit;
     }
 
+    cgroup_discovery_inotify_init();
+
     int error = uv_thread_create(&discovery_thread.thread, cgroup_discovery_worker, NULL);
     if (error) {
         collector_error("CGROUP: cannot create thread worker. uv_thread_create(): %s", uv_strerror(error));
@@ -1410,10 +1661,19 @@ void *cgroups_main(void *ptr) {
                             "top", HTTP_ACCESS_ANONYMOUS_DATA,
                             cgroup_function_systemd_top);
 
+    // reading thousands of cgroups (e.g. kubernetes nodes) takes more than a cpu
+    long cpus = (long)os_get_system_cpus();
+    long default_threads = cpus / 16 + 1;
+    if(default_threads > 4) default_threads = 4;
+    long threads = config_get_number("plugin:cgroups", "read threads", default_threads);
+    cgroup_readers_start(threads > 0 ? (size_t)threads : 1);
+
     heartbeat_t hb;
     heartbeat_init(&hb);
     usec_t step = cgroup_update_every * USEC_PER_SEC;
     usec_t find_every = cgroup_check_for_new_every * USEC_PER_SEC, find_dt = 0;
+    usec_t find_every_inotify = cgroup_check_for_new_with_inotify_every * USEC_PER_SEC;
+    size_t pending_renames = 0;
 
     while(service_running(SERVICE_COLLECTORS)) {
         worker_is_idle();
@@ -1423,8 +1683,23 @@ void *cgroups_main(void *ptr) {
         if (unlikely(!service_running(SERVICE_COLLECTORS)))
             break;
 
+        // renames are retried by the discovery, so keep it running frequently while there are any
+        bool inotify = cgroup_discovery_inotify_active();
+        bool changed = cgroup_discovery_inotify_changed();
+        usec_t every = (inotify && !pending_renames) ? find_every_inotify : find_every;
+
         find_dt += hb_dt;
-        if (unlikely(find_dt >= find_every || (!is_inside_k8s && cgroups_check))) {
+        bool read_errors = !is_inside_k8s && cgroups_check;
+        if (unlikely(changed || find_dt >= every || read_errors)) {
+            if (changed)
+                cgroup_stats.discoveries_inotify++;
+            else if (read_errors)
+                cgroup_stats.discoveries_read_errors++;
+            else if (pending_renames && inotify)
+                cgroup_stats.discoveries_renames++;
+            else
+                cgroup_stats.discoveries_periodic++;
+
             uv_mutex_lock(&discovery_thread.mutex);
             uv_cond_signal(&discovery_thread.cond_var);
             uv_mutex_unlock(&discovery_thread.mutex);
@@ -1432,11 +1707,19 @@ void *cgroups_main(void *ptr) {
             cgroups_check = 0;
         }
 
+        usec_t started_ut = now_monotonic_usec();
+
         worker_is_busy(WORKER_CGROUPS_LOCK);
         uv_mutex_lock(&cgroup_root_mutex);
 
+        usec_t locked_ut = now_monotonic_usec();
+        cgroup_stats.lock_ut += locked_ut - started_ut;
+
         worker_is_busy(WORKER_CGROUPS_READ);
-        read_all_discovered_cgroups(cgroup_root);
+        pending_renames = read_all_discovered_cgroups(cgroup_root);
+
+        usec_t read_ut = now_monotonic_usec();
+        cgroup_stats.read_ut += read_ut - locked_ut;
 
         if (unlikely(!service_running(SERVICE_COLLECTORS))) {
             uv_mutex_unlock(&cgroup_root_mutex);
@@ -1455,6 +1738,10 @@ void *cgroups_main(void *ptr) {
 
         worker_is_idle();
         uv_mutex_unlock(&cgroup_root_mutex);
+
+        cgroup_stats.chart_ut += now_monotonic_usec() - read_ut;
+
+        cgroups_statistics();
     }
 
 exit:
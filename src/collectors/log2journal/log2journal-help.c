@@ -296,6 +296,21 @@ void log_job_command_line_help(const char *name) {
     printf("       Show the configuration in YAML format before starting the job.\n");
     printf("       This is also an easy way to convert command line parameters to yaml.\n");
     printf("\n");
+    printf("  --threads N\n");
+    printf("       Parse lines with N parallel threads (default 1).\n");
+    printf("       Lines are read and written by separate threads, in batches,\n");
+    printf("       and the output preserves the order of the input lines.\n");
+    printf("\n");
+    printf("  --benchmark\n");
+    printf("       Read all of stdin into memory, process it repeatedly for a few\n");
+    printf("       seconds discarding the output, and report the throughput on stderr.\n");
+    printf("       Combine it with --threads N to compare different thread counts.\n");
+    printf("\n");
+    printf("  --scalar-parsers\n");
+    printf("       Make the json and logfmt parsers decode values character by character,\n");
+    printf("       instead of scanning for the spans that need no decoding.\n");
+    printf("       Useful only with --benchmark, to compare the two.\n");
+    printf("\n");
     printf("The program accepts all parameters as both --option=value and --option value.\n");
     printf("\n");
     printf("The maximum log line length accepted is %d characters.\n", MAX_LINE_LENGTH);
@@ -279,14 +279,57 @@ static inline bool json_parse_string(LOG_JSON_STATE *js) {
 
     json_consume_char(js);
 
+    const char *s = json_current_pos(js);
+
+    if(likely(!js->jb->scalar_parsers)) {
+        const char *e = find_first_of_2(s, '"', '\\');
+        if(*e != '\\') {
+            // no escapes - send the value directly from the line
+            size_t len = e - s;
+            if(len >= sizeof(value)) {
+                snprintf(js->msg, sizeof(js->msg),
+                         "JSON PARSER: truncated string value at position %u", js->pos);
+                return false;
+            }
+
+            js->pos += len;
+
+            if(!json_expect_char_after_white_space(js, "\""))
+                return false;
+
+            json_consume_char(js);
+
+            if(len)
+                json_process_key_value(js, s, len);
+
+            return true;
+        }
+    }
+
     value[0] = '\0';
     char *d = value;
-    const char *s = json_current_pos(js);
     size_t remaining = sizeof(value);
 
     while (*s && *s != '"') {
         char c;
 
+        if (*s != '\\' && likely(!js->jb->scalar_parsers)) {
+            // copy everything up to the next quote or escape at once
+            const char *e = find_first_of_2(s, '"', '\\');
+            size_t len = e - s;
+            if(len >= remaining) {
+                snprintf(js->msg, sizeof(js->msg),
+                         "JSON PARSER: truncated string value at position %u", js->pos);
+                return false;
+            }
+
+            memcpy(d, s, len);
+            d += len;
+            s += len;
+            remaining -= len;
+            continue;
+        }
+
         if (*s == '\\') {
             s++;
 
@@ -58,15 +58,64 @@ static inline bool logftm_parse_value(LOGFMT_STATE *lfs) {
         logfmt_consume_char(lfs);
     }
 
+    s = logfmt_current_pos(lfs);
+    char end_char = (char)(quote == '\0' ? ' ' : quote);
+
+    if(likely(!lfs->jb->scalar_parsers)) {
+        const char *e = find_first_of_2(s, end_char, '\\');
+        if(*e != '\\') {
+            // no escapes - send the value directly from the line
+            size_t len = e - s;
+            if(len >= sizeof(value)) {
+                snprintf(lfs->msg, sizeof(lfs->msg),
+                         "LOGFMT PARSER: truncated string value at position %u", lfs->pos);
+                return false;
+            }
+
+            lfs->pos += len;
+
+            if(quote != '\0') {
+                if (*e != quote) {
+                    snprintf(lfs->msg, sizeof(lfs->msg),
+                             "LOGFMT PARSER: missing quote at position %u: '%s'",
+                             lfs->pos, e);
+                    return false;
+                }
+                else
+                    logfmt_consume_char(lfs);
+            }
+
+            if(len)
+                logfmt_process_key_value(lfs, s, len);
+
+            return true;
+        }
+    }
+
     value[0] = '\0';
     char *d = value;
-    s = logfmt_current_pos(lfs);
     size_t remaining = sizeof(value);
 
-    char end_char = (char)(quote == '\0' ? ' ' : quote);
     while (*s && *s != end_char) {
         char c;
 
+        if (*s != '\\' && likely(!lfs->jb->scalar_parsers)) {
+            // copy everything up to the end of the value or the next escape at once
+            const char *e = find_first_of_2(s, end_char, '\\');
+            size_t len = e - s;
+            if(len >= remaining) {
+                snprintf(lfs->msg, sizeof(lfs->msg),
+                         "LOGFMT PARSER: truncated string value at position %u", lfs->pos);
+                return false;
+            }
+
+            memcpy(d, s, len);
+            d += len;
+            s += len;
+            remaining -= len;
+            continue;
+        }
+
         if (*s == '\\') {
             s++;
 
@@ -49,6 +49,7 @@ void log_job_cleanup(LOG_JOB *jb) {
 
     txt_cleanup(&jb->rewrites.tmp);
     txt_cleanup(&jb->filename.current);
+    txt_cleanup(&jb->output);
 
     simple_hashtable_cleanup_allocated_keys(&jb->hashtable);
     simple_hashtable_destroy_KEY(&jb->hashtable);
@@ -292,6 +293,19 @@ static bool parse_inject(LOG_JOB *jb, const char *value, bool unmatched) {
     return true;
 }
 
+static bool log_job_threads_set(LOG_JOB *jb, const char *value) {
+    char *end = NULL;
+    long threads = value ? strtol(value, &end, 10) : 0;
+
+    if(!value || !*value || *end || threads < 1 || threads > LOG2JOURNAL_MAX_THREADS) {
+        log2stderr("Error: --threads needs a number between 1 and %d", LOG2JOURNAL_MAX_THREADS);
+        return false;
+    }
+
+    jb->threads = (uint32_t)threads;
+    return true;
+}
+
 bool log_job_command_line_parse_parameters(LOG_JOB *jb, int argc, char **argv) {
     for (int i = 1; i < argc; i++) {
         char *arg = argv[i];
@@ -309,6 +323,12 @@ bool log_job_command_line_parse_parameters(LOG_JOB *jb, int argc, char **argv) {
         else if (strcmp(arg, "--show-config") == 0) {
             jb->show_config = true;
         }
+        else if (strcmp(arg, "--benchmark") == 0) {
+            jb->benchmark = true;
+        }
+        else if (strcmp(arg, "--scalar-parsers") == 0) {
+            jb->scalar_parsers = true;
+        }
         else {
             char buffer[1024];
             char *param = NULL;
@@ -354,6 +374,10 @@ bool log_job_command_line_parse_parameters(LOG_JOB *jb, int argc, char **argv) {
                     return false;
             }
 #endif
+            else if (strcmp(param, "--threads") == 0) {
+                if(!log_job_threads_set(jb, value))
+                    return false;
+            }
             else if (strcmp(param, "--unmatched-key") == 0)
                 hashed_key_set(&jb->unmatched.key, value);
             else if (strcmp(param, "--inject") == 0) {
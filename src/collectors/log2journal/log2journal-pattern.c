@@ -38,6 +38,9 @@ static inline bool compile_pcre2(SEARCH_PATTERN *sp) {
         return false;
     }
 
+    // JIT is optional - when it is not available, pcre2_match() uses the interpreter
+    pcre2_jit_compile(sp->re, PCRE2_JIT_COMPLETE);
+
     return true;
 }
 
@@ -15,6 +15,11 @@ struct pcre2_state {
     pcre2_code *re;
     pcre2_match_data *match_data;
 
+    // the named groups of the pattern, resolved once
+    uint32_t names_count;
+    uint32_t name_entry_size;
+    PCRE2_SPTR name_table;
+
     char key[PCRE2_KEY_MAX];
     char msg[PCRE2_ERROR_LINE_MAX];
 };
@@ -33,18 +38,13 @@ static inline void copy_and_convert_key(PCRE2_STATE *pcre2, const char *key) {
     *d = '\0';
 }
 
-static inline void jb_traverse_pcre2_named_groups_and_send_keys(PCRE2_STATE *pcre2, pcre2_code *re, pcre2_match_data *match_data, char *line) {
+static inline void jb_traverse_pcre2_named_groups_and_send_keys(PCRE2_STATE *pcre2, pcre2_match_data *match_data, char *line) {
     PCRE2_SIZE *ovector = pcre2_get_ovector_pointer(match_data);
-    uint32_t names_count;
-    pcre2_pattern_info(re, PCRE2_INFO_NAMECOUNT, &names_count);
+    uint32_t names_count = pcre2->names_count;
 
     if (names_count > 0) {
-        PCRE2_SPTR name_table;
-        pcre2_pattern_info(re, PCRE2_INFO_NAMETABLE, &name_table);
-        uint32_t name_entry_size;
-        pcre2_pattern_info(re, PCRE2_INFO_NAMEENTRYSIZE, &name_entry_size);
-
-        const unsigned char *table_ptr = name_table;
+        uint32_t name_entry_size = pcre2->name_entry_size;
+        const unsigned char *table_ptr = pcre2->name_table;
         for (uint32_t i = 0; i < names_count; i++) {
             int n = (table_ptr[0] << 8) | table_ptr[1];
             const char *group_name = (const char *)(table_ptr + 2);
@@ -96,8 +96,17 @@ PCRE2_STATE *pcre2_parser_create(LOG_JOB *jb) {
         return pcre2;
     }
 
+    // JIT is optional - when it is not available, pcre2_match() uses the interpreter
+    pcre2_jit_compile(pcre2->re, PCRE2_JIT_COMPLETE);
+
     pcre2->match_data = pcre2_match_data_create_from_pattern(pcre2->re, NULL);
 
+    pcre2_pattern_info(pcre2->re, PCRE2_INFO_NAMECOUNT, &pcre2->names_count);
+    if(pcre2->names_count) {
+        pcre2_pattern_info(pcre2->re, PCRE2_INFO_NAMETABLE, &pcre2->name_table);
+        pcre2_pattern_info(pcre2->re, PCRE2_INFO_NAMEENTRYSIZE, &pcre2->name_entry_size);
+    }
+
     return pcre2;
 }
 
@@ -124,7 +133,7 @@ bool pcre2_parse_document(PCRE2_STATE *pcre2, const char *txt, size_t len) {
         return false;
     }
 
-    jb_traverse_pcre2_named_groups_and_send_keys(pcre2, pcre2->re, pcre2->match_data, (char *)pcre2->line);
+    jb_traverse_pcre2_named_groups_and_send_keys(pcre2, pcre2->match_data, (char *)pcre2->line);
 
     return true;
 }
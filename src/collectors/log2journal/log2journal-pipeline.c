@@ -0,0 +1,474 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "log2journal.h"
+
+#include <poll.h>
+
+// ----------------------------------------------------------------------------
+// multi-threaded pipeline
+//
+// The reader (the calling thread) reads stdin in chunks and splits them into
+// batches of trimmed lines. Parser threads pick the batches in the order they
+// were read and process them with their own LOG_JOB (configured from the same
+// command line), so that hashtables, values and pcre2 match data are never
+// shared between threads. The writer thread writes the output of the batches
+// in the order they were read, so the output is the same as single threaded.
+//
+// In benchmark mode, the input is read once into memory and it is replayed
+// through the same pipeline for a few seconds, discarding the output.
+
+#define PIPELINE_READ_SIZE (MAX_LINE_LENGTH * 2)
+#define PIPELINE_BATCH_MAX_SIZE (256 * 1024)
+#define PIPELINE_BATCHES_PER_THREAD 4
+#define PIPELINE_BENCHMARK_DURATION_UT (5ULL * 1000000ULL)
+
+typedef enum __attribute__((__packed__)) {
+    BATCH_FREE = 0,     // available to the reader
+    BATCH_READY,        // it has lines, waiting for a parser thread
+    BATCH_PARSING,      // a parser thread is working on it
+    BATCH_PARSED,       // it has output, waiting for the writer
+} BATCH_STATE;
+
+typedef struct log_batch {
+    BATCH_STATE state;
+    size_t lines;
+    TEXT input;         // the trimmed lines, each one followed by a '\0'
+    TEXT filename;      // the filename all the lines of this batch came from
+    TEXT output;        // the journal export format of all the lines
+} LOG_BATCH;
+
+struct log_pipeline;
+
+typedef struct log_parser_thread {
+    struct log_pipeline *pl;
+    pthread_t thread;
+    LOG_JOB jb;
+    LOG_PARSER parser;
+} LOG_PARSER_THREAD;
+
+typedef struct log_pipeline {
+    LOG_JOB *jb;                // the job of the reader, for tracking filenames
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    bool eof;
+    size_t read_seq;            // the number of batches submitted by the reader
+    size_t parse_seq;           // the number of batches picked by parser threads
+    size_t write_seq;           // the number of batches written
+
+    size_t size;
+    LOG_BATCH *batches;
+
+    uint32_t threads;
+    LOG_PARSER_THREAD *parsers;
+    pthread_t writer;
+
+    struct {
+        bool enabled;
+        TEXT input;
+        size_t pos;
+        uint64_t started_ut;
+        size_t passes;
+        size_t lines;
+        size_t input_bytes;
+        size_t output_bytes;
+    } benchmark;
+} LOG_PIPELINE;
+
+static inline uint64_t pipeline_now_monotonic_ut(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+// ----------------------------------------------------------------------------
+// parser threads
+
+static void *pipeline_parser_thread(void *ptr) {
+    LOG_PARSER_THREAD *pt = ptr;
+    LOG_PIPELINE *pl = pt->pl;
+
+    while(true) {
+        LOG_BATCH *b = NULL;
+
+        pthread_mutex_lock(&pl->mutex);
+        while(true) {
+            if(pl->parse_seq < pl->read_seq) {
+                b = &pl->batches[pl->parse_seq++ % pl->size];
+                b->state = BATCH_PARSING;
+                break;
+            }
+
+            if(pl->eof)
+                break;
+
+            pthread_cond_wait(&pl->cond, &pl->mutex);
+        }
+        pthread_mutex_unlock(&pl->mutex);
+
+        if(!b)
+            break;
+
+        txt_replace(&pt->jb.filename.current, b->filename.txt, b->filename.len);
+
+        const char *s = b->input.txt;
+        const char *end = s + b->input.len;
+        while(s < end) {
+            size_t len = strlen(s);
+            log_job_process_line(&pt->jb, &pt->parser, s, len);
+            s += len + 1;
+        }
+
+        // give our output to the batch, and keep its buffer for the next one
+        TEXT tmp = b->output;
+        b->output = pt->jb.output;
+        pt->jb.output = tmp;
+        pt->jb.output.len = 0;
+
+        pthread_mutex_lock(&pl->mutex);
+        b->state = BATCH_PARSED;
+        pthread_cond_broadcast(&pl->cond);
+        pthread_mutex_unlock(&pl->mutex);
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// writer thread
+
+static void *pipeline_writer_thread(void *ptr) {
+    LOG_PIPELINE *pl = ptr;
+
+    while(true) {
+        LOG_BATCH *b = &pl->batches[pl->write_seq % pl->size];
+
+        pthread_mutex_lock(&pl->mutex);
+        while(true) {
+            if(pl->write_seq < pl->read_seq) {
+                if(b->state == BATCH_PARSED)
+                    break;
+            }
+            else if(pl->eof)
+                break;
+
+            pthread_cond_wait(&pl->cond, &pl->mutex);
+        }
+        bool finished = (pl->write_seq == pl->read_seq);
+        pthread_mutex_unlock(&pl->mutex);
+
+        if(finished)
+            break;
+
+        if(pl->benchmark.enabled) {
+            pl->benchmark.lines += b->lines;
+            pl->benchmark.output_bytes += b->output.len;
+        }
+        else if(b->output.len) {
+            fwrite(b->output.txt, 1, b->output.len, stdout);
+            fflush(stdout);
+        }
+
+        pthread_mutex_lock(&pl->mutex);
+        b->state = BATCH_FREE;
+        pl->write_seq++;
+        pthread_cond_broadcast(&pl->cond);
+        pthread_mutex_unlock(&pl->mutex);
+    }
+
+    return NULL;
+}
+
+// ----------------------------------------------------------------------------
+// reader
+
+static LOG_BATCH *pipeline_batch_get(LOG_PIPELINE *pl) {
+    LOG_BATCH *b = &pl->batches[pl->read_seq % pl->size];
+
+    pthread_mutex_lock(&pl->mutex);
+    while(b->state != BATCH_FREE)
+        pthread_cond_wait(&pl->cond, &pl->mutex);
+    pthread_mutex_unlock(&pl->mutex);
+
+    b->lines = 0;
+    b->input.len = 0;
+    b->output.len = 0;
+    txt_replace(&b->filename, pl->jb->filename.current.txt, pl->jb->filename.current.len);
+
+    return b;
+}
+
+static LOG_BATCH *pipeline_batch_submit(LOG_PIPELINE *pl, LOG_BATCH *b) {
+    pthread_mutex_lock(&pl->mutex);
+    b->state = BATCH_READY;
+    pl->read_seq++;
+    pthread_cond_broadcast(&pl->cond);
+    pthread_mutex_unlock(&pl->mutex);
+
+    return pipeline_batch_get(pl);
+}
+
+static LOG_BATCH *pipeline_batch_add_line(LOG_PIPELINE *pl, LOG_BATCH *b, char *line, size_t len) {
+    // like fgets(), stop at the first '\0'
+    len = strnlen(line, len);
+    line = log_job_line_trim(line, &len);
+
+    if(log_job_line_switched_filename(pl->jb, line, len)) {
+        TEXT *current = &pl->jb->filename.current;
+
+        if(current->len != b->filename.len || (current->len && memcmp(current->txt, b->filename.txt, current->len) != 0)) {
+            // the lines following this one are from another file
+            if(b->lines)
+                b = pipeline_batch_submit(pl, b);
+            else
+                txt_replace(&b->filename, current->txt, current->len);
+        }
+
+        return b;
+    }
+
+    txt_expand_and_append(&b->input, line, len);
+    txt_expand_and_append(&b->input, "", 1);
+    b->lines++;
+
+    if(b->input.len >= PIPELINE_BATCH_MAX_SIZE)
+        b = pipeline_batch_submit(pl, b);
+
+    return b;
+}
+
+static ssize_t pipeline_input_read(LOG_PIPELINE *pl, char *dst, size_t size) {
+    if(!pl->benchmark.enabled) {
+        ssize_t rc;
+
+        do {
+            rc = read(STDIN_FILENO, dst, size);
+        } while(rc < 0 && errno == EINTR);
+
+        return rc;
+    }
+
+    // replay the input until the benchmark duration passes
+
+    if(pl->benchmark.pos >= pl->benchmark.input.len) {
+        pl->benchmark.passes++;
+        pl->benchmark.pos = 0;
+
+        if(pipeline_now_monotonic_ut() - pl->benchmark.started_ut >= PIPELINE_BENCHMARK_DURATION_UT)
+            return 0;
+    }
+
+    size_t remaining = pl->benchmark.input.len - pl->benchmark.pos;
+    if(size > remaining)
+        size = remaining;
+
+    memcpy(dst, &pl->benchmark.input.txt[pl->benchmark.pos], size);
+    pl->benchmark.pos += size;
+
+    return (ssize_t)size;
+}
+
+static bool pipeline_input_pending(LOG_PIPELINE *pl) {
+    if(pl->benchmark.enabled)
+        return true;
+
+    struct pollfd pfd = {
+            .fd = STDIN_FILENO,
+            .events = POLLIN,
+    };
+
+    return poll(&pfd, 1, 0) > 0;
+}
+
+static void pipeline_reader(LOG_PIPELINE *pl) {
+    char *buffer = mallocz(PIPELINE_READ_SIZE + 1);
+    size_t used = 0;
+    bool eof = false;
+
+    LOG_BATCH *b = pipeline_batch_get(pl);
+
+    while(!eof) {
+        ssize_t rc = pipeline_input_read(pl, &buffer[used], PIPELINE_READ_SIZE - used);
+        if(rc <= 0)
+            eof = true;
+        else {
+            used += rc;
+            pl->benchmark.input_bytes += rc;
+        }
+
+        char *s = buffer;
+        char *end = &buffer[used];
+        while(s < end) {
+            char *nl = memchr(s, '\n', end - s);
+            size_t len = nl ? (size_t)(nl - s) : (size_t)(end - s);
+
+            if(len >= MAX_LINE_LENGTH) {
+                // like fgets(), split lines longer than our line buffer
+                char c = s[MAX_LINE_LENGTH];
+                s[MAX_LINE_LENGTH] = '\0';
+                b = pipeline_batch_add_line(pl, b, s, MAX_LINE_LENGTH);
+                s[MAX_LINE_LENGTH] = c;
+                s += MAX_LINE_LENGTH;
+                continue;
+            }
+
+            if(!nl) {
+                if(!eof)
+                    // a partial line, wait for the rest of it
+                    break;
+
+                // the last line of the input, without a newline
+                *end = '\0';
+                b = pipeline_batch_add_line(pl, b, s, len);
+                s = end;
+                break;
+            }
+
+            *nl = '\0';
+            b = pipeline_batch_add_line(pl, b, s, len);
+            s = nl + 1;
+        }
+
+        // keep the partial line for the next read
+        used = end - s;
+        if(used && s != buffer)
+            memmove(buffer, s, used);
+
+        // don't wait for a full batch when there is nothing more to read now
+        if(b->lines && (eof || !pipeline_input_pending(pl)))
+            b = pipeline_batch_submit(pl, b);
+    }
+
+    freez(buffer);
+}
+
+// ----------------------------------------------------------------------------
+
+static bool pipeline_benchmark_read_input(LOG_PIPELINE *pl) {
+    TEXT *t = &pl->benchmark.input;
+    char buffer[65536];
+    ssize_t rc;
+
+    while((rc = read(STDIN_FILENO, buffer, sizeof(buffer))) != 0) {
+        if(rc < 0) {
+            if(errno == EINTR)
+                continue;
+
+            log2stderr("Error: cannot read the benchmark input from stdin");
+            return false;
+        }
+
+        txt_expand_and_append(t, buffer, rc);
+    }
+
+    if(!t->len) {
+        log2stderr("Error: the benchmark needs some input on stdin");
+        return false;
+    }
+
+    // every pass should end with a complete line
+    if(t->txt[t->len - 1] != '\n')
+        txt_expand_and_append(t, "\n", 1);
+
+    return true;
+}
+
+static void pipeline_benchmark_report(LOG_PIPELINE *pl, uint64_t duration_ut) {
+    double seconds = (double)duration_ut / 1000000.0;
+    if(seconds <= 0.0)
+        seconds = 0.000001;
+
+    double mib_in = (double)pl->benchmark.input_bytes / (1024.0 * 1024.0);
+    double mib_out = (double)pl->benchmark.output_bytes / (1024.0 * 1024.0);
+
+    log2stderr("log2journal benchmark: %u parser threads, %zu passes, %zu lines, "
+               "%.2f MiB in, %.2f MiB out, in %.3f seconds: %.0f lines/s, %.2f MiB/s",
+               pl->threads, pl->benchmark.passes, pl->benchmark.lines,
+               mib_in, mib_out, seconds,
+               (double)pl->benchmark.lines / seconds, mib_in / seconds);
+}
+
+int log_job_run_pipeline(LOG_JOB *jb, int argc, char **argv) {
+    LOG_PIPELINE pipeline = { 0 };
+    LOG_PIPELINE *pl = &pipeline;
+    int ret = 0;
+
+    pl->jb = jb;
+    pl->threads = jb->threads ? jb->threads : 1;
+    pl->size = pl->threads * PIPELINE_BATCHES_PER_THREAD;
+    pl->batches = callocz(pl->size, sizeof(LOG_BATCH));
+    pl->parsers = callocz(pl->threads, sizeof(LOG_PARSER_THREAD));
+    pl->benchmark.enabled = jb->benchmark;
+
+    pthread_mutex_init(&pl->mutex, NULL);
+    pthread_cond_init(&pl->cond, NULL);
+
+    // every parser thread gets its own job, configured exactly like ours
+    uint32_t created = 0;
+    for(; created < pl->threads ;created++) {
+        LOG_PARSER_THREAD *pt = &pl->parsers[created];
+        pt->pl = pl;
+
+        log_job_init(&pt->jb);
+        if(!log_job_command_line_parse_parameters(&pt->jb, argc, argv) ||
+           !log_job_parser_create(&pt->jb, &pt->parser)) {
+            log_job_cleanup(&pt->jb);
+            ret = 1;
+            break;
+        }
+    }
+
+    if(!ret && pl->benchmark.enabled && !pipeline_benchmark_read_input(pl))
+        ret = 1;
+
+    if(!ret) {
+        pl->benchmark.started_ut = pipeline_now_monotonic_ut();
+
+        for(uint32_t i = 0; i < pl->threads ;i++) {
+            if(pthread_create(&pl->parsers[i].thread, NULL, pipeline_parser_thread, &pl->parsers[i]) != 0) {
+                log2stderr("Fatal Error: cannot create parser thread %u", i);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if(pthread_create(&pl->writer, NULL, pipeline_writer_thread, pl) != 0) {
+            log2stderr("Fatal Error: cannot create the writer thread");
+            exit(EXIT_FAILURE);
+        }
+
+        pipeline_reader(pl);
+
+        pthread_mutex_lock(&pl->mutex);
+        pl->eof = true;
+        pthread_cond_broadcast(&pl->cond);
+        pthread_mutex_unlock(&pl->mutex);
+
+        for(uint32_t i = 0; i < pl->threads ;i++)
+            pthread_join(pl->parsers[i].thread, NULL);
+
+        pthread_join(pl->writer, NULL);
+
+        if(pl->benchmark.enabled)
+            pipeline_benchmark_report(pl, pipeline_now_monotonic_ut() - pl->benchmark.started_ut);
+    }
+
+    for(uint32_t i = 0; i < created ;i++) {
+        log_job_parser_destroy(&pl->parsers[i].parser);
+        log_job_cleanup(&pl->parsers[i].jb);
+    }
+
+    for(size_t i = 0; i < pl->size ;i++) {
+        txt_cleanup(&pl->batches[i].input);
+        txt_cleanup(&pl->batches[i].filename);
+        txt_cleanup(&pl->batches[i].output);
+    }
+
+    txt_cleanup(&pl->benchmark.input);
+    pthread_cond_destroy(&pl->cond);
+    pthread_mutex_destroy(&pl->mutex);
+    freez(pl->batches);
+    freez(pl->parsers);
+
+    return ret;
+}
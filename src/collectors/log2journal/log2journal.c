@@ -281,12 +281,25 @@ static inline void send_key_value_error(LOG_JOB *jb, HASHED_KEY *key, const char
 static inline void send_key_value_error(LOG_JOB *jb, HASHED_KEY *key, const char *format, ...) {
     HASHED_KEY *ht_key = get_key_from_hashtable(jb, key);
 
-    printf("%s=", ht_key->key);
+    txt_expand_and_append(&jb->output, ht_key->key, ht_key->len);
+    txt_expand_and_append(&jb->output, "=", 1);
+
     va_list args;
     va_start(args, format);
-    vprintf(format, args);
+    int len = vsnprintf(NULL, 0, format, args);
     va_end(args);
-    printf("\n");
+
+    if(len > 0) {
+        txt_expand(&jb->output, len);
+
+        va_start(args, format);
+        vsnprintf(&jb->output.txt[jb->output.len], len + 1, format, args);
+        va_end(args);
+
+        jb->output.len += len;
+    }
+
+    txt_expand_and_append(&jb->output, "\n", 1);
 }
 
 inline void log_job_send_extracted_key_value(LOG_JOB *jb, const char *key, const char *value, size_t len) {
@@ -343,8 +356,12 @@ static inline void send_all_fields(LOG_JOB *jb) {
                 validate_key(jb, k);
             }
 
-            if(k->flags & HK_FILTERED_INCLUDED)
-                printf("%s=%.*s\n", k->key, (int)k->value.len, k->value.txt);
+            if(k->flags & HK_FILTERED_INCLUDED) {
+                txt_expand_and_append(&jb->output, k->key, k->len);
+                txt_expand_and_append(&jb->output, "=", 1);
+                txt_expand_and_append(&jb->output, k->value.txt, strnlen(k->value.txt, k->value.len));
+                txt_expand_and_append(&jb->output, "\n", 1);
+            }
 
             // reset it for the next round
             k->value.txt[0] = '\0';
@@ -398,7 +415,7 @@ static inline void jb_inject_filename(LOG_JOB *jb) {
         send_key_value_constant(jb, &jb->filename.key, jb->filename.current.txt, jb->filename.current.len);
 }
 
-static inline bool jb_switched_filename(LOG_JOB *jb, const char *line, size_t len) {
+bool log_job_line_switched_filename(LOG_JOB *jb, const char *line, size_t len) {
     // IMPORTANT:
     // Return TRUE when the caller should skip this line (because it is ours).
     // Unfortunately, we have to consume empty lines too.
@@ -445,14 +462,8 @@ static inline bool jb_send_unmatched_line(LOG_JOB *jb, const char *line) {
 // ----------------------------------------------------------------------------
 // running a job
 
-static char *get_next_line(LOG_JOB *jb __maybe_unused, char *buffer, size_t size, size_t *line_length) {
-    if(!fgets(buffer, (int)size, stdin)) {
-        *line_length = 0;
-        return NULL;
-    }
-
-    char *line = buffer;
-    size_t len = strlen(line);
+char *log_job_line_trim(char *line, size_t *line_length) {
+    size_t len = *line_length;
 
     // remove trailing newlines and spaces
     while(len > 1 && (line[len - 1] == '\n' || isspace(line[len - 1])))
@@ -468,30 +479,94 @@ static char *get_next_line(LOG_JOB *jb __maybe_unused, char *buffer, size_t size
     return line;
 }
 
-int log_job_run(LOG_JOB *jb) {
-    select_which_injections_should_be_injected_on_unmatched(jb);
+static char *get_next_line(LOG_JOB *jb __maybe_unused, char *buffer, size_t size, size_t *line_length) {
+    if(!fgets(buffer, (int)size, stdin)) {
+        *line_length = 0;
+        return NULL;
+    }
+
+    *line_length = strlen(buffer);
+    return log_job_line_trim(buffer, line_length);
+}
+
+bool log_job_parser_create(LOG_JOB *jb, LOG_PARSER *parser) {
+    memset(parser, 0, sizeof(*parser));
 
-    PCRE2_STATE *pcre2 = NULL;
-    LOG_JSON_STATE *json = NULL;
-    LOGFMT_STATE *logfmt = NULL;
+    select_which_injections_should_be_injected_on_unmatched(jb);
 
     if(strcmp(jb->pattern, "json") == 0) {
-        json = json_parser_create(jb);
+        parser->json = json_parser_create(jb);
         // never fails
     }
     else if(strcmp(jb->pattern, "logfmt") == 0) {
-        logfmt = logfmt_parser_create(jb);
+        parser->logfmt = logfmt_parser_create(jb);
         // never fails
     }
     else if(strcmp(jb->pattern, "none") != 0) {
-        pcre2 = pcre2_parser_create(jb);
-        if(pcre2_has_error(pcre2)) {
-            log2stderr("%s", pcre2_parser_error(pcre2));
-            pcre2_parser_destroy(pcre2);
-            return 1;
+        parser->pcre2 = pcre2_parser_create(jb);
+        if(pcre2_has_error(parser->pcre2)) {
+            log2stderr("%s", pcre2_parser_error(parser->pcre2));
+            pcre2_parser_destroy(parser->pcre2);
+            parser->pcre2 = NULL;
+            return false;
         }
     }
 
+    return true;
+}
+
+void log_job_parser_destroy(LOG_PARSER *parser) {
+    if(parser->json)
+        json_parser_destroy(parser->json);
+
+    else if(parser->logfmt)
+        logfmt_parser_destroy(parser->logfmt);
+
+    else if(parser->pcre2)
+        pcre2_parser_destroy(parser->pcre2);
+
+    memset(parser, 0, sizeof(*parser));
+}
+
+void log_job_process_line(LOG_JOB *jb, LOG_PARSER *parser, const char *line, size_t len) {
+    jb->line.trimmed = line;
+    jb->line.trimmed_len = len;
+
+    bool line_is_matched = true;
+
+    if(parser->json)
+        line_is_matched = json_parse_document(parser->json, line);
+    else if(parser->logfmt)
+        line_is_matched = logfmt_parse_document(parser->logfmt, line);
+    else if(parser->pcre2)
+        line_is_matched = pcre2_parse_document(parser->pcre2, line, len);
+
+    if(!line_is_matched) {
+        if(parser->json)
+            log2stderr("%s", json_parser_error(parser->json));
+        else if(parser->logfmt)
+            log2stderr("%s", logfmt_parser_error(parser->logfmt));
+        else if(parser->pcre2)
+            log2stderr("%s", pcre2_parser_error(parser->pcre2));
+
+        if(!jb_send_unmatched_line(jb, line))
+            // just logging to stderr, not sending unmatched lines
+            return;
+    }
+
+    jb_inject_filename(jb);
+    jb_finalize_injections(jb, line_is_matched);
+
+    log_job_process_rewrites(jb);
+    send_all_fields(jb);
+    txt_expand_and_append(&jb->output, "\n", 1);
+}
+
+int log_job_run(LOG_JOB *jb) {
+    LOG_PARSER parser;
+    if(!log_job_parser_create(jb, &parser))
+        return 1;
+
     jb->line.buffer = mallocz(MAX_LINE_LENGTH + 1);
     jb->line.size = MAX_LINE_LENGTH + 1;
     jb->line.trimmed_len = 0;
@@ -501,48 +576,19 @@ int log_job_run(LOG_JOB *jb) {
         const char *line = jb->line.trimmed;
         size_t len = jb->line.trimmed_len;
 
-        if(jb_switched_filename(jb, line, len))
+        if(log_job_line_switched_filename(jb, line, len))
             continue;
 
-        bool line_is_matched = true;
-
-        if(json)
-            line_is_matched = json_parse_document(json, line);
-        else if(logfmt)
-            line_is_matched = logfmt_parse_document(logfmt, line);
-        else if(pcre2)
-            line_is_matched = pcre2_parse_document(pcre2, line, len);
-
-        if(!line_is_matched) {
-            if(json)
-                log2stderr("%s", json_parser_error(json));
-            else if(logfmt)
-                log2stderr("%s", logfmt_parser_error(logfmt));
-            else if(pcre2)
-                log2stderr("%s", pcre2_parser_error(pcre2));
-
-            if(!jb_send_unmatched_line(jb, line))
-                // just logging to stderr, not sending unmatched lines
-                continue;
-        }
+        log_job_process_line(jb, &parser, line, len);
 
-        jb_inject_filename(jb);
-        jb_finalize_injections(jb, line_is_matched);
-
-        log_job_process_rewrites(jb);
-        send_all_fields(jb);
-        printf("\n");
-        fflush(stdout);
+        if(jb->output.len) {
+            fwrite(jb->output.txt, 1, jb->output.len, stdout);
+            fflush(stdout);
+            jb->output.len = 0;
+        }
     }
 
-    if(json)
-        json_parser_destroy(json);
-
-    else if(logfmt)
-        logfmt_parser_destroy(logfmt);
-
-    else if(pcre2)
-        pcre2_parser_destroy(pcre2);
+    log_job_parser_destroy(&parser);
 
     freez((void *)jb->line.buffer);
 
@@ -562,7 +608,11 @@ int main(int argc, char *argv[]) {
     if(log_job.show_config)
         log_job_configuration_to_yaml(&log_job);
 
-    int ret = log_job_run(&log_job);
+    int ret;
+    if(log_job.threads > 1 || log_job.benchmark)
+        ret = log_job_run_pipeline(&log_job, argc, argv);
+    else
+        ret = log_job_run(&log_job);
 
     log_job_cleanup(&log_job);
     return ret;
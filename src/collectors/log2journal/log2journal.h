@@ -16,6 +16,14 @@
 #include <math.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // ----------------------------------------------------------------------------
 // compatibility
@@ -172,6 +180,45 @@ static inline size_t copy_to_buffer(char *dst, size_t dst_size, const char *src,
     }
 }
 
+// ----------------------------------------------------------------------------
+// find the first c1, c2 or the terminating '\0' of a string
+// the parsers use it to find the spans of values that need no decoding
+
+#if defined(__SSE2__)
+static inline const char *find_first_of_2(const char *s, char c1, char c2) {
+    // aligned loads never cross a page boundary, so reading a few bytes
+    // before the start or after the end of the string cannot fault
+    uintptr_t misalignment = (uintptr_t)s & 15;
+    const __m128i *p = (const __m128i *)(s - misalignment);
+
+    const __m128i v1 = _mm_set1_epi8(c1);
+    const __m128i v2 = _mm_set1_epi8(c2);
+    const __m128i v0 = _mm_setzero_si128();
+
+    __m128i chunk = _mm_load_si128(p);
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, v1), _mm_cmpeq_epi8(chunk, v2)), _mm_cmpeq_epi8(chunk, v0)));
+
+    // ignore the bytes before the start of the string
+    mask &= 0xFFFFU << misalignment;
+
+    while(!mask) {
+        chunk = _mm_load_si128(++p);
+        mask = (uint32_t)_mm_movemask_epi8(
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, v1), _mm_cmpeq_epi8(chunk, v2)), _mm_cmpeq_epi8(chunk, v0)));
+    }
+
+    return (const char *)p + __builtin_ctz(mask);
+}
+#else
+static inline const char *find_first_of_2(const char *s, char c1, char c2) {
+    while(*s && *s != c1 && *s != c2)
+        s++;
+
+    return s;
+}
+#endif
+
 // ----------------------------------------------------------------------------
 // A dynamically sized, reusable text buffer,
 // allowing us to be fast (no allocations during iterations) while having the
@@ -220,7 +267,7 @@ static inline void txt_replace(TEXT *t, const char *s, size_t len) {
     }
 }
 
-static inline void txt_expand_and_append(TEXT *t, const char *s, size_t len) {
+static inline void txt_expand(TEXT *t, size_t len) {
     if(len + 1 > (t->size - t->len)) {
         size_t new_size = t->len + len + 1;
         if(new_size < t->size * 2)
@@ -229,6 +276,10 @@ static inline void txt_expand_and_append(TEXT *t, const char *s, size_t len) {
         t->txt = reallocz(t->txt, new_size);
         t->size = new_size;
     }
+}
+
+static inline void txt_expand_and_append(TEXT *t, const char *s, size_t len) {
+    txt_expand(t, len);
 
     char *copy_to = &t->txt[t->len];
     memcpy(copy_to, s, len);
@@ -394,6 +445,9 @@ void rewrite_cleanup(REWRITE *rw);
 
 typedef struct log_job {
     bool show_config;
+    bool benchmark;
+    bool scalar_parsers;    // disable the span scanning of the parsers, for benchmarking
+    uint32_t threads;
 
     const char *pattern;
     const char *prefix;
@@ -442,6 +496,10 @@ typedef struct log_job {
         uint32_t used;
         RENAME array[MAX_RENAMES];
     } renames;
+
+    // the journal export format of the lines processed,
+    // until the caller writes it to the output
+    TEXT output;
 } LOG_JOB;
 
 // initialize a log job
@@ -518,4 +576,31 @@ void pcre2_test(void);
 
 void pcre2_get_error_in_buffer(char *msg, size_t msg_len, int rc, int pos);
 
+// ----------------------------------------------------------------------------
+// processing lines
+
+typedef struct log_parser {
+    PCRE2_STATE *pcre2;
+    LOG_JSON_STATE *json;
+    LOGFMT_STATE *logfmt;
+} LOG_PARSER;
+
+bool log_job_parser_create(LOG_JOB *jb, LOG_PARSER *parser);
+void log_job_parser_destroy(LOG_PARSER *parser);
+
+char *log_job_line_trim(char *line, size_t *line_length);
+bool log_job_line_switched_filename(LOG_JOB *jb, const char *line, size_t len);
+
+// process a trimmed line, appending its journal export format entry to jb->output
+void log_job_process_line(LOG_JOB *jb, LOG_PARSER *parser, const char *line, size_t len);
+
+// ----------------------------------------------------------------------------
+// multi-threaded pipeline
+
+#define LOG2JOURNAL_MAX_THREADS 256
+
+// reader -> parser threads -> ordered writer
+// each parser thread runs its own LOG_JOB, configured with the same argc/argv
+int log_job_run_pipeline(LOG_JOB *jb, int argc, char **argv);
+
 #endif //NETDATA_LOG2JOURNAL_H
@@ -146,3 +146,64 @@ test_log2journal 4 "${tests}/nginx-json.log" "${tests}/nginx-json.output" -f "${
 test_log2journal 5 "${tests}/nginx-combined.log" "${tests}/nginx-combined.output" -f "${script_dir}/log2journal.d/nginx-combined.yaml"
 test_log2journal 6 "${tests}/logfmt.log" "${tests}/logfmt.output" -f "${tests}/logfmt.yaml"
 test_log2journal 7 "${tests}/logfmt.log" "${tests}/default.output" -f "${script_dir}/log2journal.d/default.yaml"
+
+# -----------------------------------------------------------------------------
+
+echo >&2
+echo >&2 "Testing parsing and output with multiple threads..."
+
+test_log2journal 8 "${tests}/json.log" "${tests}/json.output" json --threads 4
+test_log2journal 9 "${tests}/nginx-json.log" "${tests}/nginx-json.output" -f "${script_dir}/log2journal.d/nginx-json.yaml" --threads 4
+test_log2journal 10 "${tests}/nginx-combined.log" "${tests}/nginx-combined.output" -f "${script_dir}/log2journal.d/nginx-combined.yaml" --threads 4
+test_log2journal 11 "${tests}/logfmt.log" "${tests}/logfmt.output" -f "${tests}/logfmt.yaml" --threads 4
+
+test_log2journal_order() {
+  local in="${1}"
+  shift
+
+  printf >&2 "running: "
+  printf >&2 "%q " "${log2journal_bin}" "${@}"
+  printf >&2 "with 1 and 4 threads on a big input\n"
+
+  # make the input big enough to be split in many batches
+  for i in $(seq 1 5000); do cat "${in}"; done >big.log
+
+  "${log2journal_bin}" <big.log "${@}" >single 2>/dev/null
+  "${log2journal_bin}" <big.log "${@}" --threads 4 >threaded 2>/dev/null
+
+  cmp single threaded
+  [ $? -ne 0 ] && echo >&2 "the output of multiple threads is not the same as the single threaded one!" && exit 1
+
+  echo >&2 "OK"
+  echo >&2
+
+  return 0
+}
+
+test_log2journal_order "${tests}/nginx-combined.log" -f "${script_dir}/log2journal.d/nginx-combined.yaml"
+test_log2journal_order "${tests}/nginx-json.log" -f "${script_dir}/log2journal.d/nginx-json.yaml"
+
+# -----------------------------------------------------------------------------
+
+if [ "${1}" = "benchmark" ]; then
+  threads="$(nproc)"
+
+  benchmark_log2journal() {
+    local in="${1}"
+    shift
+
+    echo >&2 "benchmarking with input ${in}: ${*}"
+    "${log2journal_bin}" <"${in}" "${@}" --benchmark --threads 1 --scalar-parsers >/dev/null
+    "${log2journal_bin}" <"${in}" "${@}" --benchmark --threads 1 >/dev/null
+    "${log2journal_bin}" <"${in}" "${@}" --benchmark --threads "${threads}" >/dev/null
+    echo >&2
+  }
+
+  echo >&2
+  echo >&2 "Benchmarking..."
+
+  benchmark_log2journal "${tests}/json.log" json
+  benchmark_log2journal "${tests}/nginx-json.log" -f "${script_dir}/log2journal.d/nginx-json.yaml"
+  benchmark_log2journal "${tests}/nginx-combined.log" -f "${script_dir}/log2journal.d/nginx-combined.yaml"
+  benchmark_log2journal "${tests}/logfmt.log" -f "${tests}/logfmt.yaml"
+fi
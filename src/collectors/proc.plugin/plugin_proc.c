@@ -11,6 +11,14 @@ static struct proc_module {
     int (*func)(int update_every, usec_t dt);
 
     RRDDIM *rd;
+    RRDDIM *rd_overruns;
+
+    // timings, protected by proc_pool.mutex when running on worker threads
+    bool running;               // queued or being collected
+    usec_t scheduled_ut;        // the iteration this collection belongs to
+    usec_t last_started_ut;     // the start of the previous collection, to give each module its own dt
+    usec_t latency_ut;          // from scheduled to completed, of the last collection
+    size_t overruns;            // collections that completed after the next iteration had started
 
 } proc_modules[] = {
 
@@ -85,6 +93,40 @@ static struct proc_module {
 
 static ND_THREAD *netdev_thread = NULL;
 
+#define PROC_MODULES_MAX_WORKERS 16
+
+// the worker pool collecting the modules in parallel, when "worker threads" > 1
+static struct {
+    size_t threads;
+    ND_THREAD *workers[PROC_MODULES_MAX_WORKERS];
+
+    netdata_mutex_t mutex;
+    pthread_cond_t cond;
+    bool exit;
+
+    // a ring of module ids waiting to be collected
+    size_t queue[sizeof(proc_modules) / sizeof(proc_modules[0])];
+    size_t head;
+    size_t used;
+} proc_pool = {
+    .mutex = NETDATA_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+#define PROC_POOL_QUEUE_SIZE (sizeof(proc_pool.queue) / sizeof(proc_pool.queue[0]))
+
+static void proc_pool_stop(void) {
+    netdata_mutex_lock(&proc_pool.mutex);
+    proc_pool.exit = true;
+    pthread_cond_broadcast(&proc_pool.cond);
+    netdata_mutex_unlock(&proc_pool.mutex);
+
+    for(size_t t = 0; t < proc_pool.threads ;t++)
+        nd_thread_join(proc_pool.workers[t]);
+
+    proc_pool.threads = 0;
+}
+
 static void proc_main_cleanup(void *pptr)
 {
     struct netdata_static_thread *static_thread = CLEANUP_FUNCTION_GET_PTR(pptr);
@@ -94,6 +136,7 @@ static void proc_main_cleanup(void *pptr)
 
     collector_info("cleaning up...");
 
+    proc_pool_stop();
     nd_thread_join(netdev_thread);
     worker_unregister();
 
@@ -199,6 +242,177 @@ static bool log_proc_module(BUFFER *wb, void *data) {
     return true;
 }
 
+#define LGS_MODULE_ID 0
+
+static void proc_module_collect(size_t i, struct log_stack_entry *lgs, usec_t step) {
+    struct proc_module *pm = &proc_modules[i];
+
+    usec_t started_ut = now_monotonic_usec();
+    usec_t dt = pm->last_started_ut ? started_ut - pm->last_started_ut : step;
+    pm->last_started_ut = started_ut;
+
+    worker_is_busy(i);
+    lgs[LGS_MODULE_ID] = ND_LOG_FIELD_CB(NDF_MODULE, log_proc_module, pm);
+    bool enabled = !pm->func(localhost->rrd_update_every, dt);
+    lgs[LGS_MODULE_ID] = ND_LOG_FIELD_TXT(NDF_MODULE, "proc.plugin");
+    worker_is_idle();
+
+    usec_t latency_ut = now_monotonic_usec() - pm->scheduled_ut;
+
+    if(proc_pool.threads) netdata_mutex_lock(&proc_pool.mutex);
+
+    pm->enabled = enabled;
+    pm->latency_ut = latency_ut;
+    if(latency_ut > step)
+        pm->overruns++;
+    pm->running = false;
+
+    if(proc_pool.threads) netdata_mutex_unlock(&proc_pool.mutex);
+}
+
+static void proc_modules_register_job_names(void) {
+    for(size_t i = 0; proc_modules[i].name; i++)
+        worker_register_job_name(i, proc_modules[i].dim);
+}
+
+static void *proc_worker_thread_main(void *ptr __maybe_unused) {
+    worker_register("PROC");
+    proc_modules_register_job_names();
+
+    ND_LOG_STACK lgs[] = {
+            [LGS_MODULE_ID] = ND_LOG_FIELD_TXT(NDF_MODULE, "proc.plugin"),
+            ND_LOG_FIELD_END(),
+    };
+    ND_LOG_STACK_PUSH(lgs);
+
+    usec_t step = localhost->rrd_update_every * USEC_PER_SEC;
+
+    netdata_mutex_lock(&proc_pool.mutex);
+    while(true) {
+        while(!proc_pool.used && !proc_pool.exit)
+            pthread_cond_wait(&proc_pool.cond, &proc_pool.mutex);
+
+        if(proc_pool.exit || !service_running(SERVICE_COLLECTORS))
+            break;
+
+        size_t i = proc_pool.queue[proc_pool.head];
+        proc_pool.head = (proc_pool.head + 1) % PROC_POOL_QUEUE_SIZE;
+        proc_pool.used--;
+
+        netdata_mutex_unlock(&proc_pool.mutex);
+        proc_module_collect(i, lgs, step);
+        netdata_mutex_lock(&proc_pool.mutex);
+    }
+    netdata_mutex_unlock(&proc_pool.mutex);
+
+    worker_unregister();
+    return NULL;
+}
+
+static void proc_pool_start(size_t threads) {
+    if(threads < 2)
+        return;
+
+    if(threads > PROC_MODULES_MAX_WORKERS)
+        threads = PROC_MODULES_MAX_WORKERS;
+
+    for(size_t t = 0; t < threads ;t++) {
+        char tag[NETDATA_THREAD_TAG_MAX + 1];
+        snprintfz(tag, NETDATA_THREAD_TAG_MAX, "P[proc #%zu]", t);
+
+        proc_pool.workers[t] = nd_thread_create(tag, NETDATA_THREAD_OPTION_JOINABLE, proc_worker_thread_main, NULL);
+        if(!proc_pool.workers[t]) {
+            collector_error("PROC: cannot create worker thread %zu", t);
+            break;
+        }
+
+        proc_pool.threads++;
+    }
+
+    collector_info("PROC: collecting modules in parallel on %zu worker threads", proc_pool.threads);
+}
+
+// queue every enabled module that is not still being collected from a previous iteration
+static void proc_pool_schedule(usec_t now_ut) {
+    netdata_mutex_lock(&proc_pool.mutex);
+
+    for(size_t i = 0; proc_modules[i].name; i++) {
+        struct proc_module *pm = &proc_modules[i];
+        if(!pm->enabled || pm->running)
+            continue;
+
+        pm->running = true;
+        pm->scheduled_ut = now_ut;
+        proc_pool.queue[(proc_pool.head + proc_pool.used) % PROC_POOL_QUEUE_SIZE] = i;
+        proc_pool.used++;
+    }
+
+    pthread_cond_broadcast(&proc_pool.cond);
+    netdata_mutex_unlock(&proc_pool.mutex);
+}
+
+static void proc_modules_statistics(void) {
+    static RRDSET *st_latency = NULL, *st_overruns = NULL;
+
+    if(!global_statistics_enabled)
+        return;
+
+    if(unlikely(!st_latency)) {
+        st_latency = rrdset_create_localhost(
+                "netdata"
+                , "plugin_proc_modules_latency"
+                , NULL
+                , "proc.plugin"
+                , NULL
+                , "proc.plugin modules collection latency"
+                , "milliseconds"
+                , PLUGIN_PROC_NAME
+                , "stats"
+                , 132200
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE);
+
+        st_overruns = rrdset_create_localhost(
+                "netdata"
+                , "plugin_proc_modules_overruns"
+                , NULL
+                , "proc.plugin"
+                , NULL
+                , "proc.plugin modules that completed after their next iteration was due"
+                , "overruns/s"
+                , PLUGIN_PROC_NAME
+                , "stats"
+                , 132201
+                , localhost->rrd_update_every
+                , RRDSET_TYPE_LINE);
+
+        for(size_t i = 0; proc_modules[i].name; i++) {
+            struct proc_module *pm = &proc_modules[i];
+            if(!pm->enabled)
+                continue;
+
+            pm->rd = rrddim_add(st_latency, pm->dim, NULL, 1, USEC_PER_MS, RRD_ALGORITHM_ABSOLUTE);
+            pm->rd_overruns = rrddim_add(st_overruns, pm->dim, NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+        }
+    }
+
+    if(proc_pool.threads) netdata_mutex_lock(&proc_pool.mutex);
+
+    for(size_t i = 0; proc_modules[i].name; i++) {
+        struct proc_module *pm = &proc_modules[i];
+        if(!pm->rd)
+            continue;
+
+        rrddim_set_by_pointer(st_latency, pm->rd, (collected_number)pm->latency_ut);
+        rrddim_set_by_pointer(st_overruns, pm->rd_overruns, (collected_number)pm->overruns);
+    }
+
+    if(proc_pool.threads) netdata_mutex_unlock(&proc_pool.mutex);
+
+    rrdset_done(st_latency);
+    rrdset_done(st_overruns);
+}
+
 void *proc_main(void *ptr)
 {
     CLEANUP_FUNCTION_REGISTER(proc_main_cleanup) cleanup_ptr = ptr;
@@ -222,9 +436,16 @@ void *proc_main(void *ptr)
 
         pm->enabled = config_get_boolean("plugin:proc", pm->name, CONFIG_BOOLEAN_YES);
         pm->rd = NULL;
-
-        worker_register_job_name(i, proc_modules[i].dim);
+        pm->rd_overruns = NULL;
     }
+    proc_modules_register_job_names();
+
+    // hosts with hundreds of cpus, interfaces and disks cannot collect all modules
+    // sequentially within a second, so by default use 1 worker per 64 cpus
+    long cpus = (long)os_get_system_cpus();
+    long default_threads = cpus / 64 + 1;
+    if(default_threads > 4) default_threads = 4;
+    long threads = config_get_number("plugin:proc", "worker threads", default_threads);
 
     usec_t step = localhost->rrd_update_every * USEC_PER_SEC;
     heartbeat_t hb;
@@ -235,34 +456,41 @@ void *proc_main(void *ptr)
     is_mem_zswap_enabled = is_zswap_enabled();
     is_mem_ksm_enabled = is_ksm_enabled();
 
-#define LGS_MODULE_ID 0
-
     ND_LOG_STACK lgs[] = {
             [LGS_MODULE_ID] = ND_LOG_FIELD_TXT(NDF_MODULE, "proc.plugin"),
             ND_LOG_FIELD_END(),
     };
     ND_LOG_STACK_PUSH(lgs);
 
+    proc_pool_start(threads > 0 ? (size_t)threads : 1);
+
     while(service_running(SERVICE_COLLECTORS)) {
         worker_is_idle();
-        usec_t hb_dt = heartbeat_next(&hb, step);
+        heartbeat_next(&hb, step);
 
         if(unlikely(!service_running(SERVICE_COLLECTORS)))
             break;
 
-        for(i = 0; proc_modules[i].name; i++) {
-            if(unlikely(!service_running(SERVICE_COLLECTORS)))
-                break;
+        usec_t now_ut = now_monotonic_usec();
 
-            struct proc_module *pm = &proc_modules[i];
-            if(unlikely(!pm->enabled))
-                continue;
+        if(proc_pool.threads)
+            proc_pool_schedule(now_ut);
+
+        else {
+            for(i = 0; proc_modules[i].name; i++) {
+                if(unlikely(!service_running(SERVICE_COLLECTORS)))
+                    break;
 
-            worker_is_busy(i);
-            lgs[LGS_MODULE_ID] = ND_LOG_FIELD_CB(NDF_MODULE, log_proc_module, pm);
-            pm->enabled = !pm->func(localhost->rrd_update_every, hb_dt);
-            lgs[LGS_MODULE_ID] = ND_LOG_FIELD_TXT(NDF_MODULE, "proc.plugin");
+                struct proc_module *pm = &proc_modules[i];
+                if(unlikely(!pm->enabled))
+                    continue;
+
+                pm->scheduled_ut = now_ut;
+                proc_module_collect(i, lgs, step);
+            }
         }
+
+        proc_modules_statistics();
     }
 
     return NULL;
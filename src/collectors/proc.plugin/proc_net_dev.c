@@ -928,7 +928,7 @@ int do_proc_net_dev(int update_every, usec_t dt) {
     }
 
     if(unlikely(!ff)) {
-        ff = procfile_open(proc_net_dev_filename, " \t,|", PROCFILE_FLAG_DEFAULT);
+        ff = procfile_open(proc_net_dev_filename, " \t,|", PROCFILE_FLAG_INCREMENTAL);
         if(unlikely(!ff)) return 1;
     }
 
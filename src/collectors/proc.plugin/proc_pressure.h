@@ -7,6 +7,7 @@
 
 struct pressure {
     char *filename;
+    int fd; // kept open by cgroups.plugin
     bool staterr;
     int updated;
 
@@ -17,6 +17,10 @@
 #define SYSTEMD_JOURNAL_EXECUTE_WATCHER_PENDING_EVERY_MS 250
 #define SYSTEMD_JOURNAL_ALL_FILES_SCAN_EVERY_USEC (5 * 60 * USEC_PER_SEC)
 
+#define FACET_MAX_VALUE_LENGTH                  8192
+#define JOURNAL_KEY_ND_JOURNAL_FILE             "ND_JOURNAL_FILE"
+#define JD_SOURCE_REALTIME_TIMESTAMP            "_SOURCE_REALTIME_TIMESTAMP"
+
 #define SYSTEMD_UNITS_FUNCTION_DESCRIPTION      "View the status of systemd units"
 #define SYSTEMD_UNITS_FUNCTION_NAME              "systemd-list-units"
 #define SYSTEMD_UNITS_DEFAULT_TIMEOUT            30
@@ -128,6 +132,12 @@ void netdata_systemd_journal_transform_message_id(FACETS *facets, BUFFER *wb, FA
 void *journal_watcher_main(void *arg);
 void journal_watcher_restart(void);
 
+void journal_index_init(void);
+void *journal_index_main(void *arg);
+bool journal_file_index_query(FACETS *facets, struct journal_file *jf, FACETS_ANCHOR_DIRECTION direction,
+                              usec_t after_ut, usec_t before_ut, size_t entries,
+                              size_t *rows, usec_t *last_ut);
+
 #ifdef ENABLE_SYSTEMD_DBUS
 void function_systemd_units(const char *transaction, char *function, usec_t *stop_monotonic_ut, bool *cancelled, BUFFER *payload, HTTP_ACCESS access __maybe_unused, const char *source, void *data);
 #endif
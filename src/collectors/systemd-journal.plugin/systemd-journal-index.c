@@ -0,0 +1,816 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "systemd-internals.h"
+
+/*
+ * Persistent facet index for archived journal files
+ *
+ * Archived journal files (the ones having '@' in their filename) are never
+ * modified again. So, a background thread reads them once and saves, in the
+ * cache directory of the plugin, the number of rows per field and value, split
+ * in time slots.
+ *
+ * Queries that count all the rows of a file (no filters, no full text search)
+ * and do not need any of its rows for the table, are answered from the index,
+ * without reading the journal file at all.
+ *
+ * The index file layout (all integers are in host byte order):
+ *
+ *   struct journal_index_header
+ *   FACETS_INDEXED_SLOT totals[header.slots]   // all the rows per time slot
+ *
+ *   for each field (header.fields):
+ *     struct journal_index_field
+ *     char name[]                              // NUL terminated, padded to 4 bytes
+ *
+ *     for each value (field.values):
+ *       struct journal_index_value
+ *       char value[]                           // NUL terminated, padded to 4 bytes, not there for the empty value
+ *       FACETS_INDEXED_SLOT slots[value.slots]
+ */
+
+// cleanup hashtable defines
+#include "libnetdata/simple_hashtable_undef.h"
+
+struct journal_index_builder_value;
+#define SIMPLE_HASHTABLE_VALUE_TYPE struct journal_index_builder_value
+#define SIMPLE_HASHTABLE_NAME _JIDX_VALUE
+#include "libnetdata/simple_hashtable.h"
+
+// cleanup hashtable defines
+#include "libnetdata/simple_hashtable_undef.h"
+
+struct journal_index_builder_field;
+#define SIMPLE_HASHTABLE_VALUE_TYPE struct journal_index_builder_field
+#define SIMPLE_HASHTABLE_NAME _JIDX_FIELD
+#include "libnetdata/simple_hashtable.h"
+
+#define JOURNAL_INDEX_MAGIC                     "NDSDJIX"
+#define JOURNAL_INDEX_VERSION                   1
+#define JOURNAL_INDEX_EXTENSION                 ".idx"
+
+#define JOURNAL_INDEX_SLOT_WIDTH_S              60                      // the histogram of the query should be multiple of this
+#define JOURNAL_INDEX_MAX_SLOTS                 (366 * 86400 / JOURNAL_INDEX_SLOT_WIDTH_S)
+#define JOURNAL_INDEX_MAX_VALUES_PER_FIELD      10000                   // fields with more values are not indexed
+#define JOURNAL_INDEX_MAX_FILE_SIZE             (256 * 1024 * 1024)
+#define JOURNAL_INDEX_SCAN_EVERY_UT             (60 * USEC_PER_SEC)
+#define JOURNAL_INDEX_UNMODIFIED_FOR_UT         (60 * USEC_PER_SEC)     // files modified recently are not indexed
+
+#define JOURNAL_INDEX_FIELD_OVERFLOW            (1 << 0)                // too many values, the field is not indexed
+#define JOURNAL_INDEX_VALUE_EMPTY               (1 << 0)                // the rows not having the field
+
+struct journal_index_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_width_s;
+
+    uint64_t journal_size;                  // the size of the journal file when it was indexed
+    uint64_t journal_last_modified_ut;      // the modification time of the journal file when it was indexed
+
+    uint64_t rows;
+    uint64_t first_ut;                      // the oldest row, as the query sees it
+    uint64_t last_ut;                       // the newest row, as the journal has it
+    uint64_t base_ut;                       // the time of slot 0
+    uint64_t max_journal_vs_realtime_delta_ut;
+
+    uint32_t slots;                         // the number of slots in totals
+    uint32_t fields;
+
+    uint64_t payload_size;
+    uint64_t payload_checksum;
+};
+
+struct journal_index_field {
+    uint32_t name_len;
+    uint32_t values;
+    uint32_t rows;
+    uint32_t flags;
+};
+
+struct journal_index_value {
+    uint32_t value_len;
+    uint32_t rows;
+    uint32_t slots;
+    uint32_t flags;
+};
+
+#define JOURNAL_INDEX_PADDED_STRING(len) (((len) + 1 + 3) & ~((size_t)3))
+
+static struct {
+    bool enabled;
+    char path[FILENAME_MAX + 1];
+    DICTIONARY *failed;
+} journal_index = { 0 };
+
+// ----------------------------------------------------------------------------
+
+static bool journal_index_filename(const char *journal_filename, char *dst, size_t dst_size) {
+    if(!journal_index.enabled)
+        return false;
+
+    XXH64_hash_t hash = XXH3_64bits(journal_filename, strlen(journal_filename));
+    snprintfz(dst, dst_size, "%s/%016" PRIx64 JOURNAL_INDEX_EXTENSION, journal_index.path, (uint64_t)hash);
+    return true;
+}
+
+static bool journal_file_is_archived(const char *filename) {
+    const char *s = strrchr(filename, '/');
+    return strchr(s ? s : filename, '@') != NULL;
+}
+
+static bool journal_index_read_header(int fd, struct journal_index_header *hdr) {
+    if(pread(fd, hdr, sizeof(*hdr), 0) != sizeof(*hdr))
+        return false;
+
+    return memcmp(hdr->magic, JOURNAL_INDEX_MAGIC, sizeof(hdr->magic)) == 0 &&
+           hdr->version == JOURNAL_INDEX_VERSION &&
+           hdr->slot_width_s == JOURNAL_INDEX_SLOT_WIDTH_S &&
+           hdr->payload_size <= JOURNAL_INDEX_MAX_FILE_SIZE;
+}
+
+static bool journal_index_is_up_to_date(const char *index_filename, uint64_t size, usec_t last_modified_ut) {
+    int fd = open(index_filename, O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+        return false;
+
+    struct journal_index_header hdr;
+    bool ret = journal_index_read_header(fd, &hdr) &&
+               hdr.journal_size == size &&
+               hdr.journal_last_modified_ut == last_modified_ut;
+
+    close(fd);
+    return ret;
+}
+
+// ----------------------------------------------------------------------------
+// building the index
+
+struct journal_index_builder_slots {
+    uint32_t used;
+    uint32_t size;
+    FACETS_INDEXED_SLOT *array;
+};
+
+struct journal_index_builder_value {
+    char *value;
+    uint32_t value_len;
+    uint32_t rows;
+    struct journal_index_builder_slots slots;
+};
+
+struct journal_index_builder_field {
+    char *name;
+    uint32_t name_len;
+    uint32_t rows;
+    bool overflow;
+
+    uint64_t row_id;                                // the last row this field was found in
+    struct journal_index_builder_value *row_value;  // the last value of this field in that row
+
+    struct journal_index_builder_slots present;     // the rows having this field, per slot
+    SIMPLE_HASHTABLE_JIDX_VALUE values;
+};
+
+static inline void journal_index_slot_add(struct journal_index_builder_slots *s, uint32_t slot) {
+    // rows are read backwards, so most of the times the slot is the last one we added
+    if(likely(s->used && s->array[s->used - 1].slot == slot)) {
+        s->array[s->used - 1].rows++;
+        return;
+    }
+
+    if(unlikely(s->used == s->size)) {
+        s->size = s->size ? s->size * 2 : 16;
+        s->array = reallocz(s->array, s->size * sizeof(*s->array));
+    }
+
+    s->array[s->used++] = (FACETS_INDEXED_SLOT){ .slot = slot, .rows = 1, };
+}
+
+static int journal_index_slot_compar(const void *a, const void *b) {
+    const FACETS_INDEXED_SLOT *s1 = a, *s2 = b;
+
+    if(s1->slot < s2->slot) return -1;
+    if(s1->slot > s2->slot) return 1;
+    return 0;
+}
+
+static void journal_index_slots_finalize(struct journal_index_builder_slots *s, uint32_t base_slot) {
+    // timestamps are not always monotonic, so sort and merge duplicates
+    qsort(s->array, s->used, sizeof(*s->array), journal_index_slot_compar);
+
+    uint32_t used = 0;
+    for(uint32_t i = 0; i < s->used ;i++) {
+        if(used && s->array[used - 1].slot == s->array[i].slot)
+            s->array[used - 1].rows += s->array[i].rows;
+        else
+            s->array[used++] = s->array[i];
+    }
+    s->used = used;
+
+    for(uint32_t i = 0; i < s->used ;i++)
+        s->array[i].slot -= base_slot;
+}
+
+static void journal_index_builder_field_free_values(struct journal_index_builder_field *f) {
+    SIMPLE_HASHTABLE_FOREACH_READ_ONLY(&f->values, sl, _JIDX_VALUE) {
+        struct journal_index_builder_value *v = SIMPLE_HASHTABLE_FOREACH_READ_ONLY_VALUE(sl);
+        if(!v) continue;
+
+        freez(v->value);
+        freez(v->slots.array);
+        freez(v);
+    }
+    simple_hashtable_destroy_JIDX_VALUE(&f->values);
+    simple_hashtable_init_JIDX_VALUE(&f->values, 1);
+}
+
+static inline struct journal_index_builder_field *journal_index_builder_field_get(SIMPLE_HASHTABLE_JIDX_FIELD *fields, const char *key, size_t key_len) {
+    XXH64_hash_t hash = XXH3_64bits(key, key_len);
+    SIMPLE_HASHTABLE_SLOT_JIDX_FIELD *sl = simple_hashtable_get_slot_JIDX_FIELD(fields, hash, NULL, true);
+    struct journal_index_builder_field *f = SIMPLE_HASHTABLE_SLOT_DATA(sl);
+    if(likely(f))
+        return f;
+
+    f = callocz(1, sizeof(*f));
+    f->name = strndupz(key, key_len);
+    f->name_len = key_len;
+    simple_hashtable_init_JIDX_VALUE(&f->values, 16);
+    simple_hashtable_set_slot_JIDX_FIELD(fields, sl, hash, f);
+    return f;
+}
+
+static inline struct journal_index_builder_value *journal_index_builder_value_get(struct journal_index_builder_field *f, const char *value, size_t value_len) {
+    XXH64_hash_t hash = XXH3_64bits(value, value_len);
+    SIMPLE_HASHTABLE_SLOT_JIDX_VALUE *sl = simple_hashtable_get_slot_JIDX_VALUE(&f->values, hash, NULL, true);
+    struct journal_index_builder_value *v = SIMPLE_HASHTABLE_SLOT_DATA(sl);
+    if(likely(v))
+        return v;
+
+    if(f->values.used - f->values.deleted >= JOURNAL_INDEX_MAX_VALUES_PER_FIELD) {
+        f->overflow = true;
+        f->row_value = NULL;
+        journal_index_builder_field_free_values(f);
+        return NULL;
+    }
+
+    v = callocz(1, sizeof(*v));
+    v->value = mallocz(value_len + 1);
+    memcpy(v->value, value, value_len);
+    v->value[value_len] = '\0';
+    v->value_len = value_len;
+    simple_hashtable_set_slot_JIDX_VALUE(&f->values, sl, hash, v);
+    return v;
+}
+
+static void journal_index_write_padded_string(BUFFER *wb, const char *s, size_t len) {
+    static const char zeros[4] = { 0 };
+    buffer_memcat(wb, s, len);
+    buffer_memcat(wb, zeros, JOURNAL_INDEX_PADDED_STRING(len) - len);
+}
+
+static void journal_index_write_value(BUFFER *wb, const char *value, uint32_t value_len, uint32_t rows, uint32_t flags, FACETS_INDEXED_SLOT *slots, uint32_t entries) {
+    struct journal_index_value iv = {
+            .value_len = value_len,
+            .rows = rows,
+            .slots = entries,
+            .flags = flags,
+    };
+    buffer_memcat(wb, &iv, sizeof(iv));
+
+    if(!(flags & JOURNAL_INDEX_VALUE_EMPTY))
+        journal_index_write_padded_string(wb, value, value_len);
+
+    if(entries)
+        buffer_memcat(wb, slots, entries * sizeof(*slots));
+}
+
+static bool journal_index_write_empty_value(BUFFER *wb, struct journal_index_builder_field *f, struct journal_index_builder_slots *totals, uint64_t rows) {
+    if(f->rows >= rows)
+        return false;
+
+    // the rows that do not have this field, are all the rows minus the ones that have it
+    FACETS_INDEXED_SLOT *slots = mallocz(totals->used * sizeof(*slots));
+    uint32_t entries = 0;
+
+    for(uint32_t t = 0, p = 0; t < totals->used ;t++) {
+        uint32_t present = 0;
+
+        while(p < f->present.used && f->present.array[p].slot < totals->array[t].slot)
+            p++;
+
+        if(p < f->present.used && f->present.array[p].slot == totals->array[t].slot)
+            present = f->present.array[p].rows;
+
+        if(totals->array[t].rows > present)
+            slots[entries++] = (FACETS_INDEXED_SLOT){
+                    .slot = totals->array[t].slot,
+                    .rows = totals->array[t].rows - present,
+            };
+    }
+
+    journal_index_write_value(wb, NULL, 0, (uint32_t)(rows - f->rows), JOURNAL_INDEX_VALUE_EMPTY, slots, entries);
+    freez(slots);
+    return true;
+}
+
+static bool journal_index_save(const char *index_filename, struct journal_index_header *hdr, BUFFER *payload) {
+    hdr->payload_size = buffer_strlen(payload);
+    hdr->payload_checksum = XXH3_64bits(buffer_tostring(payload), buffer_strlen(payload));
+
+    char tmp_filename[FILENAME_MAX + 1];
+    snprintfz(tmp_filename, sizeof(tmp_filename), "%s.tmp", index_filename);
+
+    int fd = open(tmp_filename, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0660);
+    if(fd == -1) {
+        nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL INDEX: cannot create file '%s'", tmp_filename);
+        return false;
+    }
+
+    bool ok = write(fd, hdr, sizeof(*hdr)) == sizeof(*hdr) &&
+              write(fd, buffer_tostring(payload), buffer_strlen(payload)) == (ssize_t)buffer_strlen(payload);
+
+    close(fd);
+
+    if(!ok || rename(tmp_filename, index_filename) != 0) {
+        nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL INDEX: cannot save file '%s'", index_filename);
+        unlink(tmp_filename);
+        return false;
+    }
+
+    return true;
+}
+
+static bool journal_index_build(const char *filename, uint64_t size, usec_t last_modified_ut, const char *index_filename) {
+    sd_journal *j = NULL;
+    const char *paths[2] = {
+            [0] = filename,
+            [1] = NULL,
+    };
+
+    if(sd_journal_open_files(&j, paths, ND_SD_JOURNAL_OPEN_FLAGS) < 0 || !j) {
+        nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL INDEX: cannot open file '%s' for indexing", filename);
+        return false;
+    }
+
+    usec_t started_ut = now_monotonic_usec();
+
+    SIMPLE_HASHTABLE_JIDX_FIELD fields;
+    simple_hashtable_init_JIDX_FIELD(&fields, 64);
+
+    struct journal_index_builder_slots totals = { 0 };
+    size_t touched_size = 64, touched_used = 0;
+    struct journal_index_builder_field **touched = mallocz(touched_size * sizeof(*touched));
+
+    uint64_t rows = 0;
+    usec_t first_ut = UINT64_MAX, last_ut = 0, max_delta_ut = 0;
+    uint32_t min_slot = UINT32_MAX, max_slot = 0;
+    usec_t last_usec_from = 0, last_usec_to = 0;
+    bool ok = sd_journal_seek_tail(j) >= 0;
+
+    while(ok && sd_journal_previous(j) > 0) {
+        usec_t msg_ut = 0;
+        if(sd_journal_get_realtime_usec(j, &msg_ut) < 0 || !msg_ut)
+            continue;
+
+        usec_t journal_ut = msg_ut;
+        touched_used = 0;
+        rows++;
+
+        const void *data;
+        size_t length;
+        SD_JOURNAL_FOREACH_DATA(j, data, length) {
+            const char *key, *value;
+            size_t key_length, value_length;
+
+            if(!parse_journal_field(data, length, &key, &key_length, &value, &value_length))
+                continue;
+
+            // the same timestamp adjustments the query does
+            if(unlikely(key_length == sizeof(JD_SOURCE_REALTIME_TIMESTAMP) - 1 &&
+                        memcmp(key, JD_SOURCE_REALTIME_TIMESTAMP, sizeof(JD_SOURCE_REALTIME_TIMESTAMP) - 1) == 0)) {
+                usec_t ut = str2ull(value, NULL);
+                if(ut && ut < msg_ut) {
+                    usec_t delta = msg_ut - ut;
+                    msg_ut = ut;
+
+                    if(delta > JOURNAL_VS_REALTIME_DELTA_MAX_UT)
+                        delta = JOURNAL_VS_REALTIME_DELTA_MAX_UT;
+
+                    if(delta > max_delta_ut)
+                        max_delta_ut = delta;
+                }
+            }
+
+            if(value_length > FACET_MAX_VALUE_LENGTH)
+                value_length = FACET_MAX_VALUE_LENGTH;
+
+            struct journal_index_builder_field *f = journal_index_builder_field_get(&fields, key, key_length);
+            if(f->row_id != rows) {
+                f->row_id = rows;
+
+                if(touched_used == touched_size) {
+                    touched_size *= 2;
+                    touched = reallocz(touched, touched_size * sizeof(*touched));
+                }
+                touched[touched_used++] = f;
+            }
+
+            // like the query, the last value of the field in the row is the one counted
+            if(!f->overflow)
+                f->row_value = journal_index_builder_value_get(f, value, value_length);
+        }
+
+        // make sure each line gets a unique timestamp, like the query does
+        if(unlikely(msg_ut >= last_usec_from && msg_ut <= last_usec_to))
+            msg_ut = --last_usec_from;
+        else
+            last_usec_from = last_usec_to = msg_ut;
+
+        uint32_t slot = (uint32_t)(msg_ut / (JOURNAL_INDEX_SLOT_WIDTH_S * USEC_PER_SEC));
+        if(slot < min_slot) min_slot = slot;
+        if(slot > max_slot) max_slot = slot;
+        if(msg_ut < first_ut) first_ut = msg_ut;
+        if(journal_ut > last_ut) last_ut = journal_ut;
+
+        if(max_slot - min_slot > JOURNAL_INDEX_MAX_SLOTS) {
+            nd_log(NDLS_COLLECTORS, NDLP_NOTICE,
+                   "JOURNAL INDEX: file '%s' spans too much time, it will not be indexed", filename);
+            ok = false;
+            break;
+        }
+
+        journal_index_slot_add(&totals, slot);
+
+        for(size_t i = 0; i < touched_used ;i++) {
+            struct journal_index_builder_field *f = touched[i];
+            f->rows++;
+            journal_index_slot_add(&f->present, slot);
+
+            if(f->row_value) {
+                f->row_value->rows++;
+                journal_index_slot_add(&f->row_value->slots, slot);
+            }
+        }
+    }
+
+    sd_journal_close(j);
+
+    if(ok && (!rows || rows > UINT32_MAX))
+        ok = false;
+
+    BUFFER *payload = NULL;
+    struct journal_index_header hdr = {
+            .magic = JOURNAL_INDEX_MAGIC,
+            .version = JOURNAL_INDEX_VERSION,
+            .slot_width_s = JOURNAL_INDEX_SLOT_WIDTH_S,
+            .journal_size = size,
+            .journal_last_modified_ut = last_modified_ut,
+            .rows = rows,
+            .first_ut = first_ut,
+            .last_ut = last_ut,
+            .base_ut = (usec_t)min_slot * JOURNAL_INDEX_SLOT_WIDTH_S * USEC_PER_SEC,
+            .max_journal_vs_realtime_delta_ut = max_delta_ut,
+    };
+
+    if(ok) {
+        payload = buffer_create(1024 * 1024, NULL);
+
+        journal_index_slots_finalize(&totals, min_slot);
+        hdr.slots = totals.used;
+        buffer_memcat(payload, totals.array, totals.used * sizeof(*totals.array));
+
+        SIMPLE_HASHTABLE_FOREACH_READ_ONLY(&fields, fsl, _JIDX_FIELD) {
+            struct journal_index_builder_field *f = SIMPLE_HASHTABLE_FOREACH_READ_ONLY_VALUE(fsl);
+            if(!f) continue;
+
+            journal_index_slots_finalize(&f->present, min_slot);
+
+            struct journal_index_field ifl = {
+                    .name_len = f->name_len,
+                    .values = 0,
+                    .rows = f->rows,
+                    .flags = f->overflow ? JOURNAL_INDEX_FIELD_OVERFLOW : 0,
+            };
+            size_t ifl_pos = buffer_strlen(payload);
+            buffer_memcat(payload, &ifl, sizeof(ifl));
+            journal_index_write_padded_string(payload, f->name, f->name_len);
+
+            if(!f->overflow) {
+                SIMPLE_HASHTABLE_FOREACH_READ_ONLY(&f->values, vsl, _JIDX_VALUE) {
+                    struct journal_index_builder_value *v = SIMPLE_HASHTABLE_FOREACH_READ_ONLY_VALUE(vsl);
+                    if(!v) continue;
+
+                    journal_index_slots_finalize(&v->slots, min_slot);
+                    journal_index_write_value(payload, v->value, v->value_len, v->rows, 0, v->slots.array, v->slots.used);
+                    ifl.values++;
+                }
+
+                if(journal_index_write_empty_value(payload, f, &totals, rows))
+                    ifl.values++;
+
+                memcpy(&payload->buffer[ifl_pos], &ifl, sizeof(ifl));
+            }
+
+            hdr.fields++;
+        }
+
+        if(buffer_strlen(payload) > JOURNAL_INDEX_MAX_FILE_SIZE) {
+            nd_log(NDLS_COLLECTORS, NDLP_NOTICE,
+                   "JOURNAL INDEX: the index of file '%s' is too big, it will not be saved", filename);
+            ok = false;
+        }
+        else
+            ok = journal_index_save(index_filename, &hdr, payload);
+    }
+
+    // cleanup
+    SIMPLE_HASHTABLE_FOREACH_READ_ONLY(&fields, fsl, _JIDX_FIELD) {
+        struct journal_index_builder_field *f = SIMPLE_HASHTABLE_FOREACH_READ_ONLY_VALUE(fsl);
+        if(!f) continue;
+
+        journal_index_builder_field_free_values(f);
+        simple_hashtable_destroy_JIDX_VALUE(&f->values);
+        freez(f->present.array);
+        freez(f->name);
+        freez(f);
+    }
+    simple_hashtable_destroy_JIDX_FIELD(&fields);
+    freez(totals.array);
+    freez(touched);
+
+    if(ok)
+        nd_log(NDLS_COLLECTORS, NDLP_DEBUG,
+               "JOURNAL INDEX: indexed file '%s', %"PRIu64" rows, %u fields, %zu bytes, in %"PRIu64" ms",
+               filename, rows, hdr.fields, buffer_strlen(payload),
+               (uint64_t)((now_monotonic_usec() - started_ut) / USEC_PER_MS));
+
+    buffer_free(payload);
+    return ok;
+}
+
+// ----------------------------------------------------------------------------
+// querying the index
+
+static bool journal_index_load(const char *index_filename, struct journal_file *jf, struct journal_index_header *hdr,
+                               FACETS *facets, FACETS_ANCHOR_DIRECTION direction,
+                               usec_t after_ut, usec_t before_ut, size_t entries, char **payload) {
+    int fd = open(index_filename, O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+        return false;
+
+    bool ok = journal_index_read_header(fd, hdr) &&
+              hdr->journal_size == jf->size &&
+              hdr->journal_last_modified_ut == jf->file_last_modified_ut;
+
+    // all the rows of the file should be in the timeframe of the query
+    if(ok)
+        ok = hdr->first_ut >= after_ut && hdr->last_ut <= before_ut;
+
+    // the rows of the file should not be needed for the table
+    if(ok)
+        ok = facets_rows(facets) >= entries &&
+                (direction == FACETS_ANCHOR_DIRECTION_BACKWARD ?
+                    hdr->last_ut < facets_row_oldest_ut(facets) :
+                    hdr->first_ut > facets_row_newest_ut(facets));
+
+    if(ok)
+        ok = facets_indexed_histogram_is_compatible(facets, hdr->slot_width_s * USEC_PER_SEC);
+
+    if(ok) {
+        *payload = mallocz(hdr->payload_size);
+        ok = pread(fd, *payload, hdr->payload_size, sizeof(*hdr)) == (ssize_t)hdr->payload_size &&
+                XXH3_64bits(*payload, hdr->payload_size) == hdr->payload_checksum;
+
+        if(!ok) {
+            nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL INDEX: file '%s' is corrupted, deleting it", index_filename);
+            unlink(index_filename);
+            freez(*payload);
+            *payload = NULL;
+        }
+    }
+
+    close(fd);
+    return ok;
+}
+
+#define JOURNAL_INDEX_NEED(pos, bytes, end) ((size_t)((end) - (pos)) >= (size_t)(bytes))
+
+// walk the payload; when apply is false, only check it can be used for this query
+static bool journal_index_walk(FACETS *facets, struct journal_index_header *hdr, const char *payload, bool apply) {
+    const char *pos = payload;
+    const char *end = payload + hdr->payload_size;
+    usec_t slot_width_ut = hdr->slot_width_s * USEC_PER_SEC;
+
+    if(!JOURNAL_INDEX_NEED(pos, hdr->slots * sizeof(FACETS_INDEXED_SLOT), end))
+        return false;
+
+    pos += hdr->slots * sizeof(FACETS_INDEXED_SLOT);
+
+    for(uint32_t f = 0; f < hdr->fields ;f++) {
+        if(!JOURNAL_INDEX_NEED(pos, sizeof(struct journal_index_field), end))
+            return false;
+
+        const struct journal_index_field *ifl = (const struct journal_index_field *)pos;
+        pos += sizeof(*ifl);
+
+        if(!JOURNAL_INDEX_NEED(pos, JOURNAL_INDEX_PADDED_STRING(ifl->name_len), end) || pos[ifl->name_len] != '\0')
+            return false;
+
+        const char *name = pos;
+        pos += JOURNAL_INDEX_PADDED_STRING(ifl->name_len);
+
+        // the values of this field are not in the index
+        // so, the index cannot be used if the field is a facet
+        if(!apply && (ifl->flags & JOURNAL_INDEX_FIELD_OVERFLOW) && facets_key_name_is_facet(facets, name))
+            return false;
+
+        for(uint32_t v = 0; v < ifl->values ;v++) {
+            if(!JOURNAL_INDEX_NEED(pos, sizeof(struct journal_index_value), end))
+                return false;
+
+            const struct journal_index_value *iv = (const struct journal_index_value *)pos;
+            pos += sizeof(*iv);
+
+            const char *value = NULL;
+            if(!(iv->flags & JOURNAL_INDEX_VALUE_EMPTY)) {
+                if(!JOURNAL_INDEX_NEED(pos, JOURNAL_INDEX_PADDED_STRING(iv->value_len), end))
+                    return false;
+
+                value = pos;
+                pos += JOURNAL_INDEX_PADDED_STRING(iv->value_len);
+            }
+
+            if(!JOURNAL_INDEX_NEED(pos, iv->slots * sizeof(FACETS_INDEXED_SLOT), end))
+                return false;
+
+            const FACETS_INDEXED_SLOT *slots = (const FACETS_INDEXED_SLOT *)pos;
+            pos += iv->slots * sizeof(FACETS_INDEXED_SLOT);
+
+            if(apply)
+                facets_indexed_key_value(facets, name, ifl->name_len, value, iv->value_len, iv->rows,
+                                         hdr->base_ut, slot_width_ut, slots, iv->slots);
+        }
+
+        if(apply && (ifl->flags & JOURNAL_INDEX_FIELD_OVERFLOW))
+            facets_register_key_name(facets, name, 0);
+    }
+
+    return pos == end;
+}
+
+bool journal_file_index_query(FACETS *facets, struct journal_file *jf, FACETS_ANCHOR_DIRECTION direction,
+                              usec_t after_ut, usec_t before_ut, size_t entries,
+                              size_t *rows, usec_t *last_ut) {
+    char index_filename[FILENAME_MAX + 1];
+    if(!journal_file_is_archived(jf->filename) || !journal_index_filename(jf->filename, index_filename, sizeof(index_filename)))
+        return false;
+
+    struct journal_index_header hdr;
+    char *payload = NULL;
+    if(!journal_index_load(index_filename, jf, &hdr, facets, direction, after_ut, before_ut, entries, &payload))
+        return false;
+
+    bool ok = journal_index_walk(facets, &hdr, payload, false);
+    if(ok) {
+        usec_t slot_width_ut = hdr.slot_width_s * USEC_PER_SEC;
+        const FACETS_INDEXED_SLOT *totals = (const FACETS_INDEXED_SLOT *)payload;
+
+        facets_indexed_key_value(facets, JOURNAL_KEY_ND_JOURNAL_FILE, sizeof(JOURNAL_KEY_ND_JOURNAL_FILE) - 1,
+                                 jf->filename, jf->filename_len, hdr.rows, hdr.base_ut, slot_width_ut, totals, hdr.slots);
+
+        journal_index_walk(facets, &hdr, payload, true);
+
+        facets_indexed_rows_finished(facets, hdr.rows, hdr.base_ut, slot_width_ut, totals, hdr.slots);
+
+        // update max_journal_vs_realtime_delta_ut if the delta increased
+        usec_t expected = __atomic_load_n(&jf->max_journal_vs_realtime_delta_ut, __ATOMIC_RELAXED);
+        do {
+            if(hdr.max_journal_vs_realtime_delta_ut <= expected)
+                break;
+        } while(!__atomic_compare_exchange_n(&jf->max_journal_vs_realtime_delta_ut, &expected, hdr.max_journal_vs_realtime_delta_ut, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+        *rows = hdr.rows;
+        *last_ut = hdr.last_ut;
+    }
+    else
+        nd_log(NDLS_COLLECTORS, NDLP_DEBUG, "JOURNAL INDEX: cannot use index of file '%s' for this query", jf->filename);
+
+    freez(payload);
+    return ok;
+}
+
+// ----------------------------------------------------------------------------
+// the background thread maintaining the index files
+
+struct journal_index_candidate {
+    char *filename;
+    uint64_t size;
+    usec_t last_modified_ut;
+};
+
+static void journal_index_cleanup_orphans(DICTIONARY *wanted) {
+    DIR *dir = opendir(journal_index.path);
+    if(!dir)
+        return;
+
+    struct dirent *entry;
+    while((entry = readdir(dir)) != NULL) {
+        if(entry->d_type != DT_REG)
+            continue;
+
+        size_t len = strlen(entry->d_name);
+        bool tmp = len > 4 && strcmp(&entry->d_name[len - 4], ".tmp") == 0;
+        bool idx = len > sizeof(JOURNAL_INDEX_EXTENSION) - 1 &&
+                   strcmp(&entry->d_name[len - (sizeof(JOURNAL_INDEX_EXTENSION) - 1)], JOURNAL_INDEX_EXTENSION) == 0;
+
+        if(tmp || (idx && !dictionary_get(wanted, entry->d_name))) {
+            char path[FILENAME_MAX + 1];
+            snprintfz(path, sizeof(path), "%s/%s", journal_index.path, entry->d_name);
+            unlink(path);
+        }
+    }
+
+    closedir(dir);
+}
+
+static void journal_index_update(void) {
+    usec_t now_ut = now_realtime_usec();
+
+    size_t used = 0, size = dictionary_entries(journal_files_registry);
+    struct journal_index_candidate *candidates = callocz(size ? size : 1, sizeof(*candidates));
+    DICTIONARY *wanted = dictionary_create(DICT_OPTION_SINGLE_THREADED | DICT_OPTION_DONT_OVERWRITE_VALUE);
+
+    struct journal_file *jf;
+    dfe_start_read(journal_files_registry, jf) {
+        if(!journal_file_is_archived(jf->filename))
+            continue;
+
+        char index_filename[FILENAME_MAX + 1];
+        journal_index_filename(jf->filename, index_filename, sizeof(index_filename));
+        const char *basename = strrchr(index_filename, '/');
+        dictionary_set(wanted, basename ? basename + 1 : index_filename, NULL, 0);
+
+        if(used >= size || jf->file_last_modified_ut + JOURNAL_INDEX_UNMODIFIED_FOR_UT > now_ut)
+            continue;
+
+        usec_t *failed_ut = dictionary_get(journal_index.failed, jf->filename);
+        if(failed_ut && *failed_ut == jf->file_last_modified_ut)
+            continue;
+
+        candidates[used++] = (struct journal_index_candidate){
+                .filename = strdupz(jf->filename),
+                .size = jf->size,
+                .last_modified_ut = jf->file_last_modified_ut,
+        };
+    }
+    dfe_done(jf);
+
+    // newer files first, they are the ones queried most
+    for(size_t i = used; i > 0 ;i--) {
+        struct journal_index_candidate *c = &candidates[i - 1];
+
+        char index_filename[FILENAME_MAX + 1];
+        journal_index_filename(c->filename, index_filename, sizeof(index_filename));
+
+        if(!journal_index_is_up_to_date(index_filename, c->size, c->last_modified_ut) &&
+            !journal_index_build(c->filename, c->size, c->last_modified_ut, index_filename))
+            dictionary_set(journal_index.failed, c->filename, &c->last_modified_ut, sizeof(c->last_modified_ut));
+
+        freez(c->filename);
+    }
+    freez(candidates);
+
+    journal_index_cleanup_orphans(wanted);
+    dictionary_destroy(wanted);
+}
+
+void journal_index_init(void) {
+    const char *cache_dir = getenv("NETDATA_CACHE_DIR");
+    if(!cache_dir || !*cache_dir)
+        return;
+
+    snprintfz(journal_index.path, sizeof(journal_index.path), "%s/systemd-journal-index", cache_dir);
+    if(mkdir(journal_index.path, 0770) == -1 && errno != EEXIST) {
+        nd_log(NDLS_COLLECTORS, NDLP_ERR, "JOURNAL INDEX: cannot create directory '%s', indexing is disabled", journal_index.path);
+        return;
+    }
+
+    journal_index.failed = dictionary_create_advanced(DICT_OPTION_FIXED_SIZE, NULL, sizeof(usec_t));
+
+    journal_index.enabled = true;
+}
+
+void *journal_index_main(void *arg __maybe_unused) {
+    if(!journal_index.enabled)
+        return NULL;
+
+    while(!journal_files_completed_once())
+        sleep_usec(USEC_PER_SEC);
+
+    while(1) {
+        journal_index_update();
+        sleep_usec(JOURNAL_INDEX_SCAN_EVERY_UT);
+    }
+
+    return NULL;
+}
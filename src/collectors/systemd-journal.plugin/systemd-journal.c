@@ -14,8 +14,6 @@
  *
  */
 
-#define FACET_MAX_VALUE_LENGTH                  8192
-
 #define SYSTEMD_JOURNAL_FUNCTION_DESCRIPTION    "View, search and analyze systemd journal entries."
 #define SYSTEMD_JOURNAL_FUNCTION_NAME           "systemd-journal"
 #define SYSTEMD_JOURNAL_DEFAULT_TIMEOUT         60
@@ -28,6 +26,9 @@
 
 #define SYSTEMD_JOURNAL_PROGRESS_EVERY_UT       (250 * USEC_PER_MS)
 
+#define SYSTEMD_JOURNAL_QUERY_THREADS_MAX       8
+#define SYSTEMD_JOURNAL_QUERY_THREADS_POLL_UT   (50 * USEC_PER_MS)
+
 #define JOURNAL_PARAMETER_HELP                  "help"
 #define JOURNAL_PARAMETER_AFTER                 "after"
 #define JOURNAL_PARAMETER_BEFORE                "before"
@@ -46,7 +47,6 @@
 #define JOURNAL_PARAMETER_TAIL                  "tail"
 #define JOURNAL_PARAMETER_SAMPLING              "sampling"
 
-#define JOURNAL_KEY_ND_JOURNAL_FILE             "ND_JOURNAL_FILE"
 #define JOURNAL_KEY_ND_JOURNAL_PROCESS          "ND_JOURNAL_PROCESS"
 
 #define JOURNAL_DEFAULT_SLICE_MODE              true
@@ -255,11 +255,32 @@ typedef struct function_query_status {
     usec_t matches_setup_ut;
     size_t rows_useful;
     size_t rows_read;
+    size_t rows_indexed;
     size_t bytes_read;
     size_t files_matched;
     size_t file_working;
 } FUNCTION_QUERY_STATUS;
 
+typedef struct journal_query_file_stats {
+    ND_SD_JOURNAL_STATUS status;
+    bool queried;
+
+    usec_t duration_ut;
+    usec_t matches_setup_ut;
+    size_t rows_read;
+    size_t rows_useful;
+    size_t rows_indexed;
+    size_t bytes_read;
+    size_t fstat_calls;
+    size_t fstat_cached;
+
+    struct {
+        uint32_t sampled;
+        uint32_t unsampled;
+        uint32_t estimated;
+    } samples;
+} JOURNAL_QUERY_FILE_STATS;
+
 static void log_fqs(FUNCTION_QUERY_STATUS *fqs, const char *msg) {
     netdata_log_error("ERROR: %s, on query "
                       "timeframe [%"PRIu64" - %"PRIu64"], "
@@ -288,8 +309,6 @@ static inline bool netdata_systemd_journal_seek_to(sd_journal *j, usec_t timesta
     return true;
 }
 
-#define JD_SOURCE_REALTIME_TIMESTAMP "_SOURCE_REALTIME_TIMESTAMP"
-
 // ----------------------------------------------------------------------------
 // sampling support
 
@@ -976,8 +995,10 @@ static bool netdata_systemd_filtering_by_journal(sd_journal *j, FACETS *facets,
 
         if(fqs->data_only)
             interesting = facets_key_name_is_filter(facets, field);
-        else
+        else {
+            facets_register_key_name(facets, field, 0);
             interesting = facets_key_name_is_facet(facets, field);
+        }
 
         if(interesting) {
             if(sd_journal_query_unique(j, field) >= 0) {
@@ -1032,10 +1053,33 @@ static bool netdata_systemd_filtering_by_journal(sd_journal *j, FACETS *facets,
 }
 #endif // HAVE_SD_JOURNAL_RESTART_FIELDS
 
+static bool netdata_systemd_journal_query_from_index(FACETS *facets, struct journal_file *jf, FUNCTION_QUERY_STATUS *fqs) {
+    // the index has the counters of all the rows of the file,
+    // so it can only be used when all of them are counted
+    if(fqs->data_only || fqs->delta || fqs->tail || fqs->filters || fqs->query)
+        return false;
+
+    size_t rows = 0;
+    usec_t last_ut = 0;
+    if(!journal_file_index_query(facets, jf, fqs->direction, fqs->after_ut, fqs->before_ut, fqs->entries, &rows, &last_ut))
+        return false;
+
+    fqs->rows_useful += rows;
+    fqs->rows_indexed += rows;
+
+    if(last_ut > fqs->last_modified)
+        fqs->last_modified = last_ut;
+
+    return true;
+}
+
 static ND_SD_JOURNAL_STATUS netdata_systemd_journal_query_one_file(
         const char *filename, BUFFER *wb, FACETS *facets,
         struct journal_file *jf, FUNCTION_QUERY_STATUS *fqs) {
 
+    if(netdata_systemd_journal_query_from_index(facets, jf, fqs))
+        return ND_SD_JOURNAL_OK;
+
     sd_journal *j = NULL;
     errno_clear();
 
@@ -1102,6 +1146,302 @@ static bool jf_is_mine(struct journal_file *jf, FUNCTION_QUERY_STATUS *fqs) {
     return false;
 }
 
+static ND_SD_JOURNAL_STATUS netdata_systemd_journal_query_file_with_stats(
+        const char *filename, BUFFER *wb, FACETS *facets,
+        struct journal_file *jf, FUNCTION_QUERY_STATUS *fqs, JOURNAL_QUERY_FILE_STATS *st) {
+
+    size_t fs_calls = fstat_thread_calls;
+    size_t fs_cached = fstat_thread_cached_responses;
+    size_t rows_useful = fqs->rows_useful;
+    size_t rows_read = fqs->rows_read;
+    size_t rows_indexed = fqs->rows_indexed;
+    size_t bytes_read = fqs->bytes_read;
+    size_t matches_setup_ut = fqs->matches_setup_ut;
+
+    sampling_file_init(fqs, jf);
+
+    usec_t started_ut = now_monotonic_usec();
+    ND_SD_JOURNAL_STATUS status = netdata_systemd_journal_query_one_file(filename, wb, facets, jf, fqs);
+    usec_t ended_ut = now_monotonic_usec();
+
+//        nd_log(NDLS_COLLECTORS, NDLP_INFO,
+//               "JOURNAL ESTIMATION FINAL: '%s' "
+//               "total lines %zu [sampled=%zu, unsampled=%zu, estimated=%zu], "
+//               "file [%"PRIu64" - %"PRIu64", duration %"PRId64", known lines in file %zu], "
+//               "query [%"PRIu64" - %"PRIu64", duration %"PRId64"], "
+//               , jf->filename
+//               , fqs->samples_per_file.sampled + fqs->samples_per_file.unsampled + fqs->samples_per_file.estimated
+//               , fqs->samples_per_file.sampled, fqs->samples_per_file.unsampled, fqs->samples_per_file.estimated
+//               , jf->msg_first_ut, jf->msg_last_ut, jf->msg_last_ut - jf->msg_first_ut, jf->messages_in_file
+//               , fqs->query_file.start_ut, fqs->query_file.stop_ut, fqs->query_file.stop_ut - fqs->query_file.start_ut
+//        );
+
+    *st = (JOURNAL_QUERY_FILE_STATS) {
+            .status = status,
+            .queried = true,
+            .duration_ut = ended_ut - started_ut,
+            .matches_setup_ut = fqs->matches_setup_ut - matches_setup_ut,
+            .rows_read = fqs->rows_read - rows_read,
+            .rows_useful = fqs->rows_useful - rows_useful,
+            .rows_indexed = fqs->rows_indexed - rows_indexed,
+            .bytes_read = fqs->bytes_read - bytes_read,
+            .fstat_calls = fstat_thread_calls - fs_calls,
+            .fstat_cached = fstat_thread_cached_responses - fs_cached,
+            .samples = {
+                    .sampled = fqs->samples_per_file.sampled,
+                    .unsampled = fqs->samples_per_file.unsampled,
+                    .estimated = fqs->samples_per_file.estimated,
+            },
+    };
+
+    return status;
+}
+
+static void netdata_systemd_journal_file_stats_to_json(BUFFER *wb, const char *filename, struct journal_file *jf, JOURNAL_QUERY_FILE_STATS *st, bool sampling) {
+    buffer_json_add_array_item_object(wb); // journal file
+    {
+        // information about the file
+        buffer_json_member_add_string(wb, "_filename", filename);
+        buffer_json_member_add_uint64(wb, "_source_type", jf->source_type);
+        buffer_json_member_add_string(wb, "_source", string2str(jf->source));
+        buffer_json_member_add_uint64(wb, "_last_modified_ut", jf->file_last_modified_ut);
+        buffer_json_member_add_uint64(wb, "_msg_first_ut", jf->msg_first_ut);
+        buffer_json_member_add_uint64(wb, "_msg_last_ut", jf->msg_last_ut);
+        buffer_json_member_add_uint64(wb, "_journal_vs_realtime_delta_ut", jf->max_journal_vs_realtime_delta_ut);
+
+        // information about the current use of the file
+        buffer_json_member_add_uint64(wb, "duration_ut", st->duration_ut);
+        buffer_json_member_add_uint64(wb, "rows_read", st->rows_read);
+        buffer_json_member_add_uint64(wb, "rows_useful", st->rows_useful);
+        buffer_json_member_add_uint64(wb, "rows_indexed", st->rows_indexed);
+        buffer_json_member_add_double(wb, "rows_per_second", (double) st->rows_read / (double) st->duration_ut * (double) USEC_PER_SEC);
+        buffer_json_member_add_uint64(wb, "bytes_read", st->bytes_read);
+        buffer_json_member_add_double(wb, "bytes_per_second", (double) st->bytes_read / (double) st->duration_ut * (double) USEC_PER_SEC);
+        buffer_json_member_add_uint64(wb, "duration_matches_ut", st->matches_setup_ut);
+        buffer_json_member_add_uint64(wb, "fstat_query_calls", st->fstat_calls);
+        buffer_json_member_add_uint64(wb, "fstat_query_cached_responses", st->fstat_cached);
+
+        if(sampling) {
+            buffer_json_member_add_object(wb, "_sampling");
+            {
+                buffer_json_member_add_uint64(wb, "sampled", st->samples.sampled);
+                buffer_json_member_add_uint64(wb, "unsampled", st->samples.unsampled);
+                buffer_json_member_add_uint64(wb, "estimated", st->samples.estimated);
+            }
+            buffer_json_object_close(wb); // _sampling
+        }
+    }
+    buffer_json_object_close(wb); // journal file
+}
+
+static bool netdata_systemd_journal_status_merge(ND_SD_JOURNAL_STATUS *status, bool *partial, ND_SD_JOURNAL_STATUS tmp_status) {
+    bool stop = false;
+
+    switch(tmp_status) {
+        case ND_SD_JOURNAL_OK:
+        case ND_SD_JOURNAL_NO_FILE_MATCHED:
+            *status = (*status == ND_SD_JOURNAL_OK) ? ND_SD_JOURNAL_OK : tmp_status;
+            break;
+
+        case ND_SD_JOURNAL_FAILED_TO_OPEN:
+        case ND_SD_JOURNAL_FAILED_TO_SEEK:
+            *partial = true;
+            if(*status == ND_SD_JOURNAL_NO_FILE_MATCHED)
+                *status = tmp_status;
+            break;
+
+        case ND_SD_JOURNAL_CANCELLED:
+        case ND_SD_JOURNAL_TIMED_OUT:
+            *partial = true;
+            stop = true;
+            *status = tmp_status;
+            break;
+
+        case ND_SD_JOURNAL_NOT_MODIFIED:
+            internal_fatal(true, "this should never be returned here");
+            break;
+    }
+
+    return stop;
+}
+
+// ----------------------------------------------------------------------------
+// parallel query of many journal files
+//
+// Each worker thread claims the next file from the sorted list and queries it
+// into its own partial FACETS and its own copy of the query status. When all
+// workers have finished, the partials are merged into the FACETS of the query
+// (counters, histograms and the rows to be returned) in the main thread.
+
+struct journal_query_parallel {
+    FUNCTION_QUERY_STATUS *fqs;
+    const DICTIONARY_ITEM **file_items;
+    JOURNAL_QUERY_FILE_STATS *stats;
+    size_t files_used;
+
+    size_t next_file;           // the next file to be claimed by a worker
+    size_t files_completed;     // the number of files all workers have finished
+    size_t workers_running;
+    bool timed_out;
+    bool stop;
+};
+
+struct journal_query_worker {
+    struct journal_query_parallel *pq;
+    FUNCTION_QUERY_STATUS fqs;
+    FACETS *facets;
+    ND_THREAD *thread;
+};
+
+static size_t netdata_systemd_journal_query_threads(FUNCTION_QUERY_STATUS *fqs, size_t files_used) {
+    // data only queries (pagination, tail) stop early when the
+    // page is full, so splitting them across threads gives nothing
+    if(fqs->data_only || files_used < 2)
+        return 1;
+
+    size_t threads = (size_t)os_get_system_cpus() / 2;
+
+    if(threads > SYSTEMD_JOURNAL_QUERY_THREADS_MAX)
+        threads = SYSTEMD_JOURNAL_QUERY_THREADS_MAX;
+
+    if(threads > files_used)
+        threads = files_used;
+
+    return threads ? threads : 1;
+}
+
+static void *netdata_systemd_journal_query_worker(void *ptr) {
+    struct journal_query_worker *w = ptr;
+    struct journal_query_parallel *pq = w->pq;
+    usec_t max_duration_ut = 0;
+
+    while(!__atomic_load_n(&pq->stop, __ATOMIC_RELAXED)) {
+        size_t f = __atomic_fetch_add(&pq->next_file, 1, __ATOMIC_RELAXED);
+        if(f >= pq->files_used)
+            break;
+
+        const char *filename = dictionary_acquired_item_name(pq->file_items[f]);
+        struct journal_file *jf = dictionary_acquired_item_value(pq->file_items[f]);
+
+        if(jf_is_mine(jf, &w->fqs)) {
+            // do not even try to do the query if we expect it to pass the timeout
+            if(now_monotonic_usec() + max_duration_ut * 3 >= __atomic_load_n(w->fqs.stop_monotonic_ut, __ATOMIC_RELAXED)) {
+                __atomic_store_n(&pq->timed_out, true, __ATOMIC_RELAXED);
+                __atomic_store_n(&pq->stop, true, __ATOMIC_RELAXED);
+                break;
+            }
+
+            w->fqs.file_working++;
+
+            ND_SD_JOURNAL_STATUS status = netdata_systemd_journal_query_file_with_stats(
+                    filename, NULL, w->facets, jf, &w->fqs, &pq->stats[f]);
+
+            if(pq->stats[f].duration_ut > max_duration_ut)
+                max_duration_ut = pq->stats[f].duration_ut;
+
+            if(status == ND_SD_JOURNAL_CANCELLED || status == ND_SD_JOURNAL_TIMED_OUT)
+                __atomic_store_n(&pq->stop, true, __ATOMIC_RELAXED);
+        }
+
+        __atomic_add_fetch(&pq->files_completed, 1, __ATOMIC_RELAXED);
+    }
+
+    __atomic_sub_fetch(&pq->workers_running, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void netdata_systemd_journal_query_parallel(
+        FACETS *facets, FUNCTION_QUERY_STATUS *fqs,
+        const DICTIONARY_ITEM **file_items, JOURNAL_QUERY_FILE_STATS *stats, size_t files_used,
+        size_t threads, bool *timed_out) {
+
+    struct journal_query_parallel pq = {
+            .fqs = fqs,
+            .file_items = file_items,
+            .stats = stats,
+            .files_used = files_used,
+            .workers_running = threads,
+    };
+
+    struct journal_query_worker workers[threads];
+    for(size_t t = 0; t < threads ;t++) {
+        workers[t].pq = &pq;
+        workers[t].fqs = *fqs;
+        workers[t].facets = facets_create_partial(facets);
+        workers[t].thread = NULL;
+
+        // the sampling thresholds are for the whole query,
+        // so each worker gets its share of them
+        workers[t].fqs.samples.enable_after_samples /= threads;
+        workers[t].fqs.samples_per_time_slot.enable_after_samples /= threads;
+        if(workers[t].fqs.samples_per_time_slot.enable_after_samples < fqs->entries)
+            workers[t].fqs.samples_per_time_slot.enable_after_samples = fqs->entries;
+    }
+
+    size_t started = 0;
+    for(size_t t = 0; t < threads ;t++) {
+        workers[t].thread = nd_thread_create("SDJQ", NETDATA_THREAD_OPTION_JOINABLE | NETDATA_THREAD_OPTION_DONT_LOG,
+                                             netdata_systemd_journal_query_worker, &workers[t]);
+        if(workers[t].thread)
+            started++;
+        else
+            __atomic_sub_fetch(&pq.workers_running, 1, __ATOMIC_RELEASE);
+    }
+
+    if(!started) {
+        // we could not spawn any threads, do all the work here
+        __atomic_store_n(&pq.workers_running, 1, __ATOMIC_RELEASE);
+        netdata_systemd_journal_query_worker(&workers[0]);
+    }
+
+    size_t last_completed = 0;
+    usec_t last_progress_ut = now_monotonic_usec();
+    while(__atomic_load_n(&pq.workers_running, __ATOMIC_ACQUIRE)) {
+        sleep_usec(SYSTEMD_JOURNAL_QUERY_THREADS_POLL_UT);
+
+        size_t completed = __atomic_load_n(&pq.files_completed, __ATOMIC_RELAXED);
+        usec_t now_ut = now_monotonic_usec();
+        if(completed != last_completed && now_ut - last_progress_ut >= SYSTEMD_JOURNAL_PROGRESS_EVERY_UT) {
+            netdata_mutex_lock(&stdout_mutex);
+            pluginsd_function_progress_to_stdout(fqs->transaction, completed, files_used);
+            netdata_mutex_unlock(&stdout_mutex);
+
+            last_completed = completed;
+            last_progress_ut = now_ut;
+        }
+    }
+
+    for(size_t t = 0; t < threads ;t++) {
+        struct journal_query_worker *w = &workers[t];
+
+        if(w->thread)
+            nd_thread_join(w->thread);
+
+        facets_merge_partial(facets, w->facets);
+        facets_destroy(w->facets);
+
+        fqs->file_working += w->fqs.file_working;
+        fqs->rows_useful += w->fqs.rows_useful;
+        fqs->rows_read += w->fqs.rows_read;
+        fqs->rows_indexed += w->fqs.rows_indexed;
+        fqs->bytes_read += w->fqs.bytes_read;
+        fqs->matches_setup_ut += w->fqs.matches_setup_ut;
+        fqs->samples.sampled += w->fqs.samples.sampled;
+        fqs->samples.unsampled += w->fqs.samples.unsampled;
+        fqs->samples.estimated += w->fqs.samples.estimated;
+
+        if(w->fqs.last_modified > fqs->last_modified)
+            fqs->last_modified = w->fqs.last_modified;
+    }
+
+    for(size_t f = 0; f < files_used ;f++) {
+        fstat_thread_calls += stats[f].fstat_calls;
+        fstat_thread_cached_responses += stats[f].fstat_cached;
+    }
+
+    *timed_out = pq.timed_out;
+}
+
 static int netdata_systemd_journal_query(BUFFER *wb, FACETS *facets, FUNCTION_QUERY_STATUS *fqs) {
     ND_SD_JOURNAL_STATUS status = ND_SD_JOURNAL_NO_FILE_MATCHED;
     struct journal_file *jf;
@@ -1110,6 +1450,7 @@ static int netdata_systemd_journal_query(BUFFER *wb, FACETS *facets, FUNCTION_QU
     fqs->file_working = 0;
     fqs->rows_useful = 0;
     fqs->rows_read = 0;
+    fqs->rows_indexed = 0;
     fqs->bytes_read = 0;
 
     size_t files_used = 0;
@@ -1155,132 +1496,75 @@ static int netdata_systemd_journal_query(BUFFER *wb, FACETS *facets, FUNCTION_QU
 
     sampling_query_init(fqs, facets);
 
-    buffer_json_member_add_array(wb, "_journal_files");
-    for(size_t f = 0; f < files_used ;f++) {
-        const char *filename = dictionary_acquired_item_name(file_items[f]);
-        jf = dictionary_acquired_item_value(file_items[f]);
+    size_t threads = netdata_systemd_journal_query_threads(fqs, files_used);
 
-        if(!jf_is_mine(jf, fqs))
-            continue;
+    buffer_json_member_add_array(wb, "_journal_files");
+    if(threads > 1) {
+        JOURNAL_QUERY_FILE_STATS *stats = callocz(files_used, sizeof(*stats));
+        bool timed_out = false;
 
-        started_ut = ended_ut;
+        netdata_systemd_journal_query_parallel(facets, fqs, file_items, stats, files_used, threads, &timed_out);
 
-        // do not even try to do the query if we expect it to pass the timeout
-        if(ended_ut + max_duration_ut * 3 >= *fqs->stop_monotonic_ut) {
+        if(timed_out) {
             partial = true;
             status = ND_SD_JOURNAL_TIMED_OUT;
-            break;
         }
 
-        fqs->file_working++;
-        // fqs->cached_count = 0;
+        for(size_t f = 0; f < files_used ;f++) {
+            if(!stats[f].queried)
+                continue;
 
-        size_t fs_calls = fstat_thread_calls;
-        size_t fs_cached = fstat_thread_cached_responses;
-        size_t rows_useful = fqs->rows_useful;
-        size_t rows_read = fqs->rows_read;
-        size_t bytes_read = fqs->bytes_read;
-        size_t matches_setup_ut = fqs->matches_setup_ut;
+            netdata_systemd_journal_file_stats_to_json(
+                    wb, dictionary_acquired_item_name(file_items[f]),
+                    dictionary_acquired_item_value(file_items[f]), &stats[f], fqs->sampling);
 
-        sampling_file_init(fqs, jf);
+            netdata_systemd_journal_status_merge(&status, &partial, stats[f].status);
+        }
 
-        ND_SD_JOURNAL_STATUS tmp_status = netdata_systemd_journal_query_one_file(filename, wb, facets, jf, fqs);
+        freez(stats);
+    }
+    else {
+        for(size_t f = 0; f < files_used ;f++) {
+            const char *filename = dictionary_acquired_item_name(file_items[f]);
+            jf = dictionary_acquired_item_value(file_items[f]);
 
-//        nd_log(NDLS_COLLECTORS, NDLP_INFO,
-//               "JOURNAL ESTIMATION FINAL: '%s' "
-//               "total lines %zu [sampled=%zu, unsampled=%zu, estimated=%zu], "
-//               "file [%"PRIu64" - %"PRIu64", duration %"PRId64", known lines in file %zu], "
-//               "query [%"PRIu64" - %"PRIu64", duration %"PRId64"], "
-//               , jf->filename
-//               , fqs->samples_per_file.sampled + fqs->samples_per_file.unsampled + fqs->samples_per_file.estimated
-//               , fqs->samples_per_file.sampled, fqs->samples_per_file.unsampled, fqs->samples_per_file.estimated
-//               , jf->msg_first_ut, jf->msg_last_ut, jf->msg_last_ut - jf->msg_first_ut, jf->messages_in_file
-//               , fqs->query_file.start_ut, fqs->query_file.stop_ut, fqs->query_file.stop_ut - fqs->query_file.start_ut
-//        );
+            if(!jf_is_mine(jf, fqs))
+                continue;
 
-        rows_useful = fqs->rows_useful - rows_useful;
-        rows_read = fqs->rows_read - rows_read;
-        bytes_read = fqs->bytes_read - bytes_read;
-        matches_setup_ut = fqs->matches_setup_ut - matches_setup_ut;
-        fs_calls = fstat_thread_calls - fs_calls;
-        fs_cached = fstat_thread_cached_responses - fs_cached;
+            started_ut = ended_ut;
 
-        ended_ut = now_monotonic_usec();
-        duration_ut = ended_ut - started_ut;
+            // do not even try to do the query if we expect it to pass the timeout
+            if(ended_ut + max_duration_ut * 3 >= *fqs->stop_monotonic_ut) {
+                partial = true;
+                status = ND_SD_JOURNAL_TIMED_OUT;
+                break;
+            }
 
-        if(duration_ut > max_duration_ut)
-            max_duration_ut = duration_ut;
+            fqs->file_working++;
+            // fqs->cached_count = 0;
 
-        progress_duration_ut += duration_ut;
-        if(progress_duration_ut >= SYSTEMD_JOURNAL_PROGRESS_EVERY_UT) {
-            progress_duration_ut = 0;
-            netdata_mutex_lock(&stdout_mutex);
-            pluginsd_function_progress_to_stdout(fqs->transaction, f + 1, files_used);
-            netdata_mutex_unlock(&stdout_mutex);
-        }
+            JOURNAL_QUERY_FILE_STATS st;
+            netdata_systemd_journal_query_file_with_stats(filename, wb, facets, jf, fqs, &st);
 
-        buffer_json_add_array_item_object(wb); // journal file
-        {
-            // information about the file
-            buffer_json_member_add_string(wb, "_filename", filename);
-            buffer_json_member_add_uint64(wb, "_source_type", jf->source_type);
-            buffer_json_member_add_string(wb, "_source", string2str(jf->source));
-            buffer_json_member_add_uint64(wb, "_last_modified_ut", jf->file_last_modified_ut);
-            buffer_json_member_add_uint64(wb, "_msg_first_ut", jf->msg_first_ut);
-            buffer_json_member_add_uint64(wb, "_msg_last_ut", jf->msg_last_ut);
-            buffer_json_member_add_uint64(wb, "_journal_vs_realtime_delta_ut", jf->max_journal_vs_realtime_delta_ut);
-
-            // information about the current use of the file
-            buffer_json_member_add_uint64(wb, "duration_ut", ended_ut - started_ut);
-            buffer_json_member_add_uint64(wb, "rows_read", rows_read);
-            buffer_json_member_add_uint64(wb, "rows_useful", rows_useful);
-            buffer_json_member_add_double(wb, "rows_per_second", (double) rows_read / (double) duration_ut * (double) USEC_PER_SEC);
-            buffer_json_member_add_uint64(wb, "bytes_read", bytes_read);
-            buffer_json_member_add_double(wb, "bytes_per_second", (double) bytes_read / (double) duration_ut * (double) USEC_PER_SEC);
-            buffer_json_member_add_uint64(wb, "duration_matches_ut", matches_setup_ut);
-            buffer_json_member_add_uint64(wb, "fstat_query_calls", fs_calls);
-            buffer_json_member_add_uint64(wb, "fstat_query_cached_responses", fs_cached);
-
-            if(fqs->sampling) {
-                buffer_json_member_add_object(wb, "_sampling");
-                {
-                    buffer_json_member_add_uint64(wb, "sampled", fqs->samples_per_file.sampled);
-                    buffer_json_member_add_uint64(wb, "unsampled", fqs->samples_per_file.unsampled);
-                    buffer_json_member_add_uint64(wb, "estimated", fqs->samples_per_file.estimated);
-                }
-                buffer_json_object_close(wb); // _sampling
-            }
-        }
-        buffer_json_object_close(wb); // journal file
+            ended_ut = now_monotonic_usec();
+            duration_ut = ended_ut - started_ut;
 
-        bool stop = false;
-        switch(tmp_status) {
-            case ND_SD_JOURNAL_OK:
-            case ND_SD_JOURNAL_NO_FILE_MATCHED:
-                status = (status == ND_SD_JOURNAL_OK) ? ND_SD_JOURNAL_OK : tmp_status;
-                break;
+            if(duration_ut > max_duration_ut)
+                max_duration_ut = duration_ut;
 
-            case ND_SD_JOURNAL_FAILED_TO_OPEN:
-            case ND_SD_JOURNAL_FAILED_TO_SEEK:
-                partial = true;
-                if(status == ND_SD_JOURNAL_NO_FILE_MATCHED)
-                    status = tmp_status;
-                break;
+            progress_duration_ut += duration_ut;
+            if(progress_duration_ut >= SYSTEMD_JOURNAL_PROGRESS_EVERY_UT) {
+                progress_duration_ut = 0;
+                netdata_mutex_lock(&stdout_mutex);
+                pluginsd_function_progress_to_stdout(fqs->transaction, f + 1, files_used);
+                netdata_mutex_unlock(&stdout_mutex);
+            }
 
-            case ND_SD_JOURNAL_CANCELLED:
-            case ND_SD_JOURNAL_TIMED_OUT:
-                partial = true;
-                stop = true;
-                status = tmp_status;
-                break;
+            netdata_systemd_journal_file_stats_to_json(wb, filename, jf, &st, fqs->sampling);
 
-            case ND_SD_JOURNAL_NOT_MODIFIED:
-                internal_fatal(true, "this should never be returned here");
+            if(netdata_systemd_journal_status_merge(&status, &partial, st.status))
                 break;
         }
-
-        if(stop)
-            break;
     }
     buffer_json_array_close(wb); // _journal_files
 
@@ -30,6 +30,7 @@ int main(int argc __maybe_unused, char **argv __maybe_unused) {
 
     netdata_systemd_journal_annotations_init();
     journal_init_files_and_directories();
+    journal_index_init();
 
     if (!journal_data_directories_exist()) {
         nd_log_collector(NDLP_INFO, "unable to locate journal data directories. Exiting...");
@@ -70,6 +71,11 @@ int main(int argc __maybe_unused, char **argv __maybe_unused) {
 
     nd_thread_create("SDWATCH", NETDATA_THREAD_OPTION_DONT_LOG, journal_watcher_main, NULL);
 
+    // ------------------------------------------------------------------------
+    // index thread
+
+    nd_thread_create("SDJIDX", NETDATA_THREAD_OPTION_DONT_LOG, journal_index_main, NULL);
+
     // ------------------------------------------------------------------------
     // the event loop for functions
 
@@ -72,6 +72,7 @@ static struct global_statistics {
     uint64_t tier0_disk_uncompressed_bytes;
 
     uint64_t db_points_stored_per_tier[RRD_STORAGE_TIERS];
+    uint64_t db_points_store_usec;
 
 } global_statistics = {
         .connected_clients = 0,
@@ -92,11 +93,16 @@ static struct global_statistics {
         .tier0_disk_uncompressed_bytes = 0,
 };
 
-void global_statistics_rrdset_done_chart_collection_completed(size_t *points_read_per_tier_array) {
+void global_statistics_rrdset_done_chart_collection_completed(size_t *points_read_per_tier_array, usec_t *store_ut) {
     for(size_t tier = 0; tier < storage_tiers ;tier++) {
         __atomic_fetch_add(&global_statistics.db_points_stored_per_tier[tier], points_read_per_tier_array[tier], __ATOMIC_RELAXED);
         points_read_per_tier_array[tier] = 0;
     }
+
+    if(*store_ut) {
+        __atomic_fetch_add(&global_statistics.db_points_store_usec, *store_ut, __ATOMIC_RELAXED);
+        *store_ut = 0;
+    }
 }
 
 void global_statistics_ml_query_completed(size_t points_read) {
@@ -240,6 +246,8 @@ static inline void global_statistics_copy(struct global_statistics *gs, uint8_t
     for(size_t tier = 0; tier < storage_tiers ;tier++)
         gs->db_points_stored_per_tier[tier] = __atomic_load_n(&global_statistics.db_points_stored_per_tier[tier], __ATOMIC_RELAXED);
 
+    gs->db_points_store_usec = __atomic_load_n(&global_statistics.db_points_store_usec, __ATOMIC_RELAXED);
+
     if(options & GLOBAL_STATS_RESET_WEB_USEC_MAX) {
         uint64_t n = 0;
         __atomic_compare_exchange(&global_statistics.web_usec_max, (uint64_t *) &gs->web_usec_max, &n, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
@@ -671,6 +679,154 @@ static void global_statistics_extended_charts(void) {
         rrdset_done(st_compression);
     }
 
+    // ----------------------------------------------------------------
+
+    {
+        static RRDSET *st_responses = NULL, *st_traffic = NULL, *st_cpu = NULL;
+        static RRDDIM *rd_responses[WEB_RESPONSE_ENCODING_MAX] = { 0 };
+        static RRDDIM *rd_in[WEB_RESPONSE_ENCODING_MAX] = { 0 };
+        static RRDDIM *rd_out[WEB_RESPONSE_ENCODING_MAX] = { 0 };
+        static RRDDIM *rd_cpu[WEB_RESPONSE_ENCODING_MAX] = { 0 };
+
+        if (unlikely(!st_responses)) {
+            st_responses = rrdset_create_localhost(
+                    "netdata"
+                    , "api_compression_responses"
+                    , NULL
+                    , "api"
+                    , NULL
+                    , "Netdata API Compressed Responses"
+                    , "responses/s"
+                    , "netdata"
+                    , "stats"
+                    , 130601
+                    , localhost->rrd_update_every
+                    , RRDSET_TYPE_STACKED
+            );
+
+            st_traffic = rrdset_create_localhost(
+                    "netdata"
+                    , "api_compression_traffic"
+                    , NULL
+                    , "api"
+                    , NULL
+                    , "Netdata API Responses Compression Traffic"
+                    , "kilobytes/s"
+                    , "netdata"
+                    , "stats"
+                    , 130602
+                    , localhost->rrd_update_every
+                    , RRDSET_TYPE_LINE
+            );
+
+            st_cpu = rrdset_create_localhost(
+                    "netdata"
+                    , "api_compression_cpu"
+                    , NULL
+                    , "api"
+                    , NULL
+                    , "Netdata API Responses Compression CPU Time"
+                    , "milliseconds/s"
+                    , "netdata"
+                    , "stats"
+                    , 130603
+                    , localhost->rrd_update_every
+                    , RRDSET_TYPE_STACKED
+            );
+
+            for(size_t e = 0; e < WEB_RESPONSE_ENCODING_MAX ;e++) {
+                const char *name = web_response_encoding_name(e);
+                char id[50];
+
+                rd_responses[e] = rrddim_add(st_responses, name, NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+
+                snprintfz(id, sizeof(id), "%s_in", name);
+                rd_in[e] = rrddim_add(st_traffic, id, NULL, 1, 1024, RRD_ALGORITHM_INCREMENTAL);
+
+                snprintfz(id, sizeof(id), "%s_out", name);
+                rd_out[e] = rrddim_add(st_traffic, id, NULL, -1, 1024, RRD_ALGORITHM_INCREMENTAL);
+
+                rd_cpu[e] = rrddim_add(st_cpu, name, NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+            }
+        }
+
+        struct web_response_compression_statistics cs;
+        web_response_compression_statistics_get(&cs);
+
+        for(size_t e = 0; e < WEB_RESPONSE_ENCODING_MAX ;e++) {
+            rrddim_set_by_pointer(st_responses, rd_responses[e], (collected_number)cs.encodings[e].responses);
+            rrddim_set_by_pointer(st_traffic, rd_in[e], (collected_number)cs.encodings[e].bytes_in);
+            rrddim_set_by_pointer(st_traffic, rd_out[e], (collected_number)cs.encodings[e].bytes_out);
+            rrddim_set_by_pointer(st_cpu, rd_cpu[e], (collected_number)cs.encodings[e].cpu_ut);
+        }
+
+        rrdset_done(st_responses);
+        rrdset_done(st_traffic);
+        rrdset_done(st_cpu);
+    }
+
+    {
+        static RRDSET *st_files = NULL, *st_memory = NULL;
+        static RRDDIM *rd_hits = NULL, *rd_loads = NULL, *rd_not_modified = NULL, *rd_uncached = NULL, *rd_sendfile = NULL;
+        static RRDDIM *rd_evicted = NULL;
+        static RRDDIM *rd_memory = NULL;
+
+        if (unlikely(!st_files)) {
+            st_files = rrdset_create_localhost(
+                    "netdata"
+                    , "web_static_files"
+                    , NULL
+                    , "api"
+                    , NULL
+                    , "Netdata Web Server Static Files"
+                    , "responses/s"
+                    , "netdata"
+                    , "stats"
+                    , 130604
+                    , localhost->rrd_update_every
+                    , RRDSET_TYPE_LINE
+            );
+
+            rd_hits         = rrddim_add(st_files, "cached", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_not_modified = rrddim_add(st_files, "not_modified", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_loads        = rrddim_add(st_files, "loads", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_uncached     = rrddim_add(st_files, "uncached", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_sendfile     = rrddim_add(st_files, "sendfile", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_evicted      = rrddim_add(st_files, "evicted", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+
+            st_memory = rrdset_create_localhost(
+                    "netdata"
+                    , "web_static_files_memory"
+                    , NULL
+                    , "api"
+                    , NULL
+                    , "Netdata Web Server Static Files Cache Memory"
+                    , "bytes"
+                    , "netdata"
+                    , "stats"
+                    , 130605
+                    , localhost->rrd_update_every
+                    , RRDSET_TYPE_AREA
+            );
+
+            rd_memory = rrddim_add(st_memory, "memory", NULL, 1, 1, RRD_ALGORITHM_ABSOLUTE);
+        }
+
+        struct web_static_cache_statistics ss;
+        web_static_cache_statistics_get(&ss);
+
+        rrddim_set_by_pointer(st_files, rd_hits, (collected_number)ss.hits);
+        rrddim_set_by_pointer(st_files, rd_not_modified, (collected_number)ss.not_modified);
+        rrddim_set_by_pointer(st_files, rd_loads, (collected_number)ss.loads);
+        rrddim_set_by_pointer(st_files, rd_uncached, (collected_number)ss.uncached);
+        rrddim_set_by_pointer(st_files, rd_sendfile, (collected_number)ss.sendfile);
+        rrddim_set_by_pointer(st_files, rd_evicted, (collected_number)ss.evicted);
+        rrdset_done(st_files);
+
+        rrddim_set_by_pointer(st_memory, rd_memory, (collected_number)ss.memory);
+        rrdset_done(st_memory);
+    }
+
     {
         static RRDSET *st_queries = NULL;
         static RRDDIM *rd_api_data_queries = NULL;
@@ -847,6 +1003,34 @@ static void global_statistics_extended_charts(void) {
         rrdset_done(st_points_stored);
     }
 
+    {
+        static RRDSET *st_points_store_time = NULL;
+        static RRDDIM *rd_store_time = NULL;
+
+        if (unlikely(!st_points_store_time)) {
+            st_points_store_time = rrdset_create_localhost(
+                    "netdata"
+                    , "db_points_store_time"
+                    , NULL
+                    , "queries"
+                    , NULL
+                    , "Netdata DB Time Spent Storing Collected Points"
+                    , "milliseconds/s"
+                    , "netdata"
+                    , "stats"
+                    , 131004
+                    , localhost->rrd_update_every
+                    , RRDSET_TYPE_AREA
+            );
+
+            rd_store_time = rrddim_add(st_points_store_time, "store", NULL, 1, USEC_PER_MS, RRD_ALGORITHM_INCREMENTAL);
+        }
+
+        rrddim_set_by_pointer(st_points_store_time, rd_store_time, (collected_number)gs.db_points_store_usec);
+
+        rrdset_done(st_points_store_time);
+    }
+
 #ifdef ENABLE_DBENGINE
     if (tier_page_type[0] == RRDENG_PAGE_TYPE_GORILLA_32BIT)
     {
@@ -2056,6 +2240,43 @@ static void dbengine2_statistics_charts(void) {
         rrdset_done(st_mrg_references);
     }
 
+    {
+        static RRDSET *st_mrg_memory = NULL;
+        static RRDDIM *rd_mrg_memory_metric = NULL;
+        static RRDDIM *rd_mrg_memory_index = NULL;
+        static RRDDIM *rd_mrg_memory_overhead = NULL;
+
+        if (unlikely(!st_mrg_memory)) {
+            st_mrg_memory = rrdset_create_localhost(
+                    "netdata",
+                    "dbengine_metrics_registry_memory",
+                    NULL,
+                    "dbengine metrics",
+                    NULL,
+                    "Netdata Metrics Registry Memory per Metric",
+                    "bytes/metric",
+                    "netdata",
+                    "stats",
+                    priority,
+                    localhost->rrd_update_every,
+                    RRDSET_TYPE_STACKED);
+
+            rd_mrg_memory_metric = rrddim_add(st_mrg_memory, "metric", NULL, 1, 100, RRD_ALGORITHM_ABSOLUTE);
+            rd_mrg_memory_index = rrddim_add(st_mrg_memory, "index", NULL, 1, 100, RRD_ALGORITHM_ABSOLUTE);
+            rd_mrg_memory_overhead = rrddim_add(st_mrg_memory, "overhead", NULL, 1, 100, RRD_ALGORITHM_ABSOLUTE);
+        }
+        priority++;
+
+        size_t entries = mrg_stats.entries ? mrg_stats.entries : 1;
+        size_t metrics_size = mrg_stats.size > mrg_stats.index_size ? mrg_stats.size - mrg_stats.index_size : 0;
+
+        rrddim_set_by_pointer(st_mrg_memory, rd_mrg_memory_metric, (collected_number)(metrics_size * 100 / entries));
+        rrddim_set_by_pointer(st_mrg_memory, rd_mrg_memory_index, (collected_number)(mrg_stats.index_size * 100 / entries));
+        rrddim_set_by_pointer(st_mrg_memory, rd_mrg_memory_overhead, (collected_number)(buffers.mrg * 100 / entries));
+
+        rrdset_done(st_mrg_memory);
+    }
+
     {
         static RRDSET *st_cache_hit_ratio = NULL;
         static RRDDIM *rd_hit_ratio = NULL;
@@ -2132,6 +2353,49 @@ static void dbengine2_statistics_charts(void) {
         rrdset_done(st_cache_hit_ratio);
     }
 
+    {
+        static RRDSET *st_readahead = NULL;
+        static RRDDIM *rd_requested = NULL;
+        static RRDDIM *rd_skipped = NULL;
+        static RRDDIM *rd_loaded = NULL;
+        static RRDDIM *rd_already_cached = NULL;
+        static RRDDIM *rd_failed = NULL;
+        static RRDDIM *rd_hits = NULL;
+
+        if (unlikely(!st_readahead)) {
+            st_readahead = rrdset_create_localhost(
+                    "netdata",
+                    "dbengine_extent_readahead",
+                    NULL,
+                    "dbengine query router",
+                    NULL,
+                    "Netdata Extent Read-Ahead",
+                    "extents/s",
+                    "netdata",
+                    "stats",
+                    priority,
+                    localhost->rrd_update_every,
+                    RRDSET_TYPE_LINE);
+
+            rd_requested = rrddim_add(st_readahead, "requested", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_skipped = rrddim_add(st_readahead, "skipped", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_loaded = rrddim_add(st_readahead, "loaded", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_already_cached = rrddim_add(st_readahead, "already cached", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_failed = rrddim_add(st_readahead, "failed", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_hits = rrddim_add(st_readahead, "hits", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+        }
+        priority++;
+
+        rrddim_set_by_pointer(st_readahead, rd_requested, (collected_number)cache_efficiency_stats.extents_readahead_requested);
+        rrddim_set_by_pointer(st_readahead, rd_skipped, (collected_number)cache_efficiency_stats.extents_readahead_skipped);
+        rrddim_set_by_pointer(st_readahead, rd_loaded, (collected_number)cache_efficiency_stats.extents_readahead_loaded);
+        rrddim_set_by_pointer(st_readahead, rd_already_cached, (collected_number)cache_efficiency_stats.extents_readahead_already_cached);
+        rrddim_set_by_pointer(st_readahead, rd_failed, (collected_number)cache_efficiency_stats.extents_readahead_failed);
+        rrddim_set_by_pointer(st_readahead, rd_hits, (collected_number)cache_efficiency_stats.extents_readahead_hits);
+
+        rrdset_done(st_readahead);
+    }
+
     {
         static RRDSET *st_queries = NULL;
         static RRDDIM *rd_total = NULL;
@@ -2239,6 +2503,7 @@ static void dbengine2_statistics_charts(void) {
         static RRDDIM *rd_pages_main_cache = NULL;
         static RRDDIM *rd_pages_disk = NULL;
         static RRDDIM *rd_pages_extent_cache = NULL;
+        static RRDDIM *rd_pages_summary = NULL;
 
         if (unlikely(!st_query_pages_data_source)) {
             st_query_pages_data_source = rrdset_create_localhost(
@@ -2258,12 +2523,14 @@ static void dbengine2_statistics_charts(void) {
             rd_pages_main_cache = rrddim_add(st_query_pages_data_source, "main cache", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_pages_disk = rrddim_add(st_query_pages_data_source, "disk", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
             rd_pages_extent_cache = rrddim_add(st_query_pages_data_source, "extent cache", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+            rd_pages_summary = rrddim_add(st_query_pages_data_source, "journal summary", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
         }
         priority++;
 
         rrddim_set_by_pointer(st_query_pages_data_source, rd_pages_main_cache, (collected_number)cache_efficiency_stats.pages_data_source_main_cache + (collected_number)cache_efficiency_stats.pages_data_source_main_cache_at_pass4);
         rrddim_set_by_pointer(st_query_pages_data_source, rd_pages_disk, (collected_number)cache_efficiency_stats.pages_to_load_from_disk);
         rrddim_set_by_pointer(st_query_pages_data_source, rd_pages_extent_cache, (collected_number)cache_efficiency_stats.pages_data_source_extent_cache);
+        rrddim_set_by_pointer(st_query_pages_data_source, rd_pages_summary, (collected_number)cache_efficiency_stats.pages_data_source_summary);
 
         rrdset_done(st_query_pages_data_source);
     }
@@ -2681,6 +2948,73 @@ static void dbengine2_statistics_charts(void) {
 
             // ----------------------------------------------------------------
 
+            struct rrdeng_extent_write_stats extent_write_stats = rrdeng_get_extent_write_stats();
+
+            {
+                static RRDSET *st_extent_writes = NULL;
+                static RRDDIM *rd_extents = NULL;
+                static RRDDIM *rd_datafile_writes = NULL;
+                static RRDDIM *rd_journal_writes = NULL;
+
+                if (unlikely(!st_extent_writes)) {
+                    st_extent_writes = rrdset_create_localhost(
+                            "netdata",
+                            "dbengine_extent_writes",
+                            NULL,
+                            "dbengine io",
+                            NULL,
+                            "Netdata DB engine extent writes",
+                            "writes/s",
+                            "netdata",
+                            "stats",
+                            priority,
+                            localhost->rrd_update_every,
+                            RRDSET_TYPE_LINE);
+
+                    rd_extents = rrddim_add(st_extent_writes, "extents", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+                    rd_datafile_writes = rrddim_add(st_extent_writes, "datafile writes", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+                    rd_journal_writes = rrddim_add(st_extent_writes, "journal writes", NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+                }
+                priority++;
+
+                rrddim_set_by_pointer(st_extent_writes, rd_extents, (collected_number)extent_write_stats.extents);
+                rrddim_set_by_pointer(st_extent_writes, rd_datafile_writes, (collected_number)extent_write_stats.datafile_writes);
+                rrddim_set_by_pointer(st_extent_writes, rd_journal_writes, (collected_number)extent_write_stats.journal_writes);
+                rrdset_done(st_extent_writes);
+            }
+
+            {
+                static RRDSET *st_extent_write_latency = NULL;
+                static RRDDIM *rd_latency[RRDENG_EXTENT_WRITE_LATENCY_BUCKETS] = { NULL };
+
+                if (unlikely(!st_extent_write_latency)) {
+                    st_extent_write_latency = rrdset_create_localhost(
+                            "netdata",
+                            "dbengine_extent_write_latency",
+                            NULL,
+                            "dbengine io",
+                            NULL,
+                            "Netdata DB engine extent flush latency",
+                            "extents/s",
+                            "netdata",
+                            "stats",
+                            priority,
+                            localhost->rrd_update_every,
+                            RRDSET_TYPE_STACKED);
+
+                    for(size_t b = 0; b < RRDENG_EXTENT_WRITE_LATENCY_BUCKETS ;b++)
+                        rd_latency[b] = rrddim_add(st_extent_write_latency, rrdeng_extent_write_latency_buckets[b].name, NULL, 1, 1, RRD_ALGORITHM_INCREMENTAL);
+                }
+                priority++;
+
+                for(size_t b = 0; b < RRDENG_EXTENT_WRITE_LATENCY_BUCKETS ;b++)
+                    rrddim_set_by_pointer(st_extent_write_latency, rd_latency[b], (collected_number)extent_write_stats.latency[b]);
+
+                rrdset_done(st_extent_write_latency);
+            }
+
+            // ----------------------------------------------------------------
+
             {
                 static RRDSET *st_errors = NULL;
                 static RRDDIM *rd_fs_errors = NULL;
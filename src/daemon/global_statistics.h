@@ -43,7 +43,7 @@ void global_statistics_backfill_query_completed(size_t points_read);
 void global_statistics_rrdr_query_completed(size_t queries, uint64_t db_points_read, uint64_t result_points_generated, QUERY_SOURCE query_source);
 void global_statistics_sqlite3_query_completed(bool success, bool busy, bool locked);
 void global_statistics_sqlite3_row_completed(void);
-void global_statistics_rrdset_done_chart_collection_completed(size_t *points_read_per_tier_array);
+void global_statistics_rrdset_done_chart_collection_completed(size_t *points_read_per_tier_array, usec_t *store_ut);
 
 void global_statistics_gorilla_buffer_add_hot();
 
@@ -25,6 +25,7 @@ void register_libuv_worker_jobs() {
     worker_register_job_name(UV_EVENT_DBENGINE_EXTENT_PAGE_LOOKUP, "page lookup");
     worker_register_job_name(UV_EVENT_DBENGINE_EXTENT_PAGE_POPULATION, "page populate");
     worker_register_job_name(UV_EVENT_DBENGINE_EXTENT_PAGE_ALLOCATION, "page allocate");
+    worker_register_job_name(UV_EVENT_DBENGINE_EXTENT_READAHEAD, "extent read-ahead");
 
     // flushing related
     worker_register_job_name(UV_EVENT_DBENGINE_FLUSH_MAIN_CACHE, "flush main");
@@ -41,6 +42,8 @@ void register_libuv_worker_jobs() {
     worker_register_job_name(UV_EVENT_DBENGINE_FIND_ROTATED_METRICS, "find rotated metrics");
     worker_register_job_name(UV_EVENT_DBENGINE_FIND_REMAINING_RETENTION, "find remaining retention");
     worker_register_job_name(UV_EVENT_DBENGINE_POPULATE_MRG, "update retention");
+    worker_register_job_name(UV_EVENT_DBENGINE_MRG_SNAPSHOT, "retention snapshot");
+    worker_register_job_name(UV_EVENT_DBENGINE_COMPACTION, "compaction");
 
     // other dbengine events
     worker_register_job_name(UV_EVENT_DBENGINE_EVICT_MAIN_CACHE, "evict main");
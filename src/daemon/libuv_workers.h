@@ -17,6 +17,7 @@ enum event_loop_job {
     UV_EVENT_DBENGINE_EXTENT_PAGE_LOOKUP,
     UV_EVENT_DBENGINE_EXTENT_PAGE_POPULATION,
     UV_EVENT_DBENGINE_EXTENT_PAGE_ALLOCATION,
+    UV_EVENT_DBENGINE_EXTENT_READAHEAD,
 
     // flushing related
     UV_EVENT_DBENGINE_FLUSH_MAIN_CACHE,
@@ -33,6 +34,8 @@ enum event_loop_job {
     UV_EVENT_DBENGINE_FIND_ROTATED_METRICS, // find the metrics that are rotated
     UV_EVENT_DBENGINE_FIND_REMAINING_RETENTION, // find their remaining retention
     UV_EVENT_DBENGINE_POPULATE_MRG, // update mrg
+    UV_EVENT_DBENGINE_MRG_SNAPSHOT, // save the mrg retention snapshot
+    UV_EVENT_DBENGINE_COMPACTION,   // rewrite an old datafile with merged pages
 
     // other dbengine events
     UV_EVENT_DBENGINE_EVICT_MAIN_CACHE,
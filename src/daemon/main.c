@@ -551,6 +551,7 @@ void web_server_config_options(void)
     respect_web_browser_do_not_track_policy =
         config_get_boolean(CONFIG_SECTION_WEB, "respect do not track policy", respect_web_browser_do_not_track_policy);
     web_x_frame_options = config_get(CONFIG_SECTION_WEB, "x-frame-options response header", "");
+    poll_events_use_epoll = config_get_boolean(CONFIG_SECTION_WEB, "use epoll", poll_events_use_epoll);
     if(!*web_x_frame_options)
         web_x_frame_options = NULL;
 
@@ -620,6 +621,16 @@ void web_server_config_options(void)
         netdata_log_error("Invalid compression level %d. Valid levels are 1 (fastest) to 9 (best ratio). Proceeding with level 9 (best compression).", web_gzip_level);
         web_gzip_level = 9;
     }
+
+    // the encoders clamp the levels to the ranges they support
+    web_enable_zstd = config_get_boolean(CONFIG_SECTION_WEB, "enable zstd compression", web_enable_zstd);
+    web_zstd_level = (int)config_get_number(CONFIG_SECTION_WEB, "zstd compression level", web_zstd_level);
+    web_enable_brotli = config_get_boolean(CONFIG_SECTION_WEB, "enable brotli compression", web_enable_brotli);
+    web_brotli_level = (int)config_get_number(CONFIG_SECTION_WEB, "brotli compression level", web_brotli_level);
+
+    web_static_cache_enabled = config_get_boolean(CONFIG_SECTION_WEB, "static files cache", web_static_cache_enabled);
+    web_static_cache_max_size = (size_t)config_get_number(CONFIG_SECTION_WEB, "static files cache size MB", (long long)(web_static_cache_max_size / 1024 / 1024)) * 1024 * 1024;
+    web_static_cache_max_file_size = (size_t)config_get_number(CONFIG_SECTION_WEB, "static files cache max file size MB", (long long)(web_static_cache_max_file_size / 1024 / 1024)) * 1024 * 1024;
 }
 
 static void set_nofile_limit(struct rlimit *rl) {
@@ -1197,6 +1208,14 @@ static void get_netdata_configured_variables()
     default_rrdeng_page_cache_mb = (int) config_get_number(CONFIG_SECTION_DB, "dbengine page cache size MB", default_rrdeng_page_cache_mb);
     default_rrdeng_extent_cache_mb = (int) config_get_number(CONFIG_SECTION_DB, "dbengine extent cache size MB", default_rrdeng_extent_cache_mb);
     db_engine_journal_check = config_get_boolean(CONFIG_SECTION_DB, "dbengine enable journal integrity check", CONFIG_BOOLEAN_NO);
+    dbengine_mrg_snapshot_enabled = config_get_boolean(CONFIG_SECTION_DB, "dbengine retention snapshot", dbengine_mrg_snapshot_enabled);
+    dbengine_mrg_snapshot_every_s = config_get_number(CONFIG_SECTION_DB, "dbengine retention snapshot every secs", dbengine_mrg_snapshot_every_s);
+    dbengine_compaction_enabled = config_get_boolean(CONFIG_SECTION_DB, "dbengine compaction", dbengine_compaction_enabled);
+    dbengine_compaction_every_s = config_get_number(CONFIG_SECTION_DB, "dbengine compaction every secs", dbengine_compaction_every_s);
+    dbengine_compaction_io_budget_mb = config_get_number(CONFIG_SECTION_DB, "dbengine compaction io budget MiB/s", dbengine_compaction_io_budget_mb);
+    dbengine_extent_readahead_enabled = config_get_boolean(CONFIG_SECTION_DB, "dbengine extent read-ahead", dbengine_extent_readahead_enabled);
+    dbengine_extent_readahead_extents = config_get_number(CONFIG_SECTION_DB, "dbengine extent read-ahead extents", dbengine_extent_readahead_extents);
+    dbengine_extent_write_coalescing = config_get_boolean(CONFIG_SECTION_DB, "dbengine extent write coalescing", dbengine_extent_write_coalescing);
 
     if(default_rrdeng_extent_cache_mb < 0)
         default_rrdeng_extent_cache_mb = 0;
@@ -1392,6 +1411,7 @@ int get_system_info(struct rrdhost_system_info *system_info) {
 int buffer_unittest(void);
 int pgc_unittest(void);
 int mrg_unittest(void);
+int tier_distribution_unittest(void);
 int julytest(void);
 int pluginsd_parser_unittest(void);
 void replication_initialize(void);
@@ -1565,12 +1585,21 @@ int netdata_main(int argc, char **argv) {
                             if (unit_test_buffer()) return 1;
                             if (unit_test_str2ld()) return 1;
                             if (buffer_unittest()) return 1;
+                            if (print_netdata_double_unittest(false)) return 1;
+                            if (procfile_unittest()) return 1;
+                            if (rrdr2binary_unittest()) return 1;
+                            if (tier_distribution_unittest()) return 1;
+                            if (web_static_cache_unittest()) return 1;
+                            if (web_client_static_files_unittest()) return 1;
+                            if (facets_indexed_unittest()) return 1;
 
                             // No call to load the config file on this code-path
                             if (unittest_prepare_rrd(&user)) return 1;
                             if (run_all_mockup_tests()) return 1;
                             if (unit_test_storage()) return 1;
 #ifdef ENABLE_DBENGINE
+                            if (journalfile_v2_unittest()) return 1;
+                            if (compaction_unittest()) return 1;
                             if (test_dbengine()) return 1;
 #endif
                             if (test_sqlite()) return 1;
@@ -1608,10 +1637,56 @@ int netdata_main(int argc, char **argv) {
                             unittest_running = true;
                             return buffer_unittest();
                         }
+                        else if(strcmp(optarg, "printdoubletest") == 0) {
+                            unittest_running = true;
+                            return print_netdata_double_unittest(false);
+                        }
+                        else if(strcmp(optarg, "printdoubletest-exhaustive") == 0) {
+                            unittest_running = true;
+                            return print_netdata_double_unittest(true);
+                        }
+                        else if(strcmp(optarg, "printdoublebench") == 0) {
+                            unittest_running = true;
+                            if(print_netdata_double_unittest(false))
+                                return 1;
+                            return print_netdata_double_benchmark();
+                        }
                         else if(strcmp(optarg, "uuidtest") == 0) {
                             unittest_running = true;
                             return uuid_unittest();
                         }
+                        else if(strcmp(optarg, "pollbench") == 0) {
+                            unittest_running = true;
+                            return poll_events_benchmark();
+                        }
+                        else if(strcmp(optarg, "tierdisttest") == 0) {
+                            unittest_running = true;
+                            return tier_distribution_unittest();
+                        }
+                        else if(strcmp(optarg, "staticfilestest") == 0) {
+                            unittest_running = true;
+                            return web_static_cache_unittest() || web_client_static_files_unittest();
+                        }
+                        else if(strcmp(optarg, "facetstest") == 0) {
+                            unittest_running = true;
+                            return facets_indexed_unittest();
+                        }
+                        else if(strcmp(optarg, "binarytest") == 0) {
+                            unittest_running = true;
+                            return rrdr2binary_unittest();
+                        }
+                        else if(strcmp(optarg, "binarybench") == 0) {
+                            unittest_running = true;
+                            if(rrdr2binary_unittest())
+                                return 1;
+                            return rrdr2binary_benchmark();
+                        }
+                        else if(strcmp(optarg, "procfiletest") == 0) {
+                            unittest_running = true;
+                            if(procfile_unittest())
+                                return 1;
+                            return procfile_benchmark(optind + 1 > argc ? NULL : argv[optind]);
+                        }
 #ifdef OS_WINDOWS
                         else if(strcmp(optarg, "perflibdump") == 0) {
                             return windows_perflib_dump(optind + 1 > argc ? NULL : argv[optind]);
@@ -1638,6 +1713,14 @@ int netdata_main(int argc, char **argv) {
                             unittest_running = true;
                             return mrg_unittest();
                         }
+                        else if(strcmp(optarg, "journalv2test") == 0) {
+                            unittest_running = true;
+                            return journalfile_v2_unittest();
+                        }
+                        else if(strcmp(optarg, "compactiontest") == 0) {
+                            unittest_running = true;
+                            return compaction_unittest();
+                        }
                         else if(strcmp(optarg, "julytest") == 0) {
                             unittest_running = true;
                             return julytest();
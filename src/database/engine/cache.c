@@ -2275,6 +2275,24 @@ void pgc_open_evict_clean_pages_of_datafile(PGC *cache, struct rrdengine_datafil
     evict_pages_with_filter(cache, 0, 0, true, true, match_page_data, datafile);
 }
 
+struct section_and_metric {
+    Word_t section;
+    Word_t metric_id;
+};
+
+static bool match_page_section_and_metric(PGC_PAGE *page, void *data) {
+    struct section_and_metric *sm = data;
+    return (page->section == sm->section && page->metric_id == sm->metric_id);
+}
+
+void pgc_evict_clean_pages_of_metric(PGC *cache, Word_t section, Word_t metric_id) {
+    struct section_and_metric sm = {
+            .section = section,
+            .metric_id = metric_id,
+    };
+    evict_pages_with_filter(cache, 0, 0, true, true, match_page_section_and_metric, &sm);
+}
+
 size_t pgc_count_clean_pages_having_data_ptr(PGC *cache, Word_t section, void *ptr) {
     size_t found = 0;
 
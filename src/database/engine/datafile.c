@@ -18,7 +18,7 @@ void datafile_list_delete_unsafe(struct rrdengine_instance *ctx, struct rrdengin
 }
 
 
-static struct rrdengine_datafile *datafile_alloc_and_init(struct rrdengine_instance *ctx, unsigned tier, unsigned fileno)
+struct rrdengine_datafile *datafile_alloc_and_init(struct rrdengine_instance *ctx, unsigned tier, unsigned fileno)
 {
     fatal_assert(tier == 1);
 
@@ -34,6 +34,8 @@ static struct rrdengine_datafile *datafile_alloc_and_init(struct rrdengine_insta
     spinlock_init(&datafile->users.spinlock);
     spinlock_init(&datafile->writers.spinlock);
     spinlock_init(&datafile->extent_queries.spinlock);
+    spinlock_init(&datafile->readahead.spinlock);
+    datafile->readahead.backward_first = UINT64_MAX;
 
     return datafile;
 }
@@ -288,7 +290,7 @@ int create_data_file(struct rrdengine_datafile *datafile)
     return 0;
 }
 
-static int check_data_file_superblock(uv_file file)
+static int check_data_file_superblock(uv_file file, uint8_t *flags)
 {
     int ret;
     struct rrdeng_df_sb *superblock = NULL;
@@ -316,6 +318,7 @@ static int check_data_file_superblock(uv_file file)
         netdata_log_error("DBENGINE: file has invalid superblock.");
         ret = UV_EINVAL;
     } else {
+        *flags = superblock->flags;
         ret = 0;
     }
     error:
@@ -323,7 +326,7 @@ static int check_data_file_superblock(uv_file file)
     return ret;
 }
 
-static int load_data_file(struct rrdengine_datafile *datafile)
+int load_data_file(struct rrdengine_datafile *datafile)
 {
     struct rrdengine_instance *ctx = datafile->ctx;
     uv_fs_t req;
@@ -346,7 +349,8 @@ static int load_data_file(struct rrdengine_datafile *datafile)
         goto error;
     file_size = ALIGN_BYTES_CEILING(file_size);
 
-    ret = check_data_file_superblock(file);
+    uint8_t flags = 0;
+    ret = check_data_file_superblock(file, &flags);
     if (ret)
         goto error;
 
@@ -354,6 +358,7 @@ static int load_data_file(struct rrdengine_datafile *datafile)
 
     datafile->file = file;
     datafile->pos = file_size;
+    datafile->compacted = (flags & RRDENG_DF_SB_FLAG_COMPACTED);
 
     nd_log_daemon(NDLP_DEBUG, "DBENGINE: data file \"%s\" initialized (size:%" PRIu64 ").", path, file_size);
 
@@ -526,6 +531,8 @@ int init_data_files(struct rrdengine_instance *ctx)
 {
     int ret;
 
+    compaction_recover(ctx);
+
     ret = scan_data_files(ctx);
     if (ret < 0) {
         netdata_log_error("DBENGINE: failed to scan path \"%s\".", ctx->config.dbfiles_path);
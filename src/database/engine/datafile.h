@@ -24,10 +24,14 @@ struct rrdengine_instance;
 #define MAX_DATAFILES (65536 * 4) /* Supports up to 64TiB for now */
 #define TARGET_DATAFILES (50)
 
+#define EXTENT_READAHEAD_TRACKED (16)
+
 typedef enum __attribute__ ((__packed__)) {
     DATAFILE_ACQUIRE_OPEN_CACHE = 0,
     DATAFILE_ACQUIRE_PAGE_DETAILS,
     DATAFILE_ACQUIRE_RETENTION,
+    DATAFILE_ACQUIRE_COMPACTION,
+    DATAFILE_ACQUIRE_READAHEAD,
 
     // terminator
     DATAFILE_ACQUIRE_MAX,
@@ -45,6 +49,8 @@ struct rrdengine_datafile {
     struct rrdengine_datafile *prev;
     struct rrdengine_datafile *next;
 
+    bool compacted;                     // written by the compactor, or found not worth compacting
+
     struct {
         SPINLOCK spinlock;
         bool populated;
@@ -68,8 +74,21 @@ struct rrdengine_datafile {
         SPINLOCK spinlock;
         Pvoid_t pending_epdl_by_extent_offset_judyL;
     } extent_queries;
+
+    struct {
+        SPINLOCK spinlock;
+        uint64_t last_offset;           // the last extent queries loaded from this datafile
+        uint64_t last_end;              // and where it ends on disk
+        int32_t streak;                 // > 0 sequential forward, < 0 sequential backward
+        bool running;                   // a read-ahead is queued or running for this datafile
+        uint64_t forward_last;          // the offset of the last extent prefetched forward
+        uint64_t backward_first;        // the offset of the last extent prefetched backward
+        uint32_t prefetched_next;
+        uint64_t prefetched[EXTENT_READAHEAD_TRACKED]; // offsets of prefetched extents, to count the hits
+    } readahead;
 };
 
+struct rrdengine_datafile *datafile_alloc_and_init(struct rrdengine_instance *ctx, unsigned tier, unsigned fileno);
 bool datafile_acquire(struct rrdengine_datafile *df, DATAFILE_ACQUIRE_REASONS reason);
 void datafile_release(struct rrdengine_datafile *df, DATAFILE_ACQUIRE_REASONS reason);
 bool datafile_acquire_for_deletion(struct rrdengine_datafile *df);
@@ -81,6 +100,7 @@ int close_data_file(struct rrdengine_datafile *datafile);
 int unlink_data_file(struct rrdengine_datafile *datafile);
 int destroy_data_file_unsafe(struct rrdengine_datafile *datafile);
 int create_data_file(struct rrdengine_datafile *datafile);
+int load_data_file(struct rrdengine_datafile *datafile);
 int create_new_datafile_pair(struct rrdengine_instance *ctx, bool having_lock);
 int init_data_files(struct rrdengine_instance *ctx);
 void finalize_data_files(struct rrdengine_instance *ctx);
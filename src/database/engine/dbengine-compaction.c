@@ -0,0 +1,1275 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "rrdengine.h"
+#include "dbengine-compression.h"
+
+// ----------------------------------------------------------------------------
+// datafile compaction
+//
+// Datafiles are written once. Metrics that are collected rarely, or that
+// stop and start, end up in many small pages spread across many extents, and
+// old extents stay compressed with whatever algorithm was configured when
+// they were written.
+//
+// The compactor rewrites the oldest datafile of a tier that has not been
+// compacted yet. It reads its extents in file order, merges the consecutive
+// pages of each metric into full pages, and writes them to new extents
+// compressed with the best algorithm available. The new datafile and its
+// journal are written to temporary files next to the original ones, and they
+// replace the original pair under the same file number, so that the order of
+// the datafiles is not affected. The journal v2 is regenerated from the open
+// cache, like for any other datafile.
+//
+// Only pages indexed in the journal v2 of the datafile are kept. The new
+// files are written throttled by the io budget and they are not counted in
+// the disk space of the tier until they replace the original ones.
+//
+// The journal file is the commit point: once the temporary journal has been
+// renamed over the original one, the temporary datafile is renamed on startup
+// if the agent crashed before renaming it.
+
+bool dbengine_compaction_enabled = true;
+time_t dbengine_compaction_every_s = 600;
+size_t dbengine_compaction_io_budget_mb = 10;
+
+// a datafile is replaced only when it shrinks by at least this much
+int dbengine_compaction_min_savings_percent = 5;
+
+// pending pages are written in whatever state they are when they use more memory than this
+#define COMPACTION_MAX_PENDING_BYTES (64 * 1024 * 1024)
+
+// a merged page waiting for more points of its metric
+struct compaction_pending {
+    PGD *pgd;
+    nd_uuid_t *uuid;                    // in the journal v2 of the source datafile
+    time_t start_time_s;
+    time_t end_time_s;
+    uint32_t update_every_s;
+    uint32_t entries;
+    uint32_t max_entries;
+    uint32_t page_length;               // set when the page is moved to an extent
+    uint8_t type;
+};
+
+// a page written to the new datafile, to be added to the open cache
+struct compaction_page {
+    METRIC *metric;                     // acquired until the compaction finishes
+    time_t start_time_s;
+    time_t end_time_s;
+    uint32_t update_every_s;
+    uint32_t page_length;
+    uint32_t extent;                    // index in the extents array
+    struct rrdeng_page_summary summary;
+};
+
+struct compaction_extent {
+    uint64_t pos;
+    uint32_t bytes;
+};
+
+struct compaction_state {
+    struct rrdengine_instance *ctx;
+    struct rrdengine_datafile *src;
+    struct journal_v2_header *j2_header;
+    uint8_t compression_algorithm;
+    bool failed;
+
+    struct {
+        uv_file datafile;
+        uv_file journalfile;
+        uint64_t datafile_pos;
+        uint64_t journalfile_pos;
+        char datafile_path[RRDENG_PATH_MAX];
+        char journalfile_path[RRDENG_PATH_MAX];
+    } tmp;
+
+    struct {
+        struct compaction_pending *array;   // one per metric of the journal v2 of the source
+        size_t bytes;
+    } pending;
+
+    struct {
+        struct compaction_pending pages[MAX_PAGES_PER_EXTENT];
+        size_t count;
+        uint32_t uncompressed_bytes;
+    } extent;
+
+    struct {
+        struct compaction_page *array;
+        size_t used;
+        size_t size;
+    } pages;
+
+    struct {
+        struct compaction_extent *array;
+        size_t used;
+        size_t size;
+    } extents;
+
+    struct {
+        usec_t started_ut;
+        uint64_t bytes;
+    } io;
+
+    size_t pages_read;
+};
+
+static void compaction_tmp_datafile_path(struct rrdengine_instance *ctx, unsigned fileno, char *str, size_t maxlen) {
+    (void) snprintfz(str, maxlen - 1, "%s/" COMPACTION_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL DATAFILE_EXTENSION,
+                     ctx->config.dbfiles_path, 1, fileno);
+}
+
+static void compaction_tmp_journalfile_path(struct rrdengine_instance *ctx, unsigned fileno, char *str, size_t maxlen) {
+    (void) snprintfz(str, maxlen - 1, "%s/" COMPACTION_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION,
+                     ctx->config.dbfiles_path, 1, fileno);
+}
+
+static bool compaction_should_stop(struct compaction_state *cs) {
+    // the source is being deleted by database rotation
+    return cs->failed ||
+           !ctx_is_available_for_queries(cs->ctx) ||
+           !__atomic_load_n(&cs->src->users.available, __ATOMIC_RELAXED);
+}
+
+static void compaction_throttle(struct compaction_state *cs, size_t bytes) {
+    cs->io.bytes += bytes;
+
+    if(!dbengine_compaction_io_budget_mb)
+        return;
+
+    usec_t wanted_ut = cs->io.bytes * USEC_PER_SEC / (dbengine_compaction_io_budget_mb * 1024 * 1024);
+    usec_t spent_ut = now_monotonic_usec() - cs->io.started_ut;
+
+    while(wanted_ut > spent_ut && !compaction_should_stop(cs)) {
+        sleep_usec(MIN(wanted_ut - spent_ut, 100 * USEC_PER_MS));
+        spent_ut = now_monotonic_usec() - cs->io.started_ut;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// writing the new datafile
+
+static bool compaction_write(struct compaction_state *cs, uv_file file, void *buf, size_t size, uint64_t pos) {
+    uv_fs_t req;
+    uv_buf_t iov = uv_buf_init(buf, size);
+
+    int ret = uv_fs_write(NULL, &req, file, &iov, 1, (int64_t)pos, NULL);
+    uv_fs_req_cleanup(&req);
+
+    if(ret < 0 || (size_t)ret != size) {
+        netdata_log_error("DBENGINE: compaction of tier %d cannot write %zu bytes at %"PRIu64": %s",
+                          cs->ctx->config.tier, size, pos, ret < 0 ? uv_strerror(ret) : "short write");
+        ctx_io_error(cs->ctx);
+        cs->failed = true;
+        return false;
+    }
+
+    ctx_io_write_op_bytes(cs->ctx, size);
+    return true;
+}
+
+static bool compaction_tmp_files_create(struct compaction_state *cs) {
+    struct rrdengine_instance *ctx = cs->ctx;
+    unsigned fileno = cs->src->fileno;
+    int ret;
+
+    compaction_tmp_datafile_path(ctx, fileno, cs->tmp.datafile_path, sizeof(cs->tmp.datafile_path));
+    compaction_tmp_journalfile_path(ctx, fileno, cs->tmp.journalfile_path, sizeof(cs->tmp.journalfile_path));
+
+    // the journal is created first: a temporary datafile without a temporary journal
+    // is a committed compaction for compaction_recover()
+    if(open_file_for_io(cs->tmp.journalfile_path, O_CREAT | O_RDWR | O_TRUNC, &cs->tmp.journalfile, use_direct_io) < 0) {
+        ctx_fs_error(ctx);
+        return false;
+    }
+
+    if(open_file_for_io(cs->tmp.datafile_path, O_CREAT | O_RDWR | O_TRUNC, &cs->tmp.datafile, use_direct_io) < 0) {
+        ctx_fs_error(ctx);
+        close(cs->tmp.journalfile);
+        unlink(cs->tmp.journalfile_path);
+        return false;
+    }
+
+    struct rrdeng_jf_sb *jf_superblock = NULL;
+    ret = posix_memalign((void *)&jf_superblock, RRDFILE_ALIGNMENT, sizeof(*jf_superblock));
+    if (unlikely(ret))
+        fatal("DBENGINE: posix_memalign:%s", strerror(ret));
+    memset(jf_superblock, 0, sizeof(*jf_superblock));
+    (void) strncpy(jf_superblock->magic_number, RRDENG_JF_MAGIC, RRDENG_MAGIC_SZ);
+    (void) strncpy(jf_superblock->version, RRDENG_JF_VER, RRDENG_VER_SZ);
+
+    struct rrdeng_df_sb *df_superblock = NULL;
+    ret = posix_memalign((void *)&df_superblock, RRDFILE_ALIGNMENT, sizeof(*df_superblock));
+    if (unlikely(ret))
+        fatal("DBENGINE: posix_memalign:%s", strerror(ret));
+    memset(df_superblock, 0, sizeof(*df_superblock));
+    (void) strncpy(df_superblock->magic_number, RRDENG_DF_MAGIC, RRDENG_MAGIC_SZ);
+    (void) strncpy(df_superblock->version, RRDENG_DF_VER, RRDENG_VER_SZ);
+    df_superblock->tier = 1;
+    df_superblock->flags = RRDENG_DF_SB_FLAG_COMPACTED;
+
+    bool ok = compaction_write(cs, cs->tmp.journalfile, jf_superblock, sizeof(*jf_superblock), 0) &&
+              compaction_write(cs, cs->tmp.datafile, df_superblock, sizeof(*df_superblock), 0);
+
+    posix_memfree(jf_superblock);
+    posix_memfree(df_superblock);
+
+    cs->tmp.journalfile_pos = sizeof(*jf_superblock);
+    cs->tmp.datafile_pos = sizeof(*df_superblock);
+
+    return ok;
+}
+
+static void compaction_tmp_files_close(struct compaction_state *cs, bool sync) {
+    if(sync && (fsync(cs->tmp.datafile) == -1 || fsync(cs->tmp.journalfile) == -1)) {
+        netdata_log_error("DBENGINE: compaction of tier %d cannot fsync '%s'", cs->ctx->config.tier, cs->tmp.datafile_path);
+        ctx_fs_error(cs->ctx);
+        cs->failed = true;
+    }
+
+    close(cs->tmp.datafile);
+    close(cs->tmp.journalfile);
+}
+
+static void compaction_tmp_files_delete(struct compaction_state *cs) {
+    // the datafile first, so that a crash in between cannot look like a committed compaction
+    unlink(cs->tmp.datafile_path);
+    unlink(cs->tmp.journalfile_path);
+}
+
+static METRIC *compaction_metric_acquire(struct rrdengine_instance *ctx, struct compaction_pending *p) {
+    METRIC *metric = mrg_metric_get_and_acquire(main_mrg, p->uuid, (Word_t)ctx);
+    if(metric)
+        return metric;
+
+    // the metric has been deleted from the registry while we were reading it
+    MRG_ENTRY entry = {
+            .uuid = p->uuid,
+            .section = (Word_t)ctx,
+            .first_time_s = p->start_time_s,
+            .last_time_s = p->end_time_s,
+            .latest_update_every_s = p->update_every_s,
+    };
+
+    bool added;
+    metric = mrg_metric_add_and_acquire(main_mrg, entry, &added);
+    if(added)
+        __atomic_add_fetch(&ctx->atomic.metrics, 1, __ATOMIC_RELAXED);
+
+    return metric;
+}
+
+static void compaction_extent_write(struct compaction_state *cs) {
+    struct rrdengine_instance *ctx = cs->ctx;
+    size_t count = cs->extent.count;
+    int ret;
+
+    if(!count)
+        return;
+
+    if(cs->failed) {
+        for(size_t i = 0; i < count; i++)
+            pgd_free(cs->extent.pages[i].pgd);
+
+        cs->extent.count = 0;
+        cs->extent.uncompressed_bytes = 0;
+        return;
+    }
+
+    /* persistent structures */
+    struct rrdeng_df_extent_header *header;
+    struct rrdeng_df_extent_trailer *trailer;
+    struct rrdeng_jf_transaction_header *jf_header;
+    struct rrdeng_jf_store_data *jf_metric_data;
+    struct rrdeng_jf_transaction_trailer *jf_trailer;
+    uLong crc;
+
+    uint8_t compression_algorithm = cs->compression_algorithm;
+    uint32_t uncompressed_payload_length = cs->extent.uncompressed_bytes;
+    uint32_t payload_offset = sizeof(*header) + count * sizeof(header->descr[0]);
+    size_t max_compressed_size = dbengine_max_compressed_size(uncompressed_payload_length, compression_algorithm);
+    size_t size_bytes = payload_offset + MAX(uncompressed_payload_length, max_compressed_size) + sizeof(*trailer);
+
+    void *buf = NULL;
+    ret = posix_memalign(&buf, RRDFILE_ALIGNMENT, ALIGN_BYTES_CEILING(size_bytes));
+    if (unlikely(ret))
+        fatal("DBENGINE: posix_memalign:%s", strerror(ret));
+    memset(buf, 0, ALIGN_BYTES_CEILING(size_bytes));
+
+    header = buf;
+    header->number_of_pages = count;
+
+    size_t pos = sizeof(*header);
+    for(size_t i = 0; i < count; i++) {
+        struct compaction_pending *p = &cs->extent.pages[i];
+
+        header->descr[i].type = p->type;
+        uuid_copy(*(nd_uuid_t *)header->descr[i].uuid, *p->uuid);
+        header->descr[i].page_length = p->page_length;
+        header->descr[i].start_time_ut = p->start_time_s * USEC_PER_SEC;
+
+        switch (p->type) {
+            case RRDENG_PAGE_TYPE_ARRAY_32BIT:
+            case RRDENG_PAGE_TYPE_ARRAY_TIER1:
+                header->descr[i].end_time_ut = p->end_time_s * USEC_PER_SEC;
+                break;
+            case RRDENG_PAGE_TYPE_GORILLA_32BIT:
+                header->descr[i].gorilla.delta_time_s = (uint32_t) (p->end_time_s - p->start_time_s);
+                header->descr[i].gorilla.entries = pgd_slots_used(p->pgd);
+                break;
+            default:
+                fatal("Unknown page type: %uc", p->type);
+        }
+
+        pos += sizeof(header->descr[i]);
+    }
+
+    // build the extent payload and keep the pages for the open cache
+    if(cs->pages.used + count > cs->pages.size) {
+        cs->pages.size = MAX(cs->pages.size * 2, cs->pages.used + count);
+        cs->pages.array = reallocz(cs->pages.array, cs->pages.size * sizeof(*cs->pages.array));
+    }
+
+    if(cs->extents.used == cs->extents.size) {
+        cs->extents.size = cs->extents.size ? cs->extents.size * 2 : 1024;
+        cs->extents.array = reallocz(cs->extents.array, cs->extents.size * sizeof(*cs->extents.array));
+    }
+
+    for(size_t i = 0; i < count; i++) {
+        struct compaction_pending *p = &cs->extent.pages[i];
+        struct compaction_page *cp = &cs->pages.array[cs->pages.used++];
+
+        pgd_copy_to_extent(p->pgd, buf + pos, p->page_length);
+
+        cp->metric = compaction_metric_acquire(ctx, p);
+        cp->start_time_s = p->start_time_s;
+        cp->end_time_s = p->end_time_s;
+        cp->update_every_s = p->update_every_s;
+        cp->page_length = p->page_length;
+        cp->extent = cs->extents.used;
+        pgd_summary(p->pgd, &cp->summary);
+
+        pgd_free(p->pgd);
+        p->pgd = NULL;
+
+        pos += p->page_length;
+    }
+
+    size_t compressed_size = dbengine_compress(buf + payload_offset, uncompressed_payload_length, compression_algorithm);
+    if(compressed_size) {
+        header->compression_algorithm = compression_algorithm;
+        header->payload_length = compressed_size;
+    }
+    else {
+        header->compression_algorithm = RRDENG_COMPRESSION_NONE;
+        header->payload_length = compressed_size = uncompressed_payload_length;
+    }
+
+    size_bytes = payload_offset + compressed_size + sizeof(*trailer);
+    trailer = buf + size_bytes - sizeof(*trailer);
+    crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, buf, size_bytes - sizeof(*trailer));
+    crc32set(trailer->checksum, crc);
+
+    size_t real_io_size = ALIGN_BYTES_CEILING(size_bytes);
+    uint64_t extent_pos = cs->tmp.datafile_pos;
+
+    cs->extents.array[cs->extents.used++] = (struct compaction_extent){
+            .pos = extent_pos,
+            .bytes = size_bytes,
+    };
+
+    // the journal transaction of the extent
+    void *jf_buf = NULL;
+    ret = posix_memalign(&jf_buf, RRDFILE_ALIGNMENT, RRDENG_BLOCK_SIZE);
+    if (unlikely(ret))
+        fatal("DBENGINE: posix_memalign:%s", strerror(ret));
+    memset(jf_buf, 0, RRDENG_BLOCK_SIZE);
+
+    size_t descr_size = sizeof(*jf_metric_data->descr) * count;
+    size_t payload_length = sizeof(*jf_metric_data) + descr_size;
+
+    jf_header = jf_buf;
+    jf_header->type = STORE_DATA;
+    jf_header->reserved = 0;
+    jf_header->id = __atomic_fetch_add(&ctx->atomic.transaction_id, 1, __ATOMIC_RELAXED);
+    jf_header->payload_length = payload_length;
+
+    jf_metric_data = jf_buf + sizeof(*jf_header);
+    jf_metric_data->extent_offset = extent_pos;
+    jf_metric_data->extent_size = size_bytes;
+    jf_metric_data->number_of_pages = count;
+    memcpy(jf_metric_data->descr, header->descr, descr_size);
+
+    jf_trailer = jf_buf + sizeof(*jf_header) + payload_length;
+    crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, jf_buf, sizeof(*jf_header) + payload_length);
+    crc32set(jf_trailer->checksum, crc);
+
+    if(compaction_write(cs, cs->tmp.datafile, buf, real_io_size, extent_pos) &&
+       compaction_write(cs, cs->tmp.journalfile, jf_buf, RRDENG_BLOCK_SIZE, cs->tmp.journalfile_pos)) {
+        cs->tmp.datafile_pos += real_io_size;
+        cs->tmp.journalfile_pos += RRDENG_BLOCK_SIZE;
+    }
+
+    posix_memfree(buf);
+    posix_memfree(jf_buf);
+
+    cs->extent.count = 0;
+    cs->extent.uncompressed_bytes = 0;
+
+    compaction_throttle(cs, real_io_size + RRDENG_BLOCK_SIZE);
+}
+
+// move the pending page of a metric to the next extent
+static void compaction_pending_write(struct compaction_state *cs, size_t m) {
+    struct compaction_pending *p = &cs->pending.array[m];
+    if(!p->pgd)
+        return;
+
+    cs->pending.bytes -= p->max_entries * page_type_size[p->type];
+
+    p->page_length = pgd_disk_footprint(p->pgd);
+
+    if(cs->extent.count == rrdeng_pages_per_extent ||
+        cs->extent.uncompressed_bytes + p->page_length > MAX_PAGES_PER_EXTENT * RRDENG_BLOCK_SIZE)
+        compaction_extent_write(cs);
+
+    cs->extent.pages[cs->extent.count++] = *p;
+    cs->extent.uncompressed_bytes += p->page_length;
+
+    p->pgd = NULL;
+}
+
+static void compaction_pending_write_all(struct compaction_state *cs) {
+    for(size_t m = 0; m < cs->j2_header->metric_count; m++)
+        compaction_pending_write(cs, m);
+}
+
+// append a page read from the source to the pending page of its metric
+static void compaction_page_add(struct compaction_state *cs, size_t m, nd_uuid_t *uuid, VALIDATED_PAGE_DESCRIPTOR *vd, PGD *pgd) {
+    struct compaction_pending *p = &cs->pending.array[m];
+    uint32_t entries = pgd_slots_used(pgd);
+
+    if(p->pgd && (p->type != vd->type ||
+                  p->update_every_s != vd->update_every_s ||
+                  vd->start_time_s != p->end_time_s + (time_t)p->update_every_s ||
+                  p->entries + entries > p->max_entries))
+        compaction_pending_write(cs, m);
+
+    if(!p->pgd) {
+        // pages are merged up to the size the collectors use for this tier
+        uint32_t max_entries = tier_page_size[cs->ctx->config.tier] / page_type_size[vd->type];
+        max_entries = MAX(max_entries, entries);
+
+        *p = (struct compaction_pending){
+                .pgd = pgd_create(vd->type, vd->type == RRDENG_PAGE_TYPE_GORILLA_32BIT ? RRDENG_GORILLA_32BIT_BUFFER_SLOTS : max_entries),
+                .uuid = uuid,
+                .start_time_s = vd->start_time_s,
+                .end_time_s = vd->start_time_s,
+                .update_every_s = vd->update_every_s,
+                .entries = 0,
+                .max_entries = max_entries,
+                .type = vd->type,
+        };
+
+        cs->pending.bytes += max_entries * page_type_size[vd->type];
+    }
+
+    pgd_append_page(p->pgd, pgd);
+    p->entries += entries;
+    p->end_time_s = vd->end_time_s;
+
+    if(p->entries >= p->max_entries)
+        compaction_pending_write(cs, m);
+
+    if(cs->pending.bytes > COMPACTION_MAX_PENDING_BYTES)
+        compaction_pending_write_all(cs);
+}
+
+// ----------------------------------------------------------------------------
+// reading the source datafile
+
+// find the page of a metric in the journal v2, by its start time and its extent
+static struct journal_page_list *compaction_v2_page_find(struct journal_v2_header *j2_header, struct journal_metric_list *metric, uint32_t delta_start_s, uint32_t extent_index) {
+    struct journal_page_header *page_header = (void *)((uint8_t *)j2_header + metric->page_offset);
+    struct journal_page_list *pages = (void *)((uint8_t *)page_header + sizeof(*page_header));
+
+    size_t lo = 0, hi = page_header->entries;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(pages[mid].delta_start_s < delta_start_s)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for(; lo < page_header->entries && pages[lo].delta_start_s == delta_start_s; lo++)
+        if(pages[lo].extent_index == extent_index)
+            return &pages[lo];
+
+    return NULL;
+}
+
+struct compaction_buffers {
+    void *read;
+    size_t read_size;
+    void *uncompressed;
+    size_t uncompressed_size;
+};
+
+static void compaction_extent_process(struct compaction_state *cs, uint32_t extent_index, struct compaction_buffers *b) {
+    struct rrdengine_instance *ctx = cs->ctx;
+    struct journal_v2_header *j2_header = cs->j2_header;
+    struct journal_extent_list *extent = (void *)((uint8_t *)j2_header + j2_header->extent_offset) + extent_index * sizeof(struct journal_extent_list);
+
+    /* persistent structures */
+    struct rrdeng_df_extent_header *header;
+    struct rrdeng_df_extent_trailer *trailer;
+    uLong crc;
+
+    size_t data_length = extent->datafile_size;
+    size_t read_size = ALIGN_BYTES_CEILING(data_length);
+
+    if(data_length < sizeof(*header) + sizeof(header->descr[0]) + sizeof(*trailer) ||
+        extent->datafile_offset + read_size > cs->src->pos)
+        return;
+
+    if(read_size > b->read_size) {
+        posix_memfree(b->read);
+        int ret = posix_memalign(&b->read, RRDFILE_ALIGNMENT, read_size);
+        if (unlikely(ret))
+            fatal("DBENGINE: posix_memalign:%s", strerror(ret));
+        b->read_size = read_size;
+    }
+
+    uv_fs_t req;
+    uv_buf_t iov = uv_buf_init(b->read, read_size);
+    int ret = uv_fs_read(NULL, &req, cs->src->file, &iov, 1, (int64_t)extent->datafile_offset, NULL);
+    uv_fs_req_cleanup(&req);
+    if(ret < 0 || (size_t)ret < data_length) {
+        netdata_log_error("DBENGINE: compaction of tier %d cannot read extent at %"PRIu64" of datafile %u",
+                          ctx->config.tier, extent->datafile_offset, cs->src->fileno);
+        ctx_io_error(ctx);
+        cs->failed = true;
+        return;
+    }
+    ctx_io_read_op_bytes(ctx, read_size);
+
+    void *data = b->read;
+    header = data;
+    uint32_t count = header->number_of_pages;
+    uint32_t payload_length = header->payload_length;
+    uint32_t payload_offset = sizeof(*header) + sizeof(header->descr[0]) * count;
+    uint32_t trailer_offset = data_length - sizeof(*trailer);
+    trailer = data + trailer_offset;
+
+    if(count < 1 || count > MAX_PAGES_PER_EXTENT ||
+        !dbengine_valid_compression_algorithm(header->compression_algorithm) ||
+        payload_length != trailer_offset - payload_offset)
+        return;
+
+    crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, data, data_length - sizeof(*trailer));
+    if(unlikely(crc32cmp(trailer->checksum, crc))) {
+        // queries cannot read this extent either
+        ctx_io_error(ctx);
+        return;
+    }
+
+    void *payload = data + payload_offset;
+    uint32_t uncompressed_payload_length = payload_length;
+    if(header->compression_algorithm != RRDENG_COMPRESSION_NONE) {
+        uncompressed_payload_length = 0;
+        for(uint32_t i = 0; i < count; i++)
+            uncompressed_payload_length += header->descr[i].page_length;
+
+        if(uncompressed_payload_length > MAX_PAGES_PER_EXTENT * (RRDENG_BLOCK_SIZE + RRDENG_GORILLA_32BIT_BUFFER_SIZE))
+            return;
+
+        if(uncompressed_payload_length > b->uncompressed_size) {
+            b->uncompressed = reallocz(b->uncompressed, uncompressed_payload_length);
+            b->uncompressed_size = uncompressed_payload_length;
+        }
+
+        size_t bytes = dbengine_decompress(b->uncompressed, payload, uncompressed_payload_length, payload_length,
+                                           header->compression_algorithm);
+        if(bytes != uncompressed_payload_length)
+            return;
+
+        payload = b->uncompressed;
+    }
+
+    time_t now_s = max_acceptable_collected_time();
+    time_t journal_start_time_s = (time_t)(j2_header->start_time_ut / USEC_PER_SEC);
+    struct journal_metric_list *metrics = (void *)((uint8_t *)j2_header + j2_header->metric_offset);
+
+    uint32_t page_offset = 0, page_length;
+    for(uint32_t i = 0; i < count; i++, page_offset += page_length) {
+        struct rrdeng_extent_page_descr *descr = &header->descr[i];
+        page_length = descr->page_length;
+        time_t start_time_s = (time_t)(descr->start_time_ut / USEC_PER_SEC);
+
+        if(!page_length || start_time_s < journal_start_time_s || page_offset + page_length > uncompressed_payload_length)
+            continue;
+
+        nd_uuid_t *uuid = (nd_uuid_t *)descr->uuid;
+        struct journal_metric_list *metric = journalfile_v2_metric_find(cs->src->journalfile, j2_header, uuid, journal_metric_uuid_hash(uuid));
+        if(!metric)
+            continue;
+
+        struct journal_page_list *page = compaction_v2_page_find(j2_header, metric, (uint32_t)(start_time_s - journal_start_time_s), extent_index);
+        if(!page)
+            // the page has been superseded, or it was invalid when the journal was indexed
+            continue;
+
+        VALIDATED_PAGE_DESCRIPTOR vd = validate_extent_page_descr(descr, now_s, page->update_every_s, false);
+        if(!vd.is_valid)
+            continue;
+
+        PGD *pgd = pgd_create_from_disk_data(descr->type, payload + page_offset, vd.page_length);
+        if(pgd == PGD_EMPTY)
+            continue;
+
+        if(pgd_slots_used(pgd))
+            compaction_page_add(cs, metric - metrics, &metric->uuid, &vd, pgd);
+
+        pgd_free(pgd);
+        cs->pages_read++;
+    }
+
+    compaction_throttle(cs, read_size);
+}
+
+struct compaction_extent_order {
+    uint64_t pos;
+    uint32_t index;
+};
+
+static int compaction_extent_cmp(const void *a, const void *b) {
+    uint64_t pos1 = ((const struct compaction_extent_order *)a)->pos;
+    uint64_t pos2 = ((const struct compaction_extent_order *)b)->pos;
+    return (pos1 < pos2) ? -1 : (pos1 > pos2) ? 1 : 0;
+}
+
+// ----------------------------------------------------------------------------
+// replacing the source datafile
+
+static void compaction_source_restore(struct rrdengine_datafile *src) {
+    spinlock_lock(&src->users.spinlock);
+    src->users.available = true;
+    src->users.time_to_evict = 0;
+    spinlock_unlock(&src->users.spinlock);
+}
+
+// take the source away from queries and database rotation
+// our reference to the source is released, on success and on failure
+static bool compaction_source_exclusive(struct compaction_state *cs) {
+    struct rrdengine_instance *ctx = cs->ctx;
+    struct rrdengine_datafile *src = cs->src;
+
+    // database rotation cannot start while we hold this, and it cannot
+    // finish deleting the source while we hold a reference to it
+    bool expected = false;
+    while(!__atomic_compare_exchange_n(&ctx->atomic.now_deleting_files, &expected, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        if(compaction_should_stop(cs)) {
+            datafile_release(src, DATAFILE_ACQUIRE_COMPACTION);
+            return false;
+        }
+
+        expected = false;
+        sleep_usec(100 * USEC_PER_MS);
+    }
+
+    if(compaction_should_stop(cs)) {
+        __atomic_store_n(&ctx->atomic.now_deleting_files, false, __ATOMIC_RELEASE);
+        datafile_release(src, DATAFILE_ACQUIRE_COMPACTION);
+        return false;
+    }
+
+    datafile_release(src, DATAFILE_ACQUIRE_COMPACTION);
+
+    while(!datafile_acquire_for_deletion(src)) {
+        if(!ctx_is_available_for_queries(ctx)) {
+            compaction_source_restore(src);
+            __atomic_store_n(&ctx->atomic.now_deleting_files, false, __ATOMIC_RELEASE);
+            return false;
+        }
+
+        sleep_usec(100 * USEC_PER_MS);
+    }
+
+    return true;
+}
+
+static void compaction_open_cache_populate(struct compaction_state *cs, struct rrdengine_datafile *df) {
+    for(size_t i = 0; i < cs->pages.used; i++) {
+        struct compaction_page *cp = &cs->pages.array[i];
+        struct compaction_extent *ce = &cs->extents.array[cp->extent];
+
+        pgc_open_add_hot_page(
+                (Word_t)cs->ctx, mrg_metric_id(main_mrg, cp->metric),
+                cp->start_time_s, cp->end_time_s, cp->update_every_s,
+                df, ce->pos, ce->bytes, cp->page_length, &cp->summary);
+    }
+}
+
+static bool compaction_swap(struct compaction_state *cs) {
+    struct rrdengine_instance *ctx = cs->ctx;
+    struct rrdengine_datafile *src = cs->src;
+    char path[RRDENG_PATH_MAX];
+
+    if(!compaction_source_exclusive(cs)) {
+        compaction_tmp_files_delete(cs);
+        return false;
+    }
+
+    // from now on, the source is not available and we do not have a reference to it
+
+    uint64_t src_bytes = src->pos + journalfile_current_size(src->journalfile) + journalfile_v2_data_size_get(src->journalfile);
+
+    // the journal v2 of the source describes the old extents
+    journalfile_v2_generate_path(src, path, sizeof(path));
+    unlink(path);
+
+    // the commit point
+    journalfile_v1_generate_path(src, path, sizeof(path));
+    if(rename(cs->tmp.journalfile_path, path) == -1) {
+        netdata_log_error("DBENGINE: compaction cannot rename '%s' to '%s'", cs->tmp.journalfile_path, path);
+        ctx_fs_error(ctx);
+        compaction_tmp_files_delete(cs);
+        goto keep_source;
+    }
+
+    generate_datafilepath(src, path, sizeof(path));
+    if(rename(cs->tmp.datafile_path, path) == -1) {
+        netdata_log_error("DBENGINE: compaction cannot rename '%s' to '%s', it will be renamed on restart", cs->tmp.datafile_path, path);
+        ctx_fs_error(ctx);
+        goto keep_source;
+    }
+
+    // the source keeps working on its open files until it is replaced
+
+    struct rrdengine_datafile *df = datafile_alloc_and_init(ctx, 1, src->fileno);
+    df->compacted = true;
+    if(load_data_file(df) != 0) {
+        freez(df);
+        goto keep_source;
+    }
+
+    struct rrdengine_journalfile *jf = journalfile_alloc_and_init(df);
+    journalfile_v1_generate_path(df, path, sizeof(path));
+    if(open_file_for_io(path, O_RDWR, &jf->file, use_direct_io) < 0) {
+        ctx_fs_error(ctx);
+        close_data_file(df);
+        freez(jf);
+        freez(df);
+        goto keep_source;
+    }
+    jf->unsafe.pos = cs->tmp.journalfile_pos;
+
+    // stop queries from finding the old extents
+    journalfile_close(src->journalfile, src);
+
+    // the new extents reuse the file number and offsets of the old ones
+    pgc_evict_clean_pages_of_metric(extent_cache, (Word_t)ctx, src->fileno);
+
+    compaction_open_cache_populate(cs, df);
+    pgc_open_cache_to_journal_v2(open_cache, (Word_t)ctx, df->fileno, ctx->config.page_type,
+                                 journalfile_migrate_to_v2_callback, (void *)jf);
+
+    uv_rwlock_wrlock(&ctx->datafiles.rwlock);
+    DOUBLE_LINKED_LIST_INSERT_ITEM_BEFORE_UNSAFE(ctx->datafiles.first, src, df, prev, next);
+    datafile_list_delete_unsafe(ctx, src);
+    uv_rwlock_wrunlock(&ctx->datafiles.rwlock);
+
+    __atomic_store_n(&ctx->atomic.now_deleting_files, false, __ATOMIC_RELEASE);
+
+    if(!journalfile_v2_data_available(jf))
+        // another indexer was running, let the journal indexer pick it up
+        rrdeng_enq_cmd(ctx, RRDENG_OPCODE_JOURNAL_INDEX, df, NULL, STORAGE_PRIORITY_INTERNAL_DBENGINE, NULL, NULL);
+
+    close_data_file(src);
+    freez(src->journalfile);
+    freez(src);
+
+    ctx_current_disk_space_increase(ctx, df->pos + jf->unsafe.pos);
+    ctx_current_disk_space_decrease(ctx, src_bytes);
+
+    return true;
+
+keep_source:
+    // the files on disk will be loaded on restart, until then we continue using the source
+    src->compacted = true;
+    compaction_source_restore(src);
+    __atomic_store_n(&ctx->atomic.now_deleting_files, false, __ATOMIC_RELEASE);
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+// public API
+
+static bool compaction_is_candidate(struct rrdengine_instance *ctx, struct rrdengine_datafile *df) {
+    return !df->compacted &&
+           // never the two newest datafiles
+           df->next && df->next->next &&
+           // the oldest one is about to be rotated
+           !(df == ctx->datafiles.first && rrdeng_ctx_tier_cap_exceeded(ctx)) &&
+           journalfile_v2_data_available(df->journalfile);
+}
+
+bool compaction_candidate_exists(struct rrdengine_instance *ctx) {
+    if(!dbengine_compaction_enabled)
+        return false;
+
+    bool found = false;
+
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    for(struct rrdengine_datafile *df = ctx->datafiles.first; df && !found; df = df->next)
+        found = compaction_is_candidate(ctx, df);
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    return found;
+}
+
+static struct rrdengine_datafile *compaction_candidate_acquire(struct rrdengine_instance *ctx) {
+    struct rrdengine_datafile *found = NULL;
+
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    for(struct rrdengine_datafile *df = ctx->datafiles.first; df && !found; df = df->next) {
+        if(compaction_is_candidate(ctx, df) && datafile_acquire(df, DATAFILE_ACQUIRE_COMPACTION))
+            found = df;
+    }
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    return found;
+}
+
+bool compaction_run(struct rrdengine_instance *ctx) {
+    if(!dbengine_compaction_enabled || !ctx_is_available_for_queries(ctx))
+        return false;
+
+    struct rrdengine_datafile *src = compaction_candidate_acquire(ctx);
+    if(!src)
+        return false;
+
+    struct journal_v2_header *j2_header = journalfile_v2_data_acquire(src->journalfile, NULL, 0, 0);
+    if(!j2_header) {
+        datafile_release(src, DATAFILE_ACQUIRE_COMPACTION);
+        return false;
+    }
+
+    struct compaction_state cs = {
+            .ctx = ctx,
+            .src = src,
+            .j2_header = j2_header,
+            .compression_algorithm = dbengine_default_compression(),
+            .io.started_ut = now_monotonic_usec(),
+    };
+
+    bool replaced = false;
+    uint64_t src_datafile_bytes = src->pos;
+    size_t extents_read = j2_header->extent_count;
+
+    if(!compaction_tmp_files_create(&cs)) {
+        netdata_log_error("DBENGINE: compaction of datafile %u of tier %d cannot create its temporary files",
+                          src->fileno, ctx->config.tier);
+        src->compacted = true;
+        journalfile_v2_data_release(src->journalfile);
+        datafile_release(src, DATAFILE_ACQUIRE_COMPACTION);
+        return false;
+    }
+
+    netdata_log_info("DBENGINE: compacting datafile %u of tier %d (%"PRIu64" bytes, %u extents, %u metrics, %u pages)",
+                     src->fileno, ctx->config.tier, src_datafile_bytes,
+                     j2_header->extent_count, j2_header->metric_count, j2_header->page_count);
+
+    cs.pending.array = callocz(j2_header->metric_count ? j2_header->metric_count : 1, sizeof(*cs.pending.array));
+
+    // read the extents in file order
+    struct journal_extent_list *extents = (void *)((uint8_t *)j2_header + j2_header->extent_offset);
+    struct compaction_extent_order *order = mallocz((j2_header->extent_count ? j2_header->extent_count : 1) * sizeof(*order));
+    for(uint32_t i = 0; i < j2_header->extent_count; i++)
+        order[i] = (struct compaction_extent_order){ .pos = extents[i].datafile_offset, .index = i };
+
+    qsort(order, j2_header->extent_count, sizeof(*order), compaction_extent_cmp);
+
+    struct compaction_buffers buffers = { 0 };
+    for(uint32_t i = 0; i < j2_header->extent_count && !compaction_should_stop(&cs); i++)
+        compaction_extent_process(&cs, order[i].index, &buffers);
+
+    posix_memfree(buffers.read);
+    freez(buffers.uncompressed);
+    freez(order);
+
+    bool stopped = compaction_should_stop(&cs);
+
+    compaction_pending_write_all(&cs);
+    compaction_extent_write(&cs);
+    freez(cs.pending.array);
+
+    journalfile_v2_data_release(src->journalfile);
+
+    compaction_tmp_files_close(&cs, !stopped && !cs.failed);
+
+    uint64_t new_datafile_bytes = cs.tmp.datafile_pos;
+
+    if(stopped || cs.failed) {
+        compaction_tmp_files_delete(&cs);
+
+        if(cs.failed)
+            src->compacted = true;
+
+        netdata_log_info("DBENGINE: compaction of datafile %u of tier %d %s",
+                         src->fileno, ctx->config.tier, cs.failed ? "failed" : "stopped");
+
+        datafile_release(src, DATAFILE_ACQUIRE_COMPACTION);
+    }
+    else if((int64_t)(new_datafile_bytes * 100) > (int64_t)src_datafile_bytes * (100 - dbengine_compaction_min_savings_percent)) {
+        compaction_tmp_files_delete(&cs);
+
+        // remembered until restart
+        src->compacted = true;
+
+        netdata_log_info("DBENGINE: datafile %u of tier %d is not worth compacting (%"PRIu64" to %"PRIu64" bytes)",
+                         src->fileno, ctx->config.tier, src_datafile_bytes, new_datafile_bytes);
+
+        datafile_release(src, DATAFILE_ACQUIRE_COMPACTION);
+    }
+    else {
+        unsigned fileno = src->fileno;
+        replaced = compaction_swap(&cs);
+
+        if(replaced)
+            netdata_log_info("DBENGINE: compacted datafile %u of tier %d from %"PRIu64" to %"PRIu64" bytes "
+                             "(%zu extents to %zu, %zu pages to %zu)",
+                             fileno, ctx->config.tier, src_datafile_bytes, new_datafile_bytes,
+                             extents_read, cs.extents.used, cs.pages_read, cs.pages.used);
+    }
+
+    for(size_t i = 0; i < cs.pages.used; i++)
+        mrg_metric_release(main_mrg, cs.pages.array[i].metric);
+
+    freez(cs.pages.array);
+    freez(cs.extents.array);
+
+    return replaced;
+}
+
+void compaction_recover(struct rrdengine_instance *ctx) {
+    uv_fs_t req;
+    uv_dirent_t dent;
+
+    int ret = uv_fs_scandir(NULL, &req, ctx->config.dbfiles_path, 0, NULL);
+    if (ret < 0) {
+        uv_fs_req_cleanup(&req);
+        return;
+    }
+
+    while(UV_EOF != uv_fs_scandir_next(&req, &dent)) {
+        unsigned tier, fileno;
+        if(strncmp(dent.name, COMPACTION_PREFIX, sizeof(COMPACTION_PREFIX) - 1) != 0 ||
+            sscanf(dent.name, COMPACTION_PREFIX RRDENG_FILE_NUMBER_SCAN_TMPL, &tier, &fileno) != 2)
+            continue;
+
+        char tmp_datafile[RRDENG_PATH_MAX], tmp_journalfile[RRDENG_PATH_MAX];
+        compaction_tmp_datafile_path(ctx, fileno, tmp_datafile, sizeof(tmp_datafile));
+        compaction_tmp_journalfile_path(ctx, fileno, tmp_journalfile, sizeof(tmp_journalfile));
+
+        bool have_datafile = access(tmp_datafile, F_OK) == 0;
+        bool have_journalfile = access(tmp_journalfile, F_OK) == 0;
+
+        if(have_datafile && !have_journalfile) {
+            // the journal has been committed, the datafile was not renamed
+            char path[RRDENG_PATH_MAX], journalfile[RRDENG_PATH_MAX];
+
+            (void) snprintfz(path, sizeof(path) - 1, "%s/" DATAFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL DATAFILE_EXTENSION,
+                             ctx->config.dbfiles_path, 1, fileno);
+            (void) snprintfz(journalfile, sizeof(journalfile) - 1, "%s/" WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION,
+                             ctx->config.dbfiles_path, 1, fileno);
+
+            if(access(path, F_OK) != 0 || access(journalfile, F_OK) != 0) {
+                // the agent kept using the source after the failed rename,
+                // and database rotation deleted it before the restart
+                unlink(tmp_datafile);
+                netdata_log_info("DBENGINE: removed the compacted datafile %u of tier %d, its source has been rotated",
+                                 fileno, ctx->config.tier);
+                continue;
+            }
+
+            (void) snprintfz(journalfile, sizeof(journalfile) - 1, "%s/" WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION_V2,
+                             ctx->config.dbfiles_path, 1, fileno);
+            unlink(journalfile);
+
+            if(rename(tmp_datafile, path) == -1) {
+                netdata_log_error("DBENGINE: cannot complete the compaction of '%s'", path);
+                ctx_fs_error(ctx);
+            }
+            else
+                netdata_log_info("DBENGINE: completed the interrupted compaction of '%s'", path);
+        }
+        else if(have_datafile || have_journalfile) {
+            // not committed, the original files are intact
+            unlink(tmp_datafile);
+            unlink(tmp_journalfile);
+            netdata_log_info("DBENGINE: removed the files of an interrupted compaction of datafile %u of tier %d",
+                             fileno, ctx->config.tier);
+        }
+    }
+
+    uv_fs_req_cleanup(&req);
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+#define COMPACTION_UNITTEST_PAGES 3
+#define COMPACTION_UNITTEST_POINTS 128
+
+static NETDATA_DOUBLE compaction_unittest_value(size_t page, size_t point) {
+    // the first page has only gaps
+    return page ? (NETDATA_DOUBLE)(page * 1000 + point) : NAN;
+}
+
+// a page written to an extent and loaded back, like the pages the compactor reads
+static PGD *compaction_unittest_page_reload(PGD *pgd) {
+    uint32_t size = pgd_disk_footprint(pgd);
+    uint8_t *buf = callocz(1, size);
+    pgd_copy_to_extent(pgd, buf, size);
+
+    PGD *disk = pgd_create_from_disk_data(pgd_type(pgd), buf, size);
+    freez(buf);
+    return disk;
+}
+
+static PGD *compaction_unittest_page_create(uint8_t type, uint32_t slots) {
+    return pgd_create(type, type == RRDENG_PAGE_TYPE_GORILLA_32BIT ? RRDENG_GORILLA_32BIT_BUFFER_SLOTS : slots);
+}
+
+static size_t compaction_unittest_merge(uint8_t type) {
+    size_t errors = 0;
+
+    fprintf(stderr, "DBENGINE COMPACTION: merging %d pages of type %u\n", COMPACTION_UNITTEST_PAGES, type);
+
+    PGD *merged = compaction_unittest_page_create(type, COMPACTION_UNITTEST_PAGES * COMPACTION_UNITTEST_POINTS);
+
+    for(size_t p = 0; p < COMPACTION_UNITTEST_PAGES; p++) {
+        PGD *pgd = compaction_unittest_page_create(type, COMPACTION_UNITTEST_POINTS);
+
+        for(size_t i = 0; i < COMPACTION_UNITTEST_POINTS; i++) {
+            NETDATA_DOUBLE n = compaction_unittest_value(p, i);
+            pgd_append_point(pgd, 0, n, n, n, 1, 0, isnan(n) ? SN_EMPTY_SLOT : SN_DEFAULT_FLAGS, i);
+        }
+
+        PGD *disk = compaction_unittest_page_reload(pgd);
+        pgd_free(pgd);
+
+        pgd_append_page(merged, disk);
+        pgd_free(disk);
+
+        if(pgd_slots_used(merged) != (p + 1) * COMPACTION_UNITTEST_POINTS) {
+            fprintf(stderr, "DBENGINE COMPACTION: merged page has %u points, expected %zu\n",
+                    pgd_slots_used(merged), (p + 1) * COMPACTION_UNITTEST_POINTS);
+            errors++;
+        }
+
+        if(pgd_is_empty(merged) != (p == 0)) {
+            fprintf(stderr, "DBENGINE COMPACTION: merged page is %s after %zu pages\n",
+                    pgd_is_empty(merged) ? "empty" : "not empty", p + 1);
+            errors++;
+        }
+    }
+
+    PGD *disk = compaction_unittest_page_reload(merged);
+    pgd_free(merged);
+
+    PGDC cursor;
+    pgdc_reset(&cursor, disk, 0);
+
+    for(size_t p = 0; p < COMPACTION_UNITTEST_PAGES; p++) {
+        for(size_t i = 0; i < COMPACTION_UNITTEST_POINTS; i++) {
+            STORAGE_POINT sp = STORAGE_POINT_UNSET;
+            uint32_t position = p * COMPACTION_UNITTEST_POINTS + i;
+            bool ok = pgdc_get_next_point(&cursor, position, &sp);
+
+            NETDATA_DOUBLE expected = compaction_unittest_value(p, i);
+            if(!ok || isnan(expected) != isnan(sp.sum) || (!isnan(expected) && fabsndd(sp.sum - expected) > 0.01)) {
+                fprintf(stderr, "DBENGINE COMPACTION: point %u of the merged page is " NETDATA_DOUBLE_FORMAT
+                                ", expected " NETDATA_DOUBLE_FORMAT "\n",
+                        position, sp.sum, expected);
+                errors++;
+            }
+        }
+    }
+
+    pgd_free(disk);
+    return errors;
+}
+
+static void compaction_unittest_file_write(const char *dir, const char *name, const char *contents) {
+    char path[RRDENG_PATH_MAX];
+    snprintfz(path, sizeof(path) - 1, "%s/%s", dir, name);
+
+    FILE *fp = fopen(path, "w");
+    if(!fp)
+        fatal("DBENGINE COMPACTION: cannot create '%s'", path);
+
+    fputs(contents, fp);
+    fclose(fp);
+}
+
+// returns the first line of the file, or "" when it does not exist
+static const char *compaction_unittest_file_read(const char *dir, const char *name, char *buf, size_t size) {
+    char path[RRDENG_PATH_MAX];
+    snprintfz(path, sizeof(path) - 1, "%s/%s", dir, name);
+
+    buf[0] = '\0';
+    FILE *fp = fopen(path, "r");
+    if(fp) {
+        if(!fgets(buf, (int)size, fp))
+            buf[0] = '\0';
+        fclose(fp);
+    }
+
+    return buf;
+}
+
+struct compaction_unittest_files {
+    char datafile[FILENAME_MAX + 1];
+    char journalfile[FILENAME_MAX + 1];
+    char journalfile_v2[FILENAME_MAX + 1];
+    char tmp_datafile[FILENAME_MAX + 1];
+    char tmp_journalfile[FILENAME_MAX + 1];
+};
+
+static void compaction_unittest_files_init(struct compaction_unittest_files *f, unsigned fileno) {
+    snprintfz(f->datafile, FILENAME_MAX, DATAFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL DATAFILE_EXTENSION, 1, fileno);
+    snprintfz(f->journalfile, FILENAME_MAX, WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION, 1, fileno);
+    snprintfz(f->journalfile_v2, FILENAME_MAX, WALFILE_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION_V2, 1, fileno);
+    snprintfz(f->tmp_datafile, FILENAME_MAX, COMPACTION_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL DATAFILE_EXTENSION, 1, fileno);
+    snprintfz(f->tmp_journalfile, FILENAME_MAX, COMPACTION_PREFIX RRDENG_FILE_NUMBER_PRINT_TMPL WALFILE_EXTENSION, 1, fileno);
+}
+
+static size_t compaction_unittest_check(const char *dir, const char *name, const char *expected, const char *what) {
+    char buf[100];
+    const char *found = compaction_unittest_file_read(dir, name, buf, sizeof(buf));
+    if(strcmp(found, expected) != 0) {
+        fprintf(stderr, "DBENGINE COMPACTION: %s: '%s' has '%s', expected '%s'\n",
+                what, name, found, *expected ? expected : "no file");
+        return 1;
+    }
+
+    return 0;
+}
+
+enum compaction_unittest_case {
+    COMPACTION_UNITTEST_COMMITTED = 1,
+    COMPACTION_UNITTEST_COMMITTED_ROTATED,
+    COMPACTION_UNITTEST_JOURNAL_ONLY,
+    COMPACTION_UNITTEST_NOT_COMMITTED,
+    COMPACTION_UNITTEST_NOTHING,
+
+    // the last one
+    COMPACTION_UNITTEST_CASES,
+};
+
+static size_t compaction_unittest_recover(void) {
+    size_t errors = 0;
+
+    fprintf(stderr, "DBENGINE COMPACTION: recovering interrupted compactions\n");
+
+    char dir[] = "/tmp/netdata-compaction-unittest-XXXXXX";
+    if(!mkdtemp(dir))
+        fatal("DBENGINE COMPACTION: cannot create a temporary directory");
+
+    struct rrdengine_instance *ctx = callocz(1, sizeof(*ctx));
+    strncpyz(ctx->config.dbfiles_path, dir, sizeof(ctx->config.dbfiles_path) - 1);
+
+    struct compaction_unittest_files f[COMPACTION_UNITTEST_CASES];
+    for(unsigned c = 1; c < COMPACTION_UNITTEST_CASES; c++)
+        compaction_unittest_files_init(&f[c], c);
+
+    // the new journal renamed over the original one, the new datafile not renamed yet
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_COMMITTED].datafile, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_COMMITTED].journalfile, "new");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_COMMITTED].journalfile_v2, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_COMMITTED].tmp_datafile, "new");
+
+    // as above, but database rotation deleted the source before the restart
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_COMMITTED_ROTATED].tmp_datafile, "new");
+
+    // interrupted while creating the temporary files
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_JOURNAL_ONLY].datafile, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_JOURNAL_ONLY].journalfile, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_JOURNAL_ONLY].tmp_journalfile, "new");
+
+    // interrupted before the commit
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOT_COMMITTED].datafile, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOT_COMMITTED].journalfile, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOT_COMMITTED].journalfile_v2, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOT_COMMITTED].tmp_datafile, "new");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOT_COMMITTED].tmp_journalfile, "new");
+
+    // no compaction
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOTHING].datafile, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOTHING].journalfile, "old");
+    compaction_unittest_file_write(dir, f[COMPACTION_UNITTEST_NOTHING].journalfile_v2, "old");
+
+    compaction_recover(ctx);
+
+    struct compaction_unittest_files *t = &f[COMPACTION_UNITTEST_COMMITTED];
+    errors += compaction_unittest_check(dir, t->datafile, "new", "committed");
+    errors += compaction_unittest_check(dir, t->journalfile, "new", "committed");
+    errors += compaction_unittest_check(dir, t->journalfile_v2, "", "committed");
+    errors += compaction_unittest_check(dir, t->tmp_datafile, "", "committed");
+
+    t = &f[COMPACTION_UNITTEST_COMMITTED_ROTATED];
+    errors += compaction_unittest_check(dir, t->datafile, "", "committed and rotated");
+    errors += compaction_unittest_check(dir, t->journalfile, "", "committed and rotated");
+    errors += compaction_unittest_check(dir, t->tmp_datafile, "", "committed and rotated");
+
+    t = &f[COMPACTION_UNITTEST_JOURNAL_ONLY];
+    errors += compaction_unittest_check(dir, t->datafile, "old", "temporary journal only");
+    errors += compaction_unittest_check(dir, t->journalfile, "old", "temporary journal only");
+    errors += compaction_unittest_check(dir, t->tmp_journalfile, "", "temporary journal only");
+
+    t = &f[COMPACTION_UNITTEST_NOT_COMMITTED];
+    errors += compaction_unittest_check(dir, t->datafile, "old", "not committed");
+    errors += compaction_unittest_check(dir, t->journalfile, "old", "not committed");
+    errors += compaction_unittest_check(dir, t->journalfile_v2, "old", "not committed");
+    errors += compaction_unittest_check(dir, t->tmp_datafile, "", "not committed");
+    errors += compaction_unittest_check(dir, t->tmp_journalfile, "", "not committed");
+
+    t = &f[COMPACTION_UNITTEST_NOTHING];
+    errors += compaction_unittest_check(dir, t->datafile, "old", "no compaction");
+    errors += compaction_unittest_check(dir, t->journalfile, "old", "no compaction");
+    errors += compaction_unittest_check(dir, t->journalfile_v2, "old", "no compaction");
+
+    for(unsigned c = 1; c < COMPACTION_UNITTEST_CASES; c++) {
+        const char *names[] = { f[c].datafile, f[c].journalfile, f[c].journalfile_v2, f[c].tmp_datafile, f[c].tmp_journalfile };
+        for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+            char path[RRDENG_PATH_MAX];
+            snprintfz(path, sizeof(path) - 1, "%s/%s", dir, names[i]);
+            unlink(path);
+        }
+    }
+    rmdir(dir);
+
+    freez(ctx);
+    return errors;
+}
+
+int compaction_unittest(void) {
+    // the page allocators
+    if(!rrdeng_dbengine_spawn(NULL))
+        fatal("DBENGINE COMPACTION: cannot initialize dbengine");
+
+    size_t errors = 0;
+    errors += compaction_unittest_merge(RRDENG_PAGE_TYPE_ARRAY_32BIT);
+    errors += compaction_unittest_merge(RRDENG_PAGE_TYPE_ARRAY_TIER1);
+    errors += compaction_unittest_merge(RRDENG_PAGE_TYPE_GORILLA_32BIT);
+    errors += compaction_unittest_recover();
+
+    fprintf(stderr, "DBENGINE COMPACTION: %zu errors\n", errors);
+    return errors ? 1 : 0;
+}
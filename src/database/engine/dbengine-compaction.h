@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_COMPACTION_H
+#define NETDATA_DBENGINE_COMPACTION_H
+
+#define COMPACTION_PREFIX "compaction-"
+
+struct rrdengine_instance;
+
+// on startup, before scanning the datafiles
+// completes or rolls back a compaction that was interrupted
+void compaction_recover(struct rrdengine_instance *ctx);
+
+// returns true when the tier has a datafile that has not been compacted yet
+bool compaction_candidate_exists(struct rrdengine_instance *ctx);
+
+// rewrite the oldest datafile of the tier that has not been compacted yet
+// returns true when a datafile has been replaced
+bool compaction_run(struct rrdengine_instance *ctx);
+
+int compaction_unittest(void);
+
+#endif //NETDATA_DBENGINE_COMPACTION_H
@@ -0,0 +1,527 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "rrdengine.h"
+#include "dbengine-mrg-snapshot.h"
+
+// ----------------------------------------------------------------------------
+// MRG retention snapshot
+//
+// On startup, the retention of all metrics is loaded to the MRG by walking
+// the metric lists of all journal v2 files of each tier. On big parents this
+// means touching tens of GiB of journal files before the agent is ready.
+//
+// The snapshot is the result of this walk, for the journal v2 files that
+// exist when it is written: one entry per metric, with its merged first time,
+// last time and update every, sorted by uuid. It is written periodically and
+// on clean shutdown, next to the datafiles of each tier, and it is mmap()ed on
+// startup. The journal files it covers are marked as populated, so that only
+// the journal files created after it are walked.
+//
+// The snapshot is rejected (and all journal files are walked) when any of the
+// journal files it covers is missing or different. This includes the oldest
+// ones being rotated: the snapshot has only the merged first time of each
+// metric, so the first time found in the remaining journal files cannot be
+// recomputed from it.
+
+bool dbengine_mrg_snapshot_enabled = true;
+time_t dbengine_mrg_snapshot_every_s = 3600;
+
+#define MRG_SNAPSHOT_MAGIC      0x534e474d // "MGNS"
+#define MRG_SNAPSHOT_VERSION    1
+
+// entries applied to the MRG by each worker at a time
+#define MRG_SNAPSHOT_CHUNK      16384
+
+// entries buffered before each write()
+#define MRG_SNAPSHOT_WRITE_BUFFER 4096
+
+struct mrg_snapshot_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t tier;
+    uint32_t journals;              // the number of journal v2 files covered
+    uint64_t metrics;               // the number of metric entries
+    usec_t created_ut;
+    uint32_t metric_size;           // sizeof(struct mrg_snapshot_metric)
+    uint32_t crc;                   // crc32 of everything following the header
+};
+
+struct mrg_snapshot_journal {
+    uint32_t fileno;
+    uint32_t metrics;
+    int64_t first_time_s;
+    int64_t last_time_s;
+};
+
+struct mrg_snapshot_metric {
+    nd_uuid_t uuid;
+    int64_t first_time_s;
+    int64_t last_time_s;
+    uint32_t update_every_s;
+    uint32_t reserved;
+};
+
+struct mrg_snapshot {
+    void *data;
+    size_t size;
+
+    const struct mrg_snapshot_metric *metrics;
+    size_t entries;
+
+    size_t next;                    // atomic - the next entry to be applied
+    time_t now_s;
+};
+
+static void mrg_snapshot_generate_path(struct rrdengine_instance *ctx, char *str, size_t maxlen, bool tmp) {
+    (void) snprintfz(str, maxlen, "%s/" MRG_SNAPSHOT_FILENAME "%s", ctx->config.dbfiles_path, tmp ? ".tmp" : "");
+}
+
+static uint64_t mrg_snapshot_signature(const struct mrg_snapshot_journal *journals, size_t count) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef *)journals, count * sizeof(*journals));
+    return ((uint64_t)count << 32) | (uint64_t)(uint32_t)crc;
+}
+
+// ----------------------------------------------------------------------------
+// loading
+
+static void mrg_snapshot_reject(struct rrdengine_instance *ctx, const char *path, const char *reason) {
+    nd_log(NDLS_DAEMON, NDLP_NOTICE,
+           "DBENGINE: retention snapshot '%s' of tier %d cannot be used (%s), "
+           "retention will be loaded from all journal files",
+           path, ctx->config.tier, reason);
+}
+
+bool mrg_snapshot_load(struct rrdengine_instance *ctx) {
+    if(!dbengine_mrg_snapshot_enabled)
+        return false;
+
+    char path[RRDENG_PATH_MAX];
+    mrg_snapshot_generate_path(ctx, path, sizeof(path), false);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(struct mrg_snapshot_header)) {
+        close(fd);
+        mrg_snapshot_reject(ctx, path, "file is too small");
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(data == MAP_FAILED) {
+        mrg_snapshot_reject(ctx, path, "cannot mmap() it");
+        return false;
+    }
+
+    const char *reason = NULL;
+    struct rrdengine_datafile **covered = NULL;
+    const struct mrg_snapshot_header *header = data;
+    const struct mrg_snapshot_journal *journals = (const struct mrg_snapshot_journal *)(header + 1);
+    const struct mrg_snapshot_metric *metrics = (const struct mrg_snapshot_metric *)(journals + header->journals);
+
+    if(header->magic != MRG_SNAPSHOT_MAGIC || header->version != MRG_SNAPSHOT_VERSION ||
+        header->metric_size != sizeof(struct mrg_snapshot_metric)) {
+        reason = "unknown format";
+        goto cleanup;
+    }
+
+    if(header->tier != (uint32_t)ctx->config.tier) {
+        reason = "it belongs to another tier";
+        goto cleanup;
+    }
+
+    if(header->metrics > size / sizeof(*metrics) ||
+        sizeof(*header) + header->journals * sizeof(*journals) + header->metrics * sizeof(*metrics) != size) {
+        reason = "wrong file size";
+        goto cleanup;
+    }
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (const Bytef *)journals, size - sizeof(*header));
+    if((uint32_t)crc != header->crc) {
+        reason = "wrong checksum";
+        goto cleanup;
+    }
+
+    // match the journal files covered by the snapshot to the datafiles we have
+    // both lists are ordered by fileno
+
+    covered = callocz(header->journals ? header->journals : 1, sizeof(*covered));
+    size_t matched = 0;
+    time_t global_first_time_s = LONG_MAX;
+
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    struct rrdengine_datafile *df = ctx->datafiles.first;
+    for(size_t i = 0; i < header->journals && !reason; i++) {
+        const struct mrg_snapshot_journal *j = &journals[i];
+
+        if(!ctx->datafiles.first || j->fileno < ctx->datafiles.first->fileno) {
+            reason = "the oldest journal files it covers have been rotated";
+            break;
+        }
+
+        while(df && df->fileno < j->fileno)
+            df = df->next;
+
+        if(!df || df->fileno != j->fileno)
+            reason = "a journal file it covers is missing";
+
+        else if(!(df->journalfile->v2.flags & JOURNALFILE_FLAG_IS_AVAILABLE) ||
+                 df->journalfile->v2.first_time_s != (time_t)j->first_time_s ||
+                 df->journalfile->v2.last_time_s != (time_t)j->last_time_s)
+            reason = "a journal file it covers has changed";
+
+        else {
+            covered[matched++] = df;
+            global_first_time_s = MIN(global_first_time_s, df->journalfile->v2.first_time_s);
+        }
+    }
+
+    if(!reason) {
+        // nobody else runs on this tier yet
+        for(size_t i = 0; i < matched; i++)
+            covered[i]->populate_mrg.populated = true;
+    }
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    if(reason)
+        goto cleanup;
+
+    time_t old = __atomic_load_n(&ctx->atomic.first_time_s, __ATOMIC_RELAXED);
+    do {
+        if(old <= global_first_time_s)
+            break;
+    } while(!__atomic_compare_exchange_n(&ctx->atomic.first_time_s, &old, global_first_time_s, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    struct mrg_snapshot *s = callocz(1, sizeof(*s));
+    s->data = data;
+    s->size = size;
+    s->metrics = metrics;
+    s->entries = header->metrics;
+    s->next = 0;
+    s->now_s = max_acceptable_collected_time();
+    ctx->loading.mrg_snapshot = s;
+
+    // when nothing has changed since, there is no need to write it again
+    ctx->mrg_snapshot.signature = mrg_snapshot_signature(journals, header->journals);
+
+    madvise_sequential(data, size);
+
+    nd_log(NDLS_DAEMON, NDLP_INFO,
+           "DBENGINE: tier %d loading retention of %"PRIu64" metrics from snapshot '%s', "
+           "covering %zu journal files",
+           ctx->config.tier, header->metrics, path, matched);
+
+    freez(covered);
+    return true;
+
+cleanup:
+    freez(covered);
+    munmap(data, size);
+    mrg_snapshot_reject(ctx, path, reason);
+    return false;
+}
+
+void mrg_snapshot_populate(struct rrdengine_instance *ctx) {
+    struct mrg_snapshot *s = ctx->loading.mrg_snapshot;
+    if(!s)
+        return;
+
+    while(true) {
+        size_t start = __atomic_fetch_add(&s->next, MRG_SNAPSHOT_CHUNK, __ATOMIC_RELAXED);
+        if(start >= s->entries)
+            break;
+
+        size_t end = MIN(start + MRG_SNAPSHOT_CHUNK, s->entries);
+        for(size_t i = start; i < end; i++) {
+            const struct mrg_snapshot_metric *m = &s->metrics[i];
+            mrg_update_metric_retention_and_granularity_by_uuid(
+                main_mrg, (Word_t)ctx, (nd_uuid_t *)&m->uuid,
+                (time_t)m->first_time_s, (time_t)m->last_time_s, m->update_every_s, s->now_s);
+        }
+    }
+}
+
+void mrg_snapshot_unload(struct rrdengine_instance *ctx) {
+    struct mrg_snapshot *s = ctx->loading.mrg_snapshot;
+    if(!s)
+        return;
+
+    ctx->loading.mrg_snapshot = NULL;
+    munmap(s->data, s->size);
+    freez(s);
+}
+
+// ----------------------------------------------------------------------------
+// saving
+//
+// The metric lists of journal v2 files are sorted by uuid, so the snapshot is
+// a k-way merge of them. The MRG itself is not touched, so writing a snapshot
+// does not interfere with data collection and queries.
+
+struct mrg_snapshot_source {
+    struct rrdengine_datafile *datafile;
+    struct journal_metric_list *metric;
+    uint32_t remaining;
+    time_t start_time_s;
+};
+
+static inline int mrg_snapshot_source_cmp(struct mrg_snapshot_source *sources, uint32_t a, uint32_t b) {
+    return memcmp(&sources[a].metric->uuid, &sources[b].metric->uuid, sizeof(nd_uuid_t));
+}
+
+static void mrg_snapshot_heap_down(struct mrg_snapshot_source *sources, uint32_t *heap, size_t size, size_t i) {
+    while(true) {
+        size_t left = 2 * i + 1, right = left + 1, smallest = i;
+
+        if(left < size && mrg_snapshot_source_cmp(sources, heap[left], heap[smallest]) < 0)
+            smallest = left;
+
+        if(right < size && mrg_snapshot_source_cmp(sources, heap[right], heap[smallest]) < 0)
+            smallest = right;
+
+        if(smallest == i)
+            break;
+
+        uint32_t t = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = t;
+        i = smallest;
+    }
+}
+
+static bool mrg_snapshot_write(int fd, const void *buf, size_t len, uLong *crc) {
+    if(crc)
+        *crc = crc32(*crc, buf, len);
+
+    const char *s = buf;
+    while(len) {
+        ssize_t rc = write(fd, s, len);
+        if(rc < 0) {
+            if(errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        s += rc;
+        len -= rc;
+    }
+
+    return true;
+}
+
+bool mrg_snapshot_save(struct rrdengine_instance *ctx) {
+    if(!dbengine_mrg_snapshot_enabled || !__atomic_load_n(&ctx->mrg_snapshot.ready, __ATOMIC_ACQUIRE))
+        return false;
+
+    bool expected = false;
+    if(!__atomic_compare_exchange_n(&ctx->mrg_snapshot.running, &expected, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return false;
+
+    usec_t started_ut = now_monotonic_usec();
+    bool ret = false;
+    int fd = -1;
+    char path[RRDENG_PATH_MAX], tmp_path[RRDENG_PATH_MAX];
+    mrg_snapshot_generate_path(ctx, path, sizeof(path), false);
+    mrg_snapshot_generate_path(ctx, tmp_path, sizeof(tmp_path), true);
+
+    // acquire all the datafiles that have a journal v2 file, so that they cannot be deleted while we work
+
+    uv_rwlock_rdlock(&ctx->datafiles.rwlock);
+    size_t datafiles = 0;
+    for(struct rrdengine_datafile *df = ctx->datafiles.first; df ; df = df->next)
+        datafiles++;
+
+    struct mrg_snapshot_source *sources = callocz(datafiles ? datafiles : 1, sizeof(*sources));
+    size_t used = 0;
+    for(struct rrdengine_datafile *df = ctx->datafiles.first; df && used < datafiles ; df = df->next) {
+        if(!(df->journalfile->v2.flags & JOURNALFILE_FLAG_IS_AVAILABLE))
+            continue;
+
+        if(datafile_acquire(df, DATAFILE_ACQUIRE_RETENTION))
+            sources[used++].datafile = df;
+    }
+    uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
+
+    struct mrg_snapshot_journal *journals = callocz(used ? used : 1, sizeof(*journals));
+    size_t count = 0;
+    for(size_t i = 0; i < used ; i++) {
+        struct rrdengine_datafile *df = sources[i].datafile;
+        struct journal_v2_header *j2_header = journalfile_v2_data_acquire(df->journalfile, NULL, 0, 0);
+        if(!j2_header) {
+            datafile_release(df, DATAFILE_ACQUIRE_RETENTION);
+            continue;
+        }
+
+        sources[count] = (struct mrg_snapshot_source) {
+            .datafile = df,
+            .metric = (struct journal_metric_list *)((uint8_t *)j2_header + j2_header->metric_offset),
+            .remaining = j2_header->metric_count,
+            .start_time_s = (time_t)(j2_header->start_time_ut / USEC_PER_SEC),
+        };
+
+        journals[count] = (struct mrg_snapshot_journal) {
+            .fileno = df->fileno,
+            .metrics = j2_header->metric_count,
+            .first_time_s = df->journalfile->v2.first_time_s,
+            .last_time_s = df->journalfile->v2.last_time_s,
+        };
+
+        count++;
+    }
+
+    uint64_t signature = mrg_snapshot_signature(journals, count);
+    if(signature == ctx->mrg_snapshot.signature && access(path, F_OK) == 0) {
+        // the snapshot on disk covers the same journal files
+        ctx->mrg_snapshot.last_saved_s = now_realtime_sec();
+        ret = true;
+        goto cleanup;
+    }
+
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0664);
+    if(fd == -1) {
+        netdata_log_error("DBENGINE: cannot create retention snapshot '%s'", tmp_path);
+        ctx_fs_error(ctx);
+        goto cleanup;
+    }
+
+    struct mrg_snapshot_header header = {
+        .magic = MRG_SNAPSHOT_MAGIC,
+        .version = MRG_SNAPSHOT_VERSION,
+        .tier = (uint32_t)ctx->config.tier,
+        .journals = (uint32_t)count,
+        .metrics = 0,
+        .created_ut = now_realtime_usec(),
+        .metric_size = sizeof(struct mrg_snapshot_metric),
+        .crc = 0,
+    };
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    if(!mrg_snapshot_write(fd, &header, sizeof(header), NULL) ||
+        !mrg_snapshot_write(fd, journals, count * sizeof(*journals), &crc))
+        goto write_failed;
+
+    // the k-way merge
+
+    uint32_t *heap = mallocz((count ? count : 1) * sizeof(*heap));
+    size_t heap_size = 0;
+    for(size_t i = 0; i < count ; i++)
+        if(sources[i].remaining)
+            heap[heap_size++] = (uint32_t)i;
+
+    for(size_t i = heap_size / 2; i > 0 ; i--)
+        mrg_snapshot_heap_down(sources, heap, heap_size, i - 1);
+
+    struct mrg_snapshot_metric *buffer = mallocz(MRG_SNAPSHOT_WRITE_BUFFER * sizeof(*buffer));
+    size_t buffered = 0;
+    bool have_current = false, failed = false;
+    struct mrg_snapshot_metric current = { 0 };
+
+    while(heap_size && !failed) {
+        struct mrg_snapshot_source *src = &sources[heap[0]];
+        time_t first_time_s = src->start_time_s + src->metric->delta_start_s;
+        time_t last_time_s = src->start_time_s + src->metric->delta_end_s;
+        uint32_t update_every_s = src->metric->update_every_s;
+
+        if(have_current && memcmp(&current.uuid, &src->metric->uuid, sizeof(nd_uuid_t)) == 0) {
+            if(first_time_s < current.first_time_s)
+                current.first_time_s = first_time_s;
+
+            // the update every follows the latest data, like in the MRG
+            if(last_time_s > current.last_time_s || (last_time_s == current.last_time_s && !current.update_every_s)) {
+                current.last_time_s = last_time_s;
+                current.update_every_s = update_every_s;
+            }
+        }
+        else {
+            if(have_current) {
+                buffer[buffered++] = current;
+                header.metrics++;
+
+                if(buffered == MRG_SNAPSHOT_WRITE_BUFFER) {
+                    failed = !mrg_snapshot_write(fd, buffer, buffered * sizeof(*buffer), &crc);
+                    buffered = 0;
+                }
+            }
+
+            memset(&current, 0, sizeof(current));
+            uuid_copy(current.uuid, src->metric->uuid);
+            current.first_time_s = first_time_s;
+            current.last_time_s = last_time_s;
+            current.update_every_s = update_every_s;
+            have_current = true;
+        }
+
+        src->metric++;
+        if(!--src->remaining)
+            heap[0] = heap[--heap_size];
+
+        mrg_snapshot_heap_down(sources, heap, heap_size, 0);
+    }
+
+    if(have_current && !failed) {
+        buffer[buffered++] = current;
+        header.metrics++;
+    }
+
+    if(buffered && !failed)
+        failed = !mrg_snapshot_write(fd, buffer, buffered * sizeof(*buffer), &crc);
+
+    freez(buffer);
+    freez(heap);
+
+    if(failed)
+        goto write_failed;
+
+    header.crc = (uint32_t)crc;
+    if(pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) || fsync(fd) == -1)
+        goto write_failed;
+
+    close(fd);
+    fd = -1;
+
+    if(rename(tmp_path, path) == -1) {
+        netdata_log_error("DBENGINE: cannot rename retention snapshot '%s' to '%s'", tmp_path, path);
+        ctx_fs_error(ctx);
+        unlink(tmp_path);
+        goto cleanup;
+    }
+
+    ctx->mrg_snapshot.signature = signature;
+    ctx->mrg_snapshot.last_saved_s = now_realtime_sec();
+    ret = true;
+
+    nd_log(NDLS_DAEMON, NDLP_INFO,
+           "DBENGINE: tier %d retention snapshot saved, %"PRIu64" metrics from %zu journal files, %0.2f MiB, %0.2f ms",
+           ctx->config.tier, header.metrics, count,
+           (double)(sizeof(header) + count * sizeof(*journals) + header.metrics * sizeof(struct mrg_snapshot_metric)) / 1024.0 / 1024.0,
+           (double)(now_monotonic_usec() - started_ut) / USEC_PER_MS);
+
+    goto cleanup;
+
+write_failed:
+    netdata_log_error("DBENGINE: cannot write retention snapshot '%s'", tmp_path);
+    ctx_io_error(ctx);
+    close(fd);
+    fd = -1;
+    unlink(tmp_path);
+
+cleanup:
+    for(size_t i = 0; i < count ; i++) {
+        journalfile_v2_data_release(sources[i].datafile->journalfile);
+        datafile_release(sources[i].datafile, DATAFILE_ACQUIRE_RETENTION);
+    }
+
+    freez(journals);
+    freez(sources);
+
+    __atomic_store_n(&ctx->mrg_snapshot.running, false, __ATOMIC_RELEASE);
+    return ret;
+}
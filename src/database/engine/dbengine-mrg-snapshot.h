@@ -0,0 +1,23 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_DBENGINE_MRG_SNAPSHOT_H
+#define NETDATA_DBENGINE_MRG_SNAPSHOT_H
+
+#define MRG_SNAPSHOT_FILENAME "mrg-snapshot.db"
+
+struct rrdengine_instance;
+
+// on startup, before populating the MRG from the journal files
+// returns true when a snapshot has been loaded and the journal files it covers have been marked as populated
+bool mrg_snapshot_load(struct rrdengine_instance *ctx);
+
+// run by each of the populate MRG workers, until all the loaded entries have been applied to the MRG
+void mrg_snapshot_populate(struct rrdengine_instance *ctx);
+
+// release a loaded snapshot, after all the populate MRG workers have finished
+void mrg_snapshot_unload(struct rrdengine_instance *ctx);
+
+// write a new snapshot covering all the journal v2 files of the tier
+bool mrg_snapshot_save(struct rrdengine_instance *ctx);
+
+#endif //NETDATA_DBENGINE_MRG_SNAPSHOT_H
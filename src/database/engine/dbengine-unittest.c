@@ -353,6 +353,37 @@ static size_t dbengine_test_rrdr_single_region(
     return errors + value_errors + time_errors + update_every_errors;
 }
 
+// Replaces the indexed datafiles with compacted ones, returns the number of datafiles replaced
+static size_t test_dbengine_compact_datafiles(struct rrdengine_instance *ctx) {
+    fprintf(stderr, "DBENGINE Compaction of the datafiles...\n");
+
+    bool enabled = dbengine_compaction_enabled;
+    size_t io_budget_mb = dbengine_compaction_io_budget_mb;
+    int min_savings_percent = dbengine_compaction_min_savings_percent;
+
+    // unthrottled, and replacing the datafiles even when they do not shrink
+    dbengine_compaction_enabled = true;
+    dbengine_compaction_io_budget_mb = 0;
+    dbengine_compaction_min_savings_percent = -100;
+
+    // wait for the journal indexer
+    for(size_t i = 0; i < 60 && !compaction_candidate_exists(ctx); i++)
+        sleep_usec(USEC_PER_SEC);
+
+    size_t replaced = 0;
+    while(compaction_candidate_exists(ctx)) {
+        if(compaction_run(ctx))
+            replaced++;
+    }
+
+    dbengine_compaction_enabled = enabled;
+    dbengine_compaction_io_budget_mb = io_budget_mb;
+    dbengine_compaction_min_savings_percent = min_savings_percent;
+
+    fprintf(stderr, "DBENGINE Compaction replaced %zu datafiles\n", replaced);
+    return replaced;
+}
+
 int test_dbengine(void) {
     // provide enough threads to dbengine
     setenv("UV_THREADPOOL_SIZE", "48", 1);
@@ -407,6 +438,15 @@ int test_dbengine(void) {
         errors += dbengine_test_rrdr_single_region(st, rd, current_region, time_start[current_region], time_end[current_region]);
     }
 
+    // the compacted datafiles should return exactly the same data
+    if(!test_dbengine_compact_datafiles((struct rrdengine_instance *)host->db[0].si)) {
+        fprintf(stderr, "DBENGINE compaction did not replace any datafile\n");
+        errors++;
+    }
+
+    for(size_t current_region = 0; current_region < REGIONS ;current_region++)
+        errors += test_dbengine_check_metrics(st, rd, current_region, time_start[current_region], time_end[current_region]);
+
     rrd_wrlock();
     rrdeng_prepare_exit((struct rrdengine_instance *)host->db[0].si);
     rrdeng_exit((struct rrdengine_instance *)host->db[0].si);
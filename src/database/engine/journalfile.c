@@ -58,6 +58,84 @@ void journalfile_v1_extent_write(struct rrdengine_instance *ctx, struct rrdengin
 
     ctx_current_disk_space_increase(ctx, wal->buf_size);
     ctx_io_write_op_bytes(ctx, wal->buf_size);
+    __atomic_add_fetch(&rrdeng_extent_write_stats.journal_writes, 1, __ATOMIC_RELAXED);
+}
+
+struct journal_v1_write_batch {
+    uv_fs_t req;
+    struct rrdengine_instance *ctx;
+    size_t count;
+    WAL **wals;
+    uv_buf_t *iovs;
+};
+
+static void after_extent_write_journalfile_v1_batch_io(uv_fs_t* req)
+{
+    worker_is_busy(RRDENG_FLUSH_TRANSACTION_BUFFER_CB);
+
+    struct journal_v1_write_batch *batch = req->data;
+    struct rrdengine_instance *ctx = batch->ctx;
+
+    if (req->result < 0) {
+        ctx_io_error(ctx);
+        netdata_log_error("DBENGINE: %s: uv_fs_write: %s", __func__, uv_strerror((int)req->result));
+    }
+
+    uv_fs_req_cleanup(req);
+
+    for(size_t i = 0; i < batch->count ;i++)
+        wal_release(batch->wals[i]);
+
+    __atomic_sub_fetch(&ctx->atomic.extents_currently_being_flushed, batch->count, __ATOMIC_RELAXED);
+
+    freez(batch->wals);
+    freez(batch->iovs);
+    freez(batch);
+
+    worker_is_idle();
+}
+
+// append the transactions of many extents to the journal with a single write
+void journalfile_v1_extent_write_batch(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile, WAL **wals, size_t count, uv_loop_t *loop)
+{
+    if(count == 1) {
+        journalfile_v1_extent_write(ctx, datafile, wals[0], loop);
+        return;
+    }
+
+    struct rrdengine_journalfile *journalfile = datafile->journalfile;
+    struct journal_v1_write_batch *batch = callocz(1, sizeof(*batch));
+    batch->ctx = ctx;
+    batch->count = count;
+    batch->wals = mallocz(count * sizeof(*batch->wals));
+    batch->iovs = mallocz(count * sizeof(*batch->iovs));
+
+    size_t bytes = 0;
+    for(size_t i = 0; i < count ;i++) {
+        WAL *wal = wals[i];
+        if (wal->size < wal->buf_size) {
+            /* simulate an empty transaction to skip the rest of the block */
+            *(uint8_t *) (wal->buf + wal->size) = STORE_PADDING;
+        }
+
+        batch->wals[i] = wal;
+        batch->iovs[i] = uv_buf_init((void *)wal->buf, wal->buf_size);
+        bytes += wal->buf_size;
+    }
+
+    spinlock_lock(&journalfile->unsafe.spinlock);
+    uint64_t pos = journalfile->unsafe.pos;
+    journalfile->unsafe.pos += bytes;
+    spinlock_unlock(&journalfile->unsafe.spinlock);
+
+    batch->req.data = batch;
+    int ret = uv_fs_write(loop, &batch->req, journalfile->file, batch->iovs, (unsigned int)count,
+                          (int64_t)pos, after_extent_write_journalfile_v1_batch_io);
+    fatal_assert(-1 != ret);
+
+    ctx_current_disk_space_increase(ctx, bytes);
+    ctx_io_write_op_bytes(ctx, bytes);
+    __atomic_add_fetch(&rrdeng_extent_write_stats.journal_writes, 1, __ATOMIC_RELAXED);
 }
 
 void journalfile_v2_generate_path(struct rrdengine_datafile *datafile, char *str, size_t maxlen)
@@ -402,6 +480,9 @@ size_t journalfile_v2_data_size_get(struct rrdengine_journalfile *journalfile) {
     return data_size;
 }
 
+static uint32_t journalfile_v2_page_summaries_offset(struct journal_v2_header *j2_header);
+static void journalfile_v2_metric_index_set(struct rrdengine_journalfile *journalfile, struct journal_v2_header *j2_header);
+
 void journalfile_v2_data_set(struct rrdengine_journalfile *journalfile, int fd, void *journal_data, uint32_t journal_data_size) {
     spinlock_lock(&journalfile->mmap.spinlock);
     spinlock_lock(&journalfile->v2.spinlock);
@@ -420,6 +501,9 @@ void journalfile_v2_data_set(struct rrdengine_journalfile *journalfile, int fd,
     journalfile->v2.first_time_s = (time_t)(j2_header->start_time_ut / USEC_PER_SEC);
     journalfile->v2.last_time_s = (time_t)(j2_header->end_time_ut / USEC_PER_SEC);
     journalfile->v2.size_of_directory = j2_header->metric_offset + j2_header->metric_count * sizeof(struct journal_metric_list);
+    journalfile->v2.summaries_offset = journalfile_v2_page_summaries_offset(j2_header);
+
+    journalfile_v2_metric_index_set(journalfile, j2_header);
 
     journalfile_v2_mounted_data_unmount(journalfile, true, true);
 
@@ -727,7 +811,7 @@ static void journalfile_restore_extent_metadata(struct rrdengine_instance *ctx,
         pgc_open_add_hot_page(
                 (Word_t)ctx, metric_id, vd.start_time_s, vd.end_time_s, vd.update_every_s,
                 journalfile->datafile,
-                jf_metric_data->extent_offset, jf_metric_data->extent_size, jf_metric_data->descr[i].page_length);
+                jf_metric_data->extent_offset, jf_metric_data->extent_size, jf_metric_data->descr[i].page_length, NULL);
 
         extent_first_time_s = MIN(extent_first_time_s, vd.start_time_s);
 
@@ -893,6 +977,200 @@ static int journalfile_check_v2_metric_list(void *data_start, size_t file_size)
     return 0;
 }
 
+// returns the offset of the page summaries of a journal v2 file, or 0 when the file does not have them
+static uint32_t journalfile_v2_page_summaries_offset(struct journal_v2_header *j2_header)
+{
+    struct journal_v2_summary_header *j2_summary_header = journalfile_v2_summary_header(j2_header);
+
+    if (j2_summary_header->magic != JOURVAL_V2_SUMMARY_MAGIC || j2_summary_header->page_count != j2_header->page_count)
+        return 0;
+
+    if (j2_summary_header->summary_offset < j2_header->page_offset ||
+        j2_summary_header->summary_trailer_offset != j2_summary_header->summary_offset + j2_header->page_count * sizeof(struct rrdeng_page_summary) ||
+        j2_summary_header->summary_trailer_offset + 2 * sizeof(struct journal_v2_block_trailer) > j2_header->journal_v2_file_size)
+        return 0;
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (void *) j2_summary_header, offsetof(struct journal_v2_summary_header, crc));
+    if (j2_summary_header->crc != (uint32_t) crc)
+        return 0;
+
+    return j2_summary_header->summary_offset;
+}
+
+// returns the page summaries of a journal v2 file, or NULL when the file does not have them
+// the summaries header has been checked when the file was loaded
+struct rrdeng_page_summary *journalfile_v2_page_summaries(struct rrdengine_journalfile *journalfile, struct journal_v2_header *j2_header)
+{
+    if (!journalfile->v2.summaries_offset)
+        return NULL;
+
+    return (struct rrdeng_page_summary *)((uint8_t *) j2_header + journalfile->v2.summaries_offset);
+}
+
+static void journalfile_v2_page_summaries_header_set(void *data_start, uint32_t page_count, uint32_t summary_offset, uint32_t summary_trailer_offset)
+{
+    struct journal_v2_block_trailer *journal_v2_trailer = (struct journal_v2_block_trailer *)((uint8_t *) data_start + summary_trailer_offset);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (uint8_t *) data_start + summary_offset, page_count * sizeof(struct rrdeng_page_summary));
+    crc32set(journal_v2_trailer->checksum, crc);
+
+    struct journal_v2_summary_header *j2_summary_header = journalfile_v2_summary_header(data_start);
+    j2_summary_header->magic = JOURVAL_V2_SUMMARY_MAGIC;
+    j2_summary_header->page_count = page_count;
+    j2_summary_header->summary_offset = summary_offset;
+    j2_summary_header->summary_trailer_offset = summary_trailer_offset;
+    crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (void *) j2_summary_header, offsetof(struct journal_v2_summary_header, crc));
+    j2_summary_header->crc = crc;
+}
+
+static int journalfile_check_v2_page_summaries(void *data_start)
+{
+    struct journal_v2_header *j2_header = (void *) data_start;
+    uint32_t summaries_offset = journalfile_v2_page_summaries_offset(j2_header);
+
+    // files without summaries are valid
+    if (!summaries_offset)
+        return 0;
+
+    struct rrdeng_page_summary *summaries = (struct rrdeng_page_summary *)((uint8_t *) data_start + summaries_offset);
+
+    struct journal_v2_block_trailer *journal_v2_trailer =
+        (void *) ((uint8_t *) data_start + journalfile_v2_summary_header(j2_header)->summary_trailer_offset);
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (void *) summaries, j2_header->page_count * sizeof(struct rrdeng_page_summary));
+
+    int rc = crc32cmp(journal_v2_trailer->checksum, crc);
+    if (unlikely(rc))
+        netdata_log_error("DBENGINE: page summaries CRC32 check: FAILED");
+
+    return rc;
+}
+
+// returns the slots of the metric index of a journal v2 file, or NULL when the file does not have one we can use
+static struct journal_metric_index_slot *journalfile_v2_metric_index(struct journal_v2_header *j2_header, uint32_t *slots)
+{
+    struct journal_v2_metric_index_header *j2_index_header = journalfile_v2_metric_index_header(j2_header);
+
+    if (j2_index_header->magic != JOURVAL_V2_METRIC_INDEX_MAGIC || j2_index_header->version != JOURVAL_V2_METRIC_INDEX_VERSION)
+        return NULL;
+
+    uint32_t n = j2_index_header->slots;
+    if (!n || (n & (n - 1)) || n / 2 < j2_header->metric_count)
+        return NULL;
+
+    if (j2_index_header->index_offset < j2_header->page_offset ||
+        (uint64_t) j2_index_header->index_trailer_offset != (uint64_t) j2_index_header->index_offset + (uint64_t) n * sizeof(struct journal_metric_index_slot) ||
+        (uint64_t) j2_index_header->index_trailer_offset + 2 * sizeof(struct journal_v2_block_trailer) > j2_header->journal_v2_file_size)
+        return NULL;
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (void *) j2_index_header, offsetof(struct journal_v2_metric_index_header, crc));
+    if (j2_index_header->crc != (uint32_t) crc)
+        return NULL;
+
+    *slots = n;
+    return (struct journal_metric_index_slot *)((uint8_t *) j2_header + j2_index_header->index_offset);
+}
+
+// keep the metric index of a journal v2 file, so that lookups do not need to check it again
+static void journalfile_v2_metric_index_set(struct rrdengine_journalfile *journalfile, struct journal_v2_header *j2_header)
+{
+    uint32_t n = 0;
+    struct journal_metric_index_slot *slots = journalfile_v2_metric_index(j2_header, &n);
+
+    journalfile->v2.metric_index_slots = slots ? n : 0;
+    journalfile->v2.metric_index_offset = slots ? (uint32_t)((uint8_t *) slots - (uint8_t *) j2_header) : 0;
+}
+
+static void journalfile_v2_metric_index_add(struct journal_metric_index_slot *slots, uint32_t n, uint64_t hash, uint32_t metric)
+{
+    uint32_t slot = (uint32_t) hash & (n - 1);
+    while (slots[slot].metric)
+        slot = (slot + 1) & (n - 1);
+
+    slots[slot].hash = (uint32_t)(hash >> 32);
+    slots[slot].metric = metric;
+}
+
+static void journalfile_v2_metric_index_header_set(void *data_start, uint32_t n, uint32_t index_offset, uint32_t index_trailer_offset)
+{
+    struct journal_v2_block_trailer *journal_v2_trailer = (struct journal_v2_block_trailer *)((uint8_t *) data_start + index_trailer_offset);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (uint8_t *) data_start + index_offset, n * sizeof(struct journal_metric_index_slot));
+    crc32set(journal_v2_trailer->checksum, crc);
+
+    struct journal_v2_metric_index_header *j2_index_header = journalfile_v2_metric_index_header(data_start);
+    j2_index_header->magic = JOURVAL_V2_METRIC_INDEX_MAGIC;
+    j2_index_header->version = JOURVAL_V2_METRIC_INDEX_VERSION;
+    j2_index_header->slots = n;
+    j2_index_header->index_offset = index_offset;
+    j2_index_header->index_trailer_offset = index_trailer_offset;
+    crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (void *) j2_index_header, offsetof(struct journal_v2_metric_index_header, crc));
+    j2_index_header->crc = crc;
+}
+
+// find a metric in a journal v2 file
+// hash is journal_metric_uuid_hash(uuid), so that callers searching many files calculate it once
+// the metric index header has been checked when the file was loaded
+struct journal_metric_list *journalfile_v2_metric_find(struct rrdengine_journalfile *journalfile, struct journal_v2_header *j2_header, nd_uuid_t *uuid, uint64_t hash)
+{
+    struct journal_metric_list *uuid_list = (struct journal_metric_list *)((uint8_t *) j2_header + j2_header->metric_offset);
+    uint32_t metric_count = j2_header->metric_count;
+
+    uint32_t n = journalfile->v2.metric_index_slots;
+    if (unlikely(!n))
+        return bsearch(uuid, uuid_list, metric_count, sizeof(*uuid_list), journal_metric_uuid_compare);
+
+    struct journal_metric_index_slot *slots = (struct journal_metric_index_slot *)((uint8_t *) j2_header + journalfile->v2.metric_index_offset);
+
+    uint32_t mask = n - 1;
+    uint32_t tag = (uint32_t)(hash >> 32);
+
+    // the table is at most half full, so there is always an empty slot to stop at
+    for (uint32_t i = (uint32_t) hash & mask, probes = 0; probes < n; i = (i + 1) & mask, probes++) {
+        struct journal_metric_index_slot *slot = &slots[i];
+
+        if (!slot->metric)
+            return NULL;
+
+        if (slot->hash == tag && slot->metric <= metric_count) {
+            struct journal_metric_list *metric = &uuid_list[slot->metric - 1];
+            if (journal_uuid_memcmp(uuid, &metric->uuid) == 0)
+                return metric;
+        }
+    }
+
+    return NULL;
+}
+
+static int journalfile_check_v2_metric_index(void *data_start)
+{
+    struct journal_v2_header *j2_header = (void *) data_start;
+
+    uint32_t n = 0;
+    struct journal_metric_index_slot *slots = journalfile_v2_metric_index(j2_header, &n);
+
+    // files without a metric index are valid
+    if (!slots)
+        return 0;
+
+    struct journal_v2_block_trailer *journal_v2_trailer =
+        (void *) ((uint8_t *) data_start + journalfile_v2_metric_index_header(j2_header)->index_trailer_offset);
+
+    uLong crc = crc32(0L, Z_NULL, 0);
+    crc = crc32(crc, (void *) slots, n * sizeof(struct journal_metric_index_slot));
+
+    int rc = crc32cmp(journal_v2_trailer->checksum, crc);
+    if (unlikely(rc))
+        netdata_log_error("DBENGINE: metric index CRC32 check: FAILED");
+
+    return rc;
+}
+
 //
 // Return
 //   0 Ok
@@ -944,6 +1222,12 @@ static int journalfile_v2_validate(void *data_start, size_t journal_v2_file_size
     rc = journalfile_check_v2_metric_list(data_start, journal_v2_file_size);
     if (rc) return 1;
 
+    rc = journalfile_check_v2_page_summaries(data_start);
+    if (rc) return 1;
+
+    rc = journalfile_check_v2_metric_index(data_start);
+    if (rc) return 1;
+
     // Verify complete UUID chain
 
     struct journal_metric_list *metric = (void *) (data_start + j2_header->metric_offset);
@@ -1256,7 +1540,7 @@ void *journalfile_v2_write_data_page(struct journal_v2_header *j2_header, void *
 
 // Must be recorded in metric_info->entries
 static void *journalfile_v2_write_descriptors(struct journal_v2_header *j2_header, void *data, struct jv2_metrics_info *metric_info,
-        struct journal_metric_list *current_metric)
+        struct journal_metric_list *current_metric, struct rrdeng_page_summary **summary)
 {
     Pvoid_t *PValue;
 
@@ -1276,6 +1560,14 @@ static void *journalfile_v2_write_descriptors(struct journal_v2_header *j2_heade
         update_every_s = page_info->update_every_s;
         if (NULL == data_page)
             break;
+
+        // the summary of this page, at the same index as its descriptor
+        struct extent_io_data *ei = page_info->custom_data;
+        if (ei)
+            **summary = ei->summary;
+        else
+            memset(*summary, 0, sizeof(**summary));
+        (*summary)++;
     }
     current_metric->update_every_s = update_every_s;
     return data_page;
@@ -1334,6 +1626,28 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
     uint32_t pages_offset = total_file_size;
     total_file_size  += (number_of_pages * (sizeof(struct journal_page_list) + sizeof(struct journal_page_header) + sizeof(struct journal_v2_block_trailer)));
 
+    // page summaries will start here
+    total_file_size  = (total_file_size + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    uint32_t summary_offset = total_file_size;
+    total_file_size  += (number_of_pages * sizeof(struct rrdeng_page_summary));
+
+    // page summaries trailer
+    uint32_t summary_offset_trailer = total_file_size;
+    total_file_size  += sizeof(struct journal_v2_block_trailer);
+
+    // metric index will start here, with at least twice the slots of the metrics
+    uint32_t index_slots = 2;
+    while (index_slots < 2 * number_of_metrics)
+        index_slots <<= 1;
+
+    total_file_size  = (total_file_size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+    uint32_t index_offset = total_file_size;
+    total_file_size  += (index_slots * sizeof(struct journal_metric_index_slot));
+
+    // metric index trailer
+    uint32_t index_offset_trailer = total_file_size;
+    total_file_size  += sizeof(struct journal_v2_block_trailer);
+
     // File trailer
     uint32_t trailer_offset = total_file_size;
     total_file_size  += sizeof(struct journal_v2_block_trailer);
@@ -1407,6 +1721,10 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
     internal_error(true, "DBENGINE: traverse and qsort  UUID %llu", (now_monotonic_usec() - start_loading) / USEC_PER_MS);
 
     uint32_t resize_file_to = total_file_size;
+    struct rrdeng_page_summary *summary = (struct rrdeng_page_summary *)(data_start + summary_offset);
+
+    struct journal_metric_index_slot *index_slots_start = (struct journal_metric_index_slot *)(data_start + index_offset);
+    memset(index_slots_start, 0, index_slots * sizeof(struct journal_metric_index_slot));
 
     for (Index = 0; Index < number_of_metrics; Index++) {
         metric_info = uuid_list[Index].metric_info;
@@ -1420,6 +1738,9 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
         if (unlikely(!data))
             break;
 
+        // Add it to the metric index
+        journalfile_v2_metric_index_add(index_slots_start, index_slots, journal_metric_uuid_hash(metric_info->uuid), Index + 1);
+
         // Next we will write
         //   Header
         //   Detailed entries (descr @ time)
@@ -1432,7 +1753,7 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
                                                                   uuid_offset);
 
         // Start writing descr @ time
-        void *page_trailer = journalfile_v2_write_descriptors(&j2_header, metric_page, metric_info, current_metric);
+        void *page_trailer = journalfile_v2_write_descriptors(&j2_header, metric_page, metric_info, current_metric, &summary);
         if (unlikely(!page_trailer))
             break;
 
@@ -1461,6 +1782,14 @@ void journalfile_migrate_to_v2_callback(Word_t section, unsigned datafile_fileno
         crc32set(journal_v2_trailer->checksum, crc);
         internal_error(true, "DBENGINE: CALCULATE CRC FOR UUIDs  %llu", (now_monotonic_usec() - start_loading) / USEC_PER_MS);
 
+        // Calculate CRC for the page summaries and write their header
+        // if the pages written do not match the pages expected, the file will just not have summaries
+        if (summary == (struct rrdeng_page_summary *)(data_start + summary_offset) + number_of_pages)
+            journalfile_v2_page_summaries_header_set(data_start, number_of_pages, summary_offset, summary_offset_trailer);
+
+        // Calculate CRC for the metric index and write its header
+        journalfile_v2_metric_index_header_set(data_start, index_slots, index_offset, index_offset_trailer);
+
         // Prepare to write checksum for the file
         j2_header.data = NULL;
         journal_v2_trailer = (struct journal_v2_block_trailer *)(data_start + trailer_offset);
@@ -1588,3 +1917,295 @@ cleanup:
     uv_fs_req_cleanup(&req);
     return error;
 }
+
+// ----------------------------------------------------------------------------
+// unittest
+
+#define JOURNALFILE_UNITTEST_PAGES 100
+#define JOURNALFILE_UNITTEST_POINTS 128
+
+static size_t journalfile_v2_unittest_page_summary(uint8_t type) {
+    size_t errors = 0;
+
+    PGD *pgd = pgd_create(type, JOURNALFILE_UNITTEST_POINTS);
+
+    struct rrdeng_page_summary expected = { 0 };
+    for(size_t i = 0; i < JOURNALFILE_UNITTEST_POINTS; i++) {
+        if(i % 10 == 0) {
+            // a gap
+            pgd_append_point(pgd, 0, NAN, NAN, NAN, 0, 0, SN_EMPTY_SLOT, i);
+            continue;
+        }
+
+        bool anomalous = (i % 7 == 0);
+        NETDATA_DOUBLE n = (NETDATA_DOUBLE)i;
+        NETDATA_DOUBLE min = n, max = n;
+        uint16_t count = 1;
+
+        if(type == RRDENG_PAGE_TYPE_ARRAY_TIER1) {
+            // tier points aggregate 2 points, n is their sum
+            min = n - 0.5;
+            max = n + 0.5;
+            n *= 2;
+            count = 2;
+        }
+
+        pgd_append_point(pgd, 0, n, min, max, count, anomalous ? 1 : 0, anomalous ? SN_FLAG_NONE : SN_DEFAULT_FLAGS, i);
+
+        if(!expected.count || min < expected.min) expected.min = min;
+        if(!expected.count || max > expected.max) expected.max = max;
+        expected.sum += n;
+        expected.count += count;
+        expected.anomaly_count += anomalous ? 1 : 0;
+    }
+
+    struct rrdeng_page_summary summary;
+    pgd_summary(pgd, &summary);
+    pgd_free(pgd);
+
+    if(summary.count != expected.count || summary.anomaly_count != expected.anomaly_count ||
+        fabsndd(summary.min - expected.min) > 0.01 || fabsndd(summary.max - expected.max) > 0.01 ||
+        fabsndd(summary.sum - expected.sum) > expected.sum * 0.0001) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: page type %u summary is min %f, max %f, sum %f, count %u, anomalies %u, "
+                        "expected min %f, max %f, sum %f, count %u, anomalies %u\n",
+                type, summary.min, summary.max, summary.sum, summary.count, summary.anomaly_count,
+                expected.min, expected.max, expected.sum, expected.count, expected.anomaly_count);
+        errors++;
+    }
+
+    // pages without points have an empty summary
+    pgd_summary(PGD_EMPTY, &summary);
+    if(summary.count) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: the summary of an empty page has %u points\n", summary.count);
+        errors++;
+    }
+
+    return errors;
+}
+
+// a journal v2 file with only the parts the summaries need
+static struct journal_v2_header *journalfile_v2_unittest_image(uint32_t pages, uint32_t *summary_offset, uint32_t *summary_trailer_offset) {
+    uint32_t total_file_size = RRDENG_BLOCK_SIZE;
+
+    uint32_t page_offset = total_file_size;
+    total_file_size += pages * (sizeof(struct journal_page_list) + sizeof(struct journal_page_header) + sizeof(struct journal_v2_block_trailer));
+
+    total_file_size = (total_file_size + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    *summary_offset = total_file_size;
+    total_file_size += pages * sizeof(struct rrdeng_page_summary);
+
+    *summary_trailer_offset = total_file_size;
+    total_file_size += sizeof(struct journal_v2_block_trailer);
+
+    total_file_size += sizeof(struct journal_v2_block_trailer);
+
+    struct journal_v2_header *j2_header = callocz(1, total_file_size);
+    j2_header->magic = JOURVAL_V2_MAGIC;
+    j2_header->page_count = pages;
+    j2_header->page_offset = page_offset;
+    j2_header->journal_v2_file_size = total_file_size;
+
+    return j2_header;
+}
+
+static size_t journalfile_v2_unittest_summaries(void) {
+    size_t errors = 0;
+
+    uint32_t summary_offset, summary_trailer_offset;
+    struct journal_v2_header *j2_header = journalfile_v2_unittest_image(JOURNALFILE_UNITTEST_PAGES, &summary_offset, &summary_trailer_offset);
+
+    struct rrdeng_page_summary *summaries = (struct rrdeng_page_summary *)((uint8_t *) j2_header + summary_offset);
+    for(uint32_t i = 0; i < JOURNALFILE_UNITTEST_PAGES; i++) {
+        summaries[i].min = i;
+        summaries[i].max = i * 2;
+        summaries[i].sum = i * 3;
+        summaries[i].count = i + 1;
+        summaries[i].anomaly_count = i % 2;
+    }
+
+    // a file without summaries is valid
+    if(journalfile_v2_page_summaries_offset(j2_header) || journalfile_check_v2_page_summaries(j2_header)) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: a journal without summaries is not accepted as such\n");
+        errors++;
+    }
+
+    journalfile_v2_page_summaries_header_set(j2_header, JOURNALFILE_UNITTEST_PAGES, summary_offset, summary_trailer_offset);
+
+    struct rrdengine_journalfile journalfile = { 0 };
+    journalfile.v2.summaries_offset = journalfile_v2_page_summaries_offset(j2_header);
+
+    struct rrdeng_page_summary *found = journalfile_v2_page_summaries(&journalfile, j2_header);
+    if(found != summaries || journalfile_check_v2_page_summaries(j2_header)) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: the page summaries are not found\n");
+        errors++;
+    }
+    else {
+        for(uint32_t i = 0; i < JOURNALFILE_UNITTEST_PAGES; i++) {
+            if(found[i].count != i + 1 || found[i].sum != i * 3) {
+                fprintf(stderr, "DBENGINE JOURNALFILE: page summary %u is wrong\n", i);
+                errors++;
+                break;
+            }
+        }
+    }
+
+    // corrupted summaries fail the validation of the file
+    summaries[JOURNALFILE_UNITTEST_PAGES / 2].sum += 1;
+    if(!journalfile_check_v2_page_summaries(j2_header)) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: corrupted page summaries are accepted\n");
+        errors++;
+    }
+    summaries[JOURNALFILE_UNITTEST_PAGES / 2].sum -= 1;
+
+    // summaries of another page list are not used
+    j2_header->page_count--;
+    if(journalfile_v2_page_summaries_offset(j2_header)) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: page summaries are used for a different page count\n");
+        errors++;
+    }
+    j2_header->page_count++;
+
+    // a corrupted summaries header means no summaries
+    journalfile_v2_summary_header(j2_header)->summary_offset += sizeof(struct rrdeng_page_summary);
+    journalfile_v2_summary_header(j2_header)->summary_trailer_offset += sizeof(struct rrdeng_page_summary);
+    if(journalfile_v2_page_summaries_offset(j2_header)) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: a corrupted page summaries header is accepted\n");
+        errors++;
+    }
+
+    freez(j2_header);
+    return errors;
+}
+
+static int journalfile_v2_unittest_uuid_compar(const void *a, const void *b) {
+    return journal_uuid_memcmp(&((const struct journal_metric_list *) a)->uuid, &((const struct journal_metric_list *) b)->uuid);
+}
+
+static size_t journalfile_v2_unittest_metric_find(struct rrdengine_journalfile *journalfile, struct journal_v2_header *j2_header,
+                                                  struct journal_metric_list *uuid_list, nd_uuid_t *missing, const char *what) {
+    size_t errors = 0;
+
+    for(uint32_t i = 0; i < j2_header->metric_count; i++) {
+        nd_uuid_t *uuid = &uuid_list[i].uuid;
+        if(journalfile_v2_metric_find(journalfile, j2_header, uuid, journal_metric_uuid_hash(uuid)) != &uuid_list[i]) {
+            fprintf(stderr, "DBENGINE JOURNALFILE: metric %u is not found %s\n", i, what);
+            errors++;
+            break;
+        }
+    }
+
+    for(uint32_t i = 0; i < j2_header->metric_count; i++) {
+        if(journalfile_v2_metric_find(journalfile, j2_header, &missing[i], journal_metric_uuid_hash(&missing[i]))) {
+            fprintf(stderr, "DBENGINE JOURNALFILE: a metric not in the journal is found %s\n", what);
+            errors++;
+            break;
+        }
+    }
+
+    return errors;
+}
+
+static size_t journalfile_v2_unittest_metric_index(void) {
+    size_t errors = 0;
+    uint32_t metrics = JOURNALFILE_UNITTEST_PAGES * 10;
+
+    // a journal v2 file with only the parts the metric index needs
+    uint32_t total_file_size = RRDENG_BLOCK_SIZE;
+
+    uint32_t metric_offset = total_file_size;
+    total_file_size += metrics * sizeof(struct journal_metric_list);
+
+    uint32_t page_offset = total_file_size;
+
+    uint32_t index_slots = 2;
+    while (index_slots < 2 * metrics)
+        index_slots <<= 1;
+
+    total_file_size = (total_file_size + sizeof(uint64_t) - 1) / sizeof(uint64_t) * sizeof(uint64_t);
+    uint32_t index_offset = total_file_size;
+    total_file_size += index_slots * sizeof(struct journal_metric_index_slot);
+
+    uint32_t index_trailer_offset = total_file_size;
+    total_file_size += sizeof(struct journal_v2_block_trailer);
+
+    total_file_size += sizeof(struct journal_v2_block_trailer);
+
+    struct journal_v2_header *j2_header = callocz(1, total_file_size);
+    j2_header->magic = JOURVAL_V2_MAGIC;
+    j2_header->metric_count = metrics;
+    j2_header->metric_offset = metric_offset;
+    j2_header->page_offset = page_offset;
+    j2_header->journal_v2_file_size = total_file_size;
+
+    struct journal_metric_list *uuid_list = (struct journal_metric_list *)((uint8_t *) j2_header + metric_offset);
+    nd_uuid_t *missing = callocz(metrics, sizeof(*missing));
+    for(uint32_t i = 0; i < metrics; i++) {
+        uuid_generate(uuid_list[i].uuid);
+        uuid_generate(missing[i]);
+    }
+    qsort(uuid_list, metrics, sizeof(*uuid_list), journalfile_v2_unittest_uuid_compar);
+
+    // without the index, lookups fall back to binary search
+    struct rrdengine_journalfile journalfile = { 0 };
+    journalfile_v2_metric_index_set(&journalfile, j2_header);
+    if(journalfile.v2.metric_index_slots || journalfile_check_v2_metric_index(j2_header)) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: a journal without a metric index is not accepted as such\n");
+        errors++;
+    }
+    errors += journalfile_v2_unittest_metric_find(&journalfile, j2_header, uuid_list, missing, "without a metric index");
+
+    struct journal_metric_index_slot *slots = (struct journal_metric_index_slot *)((uint8_t *) j2_header + index_offset);
+    for(uint32_t i = 0; i < metrics; i++)
+        journalfile_v2_metric_index_add(slots, index_slots, journal_metric_uuid_hash(&uuid_list[i].uuid), i + 1);
+
+    journalfile_v2_metric_index_header_set(j2_header, index_slots, index_offset, index_trailer_offset);
+
+    journalfile_v2_metric_index_set(&journalfile, j2_header);
+    if(journalfile.v2.metric_index_slots != index_slots || journalfile.v2.metric_index_offset != index_offset ||
+        journalfile_check_v2_metric_index(j2_header)) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: the metric index is not found\n");
+        errors++;
+    }
+    errors += journalfile_v2_unittest_metric_find(&journalfile, j2_header, uuid_list, missing, "with the metric index");
+
+    // corrupted slots fail the validation of the file
+    for(uint32_t i = 0; i < index_slots; i++) {
+        if(slots[i].metric) {
+            slots[i].hash++;
+            if(!journalfile_check_v2_metric_index(j2_header)) {
+                fprintf(stderr, "DBENGINE JOURNALFILE: a corrupted metric index is accepted\n");
+                errors++;
+            }
+            slots[i].hash--;
+            break;
+        }
+    }
+
+    // an index of an unknown version is not used
+    journalfile_v2_metric_index_header(j2_header)->version++;
+    journalfile_v2_metric_index_set(&journalfile, j2_header);
+    if(journalfile.v2.metric_index_slots) {
+        fprintf(stderr, "DBENGINE JOURNALFILE: a metric index of an unknown version is used\n");
+        errors++;
+    }
+    errors += journalfile_v2_unittest_metric_find(&journalfile, j2_header, uuid_list, missing, "with an unknown metric index version");
+
+    freez(missing);
+    freez(j2_header);
+    return errors;
+}
+
+int journalfile_v2_unittest(void) {
+    // the page allocators
+    if(!rrdeng_dbengine_spawn(NULL))
+        fatal("DBENGINE JOURNALFILE: cannot initialize dbengine");
+
+    size_t errors = 0;
+    errors += journalfile_v2_unittest_page_summary(RRDENG_PAGE_TYPE_ARRAY_32BIT);
+    errors += journalfile_v2_unittest_page_summary(RRDENG_PAGE_TYPE_ARRAY_TIER1);
+    errors += journalfile_v2_unittest_summaries();
+    errors += journalfile_v2_unittest_metric_index();
+
+    fprintf(stderr, "DBENGINE JOURNALFILE: %zu errors\n", errors);
+    return errors ? 1 : 0;
+}
@@ -40,6 +40,9 @@ struct rrdengine_journalfile {
         time_t last_time_s;
         time_t not_needed_since_s;
         uint32_t size_of_directory;
+        uint32_t summaries_offset;     // 0 when the file does not have page summaries
+        uint32_t metric_index_offset;
+        uint32_t metric_index_slots;   // 0 when the file does not have a metric index
     } v2;
 
     struct {
@@ -136,12 +139,67 @@ struct journal_v2_header {
 
 #define JOURNAL_V2_HEADER_PADDING_SZ (RRDENG_BLOCK_SIZE - (sizeof(struct journal_v2_header)))
 
+// Page summaries (zone maps)
+// One struct rrdeng_page_summary per page, in the order the page lists are
+// written (metrics by UUID, pages by time), stored after the page lists.
+// Their header lives in the padding of the journal v2 header, so that files
+// with summaries are still valid for agents that do not know about them,
+// and files without summaries are detected by the magic.
+
+#define JOURVAL_V2_SUMMARY_MAGIC   (0x01230318)
+
+// 20 bytes
+struct journal_v2_summary_header {
+    uint32_t magic;
+    uint32_t page_count;                // must match the page count of the journal
+    uint32_t summary_offset;
+    uint32_t summary_trailer_offset;    // CRC for the summaries
+    uint32_t crc;                       // CRC for this header
+};
+
+#define journalfile_v2_summary_header(j2_header) \
+    ((struct journal_v2_summary_header *)((uint8_t *)(j2_header) + sizeof(struct journal_v2_header)))
+
+struct rrdeng_page_summary *journalfile_v2_page_summaries(struct rrdengine_journalfile *journalfile, struct journal_v2_header *j2_header);
+
+// Metric index
+// An open addressing hash table (linear probing) of the metric list, stored
+// after the page summaries, so that finding a metric touches one or two
+// cache lines, instead of the log2(metrics) random ones of a binary search.
+// Like the summaries, its header lives in the padding of the journal v2 header.
+// Files without it, or with an unknown version, are searched with bsearch().
+
+#define JOURVAL_V2_METRIC_INDEX_MAGIC   (0x01230319)
+#define JOURVAL_V2_METRIC_INDEX_VERSION (1)
+
+// 24 bytes
+struct journal_v2_metric_index_header {
+    uint32_t magic;
+    uint32_t version;                   // the hash function and the slot layout
+    uint32_t slots;                     // a power of 2, at least twice the metric count
+    uint32_t index_offset;
+    uint32_t index_trailer_offset;      // CRC for the slots
+    uint32_t crc;                       // CRC for this header
+};
+
+// 8 bytes
+struct journal_metric_index_slot {
+    uint32_t hash;                      // the upper 32 bits of the hash of the UUID
+    uint32_t metric;                    // index in the metric list + 1, 0 for empty slots
+};
+
+#define journalfile_v2_metric_index_header(j2_header) \
+    ((struct journal_v2_metric_index_header *)((uint8_t *)(j2_header) + sizeof(struct journal_v2_header) + sizeof(struct journal_v2_summary_header)))
+
+struct journal_metric_list *journalfile_v2_metric_find(struct rrdengine_journalfile *journalfile, struct journal_v2_header *j2_header, nd_uuid_t *uuid, uint64_t hash);
+
 struct wal;
 
 void journalfile_v1_generate_path(struct rrdengine_datafile *datafile, char *str, size_t maxlen);
 void journalfile_v2_generate_path(struct rrdengine_datafile *datafile, char *str, size_t maxlen);
 struct rrdengine_journalfile *journalfile_alloc_and_init(struct rrdengine_datafile *datafile);
 void journalfile_v1_extent_write(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile, struct wal *wal, uv_loop_t *loop);
+void journalfile_v1_extent_write_batch(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile, struct wal **wals, size_t count, uv_loop_t *loop);
 int journalfile_close(struct rrdengine_journalfile *journalfile, struct rrdengine_datafile *datafile);
 int journalfile_unlink(struct rrdengine_journalfile *journalfile);
 int journalfile_destroy_unsafe(struct rrdengine_journalfile *journalfile, struct rrdengine_datafile *datafile);
@@ -173,4 +231,6 @@ typedef struct {
 
 struct rrdengine_datafile *njfv2idx_find_and_acquire_j2_header(NJFV2IDX_FIND_STATE *s);
 
+int journalfile_v2_unittest(void);
+
 #endif /* NETDATA_JOURNALFILE_H */
\ No newline at end of file
@@ -4,25 +4,46 @@
 #include "libnetdata/locks/locks.h"
 #include "rrddiskprotocol.h"
 
+// ----------------------------------------------------------------------------
+// The Metrics Registry keeps the retention of every metric of every tier.
+//
+// On big parents it holds tens of millions of metrics, so its memory footprint
+// per metric matters:
+//
+// - metrics are stored in dense arrays (chunks) per partition, addressed by
+//   32-bit ids. Chunks never move, so METRIC pointers given to the callers
+//   are stable. Deleted metrics are reused by the next additions.
+//
+// - timestamps are stored as 32-bit unsigned seconds since the epoch and the
+//   section (the tier instance) as a 16-bit id to a registry of sections.
+//
+// - the index is an open addressing hash table (linear probing) per partition,
+//   holding a 32-bit hash and a 32-bit metric id per slot (8 bytes), so that
+//   most lookups touch one slot and one metric.
+
 typedef int32_t REFCOUNT;
 #define REFCOUNT_DELETING (-100)
 
-struct metric {
-    nd_uuid_t uuid;                    // never changes
-    Word_t section;                 // never changes
+typedef uint16_t MRG_SECTION_ID;
 
-    time_t first_time_s;            // the timestamp of the oldest point in the database
-    time_t latest_time_s_clean;     // the timestamp of the newest point in the database
-    time_t latest_time_s_hot;       // the timestamp of the latest point that has been collected (not yet stored)
+struct metric {
+    nd_uuid_t uuid;                 // never changes
+    uint32_t first_time_s;          // the timestamp of the oldest point in the database
+    uint32_t latest_time_s_clean;   // the timestamp of the newest point in the database
+    uint32_t latest_time_s_hot;     // the timestamp of the latest point that has been collected (not yet stored)
     uint32_t latest_update_every_s; // the latest data collection frequency
     pid_t writer;
-    uint8_t partition;
     REFCOUNT refcount;
+    MRG_SECTION_ID section;         // never changes
+    uint8_t partition;
 
-    // THIS IS allocated with malloc()
+    // THIS IS allocated in chunks
     // YOU HAVE TO INITIALIZE IT YOURSELF !
 };
 
+// when a metric is deleted, first_time_s links it to the next free metric of its partition
+#define metric_next_free first_time_s
+
 #define set_metric_field_with_condition(field, value, condition) ({ \
     typeof(field) _current = __atomic_load_n(&(field), __ATOMIC_RELAXED);   \
     typeof(field) _wanted = value;                                          \
@@ -42,16 +63,52 @@ struct metric {
     did_it;                                                                 \
 })
 
-static struct aral_statistics mrg_aral_statistics;
+// timestamps are unsigned 32-bit - valid until 2106
+static inline uint32_t mrg_time_s(time_t t) {
+    if(unlikely(t <= 0))
+        return 0;
+
+    if(unlikely(t > (time_t)UINT32_MAX))
+        return UINT32_MAX;
+
+    return (uint32_t)t;
+}
+
+#define MRG_METRICS_PER_CHUNK_BITS  12
+#define MRG_METRICS_PER_CHUNK       (1U << MRG_METRICS_PER_CHUNK_BITS)
+#define MRG_METRICS_CHUNK_MASK      (MRG_METRICS_PER_CHUNK - 1)
+
+#define MRG_HASH_INITIAL_SLOTS      1024
+
+#define MRG_SECTIONS_PER_PAGE       256
+#define MRG_SECTIONS_PAGES          256
+#define MRG_SECTIONS_MAX            (MRG_SECTIONS_PER_PAGE * MRG_SECTIONS_PAGES)
 
 struct mrg {
     size_t partitions;
 
-    struct mrg_partition {
-        ARAL *aral;                 // not protected by our spinlock - it has its own
+    struct {
+        SPINLOCK spinlock;          // serializes additions
+        uint32_t used;              // atomic - readers access the first used entries without locks
+        Word_t *pages[MRG_SECTIONS_PAGES];
+    } sections;
 
+    struct mrg_partition {
         RW_SPINLOCK rw_spinlock;
-        Pvoid_t uuid_judy;          // JudyHS: each UUID has a JudyL of sections (tiers)
+
+        struct {
+            uint64_t *slots;        // (hash << 32) | (id + 1), 0 = empty
+            uint32_t size;          // always a power of 2
+            uint32_t used;
+        } hash;
+
+        struct {
+            METRIC **chunks;
+            uint32_t chunks_size;   // the allocated size of the chunks array
+            uint32_t chunks_used;   // the chunks allocated
+            uint32_t next_id;       // the first id that has never been used
+            uint32_t free_id;       // id + 1 of the first deleted metric, 0 = none
+        } metrics;
 
         struct mrg_statistics stats;
     } index[];
@@ -90,30 +147,204 @@ static inline void MRG_STATS_DELETE_MISS(MRG *mrg, size_t partition) {
 #define mrg_index_write_lock(mrg, partition) rw_spinlock_write_lock(&(mrg)->index[partition].rw_spinlock)
 #define mrg_index_write_unlock(mrg, partition) rw_spinlock_write_unlock(&(mrg)->index[partition].rw_spinlock)
 
-static inline void mrg_stats_size_judyl_change(MRG *mrg, size_t mem_before_judyl, size_t mem_after_judyl, size_t partition) {
-    if(mem_after_judyl > mem_before_judyl)
-        __atomic_add_fetch(&mrg->index[partition].stats.size, mem_after_judyl - mem_before_judyl, __ATOMIC_RELAXED);
-    else if(mem_after_judyl < mem_before_judyl)
-        __atomic_sub_fetch(&mrg->index[partition].stats.size, mem_before_judyl - mem_after_judyl, __ATOMIC_RELAXED);
+static inline size_t uuid_partition(MRG *mrg __maybe_unused, nd_uuid_t *uuid) {
+    uint8_t *u = (uint8_t *)uuid;
+
+    size_t n;
+    memcpy(&n, &u[UUID_SZ - sizeof(size_t)], sizeof(size_t));
+
+    return n % mrg->partitions;
 }
 
-static inline void mrg_stats_size_judyhs_added_uuid(MRG *mrg, size_t partition) {
-    __atomic_add_fetch(&mrg->index[partition].stats.size, JUDYHS_INDEX_SIZE_ESTIMATE(sizeof(nd_uuid_t)), __ATOMIC_RELAXED);
+// ----------------------------------------------------------------------------
+// sections
+
+static inline Word_t mrg_section(MRG *mrg, MRG_SECTION_ID id) {
+    return mrg->sections.pages[id / MRG_SECTIONS_PER_PAGE][id % MRG_SECTIONS_PER_PAGE];
 }
 
-static inline void mrg_stats_size_judyhs_removed_uuid(MRG *mrg, size_t partition) {
-    __atomic_sub_fetch(&mrg->index[partition].stats.size, JUDYHS_INDEX_SIZE_ESTIMATE(sizeof(nd_uuid_t)), __ATOMIC_RELAXED);
+static inline bool mrg_section_find(MRG *mrg, Word_t section, MRG_SECTION_ID *id) {
+    // the sections are the tiers (or the hosts, in legacy mode) - a handful
+    static __thread MRG *last_mrg = NULL;
+    static __thread Word_t last_section = 0;
+    static __thread MRG_SECTION_ID last_id = 0;
+
+    uint32_t used = __atomic_load_n(&mrg->sections.used, __ATOMIC_ACQUIRE);
+
+    if(likely(last_mrg == mrg && last_section == section && last_id < used && mrg_section(mrg, last_id) == section)) {
+        *id = last_id;
+        return true;
+    }
+
+    for(uint32_t i = 0; i < used ; i++) {
+        if(mrg_section(mrg, i) == section) {
+            last_mrg = mrg;
+            last_section = section;
+            last_id = *id = (MRG_SECTION_ID)i;
+            return true;
+        }
+    }
+
+    return false;
 }
 
-static inline size_t uuid_partition(MRG *mrg __maybe_unused, nd_uuid_t *uuid) {
-    uint8_t *u = (uint8_t *)uuid;
+static MRG_SECTION_ID mrg_section_add(MRG *mrg, Word_t section) {
+    MRG_SECTION_ID id;
+    if(likely(mrg_section_find(mrg, section, &id)))
+        return id;
 
-    size_t n;
-    memcpy(&n, &u[UUID_SZ - sizeof(size_t)], sizeof(size_t));
+    spinlock_lock(&mrg->sections.spinlock);
 
-    return n % mrg->partitions;
+    if(!mrg_section_find(mrg, section, &id)) {
+        uint32_t used = mrg->sections.used;
+        if(used >= MRG_SECTIONS_MAX)
+            fatal("DBENGINE METRIC: too many sections in the metrics registry");
+
+        Word_t **page = &mrg->sections.pages[used / MRG_SECTIONS_PER_PAGE];
+        if(!*page)
+            *page = callocz(MRG_SECTIONS_PER_PAGE, sizeof(Word_t));
+
+        (*page)[used % MRG_SECTIONS_PER_PAGE] = section;
+        id = (MRG_SECTION_ID)used;
+        __atomic_store_n(&mrg->sections.used, used + 1, __ATOMIC_RELEASE);
+    }
+
+    spinlock_unlock(&mrg->sections.spinlock);
+    return id;
+}
+
+// ----------------------------------------------------------------------------
+// metrics storage - under the partition lock
+
+static inline METRIC *mrg_metric_by_id(MRG *mrg, size_t partition, uint32_t id) {
+    return &mrg->index[partition].metrics.chunks[id >> MRG_METRICS_PER_CHUNK_BITS][id & MRG_METRICS_CHUNK_MASK];
+}
+
+static uint32_t mrg_metric_id_allocate(MRG *mrg, size_t partition) {
+    struct mrg_partition *p = &mrg->index[partition];
+
+    if(p->metrics.free_id) {
+        uint32_t id = p->metrics.free_id - 1;
+        p->metrics.free_id = mrg_metric_by_id(mrg, partition, id)->metric_next_free;
+        return id;
+    }
+
+    uint32_t id = p->metrics.next_id;
+    if(unlikely(id == UINT32_MAX))
+        fatal("DBENGINE METRIC: too many metrics in partition %zu of the metrics registry", partition);
+
+    uint32_t chunk = id >> MRG_METRICS_PER_CHUNK_BITS;
+    if(chunk >= p->metrics.chunks_used) {
+        if(p->metrics.chunks_used == p->metrics.chunks_size) {
+            uint32_t size = p->metrics.chunks_size ? p->metrics.chunks_size * 2 : 16;
+            p->metrics.chunks = reallocz(p->metrics.chunks, size * sizeof(METRIC *));
+            p->metrics.chunks_size = size;
+        }
+
+        p->metrics.chunks[p->metrics.chunks_used++] = mallocz(MRG_METRICS_PER_CHUNK * sizeof(METRIC));
+    }
+
+    p->metrics.next_id++;
+    return id;
+}
+
+static inline void mrg_metric_id_free(MRG *mrg, size_t partition, uint32_t id) {
+    struct mrg_partition *p = &mrg->index[partition];
+    mrg_metric_by_id(mrg, partition, id)->metric_next_free = p->metrics.free_id;
+    p->metrics.free_id = id + 1;
+}
+
+// ----------------------------------------------------------------------------
+// the index - under the partition lock
+
+static inline uint32_t mrg_hash(nd_uuid_t *uuid, MRG_SECTION_ID section) {
+    uint64_t a, b;
+    memcpy(&a, uuid, sizeof(a));
+    memcpy(&b, (uint8_t *)uuid + sizeof(a), sizeof(b));
+
+    // murmur3 finalizer
+    uint64_t h = a ^ (b * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t)section << 1);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return (uint32_t)h;
+}
+
+// returns the slot of the metric, or the empty slot it should be added to
+static inline uint32_t mrg_hash_find(MRG *mrg, size_t partition, nd_uuid_t *uuid, MRG_SECTION_ID section, uint32_t hash, METRIC **metric) {
+    struct mrg_partition *p = &mrg->index[partition];
+    uint32_t mask = p->hash.size - 1;
+
+    for(uint32_t i = hash & mask; ; i = (i + 1) & mask) {
+        uint64_t slot = p->hash.slots[i];
+
+        if(!slot) {
+            *metric = NULL;
+            return i;
+        }
+
+        if((uint32_t)(slot >> 32) == hash) {
+            METRIC *m = mrg_metric_by_id(mrg, partition, (uint32_t)slot - 1);
+            if(m->section == section && uuid_eq(m->uuid, *uuid)) {
+                *metric = m;
+                return i;
+            }
+        }
+    }
 }
 
+static void mrg_hash_resize(MRG *mrg, size_t partition, uint32_t size) {
+    struct mrg_partition *p = &mrg->index[partition];
+    uint64_t *old_slots = p->hash.slots;
+    uint32_t old_size = p->hash.size;
+    uint32_t mask = size - 1;
+
+    p->hash.slots = callocz(size, sizeof(uint64_t));
+    p->hash.size = size;
+
+    for(uint32_t i = 0; i < old_size ; i++) {
+        uint64_t slot = old_slots[i];
+        if(!slot)
+            continue;
+
+        uint32_t j = (uint32_t)(slot >> 32) & mask;
+        while(p->hash.slots[j])
+            j = (j + 1) & mask;
+
+        p->hash.slots[j] = slot;
+    }
+
+    freez(old_slots);
+
+    p->stats.size -= old_size * sizeof(uint64_t);
+    p->stats.size += size * sizeof(uint64_t);
+}
+
+// backward shift deletion, so that no tombstones are needed
+static void mrg_hash_delete_slot(MRG *mrg, size_t partition, uint32_t i) {
+    struct mrg_partition *p = &mrg->index[partition];
+    uint32_t mask = p->hash.size - 1;
+
+    for(uint32_t j = (i + 1) & mask; p->hash.slots[j] ; j = (j + 1) & mask) {
+        uint32_t home = (uint32_t)(p->hash.slots[j] >> 32) & mask;
+
+        // can the entry at j move to i? only if i is cyclically in [home, j)
+        bool movable = (i <= j) ? (home <= i || home > j) : (home <= i && home > j);
+        if(movable) {
+            p->hash.slots[i] = p->hash.slots[j];
+            i = j;
+        }
+    }
+
+    p->hash.slots[i] = 0;
+    p->hash.used--;
+}
+
+// ----------------------------------------------------------------------------
+
 static inline time_t mrg_metric_get_first_time_s_smart(MRG *mrg __maybe_unused, METRIC *metric) {
     time_t first_time_s = __atomic_load_n(&metric->first_time_s, __ATOMIC_RELAXED);
 
@@ -125,14 +356,14 @@ static inline time_t mrg_metric_get_first_time_s_smart(MRG *mrg __maybe_unused,
         if(first_time_s <= 0)
             first_time_s = 0;
         else
-            __atomic_store_n(&metric->first_time_s, first_time_s, __ATOMIC_RELAXED);
+            __atomic_store_n(&metric->first_time_s, mrg_time_s(first_time_s), __ATOMIC_RELAXED);
     }
 
     return first_time_s;
 }
 
-static void metric_log(MRG *mrg __maybe_unused, METRIC *metric, const char *msg) {
-    struct rrdengine_instance *ctx = (struct rrdengine_instance *)metric->section;
+static void metric_log(MRG *mrg, METRIC *metric, const char *msg) {
+    struct rrdengine_instance *ctx = (struct rrdengine_instance *)mrg_section(mrg, metric->section);
 
     char uuid[UUID_STR_LEN];
     uuid_unparse_lower(metric->uuid, uuid);
@@ -146,9 +377,9 @@ static void metric_log(MRG *mrg __maybe_unused, METRIC *metric, const char *msg)
            ctx->config.tier,
            metric->refcount,
            metric->partition,
-           metric->first_time_s,
-           metric->latest_time_s_hot,
-           metric->latest_time_s_clean,
+           (time_t)metric->first_time_s,
+           (time_t)metric->latest_time_s_hot,
+           (time_t)metric->latest_time_s_clean,
            metric->latest_update_every_s,
            (int)metric->writer
     );
@@ -163,40 +394,25 @@ static inline bool acquired_metric_has_retention(MRG *mrg, METRIC *metric) {
 static inline void acquired_for_deletion_metric_delete(MRG *mrg, METRIC *metric) {
     size_t partition = metric->partition;
 
-    size_t mem_before_judyl, mem_after_judyl;
-
     mrg_index_write_lock(mrg, partition);
 
-    Pvoid_t *sections_judy_pptr = JudyHSGet(mrg->index[partition].uuid_judy, &metric->uuid, sizeof(nd_uuid_t));
-    if(unlikely(!sections_judy_pptr || !*sections_judy_pptr)) {
-        MRG_STATS_DELETE_MISS(mrg, partition);
-        mrg_index_write_unlock(mrg, partition);
-        return;
-    }
-
-    mem_before_judyl = JudyLMemUsed(*sections_judy_pptr);
-    int rc = JudyLDel(sections_judy_pptr, metric->section, PJE0);
-    mem_after_judyl = JudyLMemUsed(*sections_judy_pptr);
-    mrg_stats_size_judyl_change(mrg, mem_before_judyl, mem_after_judyl, partition);
+    METRIC *found;
+    uint32_t slot = mrg_hash_find(mrg, partition, &metric->uuid, metric->section,
+                                  mrg_hash(&metric->uuid, metric->section), &found);
 
-    if(unlikely(!rc)) {
+    if(unlikely(found != metric)) {
         MRG_STATS_DELETE_MISS(mrg, partition);
         mrg_index_write_unlock(mrg, partition);
         return;
     }
 
-    if(!*sections_judy_pptr) {
-        rc = JudyHSDel(&mrg->index[partition].uuid_judy, &metric->uuid, sizeof(nd_uuid_t), PJE0);
-        if(unlikely(!rc))
-            fatal("DBENGINE METRIC: cannot delete UUID from JudyHS");
-        mrg_stats_size_judyhs_removed_uuid(mrg, partition);
-    }
+    uint32_t id = (uint32_t)mrg->index[partition].hash.slots[slot] - 1;
+    mrg_hash_delete_slot(mrg, partition, slot);
+    mrg_metric_id_free(mrg, partition, id);
 
     MRG_STATS_DELETED_METRIC(mrg, partition);
 
     mrg_index_write_unlock(mrg, partition);
-
-    aral_freez(mrg->index[partition].aral, metric);
 }
 
 static inline bool metric_acquire(MRG *mrg, METRIC *metric) {
@@ -255,33 +471,18 @@ static inline bool metric_release(MRG *mrg, METRIC *metric, bool delete_if_last_
 
 static inline METRIC *metric_add_and_acquire(MRG *mrg, MRG_ENTRY *entry, bool *ret) {
     size_t partition = uuid_partition(mrg, entry->uuid);
-
-    METRIC *allocation = aral_mallocz(mrg->index[partition].aral);
-    Pvoid_t *PValue;
+    MRG_SECTION_ID section = mrg_section_add(mrg, entry->section);
+    uint32_t hash = mrg_hash(entry->uuid, section);
+    struct mrg_partition *p = &mrg->index[partition];
+    uint32_t slot;
 
     while(1) {
         mrg_index_write_lock(mrg, partition);
 
-        size_t mem_before_judyl, mem_after_judyl;
-
-        Pvoid_t *sections_judy_pptr = JudyHSIns(&mrg->index[partition].uuid_judy, entry->uuid, sizeof(nd_uuid_t), PJE0);
-        if (unlikely(!sections_judy_pptr || sections_judy_pptr == PJERR))
-            fatal("DBENGINE METRIC: corrupted UUIDs JudyHS array");
-
-        if (unlikely(!*sections_judy_pptr))
-            mrg_stats_size_judyhs_added_uuid(mrg, partition);
-
-        mem_before_judyl = JudyLMemUsed(*sections_judy_pptr);
-        PValue = JudyLIns(sections_judy_pptr, entry->section, PJE0);
-        mem_after_judyl = JudyLMemUsed(*sections_judy_pptr);
-        mrg_stats_size_judyl_change(mrg, mem_before_judyl, mem_after_judyl, partition);
-
-        if (unlikely(!PValue || PValue == PJERR))
-            fatal("DBENGINE METRIC: corrupted section JudyL array");
-
-        if (unlikely(*PValue != NULL)) {
-            METRIC *metric = *PValue;
+        METRIC *metric;
+        slot = mrg_hash_find(mrg, partition, entry->uuid, section, hash, &metric);
 
+        if (unlikely(metric)) {
             if(!metric_acquire(mrg, metric)) {
                 mrg_index_write_unlock(mrg, partition);
                 continue;
@@ -293,25 +494,34 @@ static inline METRIC *metric_add_and_acquire(MRG *mrg, MRG_ENTRY *entry, bool *r
             if (ret)
                 *ret = false;
 
-            aral_freez(mrg->index[partition].aral, allocation);
-
             return metric;
         }
 
         break;
     }
 
-    METRIC *metric = allocation;
+    // keep the load factor below 3/4
+    if(unlikely((p->hash.used + 1) * 4ULL > p->hash.size * 3ULL)) {
+        mrg_hash_resize(mrg, partition, p->hash.size * 2);
+
+        METRIC *metric;
+        slot = mrg_hash_find(mrg, partition, entry->uuid, section, hash, &metric);
+    }
+
+    uint32_t id = mrg_metric_id_allocate(mrg, partition);
+    p->hash.slots[slot] = ((uint64_t)hash << 32) | ((uint64_t)id + 1);
+    p->hash.used++;
+
+    METRIC *metric = mrg_metric_by_id(mrg, partition, id);
     uuid_copy(metric->uuid, *entry->uuid);
-    metric->section = entry->section;
-    metric->first_time_s = MAX(0, entry->first_time_s);
-    metric->latest_time_s_clean = MAX(0, entry->last_time_s);
+    metric->section = section;
+    metric->first_time_s = mrg_time_s(entry->first_time_s);
+    metric->latest_time_s_clean = mrg_time_s(entry->last_time_s);
     metric->latest_time_s_hot = 0;
     metric->latest_update_every_s = entry->latest_update_every_s;
     metric->writer = 0;
     metric->refcount = 1;
     metric->partition = partition;
-    *PValue = metric;
 
     MRG_STATS_ADDED_METRIC(mrg, partition);
 
@@ -326,26 +536,26 @@ static inline METRIC *metric_add_and_acquire(MRG *mrg, MRG_ENTRY *entry, bool *r
 static inline METRIC *metric_get_and_acquire(MRG *mrg, nd_uuid_t *uuid, Word_t section) {
     size_t partition = uuid_partition(mrg, uuid);
 
+    MRG_SECTION_ID section_id;
+    if(unlikely(!mrg_section_find(mrg, section, &section_id))) {
+        MRG_STATS_SEARCH_MISS(mrg, partition);
+        return NULL;
+    }
+
+    uint32_t hash = mrg_hash(uuid, section_id);
+
     while(1) {
         mrg_index_read_lock(mrg, partition);
 
-        Pvoid_t *sections_judy_pptr = JudyHSGet(mrg->index[partition].uuid_judy, uuid, sizeof(nd_uuid_t));
-        if (unlikely(!sections_judy_pptr)) {
+        METRIC *metric;
+        mrg_hash_find(mrg, partition, uuid, section_id, hash, &metric);
+        if (unlikely(!metric)) {
             mrg_index_read_unlock(mrg, partition);
             MRG_STATS_SEARCH_MISS(mrg, partition);
             return NULL;
         }
 
-        Pvoid_t *PValue = JudyLGet(*sections_judy_pptr, section, PJE0);
-        if (unlikely(!PValue)) {
-            mrg_index_read_unlock(mrg, partition);
-            MRG_STATS_SEARCH_MISS(mrg, partition);
-            return NULL;
-        }
-
-        METRIC *metric = *PValue;
-
-        if(metric && !metric_acquire(mrg, metric))
+        if(!metric_acquire(mrg, metric))
             metric = NULL;
 
         mrg_index_read_unlock(mrg, partition);
@@ -364,37 +574,65 @@ inline MRG *mrg_create(ssize_t partitions) {
     if(partitions < 1)
         partitions = get_netdata_cpus();
 
+    if(partitions > UINT8_MAX + 1)
+        partitions = UINT8_MAX + 1;
+
     MRG *mrg = callocz(1, sizeof(MRG) + sizeof(struct mrg_partition) * partitions);
     mrg->partitions = partitions;
+    spinlock_init(&mrg->sections.spinlock);
 
     for(size_t i = 0; i < mrg->partitions ; i++) {
         rw_spinlock_init(&mrg->index[i].rw_spinlock);
 
-        char buf[ARAL_MAX_NAME + 1];
-        snprintfz(buf, ARAL_MAX_NAME, "mrg[%zu]", i);
-
-        mrg->index[i].aral = aral_create(buf, sizeof(METRIC), 0, 16384, &mrg_aral_statistics, NULL, NULL, false, false);
+        mrg->index[i].hash.size = MRG_HASH_INITIAL_SLOTS;
+        mrg->index[i].hash.slots = callocz(MRG_HASH_INITIAL_SLOTS, sizeof(uint64_t));
+        mrg->index[i].stats.size = MRG_HASH_INITIAL_SLOTS * sizeof(uint64_t);
     }
 
     return mrg;
 }
 
-inline size_t mrg_aral_structures(void) {
-    return aral_structures_from_stats(&mrg_aral_statistics);
-}
+// the memory allocated for metrics that are not used (deleted or not yet added)
+inline size_t mrg_overhead(MRG *mrg) {
+    size_t overhead = 0;
+
+    for(size_t i = 0; i < mrg->partitions ; i++) {
+        struct mrg_partition *p = &mrg->index[i];
 
-inline size_t mrg_aral_overhead(void) {
-    return aral_overhead_from_stats(&mrg_aral_statistics);
+        mrg_index_read_lock(mrg, i);
+        overhead += (size_t)p->metrics.chunks_used * MRG_METRICS_PER_CHUNK * sizeof(METRIC) -
+                    p->stats.entries * sizeof(METRIC) +
+                    (size_t)p->metrics.chunks_size * sizeof(METRIC *);
+        mrg_index_read_unlock(mrg, i);
+    }
+
+    for(size_t i = 0; i < MRG_SECTIONS_PAGES ; i++)
+        if(mrg->sections.pages[i])
+            overhead += MRG_SECTIONS_PER_PAGE * sizeof(Word_t);
+
+    return overhead;
 }
 
-inline void mrg_destroy(MRG *mrg __maybe_unused) {
-    // no destruction possible
-    // we can't traverse the metrics list
+inline void mrg_destroy(MRG *mrg) {
+    // the caller has to make sure nobody uses the metrics anymore
+
+    if(!mrg)
+        return;
+
+    for(size_t i = 0; i < mrg->partitions ; i++) {
+        struct mrg_partition *p = &mrg->index[i];
 
-    // to delete entries, the caller needs to keep pointers to them
-    // and delete them one by one
+        for(uint32_t c = 0; c < p->metrics.chunks_used ; c++)
+            freez(p->metrics.chunks[c]);
+
+        freez(p->metrics.chunks);
+        freez(p->hash.slots);
+    }
 
-    ;
+    for(size_t i = 0; i < MRG_SECTIONS_PAGES ; i++)
+        freez(mrg->sections.pages[i]);
+
+    freez(mrg);
 }
 
 inline METRIC *mrg_metric_add_and_acquire(MRG *mrg, MRG_ENTRY entry, bool *ret) {
@@ -429,8 +667,8 @@ inline nd_uuid_t *mrg_metric_uuid(MRG *mrg __maybe_unused, METRIC *metric) {
     return &metric->uuid;
 }
 
-inline Word_t mrg_metric_section(MRG *mrg __maybe_unused, METRIC *metric) {
-    return metric->section;
+inline Word_t mrg_metric_section(MRG *mrg, METRIC *metric) {
+    return mrg_section(mrg, metric->section);
 }
 
 inline bool mrg_metric_set_first_time_s(MRG *mrg __maybe_unused, METRIC *metric, time_t first_time_s) {
@@ -439,7 +677,7 @@ inline bool mrg_metric_set_first_time_s(MRG *mrg __maybe_unused, METRIC *metric,
     if(unlikely(first_time_s < 0))
         return false;
 
-    __atomic_store_n(&metric->first_time_s, first_time_s, __ATOMIC_RELAXED);
+    __atomic_store_n(&metric->first_time_s, mrg_time_s(first_time_s), __ATOMIC_RELAXED);
 
     return true;
 }
@@ -453,10 +691,10 @@ inline void mrg_metric_expand_retention(MRG *mrg __maybe_unused, METRIC *metric,
                    "DBENGINE METRIC: metric last time is in the future");
 
     if(first_time_s > 0)
-        set_metric_field_with_condition(metric->first_time_s, first_time_s, _current <= 0 || _wanted < _current);
+        set_metric_field_with_condition(metric->first_time_s, mrg_time_s(first_time_s), _current <= 0 || _wanted < _current);
 
     if(last_time_s > 0) {
-        if(set_metric_field_with_condition(metric->latest_time_s_clean, last_time_s, _current <= 0 || _wanted > _current) &&
+        if(set_metric_field_with_condition(metric->latest_time_s_clean, mrg_time_s(last_time_s), _current <= 0 || _wanted > _current) &&
             update_every_s > 0)
             // set the latest update every too
             set_metric_field_with_condition(metric->latest_update_every_s, update_every_s, true);
@@ -468,7 +706,7 @@ inline void mrg_metric_expand_retention(MRG *mrg __maybe_unused, METRIC *metric,
 
 inline bool mrg_metric_set_first_time_s_if_bigger(MRG *mrg __maybe_unused, METRIC *metric, time_t first_time_s) {
     internal_fatal(first_time_s < 0, "DBENGINE METRIC: timestamp is negative");
-    return set_metric_field_with_condition(metric->first_time_s, first_time_s, _wanted > _current);
+    return set_metric_field_with_condition(metric->first_time_s, mrg_time_s(first_time_s), _wanted > _current);
 }
 
 inline time_t mrg_metric_get_first_time_s(MRG *mrg __maybe_unused, METRIC *metric) {
@@ -495,8 +733,8 @@ inline bool mrg_metric_set_clean_latest_time_s(MRG *mrg __maybe_unused, METRIC *
 //                   "DBENGINE METRIC: metric new clean latest time is older than the previous one");
 
     if(latest_time_s > 0) {
-        if(set_metric_field_with_condition(metric->latest_time_s_clean, latest_time_s, true)) {
-            set_metric_field_with_condition(metric->first_time_s, latest_time_s, _current <= 0 || _wanted < _current);
+        if(set_metric_field_with_condition(metric->latest_time_s_clean, mrg_time_s(latest_time_s), true)) {
+            set_metric_field_with_condition(metric->first_time_s, mrg_time_s(latest_time_s), _current <= 0 || _wanted < _current);
 
             return true;
         }
@@ -544,8 +782,8 @@ inline bool mrg_metric_zero_disk_retention(MRG *mrg __maybe_unused, METRIC *metr
             internal_error(!countdown, "METRIC: giving up on updating the retention of metric without disk retention");
 
             do_again = false;
-            set_metric_field_with_condition(metric->first_time_s, min_first_time_s, true);
-            set_metric_field_with_condition(metric->latest_time_s_clean, max_end_time_s, true);
+            set_metric_field_with_condition(metric->first_time_s, mrg_time_s(min_first_time_s), true);
+            set_metric_field_with_condition(metric->latest_time_s_clean, mrg_time_s(max_end_time_s), true);
         }
     } while(do_again);
 
@@ -561,7 +799,7 @@ inline bool mrg_metric_set_hot_latest_time_s(MRG *mrg __maybe_unused, METRIC *me
 //                   "DBENGINE METRIC: metric latest time is in the future");
 
     if(likely(latest_time_s > 0)) {
-        __atomic_store_n(&metric->latest_time_s_hot, latest_time_s, __ATOMIC_RELAXED);
+        __atomic_store_n(&metric->latest_time_s_hot, mrg_time_s(latest_time_s), __ATOMIC_RELAXED);
         return true;
     }
 
@@ -688,13 +926,13 @@ inline void mrg_update_metric_retention_and_granularity_by_uuid(
         uint64_t old_samples = 0;
 
         if (update_every_s && metric->latest_update_every_s && metric->latest_time_s_clean)
-            old_samples = (metric->latest_time_s_clean - metric->first_time_s) / metric->latest_update_every_s;
+            old_samples = ((time_t)metric->latest_time_s_clean - (time_t)metric->first_time_s) / metric->latest_update_every_s;
 
         mrg_metric_expand_retention(mrg, metric, first_time_s, last_time_s, update_every_s);
 
         uint64_t new_samples = 0;
         if (update_every_s && metric->latest_update_every_s && metric->latest_time_s_clean)
-            new_samples = (metric->latest_time_s_clean - metric->first_time_s) / metric->latest_update_every_s;
+            new_samples = ((time_t)metric->latest_time_s_clean - (time_t)metric->first_time_s) / metric->latest_update_every_s;
 
         __atomic_add_fetch(&ctx->atomic.samples, new_samples - old_samples, __ATOMIC_RELAXED);
     }
@@ -727,6 +965,7 @@ inline void mrg_get_statistics(MRG *mrg, struct mrg_statistics *s) {
         s->search_misses += __atomic_load_n(&mrg->index[i].stats.search_misses, __ATOMIC_RELAXED);
         s->writers += __atomic_load_n(&mrg->index[i].stats.writers, __ATOMIC_RELAXED);
         s->writers_conflicts += __atomic_load_n(&mrg->index[i].stats.writers_conflicts, __ATOMIC_RELAXED);
+        s->index_size += __atomic_load_n(&mrg->index[i].hash.size, __ATOMIC_RELAXED) * sizeof(uint64_t);
     }
 
     s->size += sizeof(MRG) + sizeof(struct mrg_partition) * mrg->partitions;
@@ -868,6 +1107,55 @@ int mrg_unittest(void) {
     if(s.entries != 0)
         fatal("DBENGINE METRIC: invalid entries counter");
 
+    // delete every other metric, to test the index deletions and the reuse of the deleted metrics
+    {
+        size_t n = 100000;
+        nd_uuid_t *uuids = mallocz(n * sizeof(nd_uuid_t));
+        METRIC **metrics = mallocz(n * sizeof(METRIC *));
+        for(size_t round = 0; round < 2 ; round++) {
+            for (size_t i = 0; i < n; i++) {
+                if(!round)
+                    uuid_generate_random(uuids[i]);
+                else if(i % 2 == 0)
+                    continue;
+
+                MRG_ENTRY e = { .uuid = &uuids[i], .section = i % 3, .first_time_s = 1, .last_time_s = 2, .latest_update_every_s = 1 };
+                metrics[i] = mrg_metric_add_and_acquire(mrg, e, &ret);
+                if(!ret)
+                    fatal("DBENGINE METRIC: failed to add metric %zu", i);
+            }
+
+            for (size_t i = 1; i < n; i += 2) {
+                mrg_metric_set_first_time_s(mrg, metrics[i], 0);
+                mrg_metric_set_clean_latest_time_s(mrg, metrics[i], 0);
+                if(!mrg_metric_release_and_delete(mrg, metrics[i]))
+                    fatal("DBENGINE METRIC: cannot delete metric %zu", i);
+            }
+
+            for (size_t i = 0; i < n; i++) {
+                METRIC *m = mrg_metric_get_and_acquire(mrg, &uuids[i], i % 3);
+                if((i % 2 == 0) != (m != NULL) || (m && m != metrics[i]))
+                    fatal("DBENGINE METRIC: wrong lookup result for metric %zu after deletions", i);
+                if(m)
+                    mrg_metric_release(mrg, m);
+            }
+        }
+
+        for (size_t i = 0; i < n; i += 2) {
+            mrg_metric_set_first_time_s(mrg, metrics[i], 0);
+            mrg_metric_set_clean_latest_time_s(mrg, metrics[i], 0);
+            if(!mrg_metric_release_and_delete(mrg, metrics[i]))
+                fatal("DBENGINE METRIC: cannot delete metric %zu", i);
+        }
+
+        freez(metrics);
+        freez(uuids);
+
+        mrg_get_statistics(mrg, &s);
+        if(s.entries != 0)
+            fatal("DBENGINE METRIC: invalid entries counter after deletions");
+    }
+
     size_t entries = 1000000;
     size_t threads = mrg->partitions / 3 + 1;
     size_t tiers = 3;
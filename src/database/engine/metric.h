@@ -22,6 +22,7 @@ struct mrg_statistics {
 
     size_t entries;
     size_t size;    // total memory used, with indexing
+    size_t index_size; // the memory used by the index
 
     size_t additions;
     size_t additions_duplicate;
@@ -83,8 +84,7 @@ bool mrg_metric_set_writer(MRG *mrg, METRIC *metric);
 bool mrg_metric_clear_writer(MRG *mrg, METRIC *metric);
 
 void mrg_get_statistics(MRG *mrg, struct mrg_statistics *s);
-size_t mrg_aral_structures(void);
-size_t mrg_aral_overhead(void);
+size_t mrg_overhead(MRG *mrg);
 
 
 void mrg_update_metric_retention_and_granularity_by_uuid(
@@ -476,6 +476,22 @@ void pgd_copy_to_extent(PGD *pg, uint8_t *dst, uint32_t dst_size)
 // ----------------------------------------------------------------------------
 // data collection
 
+static void pgd_gorilla_write(PGD *pg, storage_number t)
+{
+    bool ok = gorilla_writer_write(pg->gorilla.writer, t);
+    if (!ok) {
+        gorilla_buffer_t *new_buffer = aral_mallocz(pgd_alloc_globals.aral_gorilla_buffer[pg->gorilla.aral_index]);
+        memset(new_buffer, 0, RRDENG_GORILLA_32BIT_BUFFER_SIZE);
+
+        gorilla_writer_add_buffer(pg->gorilla.writer, new_buffer, RRDENG_GORILLA_32BIT_BUFFER_SLOTS);
+        pg->gorilla.num_buffers += 1;
+        global_statistics_gorilla_buffer_add_hot();
+
+        ok = gorilla_writer_write(pg->gorilla.writer, t);
+        internal_fatal(ok == false, "Failed to writer value in newly allocated gorilla buffer.");
+    }
+}
+
 void pgd_append_point(PGD *pg,
                       usec_t point_in_time_ut __maybe_unused,
                       NETDATA_DOUBLE n,
@@ -533,17 +549,75 @@ void pgd_append_point(PGD *pg,
             if ((pg->options & PAGE_OPTION_ALL_VALUES_EMPTY) && does_storage_number_exist(t))
                 pg->options &= ~PAGE_OPTION_ALL_VALUES_EMPTY;
 
-            bool ok = gorilla_writer_write(pg->gorilla.writer, t);
-            if (!ok) {
-                gorilla_buffer_t *new_buffer = aral_mallocz(pgd_alloc_globals.aral_gorilla_buffer[pg->gorilla.aral_index]);
-                memset(new_buffer, 0, RRDENG_GORILLA_32BIT_BUFFER_SIZE);
+            pgd_gorilla_write(pg, t);
+            break;
+        }
+        default:
+            netdata_log_error("%s() - Unknown page type: %uc", __FUNCTION__, pg->type);
+            break;
+    }
+}
+
+void pgd_append_page(PGD *pg, PGD *src)
+{
+    if (!src || src == PGD_EMPTY || !src->used)
+        return;
+
+    if (unlikely(src->type != pg->type))
+        fatal("DBENGINE: cannot append a page of type %u to a page of type %u", src->type, pg->type);
+
+    if (!(pg->states & PGD_STATE_CREATED_FROM_COLLECTOR) || (pg->states & PGD_STATE_SCHEDULED_FOR_FLUSHING))
+        fatal("DBENGINE: appending a page is supported only on pages being collected");
+
+    if (!(src->states & PGD_STATE_CREATED_FROM_DISK))
+        fatal("DBENGINE: appending a page is supported only for pages loaded from disk");
+
+    switch (pg->type) {
+        case RRDENG_PAGE_TYPE_ARRAY_32BIT: {
+            if (unlikely(pg->used + src->used > pg->slots))
+                fatal("DBENGINE: attempted to append %u points beyond page size (slots %u, used %u)",
+                      src->used, pg->slots, pg->used);
+
+            storage_number *dst = (storage_number *)pg->raw.data + pg->used;
+            storage_number *data = (storage_number *)src->raw.data;
+            memcpy(dst, data, src->used * sizeof(*data));
+
+            for (uint32_t i = 0; i < src->used && (pg->options & PAGE_OPTION_ALL_VALUES_EMPTY); i++)
+                if (does_storage_number_exist(data[i]))
+                    pg->options &= ~PAGE_OPTION_ALL_VALUES_EMPTY;
 
-                gorilla_writer_add_buffer(pg->gorilla.writer, new_buffer, RRDENG_GORILLA_32BIT_BUFFER_SLOTS);
-                pg->gorilla.num_buffers += 1;
-                global_statistics_gorilla_buffer_add_hot();
+            pg->used += src->used;
+            break;
+        }
+        case RRDENG_PAGE_TYPE_ARRAY_TIER1: {
+            if (unlikely(pg->used + src->used > pg->slots))
+                fatal("DBENGINE: attempted to append %u points beyond page size (slots %u, used %u)",
+                      src->used, pg->slots, pg->used);
+
+            storage_number_tier1_t *dst = (storage_number_tier1_t *)pg->raw.data + pg->used;
+            storage_number_tier1_t *data = (storage_number_tier1_t *)src->raw.data;
+            memcpy(dst, data, src->used * sizeof(*data));
+
+            for (uint32_t i = 0; i < src->used && (pg->options & PAGE_OPTION_ALL_VALUES_EMPTY); i++)
+                if (fpclassify(data[i].sum_value) != FP_NAN)
+                    pg->options &= ~PAGE_OPTION_ALL_VALUES_EMPTY;
+
+            pg->used += src->used;
+            break;
+        }
+        case RRDENG_PAGE_TYPE_GORILLA_32BIT: {
+            gorilla_reader_t gr = gorilla_reader_init((void *) src->raw.data);
+
+            for (uint32_t i = 0; i < src->used; i++) {
+                uint32_t t;
+                if (!gorilla_reader_read(&gr, &t))
+                    break;
+
+                if ((pg->options & PAGE_OPTION_ALL_VALUES_EMPTY) && does_storage_number_exist(t))
+                    pg->options &= ~PAGE_OPTION_ALL_VALUES_EMPTY;
 
-                ok = gorilla_writer_write(pg->gorilla.writer, t);
-                internal_fatal(ok == false, "Failed to writer value in newly allocated gorilla buffer.");
+                pgd_gorilla_write(pg, t);
+                pg->used++;
             }
             break;
         }
@@ -689,3 +763,33 @@ bool pgdc_get_next_point(PGDC *pgdc, uint32_t expected_position __maybe_unused,
         }
     }
 }
+
+void pgd_summary(PGD *pg, struct rrdeng_page_summary *summary)
+{
+    memset(summary, 0, sizeof(*summary));
+
+    if (!pg || pg == PGD_EMPTY)
+        return;
+
+    PGDC pgdc;
+    pgdc_reset(&pgdc, pg, 0);
+
+    STORAGE_POINT sp = STORAGE_POINT_UNSET;
+    for (uint32_t position = 0; pgdc_get_next_point(&pgdc, position, &sp); position++) {
+        if (!sp.count || !netdata_double_isnumber(sp.sum))
+            continue;
+
+        if (!summary->count) {
+            summary->min = sp.min;
+            summary->max = sp.max;
+        }
+        else {
+            if (sp.min < summary->min) summary->min = sp.min;
+            if (sp.max > summary->max) summary->max = sp.max;
+        }
+
+        summary->sum += sp.sum;
+        summary->count += sp.count;
+        summary->anomaly_count += sp.anomaly_count;
+    }
+}
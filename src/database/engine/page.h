@@ -48,6 +48,12 @@ void pgd_append_point(PGD *pg,
                       SN_FLAGS flags,
                       uint32_t expected_slot);
 
+// append all the points of a page loaded from disk to a page being collected,
+// without decoding and encoding them again - the points must fit the page
+void pgd_append_page(PGD *pg, PGD *src);
+
+void pgd_summary(PGD *pg, struct rrdeng_page_summary *summary);
+
 void pgdc_reset(PGDC *pgdc, PGD *pgd, uint32_t position);
 bool pgdc_get_next_point(PGDC *pgdc, uint32_t expected_position, STORAGE_POINT *sp);
 
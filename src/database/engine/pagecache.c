@@ -302,6 +302,7 @@ static size_t get_page_list_from_pgc(PGC *cache, METRIC *metric, struct rrdengin
                     pd->datafile.extent.pos = xio->pos;
                     pd->datafile.extent.bytes = xio->bytes;
                     pd->datafile.fileno = pd->datafile.ptr->fileno;
+                    pd->summary = xio->summary;
                     pd->status |= PDC_PAGE_DATAFILE_ACQUIRED | PDC_PAGE_DISK_PENDING;
                 }
                 else {
@@ -356,15 +357,34 @@ static void pgc_inject_gap(struct rrdengine_instance *ctx, METRIC *metric, time_
     pgc_page_release(main_cache, page);
 }
 
+// a page can be answered by its summary when all its points, and the point following it,
+// end in the same time group of the query - so that the query will not interpolate them
+// across groups - and it does not overlap the data the query has already used
+static inline bool page_summary_is_usable(struct page_details *pd, time_t now_s, time_t wanted_end_time_s, time_t group_anchor_s, time_t group_every_s) {
+    if(!group_every_s || pd->page || !pd->summary.count || !pd->update_every_s)
+        return false;
+
+    if(pd->first_time_s < now_s || pd->last_time_s > wanted_end_time_s || pd->last_time_s < group_anchor_s)
+        return false;
+
+    time_t group_start_s = group_anchor_s + (pd->last_time_s - group_anchor_s) / group_every_s * group_every_s;
+
+    return pd->first_time_s - (time_t)pd->update_every_s >= group_start_s &&
+           pd->last_time_s + (time_t)pd->update_every_s < group_start_s + group_every_s;
+}
+
 static size_t list_has_time_gaps(
         struct rrdengine_instance *ctx,
         METRIC *metric,
         Pvoid_t JudyL_page_array,
         time_t wanted_start_time_s,
         time_t wanted_end_time_s,
+        time_t group_anchor_s,
+        time_t group_every_s,
         size_t *pages_total,
         size_t *pages_found_pass4,
         size_t *pages_to_load_from_disk,
+        size_t *pages_summarized,
         size_t *pages_overlapping,
         time_t *optimal_end_time_s,
         bool populate_gaps,
@@ -372,6 +392,7 @@ static size_t list_has_time_gaps(
 ) {
     // we will recalculate these, so zero them
     *pages_to_load_from_disk = 0;
+    *pages_summarized = 0;
     *pages_overlapping = 0;
     *optimal_end_time_s = 0;
     *common_status = 0;
@@ -391,7 +412,7 @@ static size_t list_has_time_gaps(
     this_page_start_time = 0;
     while((PValue = PDCJudyLFirstThenNext(JudyL_page_array, &this_page_start_time, &first))) {
         pd = *PValue;
-        pd->status &= ~(PDC_PAGE_SKIP|PDC_PAGE_PREPROCESSED);
+        pd->status &= ~(PDC_PAGE_SKIP|PDC_PAGE_PREPROCESSED|PDC_PAGE_SUMMARY);
     }
 
     // ------------------------------------------------------------------------
@@ -410,6 +431,9 @@ static size_t list_has_time_gaps(
         pd->status |= PDC_PAGE_PREPROCESSED;
         pages_pass2++;
 
+        if(page_summary_is_usable(pd, now_s, wanted_end_time_s, group_anchor_s, group_every_s))
+            pd->status |= PDC_PAGE_SUMMARY;
+
         if(pd->update_every_s)
             dt_s = pd->update_every_s;
 
@@ -439,7 +463,7 @@ static size_t list_has_time_gaps(
         if(!(pd->status & PDC_PAGE_PREPROCESSED)) {
             (*pages_overlapping)++;
             pd->status |= PDC_PAGE_SKIP;
-            pd->status &= ~(PDC_PAGE_READY | PDC_PAGE_DISK_PENDING);
+            pd->status &= ~(PDC_PAGE_READY | PDC_PAGE_DISK_PENDING | PDC_PAGE_SUMMARY);
             *common_status |= pd->status;
             continue;
         }
@@ -452,13 +476,20 @@ static size_t list_has_time_gaps(
             if(pd->page) {
                 (*pages_found_pass4)++;
 
-                pd->status &= ~PDC_PAGE_DISK_PENDING;
+                pd->status &= ~(PDC_PAGE_DISK_PENDING | PDC_PAGE_SUMMARY);
                 pd->status |= PDC_PAGE_READY | PDC_PAGE_PRELOADED | PDC_PAGE_PRELOADED_PASS4;
 
                 if(pgd_is_empty(pgc_page_data(pd->page)))
                     pd->status |= PDC_PAGE_EMPTY;
 
             }
+            else if((pd->status & PDC_PAGE_SUMMARY) && !(pd->status & PDC_PAGE_FAILED)) {
+                // no need to load it, the query will use its summary
+                (*pages_summarized)++;
+
+                pd->status &= ~PDC_PAGE_DISK_PENDING;
+                pd->status |= PDC_PAGE_READY;
+            }
             else if(!(pd->status & PDC_PAGE_FAILED) && (pd->status & PDC_PAGE_DATAFILE_ACQUIRED)) {
                 (*pages_to_load_from_disk)++;
 
@@ -472,7 +503,7 @@ static size_t list_has_time_gaps(
             }
         }
         else {
-            pd->status &= ~PDC_PAGE_DISK_PENDING;
+            pd->status &= ~(PDC_PAGE_DISK_PENDING | PDC_PAGE_SUMMARY);
             pd->status |= (PDC_PAGE_READY | PDC_PAGE_PRELOADED);
         }
 
@@ -494,6 +525,9 @@ static size_t get_page_list_from_journal_v2(struct rrdengine_instance *ctx, METR
     nd_uuid_t *uuid = mrg_metric_uuid(main_mrg, metric);
     Word_t metric_id = mrg_metric_id(main_mrg, metric);
 
+    // hashed once, for all the journal files of the tier
+    uint64_t uuid_hash = journal_metric_uuid_hash(uuid);
+
     time_t wanted_start_time_s = (time_t)(start_time_ut / USEC_PER_SEC);
     time_t wanted_end_time_s = (time_t)(end_time_ut / USEC_PER_SEC);
 
@@ -519,9 +553,8 @@ static size_t get_page_list_from_journal_v2(struct rrdengine_instance *ctx, METR
 
         // the datafile possibly contains useful data for this query
 
-        size_t journal_metric_count = (size_t)j2_header->metric_count;
         struct journal_metric_list *uuid_list = (struct journal_metric_list *)((uint8_t *) j2_header + j2_header->metric_offset);
-        struct journal_metric_list *uuid_entry = bsearch(uuid,uuid_list,journal_metric_count,sizeof(*uuid_list), journal_metric_uuid_compare);
+        struct journal_metric_list *uuid_entry = journalfile_v2_metric_find(datafile->journalfile, j2_header, uuid, uuid_hash);
 
         if (unlikely(!uuid_entry)) {
             // our UUID is not in this datafile
@@ -534,6 +567,20 @@ static size_t get_page_list_from_journal_v2(struct rrdengine_instance *ctx, METR
         struct journal_extent_list *extent_list = (void *)((uint8_t *)j2_header + j2_header->extent_offset);
         uint32_t uuid_page_entries = page_list_header->entries;
 
+        // the page summaries are in the order of the page lists, without their headers and trailers
+        struct rrdeng_page_summary *summaries = journalfile_v2_page_summaries(datafile->journalfile, j2_header);
+        if (summaries) {
+            size_t metric_index = uuid_entry - uuid_list;
+            size_t first_page = (uuid_entry->page_offset - j2_header->page_offset -
+                                 metric_index * (sizeof(struct journal_page_header) + sizeof(struct journal_v2_block_trailer))) /
+                                sizeof(struct journal_page_list);
+
+            if (first_page + uuid_page_entries <= j2_header->page_count)
+                summaries += first_page;
+            else
+                summaries = NULL;
+        }
+
         for (uint32_t index = 0; index < uuid_page_entries; index++) {
             struct journal_page_list *page_entry_in_journal = &page_list[index];
 
@@ -559,6 +606,7 @@ static size_t get_page_list_from_journal_v2(struct rrdengine_instance *ctx, METR
                         .page_length = page_length,
                         .file = datafile->file,
                         .fileno = datafile->fileno,
+                        .summary = (summaries) ? summaries[index] : (struct rrdeng_page_summary){ 0 },
                 };
 
                 PGC_PAGE *page = pgc_page_add_and_acquire(open_cache, (PGC_ENTRY) {
@@ -621,6 +669,7 @@ void add_page_details_from_journal_v2(PGC_PAGE *page, void *JudyL_pptr) {
     pd->datafile.ptr = datafile;
     pd->update_every_s = (uint32_t) pgc_page_update_every_s(page);
     pd->metric_id = metric_id;
+    pd->summary = ei->summary;
     pd->status |= PDC_PAGE_DISK_PENDING | PDC_PAGE_SOURCE_JOURNAL_V2 | PDC_PAGE_DATAFILE_ACQUIRED;
 }
 
@@ -633,6 +682,8 @@ static Pvoid_t get_page_list(
         METRIC *metric,
         usec_t start_time_ut,
         usec_t end_time_ut,
+        time_t group_anchor_s,
+        time_t group_every_s,
         time_t *optimal_end_time_s,
         size_t *pages_to_load_from_disk,
         PDC_PAGE_STATUS *common_status
@@ -650,6 +701,7 @@ static Pvoid_t get_page_list(
             pages_found_in_open_cache = 0,
             pages_found_in_journals_v2 = 0,
             pages_found_pass4 = 0,
+            pages_summarized = 0,
             pages_overlapping = 0,
             pages_total = 0;
 
@@ -671,8 +723,9 @@ static Pvoid_t get_page_list(
 
     if(pages_found_in_main_cache && !cache_gaps) {
         query_gaps = list_has_time_gaps(ctx, metric, JudyL_page_array, wanted_start_time_s, wanted_end_time_s,
-                                        &pages_total, &pages_found_pass4, pages_to_load_from_disk, &pages_overlapping,
-                                        optimal_end_time_s, false, common_status);
+                                        group_anchor_s, group_every_s,
+                                        &pages_total, &pages_found_pass4, pages_to_load_from_disk, &pages_summarized,
+                                        &pages_overlapping, optimal_end_time_s, false, common_status);
 
         if (pages_total && !query_gaps)
             goto we_are_done;
@@ -693,8 +746,9 @@ static Pvoid_t get_page_list(
 
     if(pages_found_in_open_cache) {
         query_gaps = list_has_time_gaps(ctx, metric, JudyL_page_array, wanted_start_time_s, wanted_end_time_s,
-                                        &pages_total, &pages_found_pass4, pages_to_load_from_disk, &pages_overlapping,
-                                        optimal_end_time_s, false, common_status);
+                                        group_anchor_s, group_every_s,
+                                        &pages_total, &pages_found_pass4, pages_to_load_from_disk, &pages_summarized,
+                                        &pages_overlapping, optimal_end_time_s, false, common_status);
 
         if (pages_total && !query_gaps)
             goto we_are_done;
@@ -717,8 +771,9 @@ static Pvoid_t get_page_list(
 
     pass4_ut = now_monotonic_usec();
     query_gaps = list_has_time_gaps(ctx, metric, JudyL_page_array, wanted_start_time_s, wanted_end_time_s,
-                                    &pages_total, &pages_found_pass4, pages_to_load_from_disk, &pages_overlapping,
-                                    optimal_end_time_s, true, common_status);
+                                    group_anchor_s, group_every_s,
+                                    &pages_total, &pages_found_pass4, pages_to_load_from_disk, &pages_summarized,
+                                    &pages_overlapping, optimal_end_time_s, true, common_status);
 
 we_are_done:
     finish_ut = now_monotonic_usec();
@@ -742,6 +797,7 @@ we_are_done:
     __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_data_source_main_cache, pages_found_in_main_cache, __ATOMIC_RELAXED);
     __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_data_source_main_cache_at_pass4, pages_found_pass4, __ATOMIC_RELAXED);
     __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_to_load_from_disk, *pages_to_load_from_disk, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_data_source_summary, pages_summarized, __ATOMIC_RELAXED);
     __atomic_add_fetch(&rrdeng_cache_efficiency_stats.pages_overlapping_skipped, pages_overlapping, __ATOMIC_RELAXED);
 
     return JudyL_page_array;
@@ -763,6 +819,8 @@ void rrdeng_prep_query(struct page_details_control *pdc, bool worker) {
     pdc->page_list_JudyL = get_page_list(pdc->ctx, pdc->metric,
                                                  pdc->start_time_s * USEC_PER_SEC,
                                                  pdc->end_time_s * USEC_PER_SEC,
+                                                 pdc->group_anchor_s,
+                                                 pdc->group_every_s,
                                                  &pdc->optimal_end_time_s,
                                                  &pdc->pages_to_load_from_disk,
                                                  &pdc->common_status);
@@ -815,6 +873,8 @@ void pg_cache_preload(struct rrdeng_query_handle *handle) {
     handle->pdc->start_time_s = handle->start_time_s;
     handle->pdc->end_time_s = handle->end_time_s;
     handle->pdc->priority = handle->priority;
+    handle->pdc->group_anchor_s = handle->group_anchor_s;
+    handle->pdc->group_every_s = handle->group_every_s;
     handle->pdc->optimal_end_time_s = handle->end_time_s;
     handle->pdc->ctx = handle->ctx;
     handle->pdc->refcount = 1;
@@ -846,8 +906,11 @@ struct pgc_page *pg_cache_lookup_next(
         PDC *pdc,
         time_t now_s,
         uint32_t last_update_every_s,
-        size_t *entries
+        size_t *entries,
+        struct page_details **summary_pd
 ) {
+    *summary_pd = NULL;
+
     if (unlikely(!pdc))
         return NULL;
 
@@ -871,6 +934,13 @@ struct pgc_page *pg_cache_lookup_next(
         if (!pd)
             break;
 
+        if(pdc_page_status_check(pd, PDC_PAGE_SUMMARY)) {
+            // there is no page to load, the caller will use the summary of this page
+            pdc_page_status_set(pd, PDC_PAGE_PROCESSED);
+            *summary_pd = pd;
+            return NULL;
+        }
+
         page = pd->page;
         page_from_pd = true;
         preloaded = pdc_page_status_check(pd, PDC_PAGE_PRELOADED);
@@ -984,7 +1054,8 @@ struct pgc_page *pg_cache_lookup_next(
 }
 
 void pgc_open_add_hot_page(Word_t section, Word_t metric_id, time_t start_time_s, time_t end_time_s, uint32_t update_every_s,
-           struct rrdengine_datafile *datafile, uint64_t extent_offset, unsigned extent_size, uint32_t page_length) {
+           struct rrdengine_datafile *datafile, uint64_t extent_offset, unsigned extent_size, uint32_t page_length,
+           const struct rrdeng_page_summary *summary) {
 
     if(!datafile_acquire(datafile, DATAFILE_ACQUIRE_OPEN_CACHE)) // for open cache item
         fatal("DBENGINE: cannot acquire datafile to put page in open cache");
@@ -994,7 +1065,8 @@ void pgc_open_add_hot_page(Word_t section, Word_t metric_id, time_t start_time_s
             .fileno = datafile->fileno,
             .pos = extent_offset,
             .bytes = extent_size,
-            .page_length = page_length
+            .page_length = page_length,
+            .summary = (summary) ? *summary : (struct rrdeng_page_summary){ 0 },
     };
 
     PGC_ENTRY page_entry = {
@@ -26,6 +26,7 @@ struct page_descr_with_data {
     uint32_t update_every_s;
     uint32_t page_length;
     struct pgd *pgd;
+    struct rrdeng_page_summary summary;
 
     struct {
         struct page_descr_with_data *prev;
@@ -39,13 +40,14 @@ struct pg_alignment {
 
 struct rrdeng_query_handle;
 struct page_details_control;
+struct page_details;
 
 void rrdeng_prep_wait(struct page_details_control *pdc);
 void rrdeng_prep_query(struct page_details_control *pdc, bool worker);
 void pg_cache_preload(struct rrdeng_query_handle *handle);
-struct pgc_page *pg_cache_lookup_next(struct rrdengine_instance *ctx, struct page_details_control *pdc, time_t now_s, uint32_t last_update_every_s, size_t *entries);
+struct pgc_page *pg_cache_lookup_next(struct rrdengine_instance *ctx, struct page_details_control *pdc, time_t now_s, uint32_t last_update_every_s, size_t *entries, struct page_details **summary_pd);
 void pgc_and_mrg_initialize(void);
 
-void pgc_open_add_hot_page(Word_t section, Word_t metric_id, time_t start_time_s, time_t end_time_s, uint32_t update_every_s, struct rrdengine_datafile *datafile, uint64_t extent_offset, unsigned extent_size, uint32_t page_length);
+void pgc_open_add_hot_page(Word_t section, Word_t metric_id, time_t start_time_s, time_t end_time_s, uint32_t update_every_s, struct rrdengine_datafile *datafile, uint64_t extent_offset, unsigned extent_size, uint32_t page_length, const struct rrdeng_page_summary *summary);
 
 #endif /* NETDATA_PAGECACHE_H */
@@ -1206,6 +1206,254 @@ static inline void datafile_extent_read_free(void *buffer) {
     posix_memfree(buffer);
 }
 
+// read an extent from disk and add it to the extent cache
+// returns the extent cache page acquired, or NULL when the extent cannot be read
+static PGC_PAGE *extent_cache_load_from_disk(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile, uv_file file, uint64_t extent_offset, uint32_t extent_size, bool *added_ptr) {
+    void *extent_data = datafile_extent_read(ctx, file, extent_offset, extent_size);
+    if(!extent_data)
+        return NULL;
+
+    void *copied_extent_compressed_data = dbengine_extent_alloc(extent_size);
+    memcpy(copied_extent_compressed_data, extent_data, extent_size);
+    datafile_extent_read_free(extent_data);
+
+    bool added = false;
+    PGC_PAGE *extent_cache_page = pgc_page_add_and_acquire(extent_cache, (PGC_ENTRY) {
+            .hot = false,
+            .section = (Word_t) ctx,
+            .metric_id = (Word_t) datafile->fileno,
+            .start_time_s = (time_t) extent_offset,
+            .size = extent_size,
+            .end_time_s = 0,
+            .update_every_s = 0,
+            .data = copied_extent_compressed_data,
+    }, &added);
+
+    if (!added) {
+        dbengine_extent_free(copied_extent_compressed_data, extent_size);
+        internal_fatal(extent_size != pgc_page_data_size(extent_cache, extent_cache_page),
+                       "DBENGINE: cache size does not match the expected size");
+    }
+
+    if(added_ptr)
+        *added_ptr = added;
+
+    return extent_cache_page;
+}
+
+// ----------------------------------------------------------------------------
+// extent read-ahead
+//
+// Dashboards query the same metrics over contiguous time windows, so the extents
+// queries load from a datafile tend to be adjacent on disk, going forward while
+// time advances, or backward while the user scrolls back in time.
+// When queries load adjacent extents in a row, the next extents in the same
+// direction are read at best effort priority into the extent cache, so that
+// the next query finds them there.
+
+bool dbengine_extent_readahead_enabled = true;
+size_t dbengine_extent_readahead_extents = 2;
+
+#define EXTENT_READAHEAD_MIN_STREAK 2
+#define EXTENT_READAHEAD_MAX_EXTENTS 8
+#define EXTENT_READAHEAD_MAX_RUNNING 4
+
+static size_t extent_readahead_running = 0;
+
+struct extent_readahead {
+    struct rrdengine_datafile *datafile;
+    uint64_t offset;                    // the extent the queries are at
+    int direction;                      // 1 = forward, -1 = backward
+    size_t extents;
+};
+
+static void extent_readahead_observe(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile, uint64_t extent_offset, uint32_t extent_size, bool from_cache) {
+    if(!dbengine_extent_readahead_enabled || !dbengine_extent_readahead_extents)
+        return;
+
+    uint64_t extent_end = extent_offset + ALIGN_BYTES_CEILING(extent_size);
+    bool hit = false;
+    int direction = 0;
+
+    spinlock_lock(&datafile->readahead.spinlock);
+
+    if(from_cache) {
+        for(size_t i = 0; i < EXTENT_READAHEAD_TRACKED; i++) {
+            if(datafile->readahead.prefetched[i] == extent_offset) {
+                datafile->readahead.prefetched[i] = 0;
+                hit = true;
+                break;
+            }
+        }
+    }
+
+    if(extent_offset == datafile->readahead.last_end)
+        datafile->readahead.streak = datafile->readahead.streak > 0 ? datafile->readahead.streak + 1 : 1;
+    else if(extent_end == datafile->readahead.last_offset)
+        datafile->readahead.streak = datafile->readahead.streak < 0 ? datafile->readahead.streak - 1 : -1;
+    else if(extent_offset != datafile->readahead.last_offset)
+        // the same extent loaded again by another query does not break the streak
+        datafile->readahead.streak = 0;
+
+    datafile->readahead.last_offset = extent_offset;
+    datafile->readahead.last_end = extent_end;
+
+    if(!datafile->readahead.running) {
+        // prefetch again when the queries reach the last extent prefetched in their direction
+        if(datafile->readahead.streak >= EXTENT_READAHEAD_MIN_STREAK &&
+            extent_offset >= datafile->readahead.forward_last)
+            direction = 1;
+
+        else if(datafile->readahead.streak <= -EXTENT_READAHEAD_MIN_STREAK &&
+                extent_offset <= datafile->readahead.backward_first)
+            direction = -1;
+
+        if(direction)
+            datafile->readahead.running = true;
+    }
+
+    spinlock_unlock(&datafile->readahead.spinlock);
+
+    if(hit)
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extents_readahead_hits, 1, __ATOMIC_RELAXED);
+
+    if(!direction)
+        return;
+
+    // only datafiles with a journal v2 file have a complete extent list
+    // the extents of the datafile being written are usually in the main cache anyway
+    if(!ctx_is_available_for_queries(ctx) || !journalfile_v2_data_available(datafile->journalfile))
+        goto skip;
+
+    if(__atomic_add_fetch(&extent_readahead_running, 1, __ATOMIC_RELAXED) > EXTENT_READAHEAD_MAX_RUNNING) {
+        __atomic_sub_fetch(&extent_readahead_running, 1, __ATOMIC_RELAXED);
+        goto skip;
+    }
+
+    if(!datafile_acquire(datafile, DATAFILE_ACQUIRE_READAHEAD)) {
+        __atomic_sub_fetch(&extent_readahead_running, 1, __ATOMIC_RELAXED);
+        goto skip;
+    }
+
+    struct extent_readahead *ra = mallocz(sizeof(*ra));
+    ra->datafile = datafile;
+    ra->offset = extent_offset;
+    ra->direction = direction;
+    ra->extents = MIN(dbengine_extent_readahead_extents, EXTENT_READAHEAD_MAX_EXTENTS);
+
+    __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extents_readahead_requested, 1, __ATOMIC_RELAXED);
+    rrdeng_enq_cmd(ctx, RRDENG_OPCODE_EXTENT_READAHEAD, ra, NULL, STORAGE_PRIORITY_BEST_EFFORT, NULL, NULL);
+    return;
+
+skip:
+    __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extents_readahead_skipped, 1, __ATOMIC_RELAXED);
+    spinlock_lock(&datafile->readahead.spinlock);
+    datafile->readahead.running = false;
+    spinlock_unlock(&datafile->readahead.spinlock);
+}
+
+// find the extents next to offset, in the given direction, closest first
+// the extent list of journal v2 files is not sorted by offset, so we scan it
+static size_t extent_readahead_neighbours(struct journal_v2_header *j2_header, uint64_t offset, int direction, struct journal_extent_list *out, size_t wanted) {
+    struct journal_extent_list *extent_list = (void *)((uint8_t *)j2_header + j2_header->extent_offset);
+    size_t found = 0;
+
+    for(uint32_t i = 0; i < j2_header->extent_count; i++) {
+        uint64_t pos = extent_list[i].datafile_offset;
+        if(direction > 0 ? pos <= offset : pos >= offset)
+            continue;
+
+        size_t slot = found;
+        while(slot && (direction > 0 ? out[slot - 1].datafile_offset > pos : out[slot - 1].datafile_offset < pos)) {
+            if(slot < wanted)
+                out[slot] = out[slot - 1];
+            slot--;
+        }
+
+        if(slot < wanted) {
+            out[slot] = extent_list[i];
+            if(found < wanted)
+                found++;
+        }
+    }
+
+    return found;
+}
+
+void extent_readahead_execute(struct rrdengine_instance *ctx, void *data) {
+    struct extent_readahead *ra = data;
+    struct rrdengine_datafile *datafile = ra->datafile;
+    struct journal_extent_list extents[EXTENT_READAHEAD_MAX_EXTENTS];
+    size_t found = 0;
+
+    struct journal_v2_header *j2_header = NULL;
+    if(ctx_is_available_for_queries(ctx))
+        j2_header = journalfile_v2_data_acquire(datafile->journalfile, NULL, 0, 0);
+
+    if(j2_header) {
+        found = extent_readahead_neighbours(j2_header, ra->offset, ra->direction, extents, ra->extents);
+        journalfile_v2_data_release(datafile->journalfile);
+    }
+
+    size_t loaded = 0, already_cached = 0, failed = 0;
+    uint64_t horizon = ra->offset;
+    for(size_t i = 0; i < found; i++) {
+        uint64_t offset = extents[i].datafile_offset;
+        uint32_t size = extents[i].datafile_size;
+        horizon = offset;
+
+        PGC_PAGE *page = pgc_page_get_and_acquire(extent_cache, (Word_t)ctx, (Word_t)datafile->fileno, (time_t)offset, PGC_SEARCH_EXACT);
+        if(page) {
+            pgc_page_release(extent_cache, page);
+            already_cached++;
+            continue;
+        }
+
+        bool added = false;
+        page = extent_cache_load_from_disk(ctx, datafile, datafile->file, offset, size, &added);
+        if(!page) {
+            failed++;
+            break;
+        }
+        pgc_page_release(extent_cache, page);
+
+        if(!added) {
+            // a query loaded it meanwhile
+            already_cached++;
+            continue;
+        }
+
+        loaded++;
+        spinlock_lock(&datafile->readahead.spinlock);
+        datafile->readahead.prefetched[datafile->readahead.prefetched_next++ % EXTENT_READAHEAD_TRACKED] = offset;
+        spinlock_unlock(&datafile->readahead.spinlock);
+    }
+
+    spinlock_lock(&datafile->readahead.spinlock);
+    if(j2_header) {
+        // when there are no more extents in this direction, stop prefetching in it
+        if(ra->direction > 0)
+            datafile->readahead.forward_last = found ? horizon : UINT64_MAX;
+        else
+            datafile->readahead.backward_first = found ? horizon : 0;
+    }
+    datafile->readahead.running = false;
+    spinlock_unlock(&datafile->readahead.spinlock);
+
+    if(loaded)
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extents_readahead_loaded, loaded, __ATOMIC_RELAXED);
+
+    if(already_cached)
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extents_readahead_already_cached, already_cached, __ATOMIC_RELAXED);
+
+    if(failed)
+        __atomic_add_fetch(&rrdeng_cache_efficiency_stats.extents_readahead_failed, failed, __ATOMIC_RELAXED);
+
+    datafile_release(datafile, DATAFILE_ACQUIRE_READAHEAD);
+    __atomic_sub_fetch(&extent_readahead_running, 1, __ATOMIC_RELAXED);
+    freez(ra);
+}
+
 void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *epdl, bool worker) {
     if(worker)
         worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
@@ -1253,34 +1501,8 @@ void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *e
         if(worker)
             worker_is_busy(UV_EVENT_DBENGINE_EXTENT_MMAP);
 
-        void *extent_data = datafile_extent_read(ctx, epdl->file, epdl->extent_offset, epdl->extent_size);
-        if(extent_data != NULL) {
-
-            void *copied_extent_compressed_data = dbengine_extent_alloc(epdl->extent_size);
-            memcpy(copied_extent_compressed_data, extent_data, epdl->extent_size);
-            datafile_extent_read_free(extent_data);
-
-            if(worker)
-                worker_is_busy(UV_EVENT_DBENGINE_EXTENT_CACHE_LOOKUP);
-
-            bool added = false;
-            extent_cache_page = pgc_page_add_and_acquire(extent_cache, (PGC_ENTRY) {
-                    .hot = false,
-                    .section = (Word_t) ctx,
-                    .metric_id = (Word_t) epdl->datafile->fileno,
-                    .start_time_s = (time_t) epdl->extent_offset,
-                    .size = epdl->extent_size,
-                    .end_time_s = 0,
-                    .update_every_s = 0,
-                    .data = copied_extent_compressed_data,
-            }, &added);
-
-            if (!added) {
-                dbengine_extent_free(copied_extent_compressed_data, epdl->extent_size);
-                internal_fatal(epdl->extent_size != pgc_page_data_size(extent_cache, extent_cache_page),
-                               "DBENGINE: cache size does not match the expected size");
-            }
-
+        extent_cache_page = extent_cache_load_from_disk(ctx, epdl->datafile, epdl->file, epdl->extent_offset, epdl->extent_size, NULL);
+        if(extent_cache_page) {
             extent_compressed_data = pgc_page_data(extent_cache_page);
 
             loaded_pages_tag |= PDC_PAGE_EXTENT_FROM_DISK;
@@ -1289,6 +1511,8 @@ void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *e
     }
 
     if(extent_compressed_data) {
+        extent_readahead_observe(ctx, epdl->datafile, epdl->extent_offset, epdl->extent_size, extent_found_in_cache);
+
         // Need to decompress and then process the pagelist
         bool extent_used = epdl_populate_pages_from_extent_data(
                 ctx, extent_compressed_data, epdl->extent_size,
@@ -33,6 +33,7 @@ typedef struct extent_page_details_list EPDL;
 typedef void (*execute_extent_page_details_list_t)(struct rrdengine_instance *ctx, EPDL *epdl, enum storage_priority priority);
 void pdc_to_epdl_router(struct rrdengine_instance *ctx, struct page_details_control *pdc, execute_extent_page_details_list_t exec_first_extent_list, execute_extent_page_details_list_t exec_rest_extent_list);
 void epdl_find_extent_and_populate_pages(struct rrdengine_instance *ctx, EPDL *epdl, bool worker);
+void extent_readahead_execute(struct rrdengine_instance *ctx, void *data);
 
 size_t pdc_cache_size(void);
 size_t pd_cache_size(void);
@@ -23,7 +23,10 @@
 #define RRDENG_COMPRESSION_LZ4  (1)
 #define RRDENG_COMPRESSION_ZSTD (2)
 
-#define RRDENG_DF_SB_PADDING_SZ (RRDENG_BLOCK_SIZE - (RRDENG_MAGIC_SZ + RRDENG_VER_SZ + sizeof(uint8_t)))
+#define RRDENG_DF_SB_PADDING_SZ (RRDENG_BLOCK_SIZE - (RRDENG_MAGIC_SZ + RRDENG_VER_SZ + 2 * sizeof(uint8_t)))
+
+/* the datafile has been written by the compactor */
+#define RRDENG_DF_SB_FLAG_COMPACTED (1 << 0)
 
 /*
  * Data file persistent super-block
@@ -33,6 +36,7 @@ struct rrdeng_df_sb {
     char magic_number[RRDENG_MAGIC_SZ];
     char version[RRDENG_VER_SZ];
     uint8_t tier;
+    uint8_t flags; /* RRDENG_DF_SB_FLAG_*, zero on files written by older agents */
     uint8_t padding[RRDENG_DF_SB_PADDING_SZ];
 } __attribute__ ((packed));
 
@@ -64,6 +68,19 @@ struct rrdeng_extent_page_descr {
     };
 } __attribute__ ((packed));
 
+/*
+ * Page summary (zone map)
+ * the aggregated values of all the points of a page, so that queries can use
+ * them without loading the page - stored in journal v2 files, one per page
+ */
+struct rrdeng_page_summary {
+    double min;
+    double max;
+    double sum;
+    uint32_t count;             /* points with values, 0 when the page has no summary */
+    uint32_t anomaly_count;
+} __attribute__ ((packed));
+
 /*
  * Data file extent header
  */
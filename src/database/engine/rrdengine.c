@@ -13,6 +13,25 @@ rrdeng_stats_t global_flushing_pressure_page_deletions = 0;
 
 unsigned rrdeng_pages_per_extent = DEFAULT_PAGES_PER_EXTENT;
 
+bool dbengine_extent_write_coalescing = true;
+
+struct rrdeng_extent_write_stats rrdeng_extent_write_stats = { 0 };
+
+const struct rrdeng_extent_write_latency_bucket rrdeng_extent_write_latency_buckets[RRDENG_EXTENT_WRITE_LATENCY_BUCKETS] = {
+        { .upto_ut = 1 * USEC_PER_MS,    .name = "1ms" },
+        { .upto_ut = 5 * USEC_PER_MS,    .name = "5ms" },
+        { .upto_ut = 10 * USEC_PER_MS,   .name = "10ms" },
+        { .upto_ut = 50 * USEC_PER_MS,   .name = "50ms" },
+        { .upto_ut = 100 * USEC_PER_MS,  .name = "100ms" },
+        { .upto_ut = 500 * USEC_PER_MS,  .name = "500ms" },
+        { .upto_ut = 1 * USEC_PER_SEC,   .name = "1s" },
+        { .upto_ut = 0,                  .name = "more" },
+};
+
+// coalesced datafile writes are limited by these
+#define EXTENT_WRITE_COALESCE_MAX_EXTENTS (64)
+#define EXTENT_WRITE_COALESCE_MAX_BYTES (4 * 1024 * 1024)
+
 #if WORKER_UTILIZATION_MAX_JOB_TYPES < (RRDENG_OPCODE_MAX + 2)
 #error Please increase WORKER_UTILIZATION_MAX_JOB_TYPES to at least (RRDENG_MAX_OPCODE + 2)
 #endif
@@ -81,6 +100,12 @@ struct rrdeng_main {
         ARAL *ar;
     } xt_io_descr;
 
+    struct {
+        // extents ready to be written, only touched by the event loop
+        struct extent_io_descriptor *base;
+        size_t count;
+    } extent_writes;
+
 } rrdeng_main = {
         .thread = 0,
         .loop = {},
@@ -651,7 +676,7 @@ static void *extent_flushed_to_open_tp_worker(struct rrdengine_instance *ctx __m
                     (time_t) (descr->end_time_ut / USEC_PER_SEC),
                     descr->update_every_s,
                     datafile,
-                    xt_io_descr->pos, xt_io_descr->bytes, descr->page_length);
+                    xt_io_descr->pos, xt_io_descr->bytes, descr->page_length, &descr->summary);
 
         page_descriptor_release(descr);
     }
@@ -671,6 +696,32 @@ static void *extent_flushed_to_open_tp_worker(struct rrdengine_instance *ctx __m
     return data;
 }
 
+static inline void extent_write_latency_add(usec_t latency_ut) {
+    size_t b;
+    for(b = 0; b < RRDENG_EXTENT_WRITE_LATENCY_BUCKETS - 1 && latency_ut > rrdeng_extent_write_latency_buckets[b].upto_ut; b++) ;
+
+    __atomic_add_fetch(&rrdeng_extent_write_stats.latency[b], 1, __ATOMIC_RELAXED);
+}
+
+static void extent_write_datafile_io_completed(struct extent_io_descriptor *xt_io_descr, usec_t now_ut) {
+    struct rrdengine_datafile *datafile = xt_io_descr->datafile;
+
+    extent_write_latency_add(now_ut - xt_io_descr->ready_ut);
+
+    spinlock_lock(&datafile->writers.spinlock);
+    datafile->writers.running--;
+    datafile->writers.flushed_to_open_running++;
+    spinlock_unlock(&datafile->writers.spinlock);
+
+    rrdeng_enq_cmd(xt_io_descr->ctx,
+                   RRDENG_OPCODE_FLUSHED_TO_OPEN,
+                   &xt_io_descr->uv_fs_request,
+                   xt_io_descr->completion,
+                   STORAGE_PRIORITY_INTERNAL_DBENGINE,
+                   NULL,
+                   NULL);
+}
+
 // Main event loop callback
 static void after_extent_write_datafile_io(uv_fs_t *uv_fs_request) {
     worker_is_busy(RRDENG_OPCODE_MAX + RRDENG_OPCODE_EXTENT_WRITE);
@@ -686,22 +737,144 @@ static void after_extent_write_datafile_io(uv_fs_t *uv_fs_request) {
 
     journalfile_v1_extent_write(ctx, xt_io_descr->datafile, xt_io_descr->wal, &rrdeng_main.loop);
 
-    spinlock_lock(&datafile->writers.spinlock);
-    datafile->writers.running--;
-    datafile->writers.flushed_to_open_running++;
-    spinlock_unlock(&datafile->writers.spinlock);
+    extent_write_datafile_io_completed(xt_io_descr, now_monotonic_usec());
 
-    rrdeng_enq_cmd(xt_io_descr->ctx,
-                   RRDENG_OPCODE_FLUSHED_TO_OPEN,
-                   uv_fs_request,
-                   xt_io_descr->completion,
-                   STORAGE_PRIORITY_INTERNAL_DBENGINE,
-                   NULL,
-                   NULL);
+    worker_is_idle();
+}
+
+struct extent_write_batch {
+    uv_fs_t uv_fs_request;
+    size_t count;
+    struct extent_io_descriptor *xt_io_descr[EXTENT_WRITE_COALESCE_MAX_EXTENTS];
+    uv_buf_t iov[EXTENT_WRITE_COALESCE_MAX_EXTENTS];
+};
+
+// Main event loop callback
+static void after_extent_write_batch_datafile_io(uv_fs_t *uv_fs_request) {
+    worker_is_busy(RRDENG_OPCODE_MAX + RRDENG_OPCODE_EXTENT_WRITE);
+
+    struct extent_write_batch *batch = uv_fs_request->data;
+    struct rrdengine_datafile *datafile = batch->xt_io_descr[0]->datafile;
+    struct rrdengine_instance *ctx = datafile->ctx;
+
+    if (uv_fs_request->result < 0) {
+        ctx_io_error(ctx);
+        netdata_log_error("DBENGINE: %s: uv_fs_write(): %s", __func__, uv_strerror((int)uv_fs_request->result));
+    }
+
+    WAL *wals[EXTENT_WRITE_COALESCE_MAX_EXTENTS];
+    for(size_t i = 0; i < batch->count ;i++)
+        wals[i] = batch->xt_io_descr[i]->wal;
+
+    journalfile_v1_extent_write_batch(ctx, datafile, wals, batch->count, &rrdeng_main.loop);
+
+    usec_t now_ut = now_monotonic_usec();
+    for(size_t i = 0; i < batch->count ;i++)
+        extent_write_datafile_io_completed(batch->xt_io_descr[i], now_ut);
+
+    uv_fs_req_cleanup(uv_fs_request);
+    freez(batch);
 
     worker_is_idle();
 }
 
+// write extents that are consecutive in the same datafile, with a single write
+static void extent_write_submit(struct extent_io_descriptor **array, size_t count) {
+    struct extent_io_descriptor *first = array[0];
+    size_t bytes = 0;
+    int ret;
+
+    if(count == 1) {
+        bytes = first->iov.len;
+        ret = uv_fs_write(&rrdeng_main.loop,
+                          &first->uv_fs_request,
+                          first->datafile->file,
+                          &first->iov,
+                          1,
+                          (int64_t) first->pos,
+                          after_extent_write_datafile_io);
+    }
+    else {
+        struct extent_write_batch *batch = mallocz(sizeof(*batch));
+        batch->count = count;
+        for(size_t i = 0; i < count ;i++) {
+            batch->xt_io_descr[i] = array[i];
+            batch->iov[i] = array[i]->iov;
+            bytes += array[i]->iov.len;
+        }
+
+        batch->uv_fs_request.data = batch;
+        ret = uv_fs_write(&rrdeng_main.loop,
+                          &batch->uv_fs_request,
+                          first->datafile->file,
+                          batch->iov,
+                          (unsigned int) count,
+                          (int64_t) first->pos,
+                          after_extent_write_batch_datafile_io);
+    }
+
+    fatal_assert(-1 != ret);
+
+    ctx_io_write_op_bytes(first->ctx, bytes);
+    __atomic_add_fetch(&rrdeng_extent_write_stats.extents, count, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&rrdeng_extent_write_stats.datafile_writes, 1, __ATOMIC_RELAXED);
+}
+
+static int extent_write_compar(const void *a, const void *b) {
+    const struct extent_io_descriptor *x = *(struct extent_io_descriptor * const *)a;
+    const struct extent_io_descriptor *y = *(struct extent_io_descriptor * const *)b;
+
+    if(x->datafile != y->datafile)
+        return (uintptr_t)x->datafile < (uintptr_t)y->datafile ? -1 : 1;
+
+    if(x->pos < y->pos)
+        return -1;
+
+    return (x->pos > y->pos) ? 1 : 0;
+}
+
+// called by the event loop, every time uv_run() returns
+// the extents that became ready during the last loop iteration are sorted by datafile and position,
+// and the consecutive ones are written together
+static void extent_writes_flush(void) {
+    size_t count = rrdeng_main.extent_writes.count;
+    if(!count)
+        return;
+
+    struct extent_io_descriptor **array = mallocz(count * sizeof(*array));
+    size_t used = 0;
+    for(struct extent_io_descriptor *xt_io_descr = rrdeng_main.extent_writes.base; xt_io_descr ; xt_io_descr = xt_io_descr->write_next)
+        array[used++] = xt_io_descr;
+
+    internal_fatal(used != count, "DBENGINE: extent write queue count mismatch");
+
+    rrdeng_main.extent_writes.base = NULL;
+    rrdeng_main.extent_writes.count = 0;
+
+    if(used > 1)
+        qsort(array, used, sizeof(*array), extent_write_compar);
+
+    size_t start, end;
+    for(start = 0; start < used ; start = end) {
+        size_t bytes = array[start]->iov.len;
+
+        for(end = start + 1; end < used && end - start < EXTENT_WRITE_COALESCE_MAX_EXTENTS ; end++) {
+            struct extent_io_descriptor *prev = array[end - 1], *xt_io_descr = array[end];
+
+            if(xt_io_descr->datafile != prev->datafile ||
+                xt_io_descr->pos != prev->pos + prev->iov.len ||
+                bytes + xt_io_descr->iov.len > EXTENT_WRITE_COALESCE_MAX_BYTES)
+                break;
+
+            bytes += xt_io_descr->iov.len;
+        }
+
+        extent_write_submit(&array[start], end - start);
+    }
+
+    freez(array);
+}
+
 static bool datafile_is_full(struct rrdengine_instance *ctx, struct rrdengine_datafile *datafile) {
     bool ret = false;
     spinlock_lock(&datafile->writers.spinlock);
@@ -843,6 +1016,7 @@ static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_insta
     for (i = 0 ; i < count ; ++i) {
         descr = xt_io_descr->descr_array[i];
         pgd_copy_to_extent(descr->pgd, xt_io_descr->buf + pos, descr->page_length);
+        pgd_summary(descr->pgd, &descr->summary);
         pos += descr->page_length;
     }
 
@@ -897,7 +1071,8 @@ static struct extent_io_descriptor *datafile_extent_build(struct rrdengine_insta
 
     ctx_last_flush_fileno_set(ctx, datafile->fileno);
     ctx_current_disk_space_increase(ctx, real_io_size);
-    ctx_io_write_op_bytes(ctx, real_io_size);
+
+    xt_io_descr->ready_ut = now_monotonic_usec();
 
     return xt_io_descr;
 }
@@ -906,15 +1081,16 @@ static void after_extent_write(struct rrdengine_instance *ctx __maybe_unused, vo
     struct extent_io_descriptor *xt_io_descr = data;
 
     if(xt_io_descr) {
-        int ret = uv_fs_write(&rrdeng_main.loop,
-                              &xt_io_descr->uv_fs_request,
-                              xt_io_descr->datafile->file,
-                              &xt_io_descr->iov,
-                              1,
-                              (int64_t) xt_io_descr->pos,
-                              after_extent_write_datafile_io);
-
-        fatal_assert(-1 != ret);
+        if(dbengine_extent_write_coalescing) {
+            // queue it, the queue is written when uv_run() returns,
+            // after all the extents that became ready during this loop iteration have been queued
+            xt_io_descr->write_next = rrdeng_main.extent_writes.base;
+            rrdeng_main.extent_writes.base = xt_io_descr;
+            rrdeng_main.extent_writes.count++;
+            uv_stop(&rrdeng_main.loop);
+        }
+        else
+            extent_write_submit(&xt_io_descr, 1);
     }
 }
 
@@ -931,6 +1107,7 @@ static void after_database_rotate(struct rrdengine_instance *ctx __maybe_unused,
 
 struct uuid_first_time_s {
     nd_uuid_t *uuid;
+    uint64_t hash;
     time_t first_time_s;
     METRIC *metric;
     size_t pages_found;
@@ -987,11 +1164,8 @@ time_t find_uuid_first_time(
         if(journal_start_time_s < global_first_time_s)
             global_first_time_s = journal_start_time_s;
 
-        struct journal_metric_list *uuid_list = (struct journal_metric_list *)((uint8_t *) j2_header + j2_header->metric_offset);
         struct uuid_first_time_s *uuid_original_entry;
 
-        size_t journal_metric_count = j2_header->metric_count;
-
         for (size_t index = 0; index < count; ++index) {
             uuid_original_entry = &uuid_first_entry_list[index];
 
@@ -1000,8 +1174,7 @@ time_t find_uuid_first_time(
                 continue;
 
             struct journal_metric_list *live_entry =
-                    bsearch(uuid_original_entry->uuid,uuid_list,journal_metric_count,
-                            sizeof(*uuid_list), journal_metric_uuid_compare);
+                    journalfile_v2_metric_find(datafile->journalfile, j2_header, uuid_original_entry->uuid, uuid_original_entry->hash);
 
             if (!live_entry) {
                 // Not found in this journal
@@ -1081,7 +1254,7 @@ time_t find_uuid_first_time(
     }
     internal_error(true,
          "DBENGINE: analyzed the retention of %zu rotated metrics of tier %d, "
-         "did %zu jv2 matching binary searches (%zu not matching, %zu overflown) in %u journal files, "
+         "did %zu jv2 matching lookups (%zu not matching, %zu overflown) in %u journal files, "
          "%zu metrics with entries in open cache, "
          "metrics first time found per datafile index ([not in jv2]:%zu, [1]:%zu, [2]:%zu, [3]:%zu, [4]:%zu, [5]:%zu, [6]:%zu, [7]:%zu, [8]:%zu, [bigger]: %zu), "
          "open cache found first time %zu, "
@@ -1137,6 +1310,7 @@ static void update_metrics_first_time_s(struct rrdengine_instance *ctx, struct r
         uuid_first_entry_list[added].df_matched = 0;
         uuid_first_entry_list[added].df_index_oldest = 0;
         uuid_first_entry_list[added].uuid = mrg_metric_uuid(main_mrg, metric);
+        uuid_first_entry_list[added].hash = journal_metric_uuid_hash(uuid_first_entry_list[added].uuid);
         added++;
     }
 
@@ -1315,6 +1489,9 @@ static void after_populate_mrg(struct rrdengine_instance *ctx __maybe_unused, vo
 static void *populate_mrg_tp_worker(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t *uv_work_req __maybe_unused) {
     worker_is_busy(UV_EVENT_DBENGINE_POPULATE_MRG);
 
+    // the journal files covered by the snapshot are already marked as populated
+    mrg_snapshot_populate(ctx);
+
     do {
         struct rrdengine_datafile *datafile = NULL;
 
@@ -1348,6 +1525,31 @@ static void *populate_mrg_tp_worker(struct rrdengine_instance *ctx __maybe_unuse
     return data;
 }
 
+static void after_mrg_snapshot(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t* req __maybe_unused, int status __maybe_unused) {
+    ;
+}
+
+static void *mrg_snapshot_tp_worker(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t *uv_work_req __maybe_unused) {
+    worker_is_busy(UV_EVENT_DBENGINE_MRG_SNAPSHOT);
+    mrg_snapshot_save(ctx);
+    return data;
+}
+
+static void after_compaction(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t* req __maybe_unused, int status __maybe_unused) {
+    // keep going while there are datafiles to compact, the io budget throttles us
+    if(ctx_is_available_for_queries(ctx) && compaction_candidate_exists(ctx))
+        rrdeng_enq_cmd(ctx, RRDENG_OPCODE_CTX_COMPACTION, NULL, NULL, STORAGE_PRIORITY_INTERNAL_DBENGINE, NULL, NULL);
+    else
+        ctx->compaction.last_run_s = now_realtime_sec();
+}
+
+static void *compaction_tp_worker(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t *uv_work_req __maybe_unused) {
+    worker_is_busy(UV_EVENT_DBENGINE_COMPACTION);
+    compaction_run(ctx);
+    __atomic_store_n(&ctx->compaction.running, false, __ATOMIC_RELEASE);
+    return data;
+}
+
 static void after_ctx_shutdown(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t* req __maybe_unused, int status __maybe_unused) {
     ;
 }
@@ -1448,6 +1650,12 @@ static void *extent_read_tp_worker(struct rrdengine_instance *ctx __maybe_unused
     return data;
 }
 
+static void *extent_readahead_tp_worker(struct rrdengine_instance *ctx __maybe_unused, void *data __maybe_unused, struct completion *completion __maybe_unused, uv_work_t *uv_work_req __maybe_unused) {
+    worker_is_busy(UV_EVENT_DBENGINE_EXTENT_READAHEAD);
+    extent_readahead_execute(ctx, data);
+    return NULL;
+}
+
 static void epdl_populate_pages_asynchronously(struct rrdengine_instance *ctx, EPDL *epdl, STORAGE_PRIORITY priority) {
     rrdeng_enq_cmd(ctx, RRDENG_OPCODE_EXTENT_READ, epdl, NULL, priority,
                    rrdeng_enqueue_epdl_cmd, rrdeng_dequeue_epdl_cmd);
@@ -1544,7 +1752,7 @@ static void after_journal_v2_indexing(struct rrdengine_instance *ctx __maybe_unu
 struct rrdeng_buffer_sizes rrdeng_get_buffer_sizes(void) {
     return (struct rrdeng_buffer_sizes) {
             .pgc         = pgc_aral_overhead() + pgc_aral_structures(),
-            .mrg         = mrg_aral_overhead() + mrg_aral_structures(),
+            .mrg         = main_mrg ? mrg_overhead(main_mrg) : 0,
             .opcodes     = aral_overhead(rrdeng_main.cmd_queue.ar) + aral_structures(rrdeng_main.cmd_queue.ar),
             .handles     = aral_overhead(rrdeng_main.handles.ar) + aral_structures(rrdeng_main.handles.ar),
             .descriptors = aral_overhead(rrdeng_main.descriptors.ar) + aral_structures(rrdeng_main.descriptors.ar),
@@ -1658,6 +1866,19 @@ void retention_timer_cb(uv_timer_t *handle)
         bool cleanup = rrdeng_ctx_tier_cap_exceeded(multidb_ctx[tier]);
         if (cleanup)
             rrdeng_enq_cmd(multidb_ctx[tier], RRDENG_OPCODE_DATABASE_ROTATE, NULL, NULL, STORAGE_PRIORITY_INTERNAL_DBENGINE, NULL, NULL);
+
+        struct rrdengine_instance *ctx = multidb_ctx[tier];
+        if (dbengine_mrg_snapshot_enabled && dbengine_mrg_snapshot_every_s > 0 &&
+            __atomic_load_n(&ctx->mrg_snapshot.ready, __ATOMIC_RELAXED) &&
+            !__atomic_load_n(&ctx->mrg_snapshot.running, __ATOMIC_RELAXED) &&
+            now_realtime_sec() - ctx->mrg_snapshot.last_saved_s >= dbengine_mrg_snapshot_every_s)
+            rrdeng_enq_cmd(ctx, RRDENG_OPCODE_CTX_MRG_SNAPSHOT, NULL, NULL, STORAGE_PRIORITY_INTERNAL_DBENGINE, NULL, NULL);
+
+        if (dbengine_compaction_enabled && dbengine_compaction_every_s > 0 &&
+            __atomic_load_n(&ctx->compaction.ready, __ATOMIC_RELAXED) &&
+            !__atomic_load_n(&ctx->compaction.running, __ATOMIC_RELAXED) &&
+            now_realtime_sec() - ctx->compaction.last_run_s >= dbengine_compaction_every_s)
+            rrdeng_enq_cmd(ctx, RRDENG_OPCODE_CTX_COMPACTION, NULL, NULL, STORAGE_PRIORITY_INTERNAL_DBENGINE, NULL, NULL);
     }
 
     worker_is_idle();
@@ -1897,6 +2118,7 @@ void dbengine_event_loop(void* arg) {
     worker_register_job_name(RRDENG_OPCODE_QUERY,                                    "query");
     worker_register_job_name(RRDENG_OPCODE_EXTENT_WRITE,                             "extent write");
     worker_register_job_name(RRDENG_OPCODE_EXTENT_READ,                              "extent read");
+    worker_register_job_name(RRDENG_OPCODE_EXTENT_READAHEAD,                         "extent read-ahead");
     worker_register_job_name(RRDENG_OPCODE_FLUSHED_TO_OPEN,                          "flushed to open");
     worker_register_job_name(RRDENG_OPCODE_DATABASE_ROTATE,                          "db rotate");
     worker_register_job_name(RRDENG_OPCODE_JOURNAL_INDEX,                            "journal index");
@@ -1904,6 +2126,8 @@ void dbengine_event_loop(void* arg) {
     worker_register_job_name(RRDENG_OPCODE_EVICT_INIT,                               "evict init");
     worker_register_job_name(RRDENG_OPCODE_CTX_SHUTDOWN,                             "ctx shutdown");
     worker_register_job_name(RRDENG_OPCODE_CTX_QUIESCE,                              "ctx quiesce");
+    worker_register_job_name(RRDENG_OPCODE_CTX_MRG_SNAPSHOT,                         "ctx mrg snapshot");
+    worker_register_job_name(RRDENG_OPCODE_CTX_COMPACTION,                           "ctx compaction");
     worker_register_job_name(RRDENG_OPCODE_SHUTDOWN_EVLOOP,                          "dbengine shutdown");
 
     worker_register_job_name(RRDENG_OPCODE_MAX,                                      "get opcode");
@@ -1911,6 +2135,7 @@ void dbengine_event_loop(void* arg) {
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_QUERY,                "query cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_EXTENT_WRITE,         "extent write cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_EXTENT_READ,          "extent read cb");
+    worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_EXTENT_READAHEAD,     "extent read-ahead cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_FLUSHED_TO_OPEN,      "flushed to open cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_DATABASE_ROTATE,      "db rotate cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_JOURNAL_INDEX,        "journal index cb");
@@ -1918,6 +2143,8 @@ void dbengine_event_loop(void* arg) {
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_EVICT_INIT,           "evict init cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_SHUTDOWN,         "ctx shutdown cb");
     worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_QUIESCE,          "ctx quiesce cb");
+    worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_MRG_SNAPSHOT,     "ctx mrg snapshot cb");
+    worker_register_job_name(RRDENG_OPCODE_MAX + RRDENG_OPCODE_CTX_COMPACTION,       "ctx compaction cb");
 
     // special jobs
     worker_register_job_name(RRDENG_TIMER_CB,                                        "timer");
@@ -1940,6 +2167,8 @@ void dbengine_event_loop(void* arg) {
         worker_is_idle();
         uv_run(&main->loop, UV_RUN_DEFAULT);
 
+        extent_writes_flush();
+
         /* wait for commands */
         do {
             worker_is_busy(RRDENG_OPCODE_MAX);
@@ -2011,17 +2240,25 @@ void dbengine_event_loop(void* arg) {
 
                 case RRDENG_OPCODE_DATABASE_ROTATE: {
                     struct rrdengine_instance *ctx = cmd.ctx;
+                    bool expected = false;
                     if (!__atomic_load_n(&ctx->atomic.now_deleting_files, __ATOMIC_RELAXED) &&
                          ctx->datafiles.first->next != NULL &&
                          ctx->datafiles.first->next->next != NULL &&
-                        rrdeng_ctx_tier_cap_exceeded(ctx)) {
+                        rrdeng_ctx_tier_cap_exceeded(ctx) &&
+                        // the compactor takes it from its worker, while swapping datafiles
+                        __atomic_compare_exchange_n(&ctx->atomic.now_deleting_files, &expected, true, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
 
-                        __atomic_store_n(&ctx->atomic.now_deleting_files, true, __ATOMIC_RELAXED);
                         work_dispatch(ctx, NULL, NULL, opcode, database_rotate_tp_worker, after_database_rotate);
                     }
                     break;
                 }
 
+                case RRDENG_OPCODE_EXTENT_READAHEAD: {
+                    struct rrdengine_instance *ctx = cmd.ctx;
+                    work_dispatch(ctx, cmd.data, NULL, opcode, extent_readahead_tp_worker, NULL);
+                    break;
+                }
+
                 case RRDENG_OPCODE_CTX_POPULATE_MRG: {
                     struct rrdengine_instance *ctx = cmd.ctx;
                     struct completion *completion = cmd.completion;
@@ -2029,6 +2266,24 @@ void dbengine_event_loop(void* arg) {
                     break;
                 }
 
+                case RRDENG_OPCODE_CTX_MRG_SNAPSHOT: {
+                    struct rrdengine_instance *ctx = cmd.ctx;
+                    if(!__atomic_load_n(&ctx->mrg_snapshot.running, __ATOMIC_RELAXED) &&
+                        !__atomic_load_n(&ctx->quiesce.enabled, __ATOMIC_RELAXED))
+                        work_dispatch(ctx, NULL, NULL, opcode, mrg_snapshot_tp_worker, after_mrg_snapshot);
+                    break;
+                }
+
+                case RRDENG_OPCODE_CTX_COMPACTION: {
+                    struct rrdengine_instance *ctx = cmd.ctx;
+                    if(!__atomic_load_n(&ctx->compaction.running, __ATOMIC_RELAXED) &&
+                        !__atomic_load_n(&ctx->quiesce.enabled, __ATOMIC_RELAXED)) {
+                        __atomic_store_n(&ctx->compaction.running, true, __ATOMIC_RELAXED);
+                        work_dispatch(ctx, NULL, NULL, opcode, compaction_tp_worker, after_compaction);
+                    }
+                    break;
+                }
+
                 case RRDENG_OPCODE_CTX_QUIESCE: {
                     // a ctx will shutdown shortly
                     struct rrdengine_instance *ctx = cmd.ctx;
@@ -15,6 +15,8 @@
 #include "datafile.h"
 #include "journalfile.h"
 #include "rrdengineapi.h"
+#include "dbengine-mrg-snapshot.h"
+#include "dbengine-compaction.h"
 #include "pagecache.h"
 #include "metric.h"
 #include "cache.h"
@@ -73,6 +75,9 @@ typedef enum __attribute__ ((__packed__)) {
     PDC_PAGE_SOURCE_JOURNAL_V2         = (1 << 19),
     PDC_PAGE_PRELOADED_PASS4           = (1 << 20),
 
+    // the query will use the summary of the page, instead of its data (pd->page is null)
+    PDC_PAGE_SUMMARY                   = (1 << 21),
+
     // datafile acquired
     PDC_PAGE_DATAFILE_ACQUIRED         = (1 << 30),
 } PDC_PAGE_STATUS;
@@ -102,6 +107,10 @@ typedef struct page_details_control {
     time_t end_time_s;
     STORAGE_PRIORITY priority;
 
+    // the time groups of the query, when pages inside one of them can be answered by their summaries
+    time_t group_anchor_s;
+    time_t group_every_s;
+
     time_t optimal_end_time_s;
 } PDC;
 
@@ -125,6 +134,7 @@ struct page_details {
     time_t last_time_s;
     uint32_t update_every_s;
     PDC_PAGE_STATUS status;
+    struct rrdeng_page_summary summary;
 
     struct {
         struct page_details *prev;
@@ -218,6 +228,8 @@ struct rrdeng_query_handle {
     time_t start_time_s;
     time_t end_time_s;
     STORAGE_PRIORITY priority;
+    time_t group_anchor_s;
+    time_t group_every_s;
 
     // internal data
     time_t now_s;
@@ -226,6 +238,10 @@ struct rrdeng_query_handle {
     unsigned position;
     unsigned entries;
 
+    // a page answered by its summary, returned as a single point
+    bool summary_pending;
+    STORAGE_POINT summary_sp;
+
 #ifdef NETDATA_INTERNAL_CHECKS
     usec_t started_time_s;
     pid_t query_pid;
@@ -243,6 +259,7 @@ enum rrdeng_opcode {
     RRDENG_OPCODE_QUERY,
     RRDENG_OPCODE_EXTENT_WRITE,
     RRDENG_OPCODE_EXTENT_READ,
+    RRDENG_OPCODE_EXTENT_READAHEAD,
     RRDENG_OPCODE_FLUSHED_TO_OPEN,
     RRDENG_OPCODE_DATABASE_ROTATE,
     RRDENG_OPCODE_JOURNAL_INDEX,
@@ -251,6 +268,8 @@ enum rrdeng_opcode {
     RRDENG_OPCODE_CTX_SHUTDOWN,
     RRDENG_OPCODE_CTX_QUIESCE,
     RRDENG_OPCODE_CTX_POPULATE_MRG,
+    RRDENG_OPCODE_CTX_MRG_SNAPSHOT,
+    RRDENG_OPCODE_CTX_COMPACTION,
     RRDENG_OPCODE_SHUTDOWN_EVLOOP,
     RRDENG_OPCODE_CLEANUP,
 
@@ -273,6 +292,7 @@ struct extent_io_data {
     uint64_t pos;
     unsigned bytes;
     uint16_t page_length;
+    struct rrdeng_page_summary summary;
 };
 
 struct extent_io_descriptor {
@@ -289,6 +309,8 @@ struct extent_io_descriptor {
     struct page_descr_with_data *descr_array[MAX_PAGES_PER_EXTENT];
     struct rrdengine_datafile *datafile;
     struct extent_io_descriptor *next; /* multiple requests to be served by the same cached extent */
+    struct extent_io_descriptor *write_next; /* extents waiting to be coalesced into datafile writes */
+    usec_t ready_ut;                          /* when the extent was ready to be written */
 };
 
 struct generic_io_descriptor {
@@ -414,9 +436,24 @@ struct rrdengine_instance {
             struct completion *array;
         } populate_mrg;
 
+        struct mrg_snapshot *mrg_snapshot;          // the retention snapshot being loaded, if any
+
         bool create_new_datafile_pair;
     } loading;
 
+    struct {
+        bool ready;                                 // atomic - loading has finished, snapshots can be written
+        bool running;                               // atomic - a snapshot is being written
+        time_t last_saved_s;                        // when the last snapshot was written or found up to date
+        uint64_t signature;                         // the journal files covered by the last snapshot
+    } mrg_snapshot;
+
+    struct {
+        bool ready;                                 // atomic - loading has finished, datafiles can be compacted
+        bool running;                               // atomic - a datafile is being compacted
+        time_t last_run_s;                          // when the compactor last found nothing to do
+    } compaction;
+
     struct rrdengine_statistics stats;
 };
 
@@ -550,6 +587,14 @@ static inline int journal_metric_uuid_compare(const void *key, const void *metri
     return journal_uuid_memcmp((const nd_uuid_t *)key, (const nd_uuid_t *)&(((struct journal_metric_list *) metric)->uuid));
 }
 
+// the hash of the metric index of journal v2 files (JOURVAL_V2_METRIC_INDEX_VERSION 1)
+static inline uint64_t journal_metric_uuid_hash(const nd_uuid_t *uuid) {
+    uint64_t a, b;
+    memcpy(&a, uuid, sizeof(a));
+    memcpy(&b, (const uint8_t *)uuid + sizeof(a), sizeof(b));
+    return murmur64(a ^ murmur64(b));
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 uint64_t get_used_disk_space(struct rrdengine_instance *ctx);
 void calculate_tier_disk_space_percentage(void);
@@ -730,7 +730,9 @@ void rrdeng_load_metric_init(STORAGE_METRIC_HANDLE *smh,
                              struct storage_engine_query_handle *seqh,
                              time_t start_time_s,
                              time_t end_time_s,
-                             STORAGE_PRIORITY priority)
+                             STORAGE_PRIORITY priority,
+                             time_t group_anchor_s,
+                             time_t group_every_s)
 {
     usec_t started_ut = now_monotonic_usec();
 
@@ -749,6 +751,8 @@ void rrdeng_load_metric_init(STORAGE_METRIC_HANDLE *smh,
     handle->ctx = ctx;
     handle->metric = metric;
     handle->priority = priority;
+    handle->group_anchor_s = group_anchor_s;
+    handle->group_every_s = (group_every_s > 0) ? group_every_s : 0;
 
     // IMPORTANT!
     // It is crucial not to exceed the db boundaries, because dbengine
@@ -806,11 +810,37 @@ static bool rrdeng_load_page_next(struct storage_engine_query_handle *seqh, bool
         pgdc_reset(&handle->pgdc, NULL, UINT32_MAX);
     }
 
+    handle->summary_pending = false;
+
     if (unlikely(handle->now_s > seqh->end_time_s))
         return false;
 
     size_t entries = 0;
-    handle->page = pg_cache_lookup_next(ctx, handle->pdc, handle->now_s, handle->dt_s, &entries);
+    struct page_details *summary_pd = NULL;
+    handle->page = pg_cache_lookup_next(ctx, handle->pdc, handle->now_s, handle->dt_s, &entries, &summary_pd);
+
+    if (unlikely(summary_pd)) {
+        // the page has not been loaded - all its points are returned as one, from its summary
+        struct rrdeng_page_summary *summary = &summary_pd->summary;
+
+        handle->summary_sp = (STORAGE_POINT) {
+            .min = summary->min,
+            .max = summary->max,
+            .sum = summary->sum,
+            .start_time_s = summary_pd->first_time_s - (time_t)summary_pd->update_every_s,
+            .end_time_s = summary_pd->last_time_s,
+            .count = summary->count,
+            .anomaly_count = summary->anomaly_count,
+            .flags = summary->anomaly_count ? SN_FLAG_NONE : SN_FLAG_NOT_ANOMALOUS,
+        };
+        handle->summary_pending = true;
+
+        handle->now_s = summary_pd->last_time_s;
+        handle->dt_s = summary_pd->update_every_s;
+        handle->entries = 1;
+        handle->position = 0;
+        return true;
+    }
 
     internal_fatal(handle->page && (pgc_page_data(handle->page) == PGD_EMPTY || !entries),
                    "A page was returned, but it is empty - pg_cache_lookup_next() should be handling this case");
@@ -875,7 +905,7 @@ STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *seqh)
         goto prepare_for_next_iteration;
     }
 
-    if (unlikely(!handle->page || handle->position >= handle->entries)) {
+    if (unlikely((!handle->page && !handle->summary_pending) || handle->position >= handle->entries)) {
         // We need to get a new page
 
         if (!rrdeng_load_page_next(seqh, false)) {
@@ -885,6 +915,12 @@ STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *seqh)
         }
     }
 
+    if (unlikely(handle->summary_pending)) {
+        sp = handle->summary_sp;
+        handle->summary_pending = false;
+        goto prepare_for_next_iteration;
+    }
+
     sp.start_time_s = handle->now_s - handle->dt_s;
     sp.end_time_s = handle->now_s;
 
@@ -1065,14 +1101,17 @@ void rrdeng_get_37_statistics(struct rrdengine_instance *ctx, unsigned long long
 }
 
 static void rrdeng_populate_mrg(struct rrdengine_instance *ctx) {
+    bool snapshot = mrg_snapshot_load(ctx);
+
     uv_rwlock_rdlock(&ctx->datafiles.rwlock);
     size_t datafiles = 0;
     for(struct rrdengine_datafile *df = ctx->datafiles.first; df ;df = df->next)
-        datafiles++;
+        if(!df->populate_mrg.populated)
+            datafiles++;
     uv_rwlock_rdunlock(&ctx->datafiles.rwlock);
 
     ssize_t cpus = (ssize_t)get_netdata_cpus() / (ssize_t)storage_tiers;
-    if(cpus > (ssize_t)datafiles)
+    if(cpus > (ssize_t)datafiles && !snapshot)
         cpus = (ssize_t)datafiles;
 
     if(cpus > (ssize_t)libuv_worker_threads)
@@ -1084,9 +1123,10 @@ static void rrdeng_populate_mrg(struct rrdengine_instance *ctx) {
     if(cpus < 1)
         cpus = 1;
 
-    netdata_log_info("DBENGINE: populating retention to MRG from %zu journal files of tier %d, using %zd threads...", datafiles, ctx->config.tier, cpus);
+    netdata_log_info("DBENGINE: populating retention to MRG from %zu journal files of tier %d%s, using %zd threads...",
+                     datafiles, ctx->config.tier, snapshot ? " and the retention snapshot" : "", cpus);
 
-    if(datafiles > 2) {
+    if(datafiles > 2 && !snapshot) {
         struct rrdengine_datafile *datafile;
 
         datafile = ctx->datafiles.first->prev;
@@ -1125,6 +1165,10 @@ void rrdeng_readiness_wait(struct rrdengine_instance *ctx) {
     ctx->loading.populate_mrg.array = NULL;
     ctx->loading.populate_mrg.size = 0;
 
+    mrg_snapshot_unload(ctx);
+    __atomic_store_n(&ctx->mrg_snapshot.ready, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&ctx->compaction.ready, true, __ATOMIC_RELEASE);
+
     netdata_log_info("DBENGINE: tier %d is ready for data collection and queries", ctx->config.tier);
 }
 
@@ -1241,6 +1285,19 @@ int rrdeng_exit(struct rrdengine_instance *ctx) {
     completion_wait_for(&completion);
     completion_destroy(&completion);
 
+    // a running compaction stops at the next extent, or finishes the swap of its datafile
+    while(__atomic_load_n(&ctx->compaction.running, __ATOMIC_ACQUIRE))
+        sleep_usec(10 * USEC_PER_MS);
+
+    if(dbengine_mrg_snapshot_enabled && __atomic_load_n(&ctx->mrg_snapshot.ready, __ATOMIC_ACQUIRE)) {
+        // wait for a periodic snapshot that may be running
+        while(__atomic_load_n(&ctx->mrg_snapshot.running, __ATOMIC_ACQUIRE))
+            sleep_usec(10 * USEC_PER_MS);
+
+        netdata_log_info("DBENGINE: saving retention snapshot for tier %d", ctx->config.tier);
+        mrg_snapshot_save(ctx);
+    }
+
     finalize_rrd_files(ctx);
 
     if (unittest_running) //(ctx->config.unittest)
@@ -1391,3 +1448,7 @@ struct rrdeng_cache_efficiency_stats rrdeng_get_cache_efficiency_stats(void) {
     // FIXME - make cache efficiency stats atomic
     return rrdeng_cache_efficiency_stats;
 }
+
+struct rrdeng_extent_write_stats rrdeng_get_extent_write_stats(void) {
+    return rrdeng_extent_write_stats;
+}
@@ -16,6 +16,15 @@
 extern int default_rrdeng_page_cache_mb;
 extern int default_rrdeng_extent_cache_mb;
 extern int db_engine_journal_check;
+extern bool dbengine_mrg_snapshot_enabled;
+extern time_t dbengine_mrg_snapshot_every_s;
+extern bool dbengine_compaction_enabled;
+extern time_t dbengine_compaction_every_s;
+extern size_t dbengine_compaction_io_budget_mb;
+extern int dbengine_compaction_min_savings_percent;
+extern bool dbengine_extent_readahead_enabled;
+extern size_t dbengine_extent_readahead_extents;
+extern bool dbengine_extent_write_coalescing;
 extern int default_rrdeng_disk_quota_mb;
 extern int default_multidb_disk_quota_mb;
 extern bool new_dbengine_defaults;
@@ -47,7 +56,8 @@ void rrdeng_store_metric_next(STORAGE_COLLECT_HANDLE *sch, usec_t point_in_time_
 int rrdeng_store_metric_finalize(STORAGE_COLLECT_HANDLE *sch);
 
 void rrdeng_load_metric_init(STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
-                                    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
+                                    time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority,
+                                    time_t group_anchor_s, time_t group_every_s);
 STORAGE_POINT rrdeng_load_metric_next(struct storage_engine_query_handle *seqh);
 
 
@@ -156,6 +166,7 @@ struct rrdeng_cache_efficiency_stats {
     size_t pages_data_source_main_cache_at_pass4;
     size_t pages_data_source_disk;
     size_t pages_data_source_extent_cache;              // loaded by a cached extent
+    size_t pages_data_source_summary;                   // not loaded, answered by the journal v2 page summaries
 
     // cache hits at different points
     size_t pages_load_ok_loaded_but_cache_hit_while_inserting; // found in cache while inserting it (conflict)
@@ -172,6 +183,14 @@ struct rrdeng_cache_efficiency_stats {
     size_t pages_load_fail_invalid_extent;
     size_t pages_load_fail_cancelled;
 
+    // extent read-ahead
+    size_t extents_readahead_requested;
+    size_t extents_readahead_skipped;
+    size_t extents_readahead_loaded;
+    size_t extents_readahead_already_cached;
+    size_t extents_readahead_failed;
+    size_t extents_readahead_hits;                      // prefetched extents later used by queries
+
     // timings for query preparation
     size_t prep_time_to_route;
     size_t prep_time_in_main_cache_lookup;
@@ -224,8 +243,29 @@ struct rrdeng_buffer_sizes {
 #endif
 };
 
+#define RRDENG_EXTENT_WRITE_LATENCY_BUCKETS (8)
+
+struct rrdeng_extent_write_latency_bucket {
+    usec_t upto_ut;                     // 0 for the last bucket
+    const char *name;
+};
+
+extern const struct rrdeng_extent_write_latency_bucket rrdeng_extent_write_latency_buckets[RRDENG_EXTENT_WRITE_LATENCY_BUCKETS];
+
+struct rrdeng_extent_write_stats {
+    size_t extents;                     // extents written to datafiles
+    size_t datafile_writes;             // datafile write requests, after coalescing
+    size_t journal_writes;              // journal v1 write requests, after coalescing
+
+    // time from an extent being ready, until its datafile write completes
+    size_t latency[RRDENG_EXTENT_WRITE_LATENCY_BUCKETS];
+};
+
+extern struct rrdeng_extent_write_stats rrdeng_extent_write_stats;
+
 struct rrdeng_buffer_sizes rrdeng_get_buffer_sizes(void);
 struct rrdeng_cache_efficiency_stats rrdeng_get_cache_efficiency_stats(void);
+struct rrdeng_extent_write_stats rrdeng_get_extent_write_stats(void);
 
 RRDENG_SIZE_STATS rrdeng_size_statistics(struct rrdengine_instance *ctx);
 size_t rrdeng_collectors_running(struct rrdengine_instance *ctx);
@@ -560,7 +560,8 @@ static inline time_t storage_engine_latest_time_s(STORAGE_ENGINE_BACKEND seb __m
 
 void rrdeng_load_metric_init(
         STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
-                time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority);
+                time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority,
+                time_t group_anchor_s, time_t group_every_s);
 
 void rrddim_query_init(
         STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
@@ -574,7 +575,26 @@ static inline void storage_engine_query_init(
 
 #ifdef ENABLE_DBENGINE
     if(likely(seb == STORAGE_ENGINE_BACKEND_DBENGINE))
-        rrdeng_load_metric_init(smh, seqh, start_time_s, end_time_s, priority);
+        rrdeng_load_metric_init(smh, seqh, start_time_s, end_time_s, priority, 0, 0);
+    else
+#endif
+        rrddim_query_init(smh, seqh, start_time_s, end_time_s, priority);
+}
+
+// like storage_engine_query_init(), for queries that aggregate the points in time groups
+// of group_every_s seconds, starting at group_anchor_s, with min, max or sum.
+// The backend may return a single point for all the points of a group it has pre-aggregated,
+// so callers that need every point of the database should not use it.
+static inline void storage_engine_query_init_grouped(
+        STORAGE_ENGINE_BACKEND seb __maybe_unused,
+        STORAGE_METRIC_HANDLE *smh, struct storage_engine_query_handle *seqh,
+        time_t start_time_s, time_t end_time_s, STORAGE_PRIORITY priority,
+        time_t group_anchor_s, time_t group_every_s) {
+    internal_fatal(!is_valid_backend(seb), "STORAGE: invalid backend");
+
+#ifdef ENABLE_DBENGINE
+    if(likely(seb == STORAGE_ENGINE_BACKEND_DBENGINE))
+        rrdeng_load_metric_init(smh, seqh, start_time_s, end_time_s, priority, group_anchor_s, group_every_s);
     else
 #endif
         rrddim_query_init(smh, seqh, start_time_s, end_time_s, priority);
@@ -1161,12 +1161,41 @@ static inline void rrdset_init_last_updated_time(RRDSET *st) {
 }
 
 static __thread size_t rrdset_done_statistics_points_stored_per_tier[RRD_STORAGE_TIERS];
+static __thread usec_t rrdset_done_statistics_store_ut = 0;
 
 static inline time_t tier_next_point_time_s(RRDDIM *rd, struct rrddim_tier *t, time_t now_s) {
     time_t loop = (time_t)rd->rrdset->update_every * (time_t)t->tier_grouping;
     return now_s + loop - ((now_s + loop) % loop);
 }
 
+static inline void tier_virtual_point_merge(struct rrddim_tier *t, STORAGE_POINT *sp) {
+    // merge the dates into our virtual point
+    if (unlikely(sp->start_time_s < t->virtual_point.start_time_s))
+        t->virtual_point.start_time_s = sp->start_time_s;
+
+    if (likely(sp->end_time_s > t->virtual_point.end_time_s))
+        t->virtual_point.end_time_s = sp->end_time_s;
+
+    // merge the values into our virtual point
+    if (likely(!storage_point_is_gap(*sp))) {
+        // we aggregate only non NULLs into higher tiers
+
+        if (likely(!storage_point_is_unset(t->virtual_point))) {
+            // merge the collected point to our virtual one
+            t->virtual_point.sum += sp->sum;
+            t->virtual_point.min = MIN(t->virtual_point.min, sp->min);
+            t->virtual_point.max = MAX(t->virtual_point.max, sp->max);
+            t->virtual_point.count += sp->count;
+            t->virtual_point.anomaly_count += sp->anomaly_count;
+            t->virtual_point.flags |= sp->flags;
+        }
+        else {
+            // reset our virtual point to this one
+            t->virtual_point = *sp;
+        }
+    }
+}
+
 void store_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAGE_POINT sp, usec_t now_ut __maybe_unused) {
     if (unlikely(!t->next_point_end_time_s))
         t->next_point_end_time_s = tier_next_point_time_s(rd, t, sp.end_time_s);
@@ -1202,31 +1231,7 @@ void store_metric_at_tier(RRDDIM *rd, size_t tier, struct rrddim_tier *t, STORAG
         t->next_point_end_time_s = tier_next_point_time_s(rd, t, sp.end_time_s);
     }
 
-    // merge the dates into our virtual point
-    if (unlikely(sp.start_time_s < t->virtual_point.start_time_s))
-        t->virtual_point.start_time_s = sp.start_time_s;
-
-    if (likely(sp.end_time_s > t->virtual_point.end_time_s))
-        t->virtual_point.end_time_s = sp.end_time_s;
-
-    // merge the values into our virtual point
-    if (likely(!storage_point_is_gap(sp))) {
-        // we aggregate only non NULLs into higher tiers
-
-        if (likely(!storage_point_is_unset(t->virtual_point))) {
-            // merge the collected point to our virtual one
-            t->virtual_point.sum += sp.sum;
-            t->virtual_point.min = MIN(t->virtual_point.min, sp.min);
-            t->virtual_point.max = MAX(t->virtual_point.max, sp.max);
-            t->virtual_point.count += sp.count;
-            t->virtual_point.anomaly_count += sp.anomaly_count;
-            t->virtual_point.flags |= sp.flags;
-        }
-        else {
-            // reset our virtual point to this one
-            t->virtual_point = sp;
-        }
-    }
+    tier_virtual_point_merge(t, &sp);
 }
 #ifdef NETDATA_LOG_COLLECTION_ERRORS
 void rrddim_store_metric_with_trace(RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n, SN_FLAGS flags, const char *function) {
@@ -1306,7 +1311,7 @@ void rrddim_store_metric(RRDDIM *rd, usec_t point_end_time_ut, NETDATA_DOUBLE n,
 }
 
 void store_metric_collection_completed() {
-    global_statistics_rrdset_done_chart_collection_completed(rrdset_done_statistics_points_stored_per_tier);
+    global_statistics_rrdset_done_chart_collection_completed(rrdset_done_statistics_points_stored_per_tier, &rrdset_done_statistics_store_ut);
 }
 
 // caching of dimensions rrdset_done() and rrdset_done_interpolate() loop through
@@ -1319,14 +1324,24 @@ struct rda_item {
 static __thread struct rda_item *thread_rda = NULL;
 static __thread size_t thread_rda_entries = 0;
 
+// the row of values rrdset_done_interpolate() stores at each interpolation point, one per rda slot
+static __thread NETDATA_DOUBLE *thread_row_values = NULL;
+static __thread SN_FLAGS *thread_row_flags = NULL;
+
+#define RDA_SLOT_MEMORY (sizeof(struct rda_item) + sizeof(NETDATA_DOUBLE) + sizeof(SN_FLAGS))
+
 struct rda_item *rrdset_thread_rda_get(size_t *dimensions) {
 
     if(unlikely(!thread_rda || (*dimensions) > thread_rda_entries)) {
-        size_t old_mem = thread_rda_entries * sizeof(struct rda_item);
+        size_t old_mem = thread_rda_entries * RDA_SLOT_MEMORY;
         freez(thread_rda);
+        freez(thread_row_values);
+        freez(thread_row_flags);
         thread_rda_entries = *dimensions;
-        size_t new_mem = thread_rda_entries * sizeof(struct rda_item);
-        thread_rda = mallocz(new_mem);
+        size_t new_mem = thread_rda_entries * RDA_SLOT_MEMORY;
+        thread_rda = mallocz(thread_rda_entries * sizeof(struct rda_item));
+        thread_row_values = mallocz(thread_rda_entries * sizeof(NETDATA_DOUBLE));
+        thread_row_flags = mallocz(thread_rda_entries * sizeof(SN_FLAGS));
 
         __atomic_add_fetch(&netdata_buffers_statistics.rrdset_done_rda_size, new_mem - old_mem, __ATOMIC_RELAXED);
     }
@@ -1336,13 +1351,103 @@ struct rda_item *rrdset_thread_rda_get(size_t *dimensions) {
 }
 
 void rrdset_thread_rda_free(void) {
-    __atomic_sub_fetch(&netdata_buffers_statistics.rrdset_done_rda_size, thread_rda_entries * sizeof(struct rda_item), __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&netdata_buffers_statistics.rrdset_done_rda_size, thread_rda_entries * RDA_SLOT_MEMORY, __ATOMIC_RELAXED);
 
     freez(thread_rda);
+    freez(thread_row_values);
+    freez(thread_row_flags);
     thread_rda = NULL;
+    thread_row_values = NULL;
+    thread_row_flags = NULL;
     thread_rda_entries = 0;
 }
 
+// store a row of values, one for each dimension of the chart, all at the same point in time
+// this is rrddim_store_metric() for all the dimensions of the chart, with the loops interchanged:
+// the work that depends only on the chart is done once per tier, instead of once per dimension per tier
+static void rrdset_store_metrics_row(RRDSET *st, struct rda_item *rda_base, size_t rda_slots, usec_t point_end_time_ut, NETDATA_DOUBLE *values, SN_FLAGS *flags) {
+    static __thread struct log_stack_entry lgs[] = {
+            [0] = ND_LOG_FIELD_STR(NDF_NIDL_DIMENSION, NULL),
+            [1] = ND_LOG_FIELD_END(),
+    };
+    log_stack_push(lgs);
+
+    usec_t started_ut = now_monotonic_usec();
+
+    // store the row on tier 0
+    size_t stored = 0;
+    for(size_t slot = 0; slot < rda_slots ; slot++) {
+        RRDDIM *rd = rda_base[slot].rd;
+        if(unlikely(!rd)) continue;
+
+        lgs[0].str = rd->id;
+
+#ifdef NETDATA_LOG_COLLECTION_ERRORS
+        rd->rrddim_store_metric_count++;
+        rd->rrddim_store_metric_last_ut = point_end_time_ut;
+        rd->rrddim_store_metric_last_caller = __FUNCTION__;
+#endif
+
+        storage_engine_store_metric(rd->tiers[0].sch, point_end_time_ut,
+                                    values[slot], 0, 0,
+                                    1, 0, flags[slot]);
+        stored++;
+    }
+    rrdset_done_statistics_points_stored_per_tier[0] += stored;
+
+    time_t now_s = (time_t)(point_end_time_ut / USEC_PER_SEC);
+    time_t start_time_s = now_s - st->update_every;
+
+    // aggregate the row into the virtual points of the higher tiers
+    // only the dimensions that complete a point of a tier need the full store_metric_at_tier()
+    for(size_t tier = 1; tier < storage_tiers ;tier++) {
+        for(size_t slot = 0; slot < rda_slots ; slot++) {
+            RRDDIM *rd = rda_base[slot].rd;
+            if(unlikely(!rd)) continue;
+
+            struct rrddim_tier *t = &rd->tiers[tier];
+            if(unlikely(!t->smh)) continue;
+
+            STORAGE_POINT sp = {
+                    .start_time_s = start_time_s,
+                    .end_time_s = now_s,
+                    .min = values[slot],
+                    .max = values[slot],
+                    .sum = values[slot],
+                    .count = 1,
+                    .anomaly_count = (flags[slot] & SN_FLAG_NOT_ANOMALOUS) ? 0 : 1,
+                    .flags = flags[slot]
+            };
+
+            if(likely(t->next_point_end_time_s && start_time_s < t->next_point_end_time_s &&
+                       rrddim_option_check(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS))) {
+                tier_virtual_point_merge(t, &sp);
+                continue;
+            }
+
+            if(!rrddim_option_check(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS)) {
+                // we have not collected this tier before
+                // let's fill any gap that may exist
+                lgs[0].str = rd->id;
+                rrdr_fill_tier_gap_from_smaller_tiers(rd, tier, now_s);
+                rrddim_option_set(rd, RRDDIM_OPTION_BACKFILLED_HIGH_TIERS);
+            }
+
+            lgs[0].str = rd->id;
+            store_metric_at_tier(rd, tier, t, sp, point_end_time_ut);
+        }
+    }
+
+    for(size_t slot = 0; slot < rda_slots ; slot++) {
+        RRDDIM *rd = rda_base[slot].rd;
+        if(likely(rd))
+            rrdcontext_collected_rrddim(rd);
+    }
+
+    rrdset_done_statistics_store_ut += now_monotonic_usec() - started_ut;
+    log_stack_pop(&lgs);
+}
+
 static inline size_t rrdset_done_interpolate(
         RRDSET_STREAM_BUFFER *rsb
         , RRDSET *st
@@ -1368,6 +1473,9 @@ static inline size_t rrdset_done_interpolate(
     size_t counter = st->counter;
     long current_entry = st->db.current_entry;
 
+    NETDATA_DOUBLE *row_values = thread_row_values;
+    SN_FLAGS *row_flags = thread_row_flags;
+
     for( ; next_store_ut <= now_collect_ut ; last_collect_ut = next_store_ut, next_store_ut += update_every_ut, iterations-- ) {
 
         internal_error(iterations < 0,
@@ -1479,7 +1587,8 @@ static inline size_t rrdset_done_interpolate(
                 if(rsb->wb && rsb->v2)
                     rrddim_push_metrics_v2(rsb, rd, next_store_ut, NAN, SN_FLAG_NONE);
 
-                rrddim_store_metric(rd, next_store_ut, NAN, SN_FLAG_NONE);
+                row_values[dim_id] = NAN;
+                row_flags[dim_id] = SN_FLAG_NONE;
                 continue;
             }
 
@@ -1494,7 +1603,8 @@ static inline size_t rrdset_done_interpolate(
                 if(rsb->wb && rsb->v2)
                     rrddim_push_metrics_v2(rsb, rd, next_store_ut, new_value, dim_storage_flags);
 
-                rrddim_store_metric(rd, next_store_ut, new_value, dim_storage_flags);
+                row_values[dim_id] = new_value;
+                row_flags[dim_id] = dim_storage_flags;
                 rd->collector.last_stored_value = new_value;
             }
             else {
@@ -1505,13 +1615,16 @@ static inline size_t rrdset_done_interpolate(
                 if(rsb->wb && rsb->v2)
                     rrddim_push_metrics_v2(rsb, rd, next_store_ut, NAN, SN_FLAG_NONE);
 
-                rrddim_store_metric(rd, next_store_ut, NAN, SN_FLAG_NONE);
+                row_values[dim_id] = NAN;
+                row_flags[dim_id] = SN_FLAG_NONE;
                 rd->collector.last_stored_value = NAN;
             }
 
             stored_entries++;
         }
 
+        rrdset_store_metrics_row(st, rda_base, rda_slots, next_store_ut, row_values, row_flags);
+
         ml_chart_update_end(st);
 
         st->counter = ++counter;
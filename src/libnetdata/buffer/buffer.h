@@ -5,6 +5,7 @@
 
 #include "../string/utf8.h"
 #include "../libnetdata.h"
+#include "print_double.h"
 
 #define BUFFER_JSON_MAX_DEPTH 32 // max is 255
 
@@ -577,7 +578,26 @@ static inline void buffer_print_int64_base64(BUFFER *wb, int64_t value) {
     buffer_overflow_check(wb);
 }
 
+// the shortest string that parses back to the same value
 static inline void buffer_print_netdata_double(BUFFER *wb, NETDATA_DOUBLE value) {
+    buffer_need_bytes(wb, PRINT_NETDATA_DOUBLE_SHORTEST_MAX + 2);
+
+    if(isnan(value) || isinf(value)) {
+        buffer_fast_strcat(wb, "null", 4);
+        return;
+    }
+    else
+        wb->len += print_netdata_double_shortest(&wb->buffer[wb->len], value);
+
+    // terminate it
+    buffer_need_bytes(wb, 1);
+    wb->buffer[wb->len] = '\0';
+
+    buffer_overflow_check(wb);
+}
+
+// up to 7 fractional digits
+static inline void buffer_print_netdata_double_fixed(BUFFER *wb, NETDATA_DOUBLE value) {
     buffer_need_bytes(wb, 512 + 2);
 
     if(isnan(value) || isinf(value)) {
@@ -880,6 +900,13 @@ static inline void buffer_json_add_array_item_double(BUFFER *wb, NETDATA_DOUBLE
     wb->json.stack[wb->json.depth].count++;
 }
 
+static inline void buffer_json_add_array_item_double_fixed(BUFFER *wb, NETDATA_DOUBLE value) {
+    buffer_print_json_comma_newline_spacing(wb);
+
+    buffer_print_netdata_double_fixed(wb, value);
+    wb->json.stack[wb->json.depth].count++;
+}
+
 static inline void buffer_json_add_array_item_int64(BUFFER *wb, int64_t value) {
     buffer_print_json_comma_newline_spacing(wb);
 
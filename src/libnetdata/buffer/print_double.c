@@ -0,0 +1,584 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "../libnetdata.h"
+
+// Grisu2, from Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers" (PLDI 2010)
+//
+// It always generates digits that parse back to the same double, using only 64-bit integer arithmetic.
+// For about 99.9% of the doubles these are the shortest possible digits; for the rest, there is one more digit.
+
+typedef struct diy_fp {
+    uint64_t f;
+    int e;
+} DIY_FP;
+
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS    (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT     (-DP_EXPONENT_BIAS)
+#define DP_EXPONENT_MASK    0x7FF0000000000000ULL
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
+
+// the normalized powers of 10, from 1e-348 to 1e340, every 8
+static const struct {
+    uint64_t f;
+    int16_t e;
+} cached_powers[] = {
+    { 0xfa8fd5a0081c0288ULL, -1220 }, { 0xbaaee17fa23ebf76ULL, -1193 }, { 0x8b16fb203055ac76ULL, -1166 },
+    { 0xcf42894a5dce35eaULL, -1140 }, { 0x9a6bb0aa55653b2dULL, -1113 }, { 0xe61acf033d1a45dfULL, -1087 },
+    { 0xab70fe17c79ac6caULL, -1060 }, { 0xff77b1fcbebcdc4fULL, -1034 }, { 0xbe5691ef416bd60cULL, -1007 },
+    { 0x8dd01fad907ffc3cULL, -980 }, { 0xd3515c2831559a83ULL, -954 }, { 0x9d71ac8fada6c9b5ULL, -927 },
+    { 0xea9c227723ee8bcbULL, -901 }, { 0xaecc49914078536dULL, -874 }, { 0x823c12795db6ce57ULL, -847 },
+    { 0xc21094364dfb5637ULL, -821 }, { 0x9096ea6f3848984fULL, -794 }, { 0xd77485cb25823ac7ULL, -768 },
+    { 0xa086cfcd97bf97f4ULL, -741 }, { 0xef340a98172aace5ULL, -715 }, { 0xb23867fb2a35b28eULL, -688 },
+    { 0x84c8d4dfd2c63f3bULL, -661 }, { 0xc5dd44271ad3cdbaULL, -635 }, { 0x936b9fcebb25c996ULL, -608 },
+    { 0xdbac6c247d62a584ULL, -582 }, { 0xa3ab66580d5fdaf6ULL, -555 }, { 0xf3e2f893dec3f126ULL, -529 },
+    { 0xb5b5ada8aaff80b8ULL, -502 }, { 0x87625f056c7c4a8bULL, -475 }, { 0xc9bcff6034c13053ULL, -449 },
+    { 0x964e858c91ba2655ULL, -422 }, { 0xdff9772470297ebdULL, -396 }, { 0xa6dfbd9fb8e5b88fULL, -369 },
+    { 0xf8a95fcf88747d94ULL, -343 }, { 0xb94470938fa89bcfULL, -316 }, { 0x8a08f0f8bf0f156bULL, -289 },
+    { 0xcdb02555653131b6ULL, -263 }, { 0x993fe2c6d07b7facULL, -236 }, { 0xe45c10c42a2b3b06ULL, -210 },
+    { 0xaa242499697392d3ULL, -183 }, { 0xfd87b5f28300ca0eULL, -157 }, { 0xbce5086492111aebULL, -130 },
+    { 0x8cbccc096f5088ccULL, -103 }, { 0xd1b71758e219652cULL, -77 }, { 0x9c40000000000000ULL, -50 },
+    { 0xe8d4a51000000000ULL, -24 }, { 0xad78ebc5ac620000ULL, 3 }, { 0x813f3978f8940984ULL, 30 },
+    { 0xc097ce7bc90715b3ULL, 56 }, { 0x8f7e32ce7bea5c70ULL, 83 }, { 0xd5d238a4abe98068ULL, 109 },
+    { 0x9f4f2726179a2245ULL, 136 }, { 0xed63a231d4c4fb27ULL, 162 }, { 0xb0de65388cc8ada8ULL, 189 },
+    { 0x83c7088e1aab65dbULL, 216 }, { 0xc45d1df942711d9aULL, 242 }, { 0x924d692ca61be758ULL, 269 },
+    { 0xda01ee641a708deaULL, 295 }, { 0xa26da3999aef774aULL, 322 }, { 0xf209787bb47d6b85ULL, 348 },
+    { 0xb454e4a179dd1877ULL, 375 }, { 0x865b86925b9bc5c2ULL, 402 }, { 0xc83553c5c8965d3dULL, 428 },
+    { 0x952ab45cfa97a0b3ULL, 455 }, { 0xde469fbd99a05fe3ULL, 481 }, { 0xa59bc234db398c25ULL, 508 },
+    { 0xf6c69a72a3989f5cULL, 534 }, { 0xb7dcbf5354e9beceULL, 561 }, { 0x88fcf317f22241e2ULL, 588 },
+    { 0xcc20ce9bd35c78a5ULL, 614 }, { 0x98165af37b2153dfULL, 641 }, { 0xe2a0b5dc971f303aULL, 667 },
+    { 0xa8d9d1535ce3b396ULL, 694 }, { 0xfb9b7cd9a4a7443cULL, 720 }, { 0xbb764c4ca7a44410ULL, 747 },
+    { 0x8bab8eefb6409c1aULL, 774 }, { 0xd01fef10a657842cULL, 800 }, { 0x9b10a4e5e9913129ULL, 827 },
+    { 0xe7109bfba19c0c9dULL, 853 }, { 0xac2820d9623bf429ULL, 880 }, { 0x80444b5e7aa7cf85ULL, 907 },
+    { 0xbf21e44003acdd2dULL, 933 }, { 0x8e679c2f5e44ff8fULL, 960 }, { 0xd433179d9c8cb841ULL, 986 },
+    { 0x9e19db92b4e31ba9ULL, 1013 }, { 0xeb96bf6ebadf77d9ULL, 1039 }, { 0xaf87023b9bf0ee6bULL, 1066 },
+};
+
+static const uint64_t pow10_u64[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+static inline DIY_FP diy_fp_from_double(double d) {
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+
+    int biased_e = (int)((u & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+    uint64_t significand = u & DP_SIGNIFICAND_MASK;
+
+    if(likely(biased_e))
+        return (DIY_FP){ .f = significand + DP_HIDDEN_BIT, .e = biased_e - DP_EXPONENT_BIAS };
+
+    // subnormal
+    return (DIY_FP){ .f = significand, .e = DP_MIN_EXPONENT + 1 };
+}
+
+static inline DIY_FP diy_fp_normalize(DIY_FP x) {
+    int s = __builtin_clzll(x.f);
+    return (DIY_FP){ .f = x.f << s, .e = x.e - s };
+}
+
+// the upper 64 bits of the product, rounded
+static inline DIY_FP diy_fp_multiply(DIY_FP x, DIY_FP y) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 p = (unsigned __int128)x.f * y.f;
+    uint64_t h = (uint64_t)(p >> 64);
+    uint64_t l = (uint64_t)p;
+    if(l & (1ULL << 63))
+        h++;
+
+    return (DIY_FP){ .f = h, .e = x.e + y.e + 64 };
+#else
+    const uint64_t M32 = 0xFFFFFFFFULL;
+    const uint64_t a = x.f >> 32, b = x.f & M32;
+    const uint64_t c = y.f >> 32, d = y.f & M32;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+
+    uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1ULL << 31;
+
+    return (DIY_FP){ .f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), .e = x.e + y.e + 64 };
+#endif
+}
+
+// the boundaries of the interval of the numbers that round to v, normalized to the same exponent
+static inline void diy_fp_normalized_boundaries(DIY_FP v, DIY_FP *minus, DIY_FP *plus) {
+    DIY_FP pl = diy_fp_normalize((DIY_FP){ .f = (v.f << 1) + 1, .e = v.e - 1 });
+
+    // when v is a power of 2, the lower boundary is closer
+    DIY_FP mi = (v.f == DP_HIDDEN_BIT) ?
+        (DIY_FP){ .f = (v.f << 2) - 1, .e = v.e - 2 } :
+        (DIY_FP){ .f = (v.f << 1) - 1, .e = v.e - 1 };
+
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *minus = mi;
+    *plus = pl;
+}
+
+// a cached power of 10 that brings the exponent of the product to [-60, -32]
+static inline DIY_FP cached_power_for_binary_exponent(int e, int *K) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // log10(2)
+    int k = (int)dk;
+    if(dk - k > 0.0)
+        k++;
+
+    unsigned index = (unsigned)((k >> 3) + 1);
+    *K = -(-348 + (int)(index << 3));
+
+    return (DIY_FP){ .f = cached_powers[index].f, .e = cached_powers[index].e };
+}
+
+static inline int count_decimal_digits32(uint32_t n) {
+    if(n < 10) return 1;
+    if(n < 100) return 2;
+    if(n < 1000) return 3;
+    if(n < 10000) return 4;
+    if(n < 100000) return 5;
+    if(n < 1000000) return 6;
+    if(n < 10000000) return 7;
+    if(n < 100000000) return 8;
+    // the integral part is always less than 1e9 here
+    return 9;
+}
+
+static inline void grisu_round(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+    // move the last digit closer to the real value, while it stays within the boundaries
+    while(rest < wp_w && delta - rest >= ten_kappa &&
+          (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static inline void grisu_digits(DIY_FP W, DIY_FP Mp, uint64_t delta, char *digits, int *length, int *K) {
+    const DIY_FP one = { .f = 1ULL << -Mp.e, .e = Mp.e };
+    const uint64_t wp_w = Mp.f - W.f;
+
+    uint32_t p1 = (uint32_t)(Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = count_decimal_digits32(p1);
+    int len = 0;
+
+    // the integral part
+    while(kappa > 0) {
+        uint32_t d;
+        switch(kappa) {
+            case  9: d = p1 /  100000000; p1 %=  100000000; break;
+            case  8: d = p1 /   10000000; p1 %=   10000000; break;
+            case  7: d = p1 /    1000000; p1 %=    1000000; break;
+            case  6: d = p1 /     100000; p1 %=     100000; break;
+            case  5: d = p1 /      10000; p1 %=      10000; break;
+            case  4: d = p1 /       1000; p1 %=       1000; break;
+            case  3: d = p1 /        100; p1 %=        100; break;
+            case  2: d = p1 /         10; p1 %=         10; break;
+            case  1: d = p1;              p1 =           0; break;
+            default: d = 0; break;
+        }
+
+        if(d || len)
+            digits[len++] = (char)('0' + d);
+
+        kappa--;
+
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if(rest <= delta) {
+            *K += kappa;
+            grisu_round(digits, len, delta, rest, pow10_u64[kappa] << -one.e, wp_w);
+            *length = len;
+            return;
+        }
+    }
+
+    // the fractional part
+    for(;;) {
+        p2 *= 10;
+        delta *= 10;
+
+        char d = (char)(p2 >> -one.e);
+        if(d || len)
+            digits[len++] = (char)('0' + d);
+
+        p2 &= one.f - 1;
+        kappa--;
+
+        if(p2 < delta) {
+            *K += kappa;
+            int index = -kappa;
+            grisu_round(digits, len, delta, p2, one.f, wp_w * (index < 20 ? pow10_u64[index] : 0));
+            *length = len;
+            return;
+        }
+    }
+}
+
+// generates the digits of a positive, finite, non-zero double
+// the double is digits x 10^K
+static inline void grisu2(double value, char *digits, int *length, int *K) {
+    const DIY_FP v = diy_fp_from_double(value);
+
+    DIY_FP w_m, w_p;
+    diy_fp_normalized_boundaries(v, &w_m, &w_p);
+
+    const DIY_FP c_mk = cached_power_for_binary_exponent(w_p.e, K);
+    const DIY_FP W = diy_fp_multiply(diy_fp_normalize(v), c_mk);
+    DIY_FP Wp = diy_fp_multiply(w_p, c_mk);
+    DIY_FP Wm = diy_fp_multiply(w_m, c_mk);
+
+    // the products are rounded, so make the interval a bit narrower
+    Wm.f++;
+    Wp.f--;
+
+    grisu_digits(W, Wp, Wp.f - Wm.f, digits, length, K);
+}
+
+static inline char *print_exponent(char *d, int exponent) {
+    *d++ = 'e';
+
+    if(exponent < 0) {
+        *d++ = '-';
+        exponent = -exponent;
+    }
+    else
+        *d++ = '+';
+
+    if(exponent >= 100) {
+        *d++ = (char)('0' + exponent / 100);
+        exponent %= 100;
+        *d++ = (char)('0' + exponent / 10);
+    }
+    else if(exponent >= 10)
+        *d++ = (char)('0' + exponent / 10);
+
+    *d++ = (char)('0' + exponent % 10);
+    return d;
+}
+
+static inline int print_netdata_double_shortest_internal(char *dst, double value, int *significant_digits) {
+    char *d = dst;
+
+    if(unlikely(isnan(value))) {
+        memcpy(d, "nan", 3);
+        d += 3;
+        *d = '\0';
+        *significant_digits = 0;
+        return (int)(d - dst);
+    }
+
+    if(value < 0) {
+        *d++ = '-';
+        value = -value;
+    }
+
+    if(unlikely(isinf(value))) {
+        memcpy(d, "inf", 3);
+        d += 3;
+        *d = '\0';
+        *significant_digits = 0;
+        return (int)(d - dst);
+    }
+
+    if(unlikely(value == 0.0)) {
+        // -0.0 is printed as 0
+        d = dst;
+        *d++ = '0';
+        *d = '\0';
+        *significant_digits = 1;
+        return 1;
+    }
+
+    char digits[PRINT_NETDATA_DOUBLE_SHORTEST_MAX];
+    int length, K;
+    grisu2(value, digits, &length, &K);
+    *significant_digits = length;
+
+    // the position of the decimal point, relative to the first digit
+    const int point = length + K;
+
+    if(K >= 0 && point <= 21) {
+        // an integer: 1234e7 -> 12340000000
+        memcpy(d, digits, length);
+        d += length;
+        memset(d, '0', K);
+        d += K;
+    }
+    else if(point > 0 && point <= 21) {
+        // 1234e-2 -> 12.34
+        memcpy(d, digits, point);
+        d += point;
+        *d++ = '.';
+        memcpy(d, &digits[point], length - point);
+        d += length - point;
+    }
+    else if(point > -6 && point <= 0) {
+        // 1234e-6 -> 0.001234
+        *d++ = '0';
+        *d++ = '.';
+        memset(d, '0', -point);
+        d += -point;
+        memcpy(d, digits, length);
+        d += length;
+    }
+    else {
+        // 1234e30 -> 1.234e+33
+        *d++ = digits[0];
+        if(length > 1) {
+            *d++ = '.';
+            memcpy(d, &digits[1], length - 1);
+            d += length - 1;
+        }
+        d = print_exponent(d, point - 1);
+    }
+
+    *d = '\0';
+    return (int)(d - dst);
+}
+
+int print_netdata_double_shortest(char *dst, NETDATA_DOUBLE value) {
+    int significant_digits;
+    return print_netdata_double_shortest_internal(dst, (double)value, &significant_digits);
+}
+
+// ----------------------------------------------------------------------------
+// unittest and benchmark
+
+static inline uint64_t print_double_xorshift(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+static inline double print_double_from_bits(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// the least significant digits that parse back to the same double
+static int print_double_shortest_digits_by_printf(double value) {
+    char buf[50];
+    for(int precision = 0; precision < 17 ;precision++) {
+        snprintf(buf, sizeof(buf), "%.*e", precision, value);
+        if(strtod(buf, NULL) == value)
+            return precision + 1;
+    }
+
+    return 17;
+}
+
+struct print_double_unittest_stats {
+    size_t checked;
+    size_t failed;
+    size_t longer;
+    size_t length_checked;
+};
+
+static void print_double_check(struct print_double_unittest_stats *st, double value, bool check_length) {
+    char buf[PRINT_NETDATA_DOUBLE_SHORTEST_MAX];
+    int significant_digits;
+    int len = print_netdata_double_shortest_internal(buf, value, &significant_digits);
+
+    st->checked++;
+
+    char *end = NULL;
+    double parsed = strtod(buf, &end);
+    if(parsed != value || end != &buf[len] || len >= PRINT_NETDATA_DOUBLE_SHORTEST_MAX || (size_t)len != strlen(buf)) {
+        if(st->failed++ < 10)
+            fprintf(stderr, "PRINT DOUBLE: %.17g (%a) printed as '%s', which is parsed as %.17g\n",
+                    value, value, buf, parsed);
+        return;
+    }
+
+    if(check_length && value != 0.0) {
+        int expected = print_double_shortest_digits_by_printf(value);
+
+        // grisu2 excludes the boundaries of the rounding interval, so rarely it needs more digits
+        st->length_checked++;
+        if(significant_digits > expected)
+            st->longer++;
+    }
+
+    if(significant_digits > 17) {
+        if(st->failed++ < 10)
+            fprintf(stderr, "PRINT DOUBLE: %.17g printed as '%s' with %d digits\n", value, buf, significant_digits);
+    }
+}
+
+static int print_double_check_strings(void) {
+    const struct {
+        double value;
+        const char *expected;
+    } values[] = {
+        { 0.0, "0" },
+        { -0.0, "0" },
+        { 1.0, "1" },
+        { -1.5, "-1.5" },
+        { 0.1, "0.1" },
+        { 0.3, "0.3" },
+        { 0.1 + 0.2, "0.30000000000000004" },
+        { 100.0 / 3.0, "33.333333333333336" },
+        { 123.456, "123.456" },
+        { 1700000000.0, "1700000000" },
+        { 1e20, "100000000000000000000" },
+        { 1e21, "1e+21" },
+        { 1.5e300, "1.5e+300" },
+        { 0.000001, "0.000001" },
+        { 0.0000001, "1e-7" },
+        { 1.234e-10, "1.234e-10" },
+        { 9007199254740993.0, "9007199254740992" },
+        { 5e-324, "5e-324" },
+        { 2.2250738585072014e-308, "2.2250738585072014e-308" },
+        { 1.7976931348623157e308, "1.7976931348623157e+308" },
+        { 9.12345678901234567890123456789e+45, "9.123456789012346e+45" },
+    };
+
+    int errors = 0;
+    char buf[PRINT_NETDATA_DOUBLE_SHORTEST_MAX];
+    for(size_t i = 0; i < sizeof(values) / sizeof(values[0]) ;i++) {
+        print_netdata_double_shortest(buf, values[i].value);
+        if(strcmp(buf, values[i].expected) != 0) {
+            fprintf(stderr, "PRINT DOUBLE: %.17g printed as '%s', expected '%s'\n", values[i].value, buf, values[i].expected);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+int print_netdata_double_unittest(bool exhaustive) {
+    fprintf(stderr, "\n%s() running%s...\n", __FUNCTION__, exhaustive ? " exhaustively (this will take a while)" : "");
+
+    int errors = print_double_check_strings();
+
+    struct print_double_unittest_stats st = { 0 };
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+    // every binary exponent, with the edge significands and random ones
+    for(uint64_t e = 0; e < 0x7FF ;e++) {
+        const uint64_t significands[] = { 0, 1, 2, DP_SIGNIFICAND_MASK - 1, DP_SIGNIFICAND_MASK, DP_HIDDEN_BIT >> 1, (DP_HIDDEN_BIT >> 1) + 1 };
+        for(size_t s = 0; s < sizeof(significands) / sizeof(significands[0]) ;s++) {
+            double v = print_double_from_bits((e << DP_SIGNIFICAND_SIZE) | significands[s]);
+            print_double_check(&st, v, true);
+            print_double_check(&st, -v, false);
+        }
+
+        for(size_t s = 0; s < 64 ;s++)
+            print_double_check(&st, print_double_from_bits((e << DP_SIGNIFICAND_SIZE) | (print_double_xorshift(&seed) & DP_SIGNIFICAND_MASK)), (s % 16) == 0);
+    }
+
+    // the values metrics usually have
+    for(int64_t i = -100000; i <= 1000000 ;i++) {
+        print_double_check(&st, (double)i, false);
+        print_double_check(&st, (double)i / 10.0, false);
+        print_double_check(&st, (double)i / 100.0, false);
+        print_double_check(&st, (double)i / 1000.0, false);
+        print_double_check(&st, (double)i / 3.0, (i % 997) == 0);
+    }
+
+    // float32 values, every one of them when exhaustive
+    const uint64_t step = exhaustive ? 1 : 4099;
+    for(uint64_t bits = 0; bits <= UINT32_MAX ;bits += step) {
+        uint32_t b32 = (uint32_t)bits;
+        float f;
+        memcpy(&f, &b32, sizeof(f));
+        if(!isfinite(f))
+            continue;
+
+        print_double_check(&st, (double)f, !exhaustive && (bits % 61) == 0);
+    }
+
+    // random doubles
+    for(size_t i = 0; i < (exhaustive ? 100000000 : 1000000) ;i++) {
+        double v = print_double_from_bits(print_double_xorshift(&seed));
+        if(!isfinite(v))
+            continue;
+
+        print_double_check(&st, v, (i % 127) == 0);
+    }
+
+    fprintf(stderr, "PRINT DOUBLE: checked %zu doubles, %zu failed to round-trip or were too long, "
+                    "%zu of %zu (%0.3f%%) have more digits than the shortest\n",
+            st.checked, st.failed, st.longer, st.length_checked,
+            st.length_checked ? (double)st.longer * 100.0 / (double)st.length_checked : 0.0);
+
+    errors += (int)st.failed;
+    fprintf(stderr, "PRINT DOUBLE: %s\n", errors ? "FAILED" : "OK");
+    return errors;
+}
+
+int print_netdata_double_benchmark(void) {
+    const size_t count = 1000000;
+    double *values = mallocz(count * sizeof(double));
+
+    enum {
+        PRINT_DOUBLE_BENCHMARK_METRICS = 0,
+        PRINT_DOUBLE_BENCHMARK_INTEGERS,
+        PRINT_DOUBLE_BENCHMARK_RANDOM,
+        PRINT_DOUBLE_BENCHMARK_MAX,
+    };
+    const char *sets[PRINT_DOUBLE_BENCHMARK_MAX] = {
+        [PRINT_DOUBLE_BENCHMARK_METRICS] = "averages",
+        [PRINT_DOUBLE_BENCHMARK_INTEGERS] = "integers",
+        [PRINT_DOUBLE_BENCHMARK_RANDOM] = "random",
+    };
+
+    for(size_t set = 0; set < PRINT_DOUBLE_BENCHMARK_MAX ;set++) {
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+        for(size_t i = 0; i < count ;i++) {
+            switch(set) {
+                case PRINT_DOUBLE_BENCHMARK_METRICS:
+                    // like the points of a query: collected values, grouped
+                    values[i] = (double)(print_double_xorshift(&seed) % 10000000) / 1000.0 / (double)(1 + i % 7);
+                    break;
+
+                case PRINT_DOUBLE_BENCHMARK_INTEGERS:
+                    values[i] = (double)(print_double_xorshift(&seed) % 100000000);
+                    break;
+
+                default:
+                    do {
+                        values[i] = print_double_from_bits(print_double_xorshift(&seed));
+                    } while(!isfinite(values[i]));
+                    break;
+            }
+        }
+
+        const char *names[] = { "fixed", "shortest", "printf" };
+        for(size_t f = 0; f < sizeof(names) / sizeof(names[0]) ;f++) {
+            char buf[512 + 2];
+            size_t bytes = 0;
+
+            usec_t started_ut = now_monotonic_usec();
+            for(size_t i = 0; i < count ;i++) {
+                switch(f) {
+                    case 0:
+                        bytes += print_netdata_double(buf, values[i]);
+                        break;
+
+                    case 1:
+                        bytes += print_netdata_double_shortest(buf, values[i]);
+                        break;
+
+                    default:
+                        bytes += snprintf(buf, sizeof(buf), "%.17g", values[i]);
+                        break;
+                }
+            }
+            usec_t ended_ut = now_monotonic_usec();
+
+            fprintf(stderr, "PRINT DOUBLE BENCHMARK: %-8s %-8s %6.1f ns per number, %5.1f bytes per number\n",
+                    sets[set], names[f],
+                    (double)(ended_ut - started_ut) * 1000.0 / (double)count,
+                    (double)bytes / (double)count);
+        }
+    }
+
+    freez(values);
+    return 0;
+}
@@ -0,0 +1,19 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_PRINT_DOUBLE_H
+#define NETDATA_PRINT_DOUBLE_H 1
+
+#include "../libnetdata.h"
+
+// the max bytes print_netdata_double_shortest() writes, including the terminating NUL
+#define PRINT_NETDATA_DOUBLE_SHORTEST_MAX 32
+
+// print the shortest decimal string that parses back to the same double
+// numbers below 1e21 are printed without an exponent, and numbers below 1e-6 with one (like javascript does)
+// long doubles are printed as doubles
+int print_netdata_double_shortest(char *dst, NETDATA_DOUBLE value);
+
+int print_netdata_double_unittest(bool exhaustive);
+int print_netdata_double_benchmark(void);
+
+#endif //NETDATA_PRINT_DOUBLE_H
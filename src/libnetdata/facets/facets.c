@@ -166,6 +166,7 @@ struct facet_key {
 
     FACETS_HASH hash;
     const char *name;
+    uint32_t name_len;
 
     FACET_KEY_OPTIONS options;
 
@@ -251,7 +252,10 @@ struct facets {
 
     struct {
         // this is like a stack, of the keys that need to clean up between each row
+        // it is also used to predict the keys of the next row, since log rows
+        // usually have the same fields in the same order
         size_t used;
+        size_t previous;        // the number of keys the previous row had
         FACET_KEY *array[FACETS_KEYS_IN_ROW_MAX];
     } keys_in_row;
 
@@ -305,6 +309,7 @@ struct facets {
             size_t matched;
             size_t unsampled;
             size_t estimated;
+            size_t indexed;
             size_t created;
             size_t reused;
         } rows;
@@ -312,6 +317,7 @@ struct facets {
         struct {
             size_t registered;
             size_t unique;
+            size_t predicted;
         } keys;
 
         struct {
@@ -334,6 +340,10 @@ struct facets {
     struct {
         DICTIONARY *used_hashes_registry;
     } report;
+
+    // partial instances borrow the patterns of the FACETS they were created from,
+    // so that many threads can evaluate rows concurrently and merge their results
+    FACETS *parent;
 };
 
 usec_t facets_row_oldest_ut(FACETS *facets) {
@@ -678,6 +688,7 @@ static void facet_key_set_name(FACET_KEY *k, const char *name, size_t name_lengt
     internal_fatal(strchr(buf, '='), "found = in key");
 
     k->name = strdupz(buf);
+    k->name_len = name_length;
     facet_key_late_init(k->facets, k);
 }
 
@@ -740,11 +751,17 @@ bool facets_key_name_is_filter(FACETS *facets, const char *key) {
     return (!k || k->default_selected_for_values) ? false : true;
 }
 
+static inline bool facets_key_options_is_facet(FACETS *facets, FACET_KEY_OPTIONS options, const char *name, bool *never);
+
+// does not register the key - call facets_register_key_name() for that
 bool facets_key_name_is_facet(FACETS *facets, const char *key) {
-    size_t key_len = strlen(key);
-    FACETS_HASH hash = FACETS_HASH_FUNCTION(key, key_len);
-    FACET_KEY *k = FACETS_KEY_ADD_TO_INDEX(facets, hash, key, key_len, 0);
-    return (k && (k->options & FACET_KEY_OPTION_FACET));
+    FACETS_HASH hash = FACETS_HASH_FUNCTION(key, strlen(key));
+    FACET_KEY *k = FACETS_KEY_GET_FROM_INDEX(facets, hash);
+
+    if(k && (k->options & (FACET_KEY_OPTION_FACET | FACET_KEY_OPTION_NO_FACET | FACET_KEY_OPTION_NEVER_FACET)))
+        return (k->options & FACET_KEY_OPTION_FACET) ? true : false;
+
+    return facets_key_options_is_facet(facets, k ? k->options : 0, key, NULL);
 }
 
 // ----------------------------------------------------------------------------
@@ -947,6 +964,102 @@ void facets_row_finished_unsampled(FACETS *facets, usec_t usec) {
     facets_reset_key(facets->histogram.key);
 }
 
+// ----------------------------------------------------------------------------
+// pre-computed counters
+//
+// The caller has already counted the rows of a set of data (all of them in the
+// timeframe, without filters or full text search) per key and value.
+// facets_indexed_key_value() is called once for every key/value pair and
+// facets_indexed_rows_finished() once at the end, to account the rows that did
+// not have some of the facet keys.
+
+bool facets_indexed_histogram_is_compatible(FACETS *facets, usec_t slot_width_ut) {
+    if(!facets->histogram.enabled)
+        return true;
+
+    // every indexed slot should fall into exactly one histogram slot
+    return slot_width_ut &&
+           facets->histogram.slot_width_ut % slot_width_ut == 0 &&
+           facets->histogram.after_ut % slot_width_ut == 0;
+}
+
+static inline void facets_indexed_histogram_update(FACETS *facets, FACET_KEY *k, FACET_VALUE *v,
+                                                   usec_t base_ut, usec_t slot_width_ut, const FACETS_INDEXED_SLOT *slots, size_t entries) {
+    if(unlikely(!facets->histogram.key && facets->histogram.hash == k->hash))
+        facets->histogram.key = k;
+
+    if(!facets->histogram.enabled || facets->histogram.key != k)
+        return;
+
+    for(size_t i = 0; i < entries ;i++) {
+        usec_t ut = base_ut + slots[i].slot * slot_width_ut;
+
+        if(ut < facets->histogram.after_ut || ut > facets->histogram.before_ut)
+            continue;
+
+        uint32_t slot = facets_histogram_slot_at_time_ut(facets, ut, v);
+        v->histogram[slot] += slots[i].rows;
+    }
+}
+
+void facets_indexed_key_value(FACETS *facets, const char *key, size_t key_len, const char *value, size_t value_len, uint32_t rows,
+                              usec_t base_ut, usec_t slot_width_ut, const FACETS_INDEXED_SLOT *slots, size_t entries) {
+    FACET_KEY *k = FACETS_KEY_ADD_TO_INDEX(facets, FACETS_HASH_FUNCTION(key, key_len), key, key_len, 0);
+    if(!k->values.enabled)
+        return;
+
+    // mark the key as found, so that adding the value will not count it
+    // and facets_indexed_rows_finished() will know it has been given
+    k->key_found_in_row = 1;
+
+    FACET_VALUE *v;
+    if(!value) {
+        FACET_VALUE_ADD_EMPTY_VALUE_TO_INDEX(k);
+        v = k->empty_value.v;
+        facets->operations.values.empty += rows;
+    }
+    else {
+        FACET_VALUE tv = {
+                .hash = FACETS_HASH_FUNCTION(value, value_len),
+                .name = value,
+                .name_len = value_len,
+        };
+        v = FACET_VALUE_ADD_TO_INDEX(k, &tv);
+        facets->operations.values.indexed++;
+    }
+
+    v->rows_matching_facet_value += rows;
+    v->final_facet_value_counter += rows;
+    facets->operations.values.registered += rows;
+
+    facets_indexed_histogram_update(facets, k, v, base_ut, slot_width_ut, slots, entries);
+}
+
+void facets_indexed_rows_finished(FACETS *facets, size_t rows,
+                                  usec_t base_ut, usec_t slot_width_ut, const FACETS_INDEXED_SLOT *slots, size_t entries) {
+    facets->operations.rows.evaluated += rows;
+    facets->operations.rows.matched += rows;
+    facets->operations.rows.indexed += rows;
+
+    for(size_t p = 0; p < facets->keys_with_values.used ;p++) {
+        FACET_KEY *k = facets->keys_with_values.array[p];
+
+        if(!k->key_found_in_row) {
+            // none of the rows had this key
+            k->key_found_in_row = 1;
+            FACET_VALUE_ADD_EMPTY_VALUE_TO_INDEX(k);
+            FACET_VALUE *v = k->empty_value.v;
+            v->rows_matching_facet_value += rows;
+            v->final_facet_value_counter += rows;
+            facets->operations.values.empty += rows;
+
+            facets_indexed_histogram_update(facets, k, v, base_ut, slot_width_ut, slots, entries);
+        }
+
+        facets_reset_key(k);
+    }
+}
+
 static const char *facets_key_name_cached(FACET_KEY *k, DICTIONARY *used_hashes_registry) {
     if(k->name) {
         if(used_hashes_registry && !k->default_selected_for_values) {
@@ -1547,36 +1660,46 @@ static inline void facet_value_is_used(FACET_KEY *k, FACET_VALUE *v) {
         k->key_values_selected_in_row++;
 }
 
-static inline bool facets_key_is_facet(FACETS *facets, FACET_KEY *k) {
-    bool included = facets->all_keys_included_by_default, excluded = false, never = false;
+static inline bool facets_key_options_is_facet(FACETS *facets, FACET_KEY_OPTIONS options, const char *name, bool *never) {
+    bool included = facets->all_keys_included_by_default, excluded = false;
+    bool never_facet = false;
 
-    if(k->options & (FACET_KEY_OPTION_FACET | FACET_KEY_OPTION_NO_FACET | FACET_KEY_OPTION_NEVER_FACET)) {
-        if(k->options & FACET_KEY_OPTION_FACET) {
+    if(options & (FACET_KEY_OPTION_FACET | FACET_KEY_OPTION_NO_FACET | FACET_KEY_OPTION_NEVER_FACET)) {
+        if(options & FACET_KEY_OPTION_FACET) {
             included = true;
             excluded = false;
-            never = false;
+            never_facet = false;
         }
-        else if(k->options & (FACET_KEY_OPTION_NO_FACET | FACET_KEY_OPTION_NEVER_FACET)) {
+        else if(options & (FACET_KEY_OPTION_NO_FACET | FACET_KEY_OPTION_NEVER_FACET)) {
             included = false;
             excluded = true;
-            never = true;
+            never_facet = true;
         }
     }
     else {
         if (facets->included_keys) {
-            if (!simple_pattern_matches(facets->included_keys, k->name))
+            if (!simple_pattern_matches(facets->included_keys, name))
                 included = false;
         }
 
         if (facets->excluded_keys) {
-            if (simple_pattern_matches(facets->excluded_keys, k->name)) {
+            if (simple_pattern_matches(facets->excluded_keys, name)) {
                 excluded = true;
-                never = true;
+                never_facet = true;
             }
         }
     }
 
-    if(included && !excluded) {
+    if(never)
+        *never = never_facet;
+
+    return included && !excluded;
+}
+
+static inline bool facets_key_is_facet(FACETS *facets, FACET_KEY *k) {
+    bool never = false;
+
+    if(facets_key_options_is_facet(facets, k->options, k->name, &never)) {
         k->options |= FACET_KEY_OPTION_FACET;
         k->options &= ~FACET_KEY_OPTION_NO_FACET;
         return true;
@@ -1617,12 +1740,67 @@ FACETS *facets_create(uint32_t items_to_return, FACETS_OPTIONS options, const ch
     return facets;
 }
 
+FACETS *facets_create_partial(FACETS *facets) {
+    FACETS *partial = callocz(1, sizeof(FACETS));
+    partial->parent = facets;
+    partial->all_keys_included_by_default = facets->all_keys_included_by_default;
+    partial->options = facets->options;
+    partial->visible_keys = facets->visible_keys;
+    partial->included_keys = facets->included_keys;
+    partial->excluded_keys = facets->excluded_keys;
+    partial->query = facets->query;
+    partial->anchor = facets->anchor;
+    partial->max_items_to_return = facets->max_items_to_return;
+    partial->order = facets->order;
+    partial->timeframe = facets->timeframe;
+    partial->histogram = facets->histogram;
+    partial->histogram.key = NULL;
+    partial->histogram.chart = NULL;
+    partial->severity = facets->severity;
+    FACETS_KEYS_INDEX_CREATE(partial);
+
+    FACET_KEY *k;
+    foreach_key_in_facets(facets, k) {
+        FACET_KEY *pk = FACETS_KEY_ADD_TO_INDEX(partial, k->hash, k->name, k->name ? strlen(k->name) : 0, k->options);
+        pk->order = k->order;
+        pk->default_selected_for_values = k->default_selected_for_values;
+        pk->transform = k->transform;
+        pk->dynamic = k->dynamic;
+
+        if(k->values.enabled) {
+            facet_key_late_init(partial, pk);
+
+            FACET_VALUE *v;
+            foreach_value_in_key(k, v) {
+                FACET_VALUE tv = {
+                        .hash = v->hash,
+                        .name = v->name,
+                        .name_len = v->name_len,
+                        .selected = v->selected,
+                };
+                FACET_VALUE_ADD_TO_INDEX(pk, &tv);
+            }
+            foreach_value_in_key_done(v);
+        }
+
+        facets_reset_key(pk);
+    }
+    foreach_key_in_facets_done(k);
+
+    partial->order = facets->order;
+
+    return partial;
+}
+
 void facets_destroy(FACETS *facets) {
     dictionary_destroy(facets->accepted_params);
     FACETS_KEYS_INDEX_DESTROY(facets);
-    simple_pattern_free(facets->visible_keys);
-    simple_pattern_free(facets->included_keys);
-    simple_pattern_free(facets->excluded_keys);
+
+    if(!facets->parent) {
+        simple_pattern_free(facets->visible_keys);
+        simple_pattern_free(facets->included_keys);
+        simple_pattern_free(facets->excluded_keys);
+    }
 
     while(facets->base) {
         FACET_ROW *r = facets->base;
@@ -1878,8 +2056,27 @@ void facets_add_key_value(FACETS *facets, const char *key, const char *value) {
     facets_key_check_value(facets, k);
 }
 
+static inline FACET_KEY *facets_key_predicted(FACETS *facets, const char *key, size_t key_len) {
+    // the slots above keys_in_row.used still have the keys of the previous row,
+    // so when this row follows the same order, we can skip hashing the key name
+    size_t pos = facets->keys_in_row.used;
+    if(likely(pos < facets->keys_in_row.previous)) {
+        FACET_KEY *k = facets->keys_in_row.array[pos];
+        if(likely(k->name_len == key_len && !(k->options & FACET_KEY_OPTION_REORDER) &&
+                  memcmp(k->name, key, key_len) == 0)) {
+            facets->operations.keys.registered++;
+            facets->operations.keys.predicted++;
+            return k;
+        }
+    }
+
+    return NULL;
+}
+
 void facets_add_key_value_length(FACETS *facets, const char *key, size_t key_len, const char *value, size_t value_len) {
-    FACET_KEY *k = facets_register_key_name_length(facets, key, key_len, 0);
+    FACET_KEY *k = facets_key_predicted(facets, key, key_len);
+    if(unlikely(!k))
+        k = facets_register_key_name_length(facets, key, key_len, 0);
     k->current_value.raw = value;
     k->current_value.raw_len = value_len;
 
@@ -1962,7 +2159,7 @@ static FACET_ROW *facets_row_create(FACETS *facets, usec_t usec, FACET_ROW *into
             t.empty = false;
         }
 
-        dictionary_set(row->dict, k->name, &t, sizeof(t));
+        dictionary_set_advanced(row->dict, k->name, k->name ? (ssize_t)k->name_len : -1, &t, sizeof(t), NULL);
     }
     foreach_key_in_facets_done(k);
 
@@ -2041,15 +2238,7 @@ bool facets_row_candidate_to_keep(FACETS *facets, usec_t usec) {
             facets->items_to_return < facets->max_items_to_return;
 }
 
-static void facets_row_keep(FACETS *facets, usec_t usec) {
-    facets->operations.rows.matched++;
-
-    if(unlikely(!facets->base)) {
-        // the first row to keep
-        facets_row_keep_first_entry(facets, usec);
-        return;
-    }
-
+static bool facets_row_keep_find_position(FACETS *facets, usec_t usec, FACET_ROW **closest_ptr, FACET_ROW **to_replace_ptr) {
     FACET_ROW *closest = facets_row_keep_seek_to_position(facets, usec);
     FACET_ROW *to_replace = NULL;
 
@@ -2062,7 +2251,7 @@ static void facets_row_keep(FACETS *facets, usec_t usec) {
                 if(closest == facets->base->prev && usec < closest->usec) {
                     // this is to the end of the list, belonging to the next page
                     facets->operations.skips_after++;
-                    return;
+                    return false;
                 }
 
                 // it seems we need to remove an item - the last one
@@ -2076,7 +2265,7 @@ static void facets_row_keep(FACETS *facets, usec_t usec) {
                 if(closest == facets->base && usec > closest->usec) {
                     // this is to the beginning of the list, belonging to the next page
                     facets->operations.skips_before++;
-                    return;
+                    return false;
                 }
 
                 // it seems we need to remove an item - the first one
@@ -2095,20 +2284,42 @@ static void facets_row_keep(FACETS *facets, usec_t usec) {
     internal_fatal(!closest, "FACETS: closest cannot be NULL");
     internal_fatal(closest == to_replace, "FACETS: closest cannot be the same as to_replace");
 
-    facets->operations.last_added = facets_row_create(facets, usec, to_replace);
+    *closest_ptr = closest;
+    *to_replace_ptr = to_replace;
+    return true;
+}
+
+static void facets_row_keep_insert(FACETS *facets, FACET_ROW *closest, FACET_ROW *row) {
+    facets->operations.last_added = row;
 
-    if(usec < closest->usec) {
-        DOUBLE_LINKED_LIST_INSERT_ITEM_AFTER_UNSAFE(facets->base, closest, facets->operations.last_added, prev, next);
+    if(row->usec < closest->usec) {
+        DOUBLE_LINKED_LIST_INSERT_ITEM_AFTER_UNSAFE(facets->base, closest, row, prev, next);
         facets->operations.appends++;
     }
     else {
-        DOUBLE_LINKED_LIST_INSERT_ITEM_BEFORE_UNSAFE(facets->base, closest, facets->operations.last_added, prev, next);
+        DOUBLE_LINKED_LIST_INSERT_ITEM_BEFORE_UNSAFE(facets->base, closest, row, prev, next);
         facets->operations.prepends++;
     }
 
     facets->items_to_return++;
 }
 
+static void facets_row_keep(FACETS *facets, usec_t usec) {
+    facets->operations.rows.matched++;
+
+    if(unlikely(!facets->base)) {
+        // the first row to keep
+        facets_row_keep_first_entry(facets, usec);
+        return;
+    }
+
+    FACET_ROW *closest, *to_replace;
+    if(!facets_row_keep_find_position(facets, usec, &closest, &to_replace))
+        return;
+
+    facets_row_keep_insert(facets, closest, facets_row_create(facets, usec, to_replace));
+}
+
 static inline void facets_reset_key(FACET_KEY *k) {
     k->key_found_in_row = 0;
     k->key_values_selected_in_row = 0;
@@ -2127,6 +2338,7 @@ static void facets_reset_keys_with_value_and_row(FACETS *facets) {
     facets->current_row.severity = FACET_ROW_SEVERITY_NORMAL;
     facets->current_row.keys_matched_by_query_positive = 0;
     facets->current_row.keys_matched_by_query_negative = 0;
+    facets->keys_in_row.previous = entries;
     facets->keys_in_row.used = 0;
 }
 
@@ -2216,6 +2428,141 @@ bool facets_row_finished(FACETS *facets, usec_t usec) {
     return selected_keys == total_keys;
 }
 
+// ----------------------------------------------------------------------------
+// merging partial results
+
+static void facets_row_merge(FACETS *facets, FACET_ROW *row) {
+    if(unlikely(!facets->base)) {
+        DOUBLE_LINKED_LIST_APPEND_ITEM_UNSAFE(facets->base, row, prev, next);
+        facets->operations.last_added = row;
+        facets->items_to_return++;
+        return;
+    }
+
+    FACET_ROW *closest, *to_replace;
+    if(!facets_row_keep_find_position(facets, row->usec, &closest, &to_replace)) {
+        facets_row_free(facets, row);
+        return;
+    }
+
+    if(to_replace)
+        facets_row_free(facets, to_replace);
+
+    facets_row_keep_insert(facets, closest, row);
+}
+
+static void facets_merge_key_values(FACETS *facets, FACET_KEY *k, FACET_KEY *pk) {
+    FACET_VALUE *pv;
+    foreach_value_in_key(pk, pv) {
+        FACET_VALUE *v = FACET_VALUE_GET_FROM_INDEX(k, pv->hash);
+
+        if(!v) {
+            FACET_VALUE tv = {
+                    .hash = pv->hash,
+                    .name = pv->name,
+                    .name_len = pv->name_len,
+                    .color = pv->color,
+                    .selected = pv->selected,
+                    .empty = pv->empty,
+                    .unsampled = pv->unsampled,
+                    .estimated = pv->estimated,
+            };
+            v = FACET_VALUE_ADD_TO_INDEX(k, &tv);
+
+            if(v->empty)
+                k->empty_value.v = v;
+            else if(v->unsampled)
+                k->unsampled_value.v = v;
+            else if(v->estimated)
+                k->estimated_value.v = v;
+        }
+        else if(!v->name && pv->name && pv->name_len) {
+            v->name = facets_value_dup(pv->name, pv->name_len);
+            v->name_len = pv->name_len;
+        }
+
+        v->rows_matching_facet_value += pv->rows_matching_facet_value;
+        v->final_facet_value_counter += pv->final_facet_value_counter;
+
+        if(pv->histogram) {
+            if(!v->histogram)
+                v->histogram = callocz(facets->histogram.slots, sizeof(*v->histogram));
+
+            for(uint32_t i = 0; i < facets->histogram.slots ;i++)
+                v->histogram[i] += pv->histogram[i];
+        }
+    }
+    foreach_value_in_key_done(pv);
+}
+
+void facets_merge_partial(FACETS *facets, FACETS *partial) {
+    internal_fatal(partial->parent != facets, "FACETS: merging a partial into a FACETS it was not created from");
+    internal_fatal(partial->histogram.slots != facets->histogram.slots, "FACETS: histogram slots of partial do not match");
+
+    FACET_KEY *pk;
+    foreach_key_in_facets(partial, pk) {
+        FACET_KEY *k = FACETS_KEY_ADD_TO_INDEX(facets, pk->hash, pk->name, pk->name ? strlen(pk->name) : 0, pk->options);
+
+        if(!k->transform.cb)
+            k->transform = pk->transform;
+
+        if(!k->dynamic.cb)
+            k->dynamic = pk->dynamic;
+
+        if(pk->values.enabled) {
+            facet_key_late_init(facets, k);
+
+            if(k->values.enabled)
+                facets_merge_key_values(facets, k, pk);
+        }
+
+        facets_reset_key(k);
+    }
+    foreach_key_in_facets_done(pk);
+
+    // move the rows of the partial to ours, keeping only the ones we need
+    while(partial->base) {
+        FACET_ROW *row = partial->base;
+        DOUBLE_LINKED_LIST_REMOVE_ITEM_UNSAFE(partial->base, row, prev, next);
+        partial->items_to_return--;
+        facets_row_merge(facets, row);
+    }
+    partial->operations.last_added = NULL;
+
+    facets->operations.first += partial->operations.first;
+    facets->operations.forwards += partial->operations.forwards;
+    facets->operations.backwards += partial->operations.backwards;
+    facets->operations.skips_before += partial->operations.skips_before;
+    facets->operations.skips_after += partial->operations.skips_after;
+    facets->operations.prepends += partial->operations.prepends;
+    facets->operations.appends += partial->operations.appends;
+    facets->operations.shifts += partial->operations.shifts;
+
+    facets->operations.rows.evaluated += partial->operations.rows.evaluated;
+    facets->operations.rows.matched += partial->operations.rows.matched;
+    facets->operations.rows.unsampled += partial->operations.rows.unsampled;
+    facets->operations.rows.estimated += partial->operations.rows.estimated;
+    facets->operations.rows.indexed += partial->operations.rows.indexed;
+    facets->operations.rows.created += partial->operations.rows.created;
+    facets->operations.rows.reused += partial->operations.rows.reused;
+
+    facets->operations.keys.registered += partial->operations.keys.registered;
+    facets->operations.keys.unique += partial->operations.keys.unique;
+    facets->operations.keys.predicted += partial->operations.keys.predicted;
+
+    facets->operations.values.registered += partial->operations.values.registered;
+    facets->operations.values.transformed += partial->operations.values.transformed;
+    facets->operations.values.dynamic += partial->operations.values.dynamic;
+    facets->operations.values.empty += partial->operations.values.empty;
+    facets->operations.values.unsampled += partial->operations.values.unsampled;
+    facets->operations.values.estimated += partial->operations.values.estimated;
+    facets->operations.values.indexed += partial->operations.values.indexed;
+    facets->operations.values.inserts += partial->operations.values.inserts;
+    facets->operations.values.conflicts += partial->operations.values.conflicts;
+
+    facets->operations.fts.searches += partial->operations.fts.searches;
+}
+
 // ----------------------------------------------------------------------------
 // output
 
@@ -2742,6 +3089,7 @@ void facets_report(FACETS *facets, BUFFER *wb, DICTIONARY *used_hashes_registry)
         buffer_json_member_add_uint64(wb, "matched", facets->operations.rows.matched);
         buffer_json_member_add_uint64(wb, "unsampled", facets->operations.rows.unsampled);
         buffer_json_member_add_uint64(wb, "estimated", facets->operations.rows.estimated);
+        buffer_json_member_add_uint64(wb, "indexed", facets->operations.rows.indexed);
         buffer_json_member_add_uint64(wb, "returned", facets->items_to_return);
         buffer_json_member_add_uint64(wb, "max_to_return", facets->max_items_to_return);
         buffer_json_member_add_uint64(wb, "before", facets->operations.skips_before);
@@ -2782,6 +3130,7 @@ void facets_report(FACETS *facets, BUFFER *wb, DICTIONARY *used_hashes_registry)
 
             buffer_json_member_add_uint64(wb, "registered", facets->operations.keys.registered);
             buffer_json_member_add_uint64(wb, "unique", facets->operations.keys.unique);
+            buffer_json_member_add_uint64(wb, "predicted", facets->operations.keys.predicted);
             buffer_json_member_add_uint64(wb, "hashtables", count);
             buffer_json_member_add_uint64(wb, "hashtable_used", used);
             buffer_json_member_add_uint64(wb, "hashtable_size", size);
@@ -2827,3 +3176,194 @@ void facets_report(FACETS *facets, BUFFER *wb, DICTIONARY *used_hashes_registry)
     }
     buffer_json_object_close(wb); // items
 }
+
+// ----------------------------------------------------------------------------
+// unittest for pre-computed counters
+//
+// The same rows are given once row by row and once as pre-computed counters
+// (as an index of an immutable file would have them). Both should end up
+// with the same facet counters and histograms.
+
+#define FACETS_UNITTEST_ROWS            2000
+#define FACETS_UNITTEST_ROW_EVERY_S     40
+#define FACETS_UNITTEST_SLOT_WIDTH_S    60
+#define FACETS_UNITTEST_SLOTS           (86400 / FACETS_UNITTEST_SLOT_WIDTH_S)
+
+struct facets_unittest_value {
+    const char *key;
+    const char *value;                  // NULL for the rows not having the key
+    uint32_t rows;
+    uint32_t per_slot[FACETS_UNITTEST_SLOTS];
+};
+
+static void facets_unittest_row_values(size_t row, char *priority, size_t priority_size, char *unit, size_t unit_size, char *message, size_t message_size) {
+    snprintfz(priority, priority_size, "%zu", row % 4);
+    snprintfz(unit, unit_size, "unit-%zu.service", (row / 2) % 3);
+    snprintfz(message, message_size, "message %zu", row);
+}
+
+static FACETS *facets_unittest_create(usec_t after_ut, usec_t before_ut) {
+    FACETS *facets = facets_create(50, 0, NULL, NULL, "MESSAGE");
+    facets_set_timeframe_and_histogram_by_name(facets, "PRIORITY", after_ut, before_ut);
+
+    // a facet that none of the rows has
+    facets_register_key_name(facets, "ABSENT", 0);
+
+    return facets;
+}
+
+static void facets_unittest_indexed_value(struct facets_unittest_value *iv, const char *key, const char *value, uint32_t slot) {
+    iv->key = key;
+    iv->value = value;
+    iv->rows++;
+    iv->per_slot[slot]++;
+}
+
+static void facets_unittest_indexed_feed(FACETS *facets, struct facets_unittest_value *iv, usec_t base_ut) {
+    FACETS_INDEXED_SLOT *slots = mallocz(FACETS_UNITTEST_SLOTS * sizeof(*slots));
+
+    size_t entries = 0;
+    for(uint32_t s = 0; s < FACETS_UNITTEST_SLOTS ;s++) {
+        if(!iv->per_slot[s])
+            continue;
+
+        slots[entries].slot = s;
+        slots[entries].rows = iv->per_slot[s];
+        entries++;
+    }
+
+    if(iv->key)
+        facets_indexed_key_value(facets, iv->key, strlen(iv->key), iv->value, iv->value ? strlen(iv->value) : 0, iv->rows,
+                                 base_ut, FACETS_UNITTEST_SLOT_WIDTH_S * USEC_PER_SEC, slots, entries);
+    else
+        facets_indexed_rows_finished(facets, iv->rows,
+                                     base_ut, FACETS_UNITTEST_SLOT_WIDTH_S * USEC_PER_SEC, slots, entries);
+
+    freez(slots);
+}
+
+static int facets_unittest_compare_key(FACETS *scanned, FACETS *indexed, const char *key) {
+    int errors = 0;
+    FACETS_HASH hash = FACETS_HASH_FUNCTION(key, strlen(key));
+    FACET_KEY *sk = FACETS_KEY_GET_FROM_INDEX(scanned, hash);
+    FACET_KEY *ik = FACETS_KEY_GET_FROM_INDEX(indexed, hash);
+
+    if(!sk || !ik || !sk->values.enabled || !ik->values.enabled) {
+        fprintf(stderr, "FACETS: key '%s' is not a facet in both cases\n", key);
+        return 1;
+    }
+
+    if(sk->values.used != ik->values.used) {
+        fprintf(stderr, "FACETS: key '%s' has %u values when scanned, but %u when indexed\n",
+                key, sk->values.used, ik->values.used);
+        errors++;
+    }
+
+    for(FACET_VALUE *sv = sk->values.ll; sv ;sv = sv->next) {
+        FACET_VALUE *iv = FACET_VALUE_GET_FROM_INDEX(ik, sv->hash);
+        if(!iv) {
+            fprintf(stderr, "FACETS: key '%s' value '%s' is missing when indexed\n", key, sv->name ? sv->name : "(empty)");
+            errors++;
+            continue;
+        }
+
+        if(sv->final_facet_value_counter != iv->final_facet_value_counter) {
+            fprintf(stderr, "FACETS: key '%s' value '%s' counted %u rows when scanned, but %u when indexed\n",
+                    key, sv->name ? sv->name : "(empty)", sv->final_facet_value_counter, iv->final_facet_value_counter);
+            errors++;
+        }
+
+        for(uint32_t s = 0; s < scanned->histogram.slots ;s++) {
+            uint32_t sn = sv->histogram ? sv->histogram[s] : 0;
+            uint32_t in = iv->histogram ? iv->histogram[s] : 0;
+            if(sn != in) {
+                fprintf(stderr, "FACETS: key '%s' value '%s' histogram slot %u has %u rows when scanned, but %u when indexed\n",
+                        key, sv->name ? sv->name : "(empty)", s, sn, in);
+                errors++;
+                break;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int facets_indexed_unittest(void) {
+    int errors = 0;
+
+    usec_t base_ut = 1700006400ULL * USEC_PER_SEC;      // midnight, so that the slots align with the histogram
+    usec_t after_ut = base_ut;
+    usec_t before_ut = base_ut + 86400 * USEC_PER_SEC - 1;
+
+    FACETS *scanned = facets_unittest_create(after_ut, before_ut);
+    FACETS *indexed = facets_unittest_create(after_ut, before_ut);
+
+    if(!facets_indexed_histogram_is_compatible(indexed, FACETS_UNITTEST_SLOT_WIDTH_S * USEC_PER_SEC)) {
+        fprintf(stderr, "FACETS: the histogram is not compatible with the indexed slots\n");
+        errors++;
+    }
+
+    // checking for a facet should not add the key to the facets
+    size_t keys = scanned->keys.count;
+    if(!facets_key_name_is_facet(scanned, "PRIORITY") || facets_key_name_is_facet(scanned, "MESSAGE") || scanned->keys.count != keys) {
+        fprintf(stderr, "FACETS: facets_key_name_is_facet() did not answer as expected, or registered the keys\n");
+        errors++;
+    }
+
+    // the values of the indexed file: 4 priorities, 3 units and the rows without a unit
+    struct facets_unittest_value *values = callocz(4 + 3 + 1 + 1, sizeof(*values));
+    struct facets_unittest_value *totals = &values[4 + 3 + 1];
+    char priorities[4][2], units[3][30];
+
+    for(size_t row = 0; row < FACETS_UNITTEST_ROWS ;row++) {
+        char priority[2], unit[30], message[30];
+        facets_unittest_row_values(row, priority, sizeof(priority), unit, sizeof(unit), message, sizeof(message));
+        usec_t ut = base_ut + row * FACETS_UNITTEST_ROW_EVERY_S * USEC_PER_SEC;
+        uint32_t slot = (ut - base_ut) / (FACETS_UNITTEST_SLOT_WIDTH_S * USEC_PER_SEC);
+
+        facets_rows_begin(scanned);
+        facets_add_key_value(scanned, "PRIORITY", priority);
+        if(row % 2 == 0)
+            facets_add_key_value(scanned, "UNIT", unit);
+        facets_add_key_value(scanned, "MESSAGE", message);
+        facets_row_finished(scanned, ut);
+
+        size_t p = row % 4, u = (row / 2) % 3;
+        strncpyz(priorities[p], priority, sizeof(priorities[p]) - 1);
+        facets_unittest_indexed_value(&values[p], "PRIORITY", priorities[p], slot);
+
+        if(row % 2 == 0) {
+            strncpyz(units[u], unit, sizeof(units[u]) - 1);
+            facets_unittest_indexed_value(&values[4 + u], "UNIT", units[u], slot);
+        }
+        else
+            facets_unittest_indexed_value(&values[4 + 3], "UNIT", NULL, slot);
+
+        facets_unittest_indexed_value(totals, NULL, NULL, slot);
+    }
+
+    for(size_t i = 0; i < 4 + 3 + 1 ;i++)
+        facets_unittest_indexed_feed(indexed, &values[i], base_ut);
+
+    // MESSAGE has too many values to be indexed
+    facets_register_key_name(indexed, "MESSAGE", 0);
+
+    facets_unittest_indexed_feed(indexed, totals, base_ut);
+
+    errors += facets_unittest_compare_key(scanned, indexed, "PRIORITY");
+    errors += facets_unittest_compare_key(scanned, indexed, "UNIT");
+    errors += facets_unittest_compare_key(scanned, indexed, "ABSENT");
+
+    if(scanned->operations.rows.matched != indexed->operations.rows.matched) {
+        fprintf(stderr, "FACETS: %zu rows matched when scanned, but %zu when indexed\n",
+                scanned->operations.rows.matched, indexed->operations.rows.matched);
+        errors++;
+    }
+
+    freez(values);
+    facets_destroy(scanned);
+    facets_destroy(indexed);
+
+    fprintf(stderr, "FACETS: indexed counters, %d errors\n", errors);
+    return errors;
+}
@@ -83,6 +83,9 @@ typedef enum __attribute__((packed)) {
 FACETS *facets_create(uint32_t items_to_return, FACETS_OPTIONS options, const char *visible_keys, const char *facet_keys, const char *non_facet_keys);
 void facets_destroy(FACETS *facets);
 
+FACETS *facets_create_partial(FACETS *facets);
+void facets_merge_partial(FACETS *facets, FACETS *partial);
+
 void facets_accepted_param(FACETS *facets, const char *param);
 
 void facets_rows_begin(FACETS *facets);
@@ -92,6 +95,19 @@ void facets_row_finished_unsampled(FACETS *facets, usec_t usec);
 void facets_update_estimations(FACETS *facets, usec_t from_ut, usec_t to_ut, size_t entries);
 size_t facets_histogram_slots(FACETS *facets);
 
+// pre-computed counters (e.g. from an index of an immutable log file)
+// slots are relative to base_ut, each one spanning slot_width_ut
+typedef struct facets_indexed_slot {
+    uint32_t slot;
+    uint32_t rows;
+} FACETS_INDEXED_SLOT;
+
+bool facets_indexed_histogram_is_compatible(FACETS *facets, usec_t slot_width_ut);
+void facets_indexed_key_value(FACETS *facets, const char *key, size_t key_len, const char *value, size_t value_len, uint32_t rows,
+                              usec_t base_ut, usec_t slot_width_ut, const FACETS_INDEXED_SLOT *slots, size_t entries);
+void facets_indexed_rows_finished(FACETS *facets, size_t rows,
+                                  usec_t base_ut, usec_t slot_width_ut, const FACETS_INDEXED_SLOT *slots, size_t entries);
+
 FACET_KEY *facets_register_key_name(FACETS *facets, const char *key, FACET_KEY_OPTIONS options);
 void facets_set_query(FACETS *facets, const char *query);
 void facets_set_items(FACETS *facets, uint32_t items);
@@ -132,4 +148,6 @@ void facets_table_config(BUFFER *wb);
 
 const char *facets_severity_to_string(FACET_ROW_SEVERITY severity);
 
+int facets_indexed_unittest(void);
+
 #endif
@@ -134,6 +134,14 @@ typedef uint32_t uid_t;
 #include <poll.h>
 #endif
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
+#ifdef HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
+
 #ifdef HAVE_SYSLOG_H
 #include <syslog.h>
 #else
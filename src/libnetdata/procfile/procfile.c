@@ -8,6 +8,12 @@
 #define PFLINES_INCREASE_STEP 200
 #define PROCFILE_INCREMENT_BUFFER 4096
 
+// internal: the file does not support pread(), use read() and lseek()
+#define PROCFILE_FLAG_NO_PREAD 0x80000000
+
+// internal: the fd belongs to the caller of procfile_readall_fd(), never close it
+#define PROCFILE_FLAG_BORROWED_FD 0x40000000
+
 int procfile_open_flags = O_RDONLY | O_CLOEXEC;
 
 int procfile_adaptive_initial_allocation = 0;
@@ -138,6 +144,128 @@ static inline void procfile_lines_free(pflines *fl) {
 }
 
 
+// ----------------------------------------------------------------------------
+// The layout of the last parse
+
+static inline void procfile_layout_invalidate(procfile *ff) {
+    if(ff->layout)
+        ff->layout->valid = false;
+}
+
+static inline void procfile_layout_free(pflayout *fo) {
+    if(!fo) return;
+
+    freez(fo->types);
+    freez(fo->ends);
+    freez(fo);
+}
+
+static inline void procfile_layout_ends_add(pflayout *fo, size_t offset) {
+    if(unlikely(fo->ends_len == fo->ends_size)) {
+        fo->ends_size = fo->ends_size ? fo->ends_size * 2 : PFWORDS_INCREASE_STEP;
+        fo->ends = reallocz(fo->ends, fo->ends_size * sizeof(*fo->ends));
+    }
+
+    fo->ends[fo->ends_len++] = (uint32_t)offset;
+}
+
+// the layout can be reused only when the parser uses just separators and newlines
+static inline bool procfile_layout_supported(procfile *ff) {
+    if(unlikely(ff->len > UINT32_MAX))
+        return false;
+
+    PF_CHAR_TYPE *ffs = ff->separators;
+    for(size_t i = 0; i < 256 ;i++) {
+        if(unlikely(ffs[i] == PF_CHAR_IS_QUOTE || ffs[i] == PF_CHAR_IS_OPEN || ffs[i] == PF_CHAR_IS_CLOSE))
+            return false;
+    }
+
+    return true;
+}
+
+// remember the type of every character and where the parser will terminate words
+// this has to run before procfile_parser(), which modifies the data
+static void procfile_layout_capture(procfile *ff) {
+    pflayout *fo = ff->layout;
+    if(!fo)
+        fo = ff->layout = callocz(1, sizeof(pflayout));
+
+    fo->valid = false;
+    fo->reparsed++;
+
+    if(!procfile_layout_supported(ff))
+        return;
+
+    if(unlikely(fo->types_size < ff->len)) {
+        freez(fo->types);
+        fo->types_size = ff->len;
+        fo->types = mallocz(fo->types_size * sizeof(PF_CHAR_TYPE));
+    }
+
+    PF_CHAR_TYPE *separators = ff->separators;
+    PF_CHAR_TYPE *types = fo->types;
+    const unsigned char *s = (const unsigned char *)ff->data;
+    PF_CHAR_TYPE last = PF_CHAR_IS_SEPARATOR;
+
+    fo->ends_len = 0;
+    for(size_t i = 0; i < ff->len ;i++) {
+        PF_CHAR_TYPE ct = types[i] = separators[s[i]];
+
+        // the same decisions procfile_parser() makes, when there are no quotes or parenthesis
+        if(ct == PF_CHAR_IS_NEWLINE || (ct == PF_CHAR_IS_SEPARATOR && last == PF_CHAR_IS_WORD))
+            procfile_layout_ends_add(fo, i);
+
+        last = ct;
+    }
+
+    if(ff->len && last == PF_CHAR_IS_WORD)
+        procfile_layout_ends_add(fo, (ff->len >= ff->size) ? ff->size - 1 : ff->len);
+
+    fo->data = ff->data;
+    fo->len = ff->len;
+    fo->valid = true;
+}
+
+// check if the data just read have the same layout with the last parse
+static bool procfile_layout_matches(procfile *ff) {
+    pflayout *fo = ff->layout;
+
+    if(!fo || !fo->valid || fo->data != ff->data || fo->len != ff->len)
+        return false;
+
+    PF_CHAR_TYPE *separators = ff->separators;
+    PF_CHAR_TYPE *types = fo->types;
+    const unsigned char *s = (const unsigned char *)ff->data;
+    size_t len = ff->len;
+
+    // compare in blocks without branches, stop at the first block that differs
+    size_t i = 0;
+    while(i < len) {
+        size_t end = (len - i > 64) ? i + 64 : len;
+        unsigned diff = 0;
+
+        for(; i < end ;i++)
+            diff |= (unsigned)(separators[s[i]] ^ types[i]);
+
+        if(diff)
+            return false;
+    }
+
+    return true;
+}
+
+// the words and lines of the last parse are still valid, terminate the words again
+static void procfile_layout_apply(procfile *ff) {
+    pflayout *fo = ff->layout;
+    uint32_t *ends = fo->ends, *end = &fo->ends[fo->ends_len];
+    char *data = ff->data;
+
+    while(ends < end)
+        data[*ends++] = '\0';
+
+    fo->reused++;
+}
+
 // ----------------------------------------------------------------------------
 // The procfile
 
@@ -149,8 +277,9 @@ void procfile_close(procfile *ff) {
     freez(ff->filename);
     procfile_lines_free(ff->lines);
     procfile_words_free(ff->words);
+    procfile_layout_free(ff->layout);
 
-    if(likely(ff->fd != -1)) close(ff->fd);
+    if(likely(ff->fd != -1 && !(ff->flags & PROCFILE_FLAG_BORROWED_FD))) close(ff->fd);
     freez(ff);
 }
 
@@ -294,7 +423,17 @@ procfile *procfile_readall(procfile *ff) {
         }
 
         netdata_log_debug(D_PROCFILE, "Reading file '%s', from position %zd with length %zd", procfile_filename(ff), s, (ssize_t)(ff->size - s));
-        r = read(ff->fd, &ff->data[s], ff->size - s);
+        if(likely(!(ff->flags & PROCFILE_FLAG_NO_PREAD))) {
+            // pread() saves us the lseek() to rewind the file
+            r = pread(ff->fd, &ff->data[s], ff->size - s, (off_t)s);
+            if(unlikely(r == -1 && errno == ESPIPE && !s)) {
+                ff->flags |= PROCFILE_FLAG_NO_PREAD;
+                r = read(ff->fd, &ff->data[s], ff->size - s);
+            }
+        }
+        else
+            r = read(ff->fd, &ff->data[s], ff->size - s);
+
         if(unlikely(r == -1)) {
             if(unlikely(!(ff->flags & PROCFILE_FLAG_NO_ERROR_ON_FILE_IO))) collector_error(PF_PREFIX ": Cannot read from file '%s' on fd %d", procfile_filename(ff), ff->fd);
             else if(unlikely(ff->flags & PROCFILE_FLAG_ERROR_ON_ERROR_LOG))
@@ -307,7 +446,7 @@ procfile *procfile_readall(procfile *ff) {
     }
 
     // netdata_log_debug(D_PROCFILE, "Rewinding file '%s'", ff->filename);
-    if(unlikely(lseek(ff->fd, 0, SEEK_SET) == -1)) {
+    if(unlikely((ff->flags & PROCFILE_FLAG_NO_PREAD) && lseek(ff->fd, 0, SEEK_SET) == -1)) {
         if(unlikely(!(ff->flags & PROCFILE_FLAG_NO_ERROR_ON_FILE_IO))) collector_error(PF_PREFIX ": Cannot rewind on file '%s'.", procfile_filename(ff));
         else if(unlikely(ff->flags & PROCFILE_FLAG_ERROR_ON_ERROR_LOG))
             netdata_log_error(PF_PREFIX ": Cannot rewind on file '%s'.", procfile_filename(ff));
@@ -315,6 +454,15 @@ procfile *procfile_readall(procfile *ff) {
         return NULL;
     }
 
+    if(ff->flags & PROCFILE_FLAG_INCREMENTAL) {
+        if(likely(procfile_layout_matches(ff))) {
+            procfile_layout_apply(ff);
+            return ff;
+        }
+
+        procfile_layout_capture(ff);
+    }
+
     procfile_lines_reset(ff->lines);
     procfile_words_reset(ff->words);
     procfile_parser(ff);
@@ -350,6 +498,8 @@ static void procfile_set_separators(procfile *ff, const char *separators) {
     if(unlikely(!separators))
         separators = " \t=|";
 
+    procfile_layout_invalidate(ff);
+
     // copy the default
     memcpy(ff->separators, procfile_default_separators, 256 * sizeof(PF_CHAR_TYPE));
 
@@ -360,6 +510,8 @@ static void procfile_set_separators(procfile *ff, const char *separators) {
 }
 
 void procfile_set_quotes(procfile *ff, const char *quotes) {
+    procfile_layout_invalidate(ff);
+
     PF_CHAR_TYPE *ffs = ff->separators;
 
     // remove all quotes
@@ -379,6 +531,8 @@ void procfile_set_quotes(procfile *ff, const char *quotes) {
 }
 
 void procfile_set_open_close(procfile *ff, const char *open, const char *close) {
+    procfile_layout_invalidate(ff);
+
     PF_CHAR_TYPE *ffs = ff->separators;
 
     // remove all open/close
@@ -402,6 +556,26 @@ void procfile_set_open_close(procfile *ff, const char *open, const char *close)
         ffs[(int)*s++] = PF_CHAR_IS_CLOSE;
 }
 
+static procfile *procfile_create(int fd, const char *separators, uint32_t flags) {
+    size_t size = (unlikely(procfile_adaptive_initial_allocation)) ? procfile_max_allocation : PROCFILE_INCREMENT_BUFFER;
+    procfile *ff = mallocz(sizeof(procfile) + size);
+
+    //strncpyz(ff->filename, filename, FILENAME_MAX);
+    ff->filename = NULL;
+    ff->fd = fd;
+    ff->size = size;
+    ff->len = 0;
+    ff->flags = flags;
+
+    ff->lines = procfile_lines_create();
+    ff->words = procfile_words_create();
+    ff->layout = NULL;
+
+    procfile_set_separators(ff, separators);
+
+    return ff;
+}
+
 procfile *procfile_open(const char *filename, const char *separators, uint32_t flags) {
     netdata_log_debug(D_PROCFILE, PF_PREFIX ": Opening file '%s'", filename);
 
@@ -420,22 +594,30 @@ procfile *procfile_open(const char *filename, const char *separators, uint32_t f
 
     // netdata_log_info("PROCFILE: opened '%s' on fd %d", filename, fd);
 
-    size_t size = (unlikely(procfile_adaptive_initial_allocation)) ? procfile_max_allocation : PROCFILE_INCREMENT_BUFFER;
-    procfile *ff = mallocz(sizeof(procfile) + size);
+    procfile *ff = procfile_create(fd, separators, flags);
 
-    //strncpyz(ff->filename, filename, FILENAME_MAX);
-    ff->filename = NULL;
-    ff->fd = fd;
-    ff->size = size;
-    ff->len = 0;
-    ff->flags = flags;
+    netdata_log_debug(D_PROCFILE, "File '%s' opened.", filename);
+    return ff;
+}
 
-    ff->lines = procfile_lines_create();
-    ff->words = procfile_words_create();
+// Parse a file that the caller keeps open, re-reading it from the beginning.
+// The same procfile can be given any number of such files in turn, so that
+// they all share the same parsing buffers. The separators and the flags are
+// applied only when ff is NULL and a new procfile is allocated.
+// The fd is never closed by procfile. On failure, NULL is returned (ff is freed)
+// and the caller should decide what to do with its fd.
+procfile *procfile_readall_fd(procfile *ff, int fd, const char *separators, uint32_t flags) {
+    if(unlikely(!ff))
+        // layouts are kept per file, they cannot be reused across files
+        ff = procfile_create(-1, separators, (flags & ~PROCFILE_FLAG_INCREMENTAL) | PROCFILE_FLAG_BORROWED_FD);
 
-    procfile_set_separators(ff, separators);
+    ff->fd = fd;
+    ff->flags &= ~PROCFILE_FLAG_NO_PREAD;
+
+    ff = procfile_readall(ff);
+    if(likely(ff))
+        ff->fd = -1;
 
-    netdata_log_debug(D_PROCFILE, "File '%s' opened.", filename);
     return ff;
 }
 
@@ -459,6 +641,7 @@ procfile *procfile_reopen(procfile *ff, const char *filename, const char *separa
     freez(ff->filename);
     ff->filename = NULL;
     ff->flags = flags;
+    procfile_layout_invalidate(ff);
 
     // do not do the separators again if NULL is given
     if(likely(separators)) procfile_set_separators(ff, separators);
@@ -488,3 +671,209 @@ void procfile_print(procfile *ff) {
         }
     }
 }
+
+// ----------------------------------------------------------------------------
+// unittest
+
+static int procfile_unittest_compare(procfile *full, procfile *incremental, const char *step) {
+    int errors = 0;
+
+    if(procfile_lines(full) != procfile_lines(incremental)) {
+        fprintf(stderr, "PROCFILE: %s: full parse has %zu lines, incremental has %zu\n",
+                step, procfile_lines(full), procfile_lines(incremental));
+        return 1;
+    }
+
+    for(size_t l = 0; l < procfile_lines(full) ;l++) {
+        size_t words = procfile_linewords(full, l);
+        if(words != procfile_linewords(incremental, l)) {
+            fprintf(stderr, "PROCFILE: %s: line %zu has %zu words on full parse, %zu on incremental\n",
+                    step, l, words, procfile_linewords(incremental, l));
+            errors++;
+            continue;
+        }
+
+        for(size_t w = 0; w < words ;w++) {
+            if(strcmp(procfile_lineword(full, l, w), procfile_lineword(incremental, l, w)) != 0) {
+                fprintf(stderr, "PROCFILE: %s: line %zu word %zu is '%s' on full parse, '%s' on incremental\n",
+                        step, l, w, procfile_lineword(full, l, w), procfile_lineword(incremental, l, w));
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+int procfile_unittest(void) {
+    static const struct {
+        const char *step;
+        const char *contents;
+        bool reused;
+    } steps[] = {
+        { "initial",           "cpu  10 20 30\ncpu0 1 2 3\nintr 100 0 0\n", false },
+        { "same layout",       "cpu  11 22 33\ncpu0 4 5 6\nintr 101 9 9\n", true  },
+        { "value grew",        "cpu  110 22 33\ncpu0 4 5 6\nintr 101 9 9\n", false },
+        { "same again",        "cpu  111 23 34\ncpu0 5 6 7\nintr 102 8 8\n", true  },
+        { "separator moved",   "cpu  111 23 34\ncpu0 5 6 7\nintr 1028 8\n", false },
+        { "no final newline",  "cpu  1 2 3\ncpu0 4 5 6\nintr 7 8 9", false },
+        { "no final newline 2","cpu  9 8 7\ncpu0 6 5 4\nintr 3 2 1", true  },
+        { "new line",          "cpu  9 8 7\ncpu0 6 5 4\ncpu1 6 5 4\nintr 3 2 1", false },
+        { "empty",             "", false },
+        { "empty again",       "", true  },
+        { "separators only",   " \t: \n\n:", false },
+        { "final",             "cpu  10 20 30\ncpu0 1 2 3\nintr 100 0 0\n", false },
+    };
+
+    char filename[FILENAME_MAX + 1];
+    snprintfz(filename, FILENAME_MAX, "/tmp/netdata-procfile-unittest-XXXXXX");
+    int fd = mkstemp(filename);
+    if(fd == -1) {
+        fprintf(stderr, "PROCFILE: cannot create temporary file '%s'\n", filename);
+        return 1;
+    }
+
+    int errors = 0;
+    procfile *full = procfile_open(filename, " \t:", PROCFILE_FLAG_DEFAULT);
+    procfile *incremental = procfile_open(filename, " \t:", PROCFILE_FLAG_INCREMENTAL);
+    procfile *borrowed = NULL;
+    if(!full || !incremental) {
+        fprintf(stderr, "PROCFILE: cannot open temporary file '%s'\n", filename);
+        errors++;
+        goto cleanup;
+    }
+
+    for(size_t i = 0; i < sizeof(steps) / sizeof(steps[0]) ;i++) {
+        size_t len = strlen(steps[i].contents);
+        if(ftruncate(fd, 0) != 0 || pwrite(fd, steps[i].contents, len, 0) != (ssize_t)len) {
+            fprintf(stderr, "PROCFILE: cannot write temporary file '%s'\n", filename);
+            errors++;
+            goto cleanup;
+        }
+
+        size_t reused = incremental->layout ? incremental->layout->reused : 0;
+
+        full = procfile_readall(full);
+        incremental = procfile_readall(incremental);
+        if(!full || !incremental) {
+            fprintf(stderr, "PROCFILE: %s: cannot read temporary file '%s'\n", steps[i].step, filename);
+            errors++;
+            goto cleanup;
+        }
+
+        errors += procfile_unittest_compare(full, incremental, steps[i].step);
+
+        // the same file, through a descriptor we own
+        borrowed = procfile_readall_fd(borrowed, fd, " \t:", PROCFILE_FLAG_DEFAULT);
+        if(!borrowed || fcntl(fd, F_GETFD) == -1) {
+            fprintf(stderr, "PROCFILE: %s: cannot read borrowed fd of temporary file '%s'\n", steps[i].step, filename);
+            errors++;
+            goto cleanup;
+        }
+        errors += procfile_unittest_compare(full, borrowed, steps[i].step);
+
+        bool was_reused = incremental->layout && incremental->layout->reused != reused;
+        if(was_reused != steps[i].reused) {
+            fprintf(stderr, "PROCFILE: %s: expected the layout to be %s, but it was %s\n",
+                    steps[i].step, steps[i].reused ? "reused" : "parsed", was_reused ? "reused" : "parsed");
+            errors++;
+        }
+    }
+
+cleanup:
+    procfile_close(full);
+    procfile_close(incremental);
+    procfile_close(borrowed);
+    close(fd);
+    unlink(filename);
+
+    fprintf(stderr, "PROCFILE: %d errors\n", errors);
+    return errors ? 1 : 0;
+}
+
+// ----------------------------------------------------------------------------
+// benchmark
+//
+// reads every file of snapshots_dir (or a few large /proc files, when it is NULL)
+// repeatedly, with and without PROCFILE_FLAG_INCREMENTAL.
+// Snapshots can be captured with e.g. `cp /proc/interrupts /proc/softirqs /proc/stat DIR/`
+
+#define PROCFILE_BENCHMARK_USEC (1 * USEC_PER_SEC)
+
+static void procfile_benchmark_file(const char *filename) {
+    usec_t per_read_ut[2] = { 0, 0 };
+    size_t reused = 0, reads = 0, bytes = 0;
+
+    for(int incremental = 0; incremental < 2 ;incremental++) {
+        procfile *ff = procfile_open(filename, " \t:", incremental ? PROCFILE_FLAG_INCREMENTAL : PROCFILE_FLAG_DEFAULT);
+        if(!ff) {
+            fprintf(stderr, "PROCFILE: cannot open '%s'\n", filename);
+            return;
+        }
+
+        size_t count = 0;
+        usec_t started_ut = now_monotonic_usec(), ended_ut;
+        do {
+            for(size_t i = 0; i < 100 && ff ;i++, count++)
+                ff = procfile_readall(ff);
+
+            ended_ut = now_monotonic_usec();
+        } while(ff && ended_ut - started_ut < PROCFILE_BENCHMARK_USEC);
+
+        if(!ff) {
+            fprintf(stderr, "PROCFILE: cannot read '%s'\n", filename);
+            return;
+        }
+
+        per_read_ut[incremental] = (ended_ut - started_ut) * 1000 / count;
+        bytes = ff->len;
+
+        if(incremental && ff->layout) {
+            reused = ff->layout->reused;
+            reads = ff->layout->reused + ff->layout->reparsed;
+        }
+
+        procfile_close(ff);
+    }
+
+    fprintf(stderr, "%-40s %10zu bytes, full: %8.2f us/read, incremental: %8.2f us/read (layout reused %5.1f%%)\n",
+            filename, bytes,
+            (double)per_read_ut[0] / 1000.0, (double)per_read_ut[1] / 1000.0,
+            reads ? (double)reused * 100.0 / (double)reads : 0.0);
+}
+
+int procfile_benchmark(const char *snapshots_dir) {
+    static const char *proc_files[] = {
+        "/proc/stat",
+        "/proc/interrupts",
+        "/proc/softirqs",
+        "/proc/net/dev",
+        "/proc/diskstats",
+    };
+
+    if(!snapshots_dir) {
+        for(size_t i = 0; i < sizeof(proc_files) / sizeof(proc_files[0]) ;i++)
+            procfile_benchmark_file(proc_files[i]);
+
+        return 0;
+    }
+
+    DIR *dir = opendir(snapshots_dir);
+    if(!dir) {
+        fprintf(stderr, "PROCFILE: cannot open directory '%s'\n", snapshots_dir);
+        return 1;
+    }
+
+    struct dirent *de;
+    while((de = readdir(dir))) {
+        if(de->d_type != DT_REG)
+            continue;
+
+        char filename[FILENAME_MAX + 1];
+        snprintfz(filename, FILENAME_MAX, "%s/%s", snapshots_dir, de->d_name);
+        procfile_benchmark_file(filename);
+    }
+
+    closedir(dir);
+    return 0;
+}
@@ -37,6 +37,7 @@ typedef struct {
 #define PROCFILE_FLAG_DEFAULT             0x00000000 // To store inside `collector.log`
 #define PROCFILE_FLAG_NO_ERROR_ON_FILE_IO 0x00000001 // Do not store nothing
 #define PROCFILE_FLAG_ERROR_ON_ERROR_LOG  0x00000002 // Store inside `error.log`
+#define PROCFILE_FLAG_INCREMENTAL         0x00000004 // Re-tokenize only when the layout of the file changes
 
 typedef enum __attribute__ ((__packed__)) procfile_separator {
     PF_CHAR_IS_SEPARATOR,
@@ -47,6 +48,27 @@ typedef enum __attribute__ ((__packed__)) procfile_separator {
     PF_CHAR_IS_CLOSE
 } PF_CHAR_TYPE;
 
+// ----------------------------------------------------------------------------
+// The layout of the last parse (PROCFILE_FLAG_INCREMENTAL)
+//
+// When a file is read again and every character has the same type as before
+// (only the values changed, but not their width, or the number of lines and
+// words), the lines and words of the last parse are still valid, and only the
+// word terminators need to be placed again.
+
+typedef struct {
+    bool valid;
+    char *data;                     // the data the words of the last parse point to
+    size_t len;                     // the length of the data of the last parse
+    PF_CHAR_TYPE *types;            // the type of each character of the last parse
+    size_t types_size;
+    uint32_t *ends;                 // the offsets the parser terminated with '\0'
+    size_t ends_len;
+    size_t ends_size;
+    size_t reused;                  // statistics: how many times the layout matched
+    size_t reparsed;                // statistics: how many times the data had to be parsed
+} pflayout;
+
 typedef struct procfile {
     char *filename;                 // not populated until procfile_filename() is called
     uint32_t flags;
@@ -55,6 +77,7 @@ typedef struct procfile {
     size_t size;                    // the bytes we have allocated for data
     pflines *lines;
     pfwords *words;
+    pflayout *layout;               // only with PROCFILE_FLAG_INCREMENTAL
     PF_CHAR_TYPE separators[256];
     char data[];                    // allocated buffer to keep file contents
 } procfile;
@@ -72,6 +95,9 @@ procfile *procfile_open(const char *filename, const char *separators, uint32_t f
 // if separators == NULL, the last separators are used
 procfile *procfile_reopen(procfile *ff, const char *filename, const char *separators, uint32_t flags);
 
+// parse a file kept open by the caller, sharing the buffers of ff among many files
+procfile *procfile_readall_fd(procfile *ff, int fd, const char *separators, uint32_t flags);
+
 // example walk-through a procfile parsed file
 void procfile_print(procfile *ff);
 
@@ -80,6 +106,9 @@ void procfile_set_open_close(procfile *ff, const char *open, const char *close);
 
 char *procfile_filename(procfile *ff);
 
+int procfile_unittest(void);
+int procfile_benchmark(const char *snapshots_dir);
+
 // ----------------------------------------------------------------------------
 
 // set to the O_XXXX flags, to have procfile_open and procfile_reopen use them when opening proc files
@@ -1478,12 +1478,111 @@ int accept_socket(int fd, int flags, char *client_ip, size_t ipsize, char *clien
 
 
 // --------------------------------------------------------------------------------------------------------------------
-// poll() based listener
-// this should be the fastest possible listener for up to 100 sockets
-// above 100, an epoll() interface is needed on Linux
+// poll() or epoll() based listener
+// poll() should be the fastest possible listener for up to 100 sockets
+// above 100, epoll() is used on Linux, so that each wakeup costs the sockets that have events, not all of them
 
 #define POLL_FDS_INCREASE_STEP 10
 
+#ifdef HAVE_SYS_EPOLL_H
+bool poll_events_use_epoll = true;
+#else
+bool poll_events_use_epoll = false;
+#endif
+
+#define POLL_EPOLL_UNREGISTERED (-1)
+#define POLL_EPOLL_ALWAYS_READY (-2)
+#define POLL_EPOLL_MAX_EVENTS   1024
+
+#ifdef HAVE_SYS_EPOLL_H
+static inline uint32_t poll_events_to_epoll(short int events) {
+    uint32_t e = 0;
+    if(events & POLLIN)  e |= EPOLLIN;
+    if(events & POLLPRI) e |= EPOLLPRI;
+    if(events & POLLOUT) e |= EPOLLOUT;
+    return e;
+}
+
+static inline short int epoll_events_to_poll(uint32_t e) {
+    short int events = 0;
+    if(e & EPOLLIN)  events |= POLLIN;
+    if(e & EPOLLPRI) events |= POLLPRI;
+    if(e & EPOLLOUT) events |= POLLOUT;
+    if(e & EPOLLERR) events |= POLLERR;
+    if(e & EPOLLHUP) events |= POLLHUP;
+    return events;
+}
+
+static void poll_epoll_always_ready_del(POLLJOB *p, size_t slot) {
+    for(size_t i = 0; i < p->always_ready_used ;i++) {
+        if(p->always_ready[i] == slot) {
+            p->always_ready[i] = p->always_ready[--p->always_ready_used];
+            return;
+        }
+    }
+}
+
+// bring the epoll set in sync with the events wanted for a slot
+// epoll is level-triggered: the callbacks are not required to drain their sockets
+static void poll_epoll_sync_slot(POLLJOB *p, size_t slot) {
+    struct pollfd *pf = &p->fds[slot];
+    short int registered = p->epoll_registered[slot];
+
+    if(pf->fd == -1 || registered == POLL_EPOLL_ALWAYS_READY)
+        return;
+
+    short int wanted = (short int)(pf->events & (POLLIN | POLLPRI | POLLOUT));
+    if(registered == wanted)
+        return;
+
+    int op = (registered == POLL_EPOLL_UNREGISTERED) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    struct epoll_event ev = {
+            .events = poll_events_to_epoll(wanted),
+            .data.u64 = slot,
+    };
+
+    if(epoll_ctl(p->epoll_fd, op, pf->fd, &ev) == -1) {
+        if(op == EPOLL_CTL_ADD && errno == EPERM) {
+            // regular files cannot be watched by epoll
+            if(p->always_ready_used == p->always_ready_size) {
+                p->always_ready_size = p->always_ready_size ? p->always_ready_size * 2 : POLL_FDS_INCREASE_STEP;
+                p->always_ready = reallocz(p->always_ready, sizeof(size_t) * p->always_ready_size);
+            }
+            p->always_ready[p->always_ready_used++] = slot;
+            p->epoll_registered[slot] = POLL_EPOLL_ALWAYS_READY;
+        }
+        else
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "POLLFD: epoll_ctl() failed for socket %d at slot %zu",
+                   pf->fd, slot);
+
+        return;
+    }
+
+    p->epoll_registered[slot] = wanted;
+}
+
+static void poll_epoll_del_slot(POLLJOB *p, size_t slot) {
+    short int registered = p->epoll_registered[slot];
+
+    if(registered == POLL_EPOLL_ALWAYS_READY)
+        poll_epoll_always_ready_del(p, slot);
+
+    else if(registered != POLL_EPOLL_UNREGISTERED) {
+        struct epoll_event ev = { 0 };
+        if(epoll_ctl(p->epoll_fd, EPOLL_CTL_DEL, p->fds[slot].fd, &ev) == -1)
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "POLLFD: epoll_ctl() failed to remove socket %d at slot %zu",
+                   p->fds[slot].fd, slot);
+    }
+
+    p->epoll_registered[slot] = POLL_EPOLL_UNREGISTERED;
+}
+#else
+static inline void poll_epoll_sync_slot(POLLJOB *p __maybe_unused, size_t slot __maybe_unused) { ; }
+static inline void poll_epoll_del_slot(POLLJOB *p __maybe_unused, size_t slot __maybe_unused) { ; }
+#endif
+
 inline POLLINFO *poll_add_fd(POLLJOB *p
                              , int fd
                              , int socktype
@@ -1511,6 +1610,7 @@ inline POLLINFO *poll_add_fd(POLLJOB *p
 
         p->fds = reallocz(p->fds, sizeof(struct pollfd) * new_slots);
         p->inf = reallocz(p->inf, sizeof(POLLINFO) * new_slots);
+        p->epoll_registered = reallocz(p->epoll_registered, sizeof(short int) * new_slots);
 
         // reset all the newly added slots
         ssize_t i;
@@ -1519,6 +1619,8 @@ inline POLLINFO *poll_add_fd(POLLJOB *p
             p->fds[i].events = 0;
             p->fds[i].revents = 0;
 
+            p->epoll_registered[i] = POLL_EPOLL_UNREGISTERED;
+
             p->inf[i].p = p;
             p->inf[i].slot = (size_t)i;
             p->inf[i].flags = 0;
@@ -1583,9 +1685,22 @@ inline POLLINFO *poll_add_fd(POLLJOB *p
         p->min = pi->slot;
     }
 
+    if(p->epoll_fd != -1)
+        poll_epoll_sync_slot(p, pi->slot);
+
     return pi;
 }
 
+// for callbacks that need events on another socket of the same POLLJOB
+void poll_fd_events_add(POLLINFO *pi, short int events) {
+    POLLJOB *p = pi->p;
+
+    p->fds[pi->slot].events |= events;
+
+    if(p->epoll_fd != -1)
+        poll_epoll_sync_slot(p, pi->slot);
+}
+
 inline void poll_close_fd(POLLINFO *pi) {
     POLLJOB *p = pi->p;
 
@@ -1593,6 +1708,9 @@ inline void poll_close_fd(POLLINFO *pi) {
 
     if(unlikely(pf->fd == -1)) return;
 
+    if(p->epoll_fd != -1)
+        poll_epoll_del_slot(p, pi->slot);
+
     if(pi->flags & POLLINFO_FLAG_CLIENT_SOCKET) {
         pi->del_callback(pi);
 
@@ -1707,8 +1825,13 @@ static void poll_events_cleanup(void *pptr) {
         poll_close_fd(pi);
     }
 
+    if(p->epoll_fd != -1)
+        close(p->epoll_fd);
+
     freez(p->fds);
     freez(p->inf);
+    freez(p->epoll_registered);
+    freez(p->always_ready);
 }
 
 static int poll_process_error(POLLINFO *pi, struct pollfd *pf, short int revents) {
@@ -1896,6 +2019,12 @@ void poll_events(LISTEN_SOCKETS *sockets
             .inf = NULL,
             .first_free = NULL,
 
+            .epoll_fd = -1,
+            .epoll_registered = NULL,
+            .always_ready = NULL,
+            .always_ready_used = 0,
+            .always_ready_size = 0,
+
             .complete_request_timeout = tcp_request_timeout_seconds,
             .idle_timeout = tcp_idle_timeout_seconds,
             .checks_every = (tcp_idle_timeout_seconds / 3) + 1,
@@ -1913,6 +2042,18 @@ void poll_events(LISTEN_SOCKETS *sockets
             .tmr_callback = tmr_callback?tmr_callback:poll_default_tmr_callback
     };
 
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event *epoll_events = NULL;
+    if(poll_events_use_epoll) {
+        p.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if(p.epoll_fd == -1)
+            nd_log(NDLS_DAEMON, NDLP_ERR,
+                   "POLLFD: LISTENER: epoll_create1() failed, falling back to poll()");
+        else
+            epoll_events = mallocz(sizeof(struct epoll_event) * POLL_EPOLL_MAX_EVENTS);
+    }
+#endif
+
     size_t i;
     for(i = 0; i < sockets->opened ;i++) {
 
@@ -1975,17 +2116,55 @@ void poll_events(LISTEN_SOCKETS *sockets
             for (i = 0; i <= p.max; i++) {
                 if(p.inf[i].flags & POLLINFO_FLAG_SERVER_SOCKET && p.inf[i].socktype == SOCK_STREAM) {
                     p.fds[i].events = (short int) ((listen_sockets_active) ? POLLIN : 0);
+
+                    if(p.epoll_fd != -1)
+                        poll_epoll_sync_slot(&p, i);
                 }
             }
         }
 
+        // with epoll(), the slots that have events
+        size_t ready_max = 0;
+        size_t *ready = NULL;
+
+#ifdef HAVE_SYS_EPOLL_H
+        if(p.epoll_fd != -1) {
+            retval = epoll_wait(p.epoll_fd, epoll_events, POLL_EPOLL_MAX_EVENTS,
+                                p.always_ready_used ? 0 : ND_CHECK_CANCELLABILITY_WHILE_WAITING_EVERY_MS);
+
+            if(retval != -1) {
+                ready = mallocz(sizeof(size_t) * (retval + p.always_ready_used + 1));
+
+                for(int e = 0; e < retval ;e++) {
+                    size_t slot = (size_t)epoll_events[e].data.u64;
+                    if(slot > p.max || p.fds[slot].fd == -1)
+                        continue;
+
+                    p.fds[slot].revents = epoll_events_to_poll(epoll_events[e].events);
+                    ready[ready_max++] = slot;
+                }
+
+                // files are always ready, for the events wanted
+                for(size_t a = 0; a < p.always_ready_used ;a++) {
+                    size_t slot = p.always_ready[a];
+                    p.fds[slot].revents = (short int)(p.fds[slot].events & (POLLIN | POLLOUT));
+                    if(p.fds[slot].revents)
+                        ready[ready_max++] = slot;
+                }
+
+                retval = (int)ready_max;
+            }
+        }
+        else
+#endif
         retval = poll(p.fds, p.max + 1, ND_CHECK_CANCELLABILITY_WHILE_WAITING_EVERY_MS);
+
         time_t now = now_boottime_sec();
 
         if(unlikely(retval == -1)) {
             nd_log(NDLS_DAEMON, NDLP_ERR,
-                   "POLLFD: LISTENER: poll() failed while waiting on %zu sockets.",
-                   p.max + 1);
+                   "POLLFD: LISTENER: %s() failed while waiting on %zu sockets.",
+                   p.epoll_fd != -1 ? "epoll_wait" : "poll", p.max + 1);
 
             break;
         }
@@ -1999,14 +2178,18 @@ void poll_events(LISTEN_SOCKETS *sockets
             size_t idx, processed = 0;
             short int revents;
 
+            // poll() reports events on the slots 0 to max, epoll() on the ready ones
+            size_t candidates = ready ? ready_max : p.max + 1;
+
             // keep fast lookup arrays per function
             // to avoid looping through the entire list every time
-            size_t sends[p.max + 1], sends_max = 0;
-            size_t reads[p.max + 1], reads_max = 0;
-            size_t conns[p.max + 1], conns_max = 0;
-            size_t udprd[p.max + 1], udprd_max = 0;
+            size_t sends[candidates], sends_max = 0;
+            size_t reads[candidates], reads_max = 0;
+            size_t conns[candidates], conns_max = 0;
+            size_t udprd[candidates], udprd_max = 0;
 
-            for (i = 0; i <= p.max; i++) {
+            for (size_t c = 0; c < candidates; c++) {
+                i = ready ? ready[c] : c;
                 pi = &p.inf[i];
                 pf = &p.fds[i];
                 revents = pf->revents;
@@ -2116,6 +2299,14 @@ void poll_events(LISTEN_SOCKETS *sockets
             }
         }
 
+        if(ready) {
+            // the callbacks have set the events they want next
+            for(size_t c = 0; c < ready_max ;c++)
+                poll_epoll_sync_slot(&p, ready[c]);
+
+            freez(ready);
+        }
+
         if(unlikely(p.checks_every > 0 && now - last_check > p.checks_every)) {
             last_check = now;
 
@@ -2150,4 +2341,213 @@ void poll_events(LISTEN_SOCKETS *sockets
             }
         }
     }
+
+#ifdef HAVE_SYS_EPOLL_H
+    freez(epoll_events);
+#endif
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// poll_events() benchmark
+// 1-byte round trips to an echo server, while the server is holding an increasing number of connections
+
+#define POLL_BENCHMARK_ROUND_TRIPS 20000
+
+static bool poll_benchmark_stop = false;
+
+static bool poll_benchmark_check_to_stop(void) {
+    return __atomic_load_n(&poll_benchmark_stop, __ATOMIC_RELAXED);
+}
+
+static int poll_benchmark_echo_rcv_callback(POLLINFO *pi, short int *events) {
+    *events |= POLLIN;
+
+    char buffer[64];
+    ssize_t rc = recv(pi->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    if(rc == 0)
+        return -1;
+
+    if(rc < 0)
+        return (errno == EWOULDBLOCK || errno == EAGAIN) ? 0 : -1;
+
+    if(send(pi->fd, buffer, rc, MSG_DONTWAIT) != rc)
+        return -1;
+
+    return 0;
+}
+
+static void *poll_benchmark_server_thread(void *ptr) {
+    LISTEN_SOCKETS *sockets = ptr;
+
+    poll_events(sockets
+                , NULL
+                , NULL
+                , poll_benchmark_echo_rcv_callback
+                , NULL
+                , NULL
+                , poll_benchmark_check_to_stop
+                , NULL
+                , 0
+                , NULL
+                , 0
+                , 0
+                , 0
+                , NULL
+                , 0
+    );
+
+    return NULL;
+}
+
+static int poll_benchmark_round_trip(int fd) {
+    char c = 'x';
+    if(send(fd, &c, 1, 0) != 1)
+        return -1;
+
+    if(recv(fd, &c, 1, 0) != 1)
+        return -1;
+
+    return 0;
+}
+
+static int poll_benchmark_usec_compar(const void *a, const void *b) {
+    usec_t ua = *(const usec_t *)a, ub = *(const usec_t *)b;
+    return (ua < ub) ? -1 : (ua > ub) ? 1 : 0;
+}
+
+static int poll_benchmark_connect(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd == -1)
+        return -1;
+
+    int one = 1;
+    (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    struct sockaddr_in sa = {
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+
+    // the round trip makes sure the server has accepted the connection
+    if(connect(fd, (struct sockaddr *)&sa, sizeof(sa)) == -1 || poll_benchmark_round_trip(fd) == -1) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int poll_benchmark_run(bool use_epoll, size_t connections, usec_t *rtt) {
+    int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if(listen_fd == -1)
+        return -1;
+
+    struct sockaddr_in sa = {
+            .sin_family = AF_INET,
+            .sin_port = 0,
+            .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    socklen_t sa_len = sizeof(sa);
+
+    if(bind(listen_fd, (struct sockaddr *)&sa, sizeof(sa)) == -1 ||
+        listen(listen_fd, 4096) == -1 ||
+        getsockname(listen_fd, (struct sockaddr *)&sa, &sa_len) == -1) {
+        close(listen_fd);
+        return -1;
+    }
+
+    LISTEN_SOCKETS sockets = {
+            .opened = 1,
+            .fds = { listen_fd },
+            .fds_names = { "poll benchmark" },
+            .fds_types = { SOCK_STREAM },
+            .fds_families = { AF_INET },
+            .fds_acl_flags = { HTTP_ACL_NONE },
+    };
+
+    bool old_use_epoll = poll_events_use_epoll;
+    poll_events_use_epoll = use_epoll;
+    __atomic_store_n(&poll_benchmark_stop, false, __ATOMIC_RELAXED);
+
+    ND_THREAD *thread = nd_thread_create("POLLBENCH", NETDATA_THREAD_OPTION_JOINABLE, poll_benchmark_server_thread, &sockets);
+
+    int ret = 0;
+    int *fds = mallocz(sizeof(int) * connections);
+    size_t opened;
+    for(opened = 0; opened < connections ;opened++) {
+        fds[opened] = poll_benchmark_connect(ntohs(sa.sin_port));
+        if(fds[opened] == -1) {
+            fprintf(stderr, "POLL BENCHMARK: cannot open connection No %zu\n", opened + 1);
+            ret = -1;
+            break;
+        }
+    }
+
+    for(size_t i = 0; !ret && i < POLL_BENCHMARK_ROUND_TRIPS ;i++) {
+        usec_t started_ut = now_monotonic_high_precision_usec();
+        if(poll_benchmark_round_trip(fds[i % opened]) == -1) {
+            fprintf(stderr, "POLL BENCHMARK: round trip failed\n");
+            ret = -1;
+            break;
+        }
+        rtt[i] = now_monotonic_high_precision_usec() - started_ut;
+    }
+
+    for(size_t i = 0; i < opened ;i++)
+        close(fds[i]);
+    freez(fds);
+
+    __atomic_store_n(&poll_benchmark_stop, true, __ATOMIC_RELAXED);
+    nd_thread_join(thread);
+    poll_events_use_epoll = old_use_epoll;
+
+    // poll_events() does not close the listening sockets
+    close(listen_fd);
+
+    return ret;
+}
+
+int poll_events_benchmark(void) {
+    static const size_t connections[] = { 1, 10, 100, 1000, 5000 };
+
+    struct rlimit rl;
+    size_t max_connections = 5000;
+    if(getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY)
+        // each connection takes 2 fds, one for each side
+        max_connections = (rl.rlim_cur > 100) ? (rl.rlim_cur - 100) / 2 : 1;
+
+    usec_t *rtt = mallocz(sizeof(usec_t) * POLL_BENCHMARK_ROUND_TRIPS);
+
+    int ret = 0;
+    for(size_t c = 0; c < sizeof(connections) / sizeof(connections[0]) && !ret ;c++) {
+        if(connections[c] > max_connections) {
+            fprintf(stderr, "POLL BENCHMARK: skipping %zu connections, the open files limit is too low\n", connections[c]);
+            continue;
+        }
+
+        for(int use_epoll = 0; use_epoll < 2 && !ret ;use_epoll++) {
+#ifndef HAVE_SYS_EPOLL_H
+            if(use_epoll) continue;
+#endif
+            ret = poll_benchmark_run(use_epoll, connections[c], rtt);
+            if(ret)
+                break;
+
+            qsort(rtt, POLL_BENCHMARK_ROUND_TRIPS, sizeof(usec_t), poll_benchmark_usec_compar);
+
+            usec_t total = 0;
+            for(size_t i = 0; i < POLL_BENCHMARK_ROUND_TRIPS ;i++)
+                total += rtt[i];
+
+            fprintf(stderr, "POLL BENCHMARK: %-5s %5zu connections: round trip avg %6.1f us, p50 %4llu us, p99 %4llu us\n",
+                    use_epoll ? "epoll" : "poll", connections[c],
+                    (double)total / POLL_BENCHMARK_ROUND_TRIPS,
+                    (unsigned long long)rtt[POLL_BENCHMARK_ROUND_TRIPS / 2],
+                    (unsigned long long)rtt[POLL_BENCHMARK_ROUND_TRIPS * 99 / 100]);
+        }
+    }
+
+    freez(rtt);
+    return ret;
 }
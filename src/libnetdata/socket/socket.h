@@ -71,7 +71,10 @@ int accept4(int sock, struct sockaddr *addr, socklen_t *addrlen, int flags);
 
 
 // ----------------------------------------------------------------------------
-// poll() based listener
+// poll() or epoll() based listener
+
+// use epoll() instead of poll(), when it is available
+extern bool poll_events_use_epoll;
 
 #define POLLINFO_FLAG_SERVER_SOCKET 0x00000001
 #define POLLINFO_FLAG_CLIENT_SOCKET 0x00000002
@@ -133,6 +136,13 @@ struct poll {
     struct pollinfo *inf;
     struct pollinfo *first_free;
 
+    // epoll() - the fds array above still has the events wanted for each slot
+    int epoll_fd;                   // -1 when poll() is used
+    short int *epoll_registered;    // the events registered to epoll for each slot
+    size_t *always_ready;           // slots of files epoll cannot watch, poll() reports them always ready
+    size_t always_ready_used;
+    size_t always_ready_size;
+
     SIMPLE_PATTERN *access_list;
     int allow_dns;
 
@@ -165,6 +175,7 @@ POLLINFO *poll_add_fd(POLLJOB *p
                              , void *data
 );
 void poll_close_fd(POLLINFO *pi);
+void poll_fd_events_add(POLLINFO *pi, short int events);
 
 void poll_events(LISTEN_SOCKETS *sockets
         , void *(*add_callback)(POLLINFO *pi, short int *events, void *data)
@@ -183,6 +194,8 @@ void poll_events(LISTEN_SOCKETS *sockets
         , size_t max_tcp_sockets
 );
 
+int poll_events_benchmark(void);
+
 #ifndef INET6_ADDRSTRLEN
 #define INET6_ADDRSTRLEN 46
 #endif
@@ -0,0 +1,531 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "binary.h"
+
+#define RRDR_BINARY_ALIGN(size) (((size) + 7) & ~((size_t)7))
+
+static inline size_t rrdr_binary_bitmap_size(size_t rows) {
+    return RRDR_BINARY_ALIGN((rows + 7) / 8);
+}
+
+static inline size_t rrdr_binary_column_size(size_t rows, size_t value_size, RRDR_BINARY_FLAGS flags) {
+    size_t size = RRDR_BINARY_ALIGN(rows * value_size) + RRDR_BINARY_ALIGN(rows * sizeof(float));
+
+    if(flags & RRDR_BINARY_FLAG_COUNT)
+        size += RRDR_BINARY_ALIGN(rows * sizeof(uint32_t));
+
+    if(flags & RRDR_BINARY_FLAG_HIDDEN)
+        size += RRDR_BINARY_ALIGN(rows * value_size);
+
+    return size + RRDR_BINARY_BITMAP_MAX * rrdr_binary_bitmap_size(rows);
+}
+
+static inline void rrdr2binary_values(void *dst, const NETDATA_DOUBLE *src, const RRDR_VALUE_FLAGS *o, size_t d, size_t dimensions, long start, long end, long step, size_t value_size, NETDATA_DOUBLE empty) {
+    if(value_size == sizeof(float)) {
+        float *values = dst;
+        for(long i = start; i != end; i += step) {
+            size_t slot = i * dimensions + d;
+            *values++ = (float)((o && (o[slot] & RRDR_VALUE_EMPTY)) ? empty : src[slot]);
+        }
+    }
+    else {
+        double *values = dst;
+        for(long i = start; i != end; i += step) {
+            size_t slot = i * dimensions + d;
+            *values++ = (double)((o && (o[slot] & RRDR_VALUE_EMPTY)) ? empty : src[slot]);
+        }
+    }
+}
+
+void rrdr2binary(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, size_t value_size, BUFFER *metadata) {
+    QUERY_TARGET *qt = r->internal.qt;
+
+    bool send_count = query_target_aggregatable(qt);
+    bool send_hidden = send_count && r->vh && query_has_group_by_aggregation_percentage(qt);
+
+    if(value_size != sizeof(float))
+        value_size = sizeof(double);
+
+    RRDR_BINARY_FLAGS flags = 0;
+    if(options & RRDR_OPTION_MILLISECONDS) flags |= RRDR_BINARY_FLAG_MILLISECONDS;
+    if(send_count) flags |= RRDR_BINARY_FLAG_COUNT;
+    if(send_hidden) flags |= RRDR_BINARY_FLAG_HIDDEN;
+
+    const size_t dimensions = r->d;
+    const size_t rows = rrdr_rows(r);
+
+    size_t columns = 0, ids_size = 0;
+    for(size_t d = 0; d < dimensions ; d++) {
+        if(!rrdr_dimension_should_be_exposed(r->od[d], options))
+            continue;
+
+        columns++;
+        ids_size += string_strlen(r->di[d]) + 1;
+    }
+
+    const size_t metadata_size = metadata ? buffer_strlen(metadata) : 0;
+    const size_t column_size = rrdr_binary_column_size(rows, value_size, flags);
+    const size_t total = sizeof(RRDR_BINARY_HEADER) +
+                         RRDR_BINARY_ALIGN(metadata_size) +
+                         RRDR_BINARY_ALIGN(ids_size) +
+                         RRDR_BINARY_ALIGN(rows * sizeof(int64_t)) +
+                         columns * column_size;
+
+    // the sections are aligned relative to the beginning of the response
+    internal_fatal(wb->len % 8, "RRDR BINARY: the response does not start at an aligned offset");
+
+    buffer_need_bytes(wb, total + 1);
+    uint8_t *base = (uint8_t *)&wb->buffer[wb->len];
+    memset(base, 0, total);
+
+    RRDR_BINARY_HEADER *h = (RRDR_BINARY_HEADER *)base;
+    h->magic = RRDR_BINARY_MAGIC;
+    h->version = RRDR_BINARY_VERSION;
+    h->value_size = (uint8_t)value_size;
+    h->flags = flags;
+    h->rows = (uint32_t)rows;
+    h->columns = (uint32_t)columns;
+    h->metadata_size = (uint32_t)metadata_size;
+    h->ids_size = (uint32_t)ids_size;
+    h->after = r->view.after;
+    h->before = r->view.before;
+
+    uint8_t *p = base + sizeof(RRDR_BINARY_HEADER);
+
+    if(metadata_size)
+        memcpy(p, buffer_tostring(metadata), metadata_size);
+    p += RRDR_BINARY_ALIGN(metadata_size);
+
+    char *id = (char *)p;
+    for(size_t d = 0; d < dimensions ; d++) {
+        if(!rrdr_dimension_should_be_exposed(r->od[d], options))
+            continue;
+
+        size_t len = string_strlen(r->di[d]);
+        memcpy(id, string2str(r->di[d]), len);
+        id += len + 1;
+    }
+    p += RRDR_BINARY_ALIGN(ids_size);
+
+    // the rows in the order of the JSON formats
+    long start = 0, end = (long)rows, step = 1;
+    if (!(options & RRDR_OPTION_REVERSED)) {
+        start = (long)rows - 1;
+        end = -1;
+        step = -1;
+    }
+
+    int64_t *timestamps = (int64_t *)p;
+    for(long i = start; i != end; i += step)
+        *timestamps++ = (flags & RRDR_BINARY_FLAG_MILLISECONDS) ? (int64_t)r->t[i] * MSEC_PER_SEC : (int64_t)r->t[i];
+    p += RRDR_BINARY_ALIGN(rows * sizeof(int64_t));
+
+    const NETDATA_DOUBLE empty = (options & RRDR_OPTION_NULL2ZERO) ? 0.0 : NAN;
+
+    for(size_t d = 0; d < dimensions ; d++) {
+        if(!rrdr_dimension_should_be_exposed(r->od[d], options))
+            continue;
+
+        uint8_t *c = p;
+
+        rrdr2binary_values(c, r->v, r->o, d, dimensions, start, end, step, value_size, empty);
+        c += RRDR_BINARY_ALIGN(rows * value_size);
+
+        float *ar = (float *)c;
+        for(long i = start; i != end; i += step)
+            *ar++ = (float)r->ar[i * dimensions + d];
+        c += RRDR_BINARY_ALIGN(rows * sizeof(float));
+
+        if(flags & RRDR_BINARY_FLAG_COUNT) {
+            uint32_t *counts = (uint32_t *)c;
+            for(long i = start; i != end; i += step)
+                *counts++ = r->gbc[i * dimensions + d];
+            c += RRDR_BINARY_ALIGN(rows * sizeof(uint32_t));
+        }
+
+        if(flags & RRDR_BINARY_FLAG_HIDDEN) {
+            rrdr2binary_values(c, r->vh, NULL, d, dimensions, start, end, step, value_size, empty);
+            c += RRDR_BINARY_ALIGN(rows * value_size);
+        }
+
+        uint8_t *empty_bitmap = c;
+        uint8_t *reset_bitmap = empty_bitmap + rrdr_binary_bitmap_size(rows);
+        uint8_t *partial_bitmap = reset_bitmap + rrdr_binary_bitmap_size(rows);
+        size_t row = 0;
+        for(long i = start; i != end; i += step, row++) {
+            RRDR_VALUE_FLAGS o = r->o[i * dimensions + d];
+            if(likely(!o))
+                continue;
+
+            uint8_t bit = (uint8_t)(1 << (row % 8));
+            if(o & RRDR_VALUE_EMPTY) empty_bitmap[row / 8] |= bit;
+            if(o & RRDR_VALUE_RESET) reset_bitmap[row / 8] |= bit;
+            if(o & RRDR_VALUE_PARTIAL) partial_bitmap[row / 8] |= bit;
+        }
+
+        p += column_size;
+    }
+
+    wb->len += total;
+    wb->buffer[wb->len] = '\0';
+    buffer_overflow_check(wb);
+}
+
+// ----------------------------------------------------------------------------
+// decoding
+
+bool rrdr_binary_decode(const void *data, size_t size, RRDR_BINARY *b) {
+    memset(b, 0, sizeof(*b));
+
+    if(!data || size < sizeof(RRDR_BINARY_HEADER))
+        return false;
+
+    const RRDR_BINARY_HEADER *h = data;
+    if(h->magic != RRDR_BINARY_MAGIC || h->version != RRDR_BINARY_VERSION)
+        return false;
+
+    if(h->value_size != sizeof(float) && h->value_size != sizeof(double))
+        return false;
+
+    size_t column_size = rrdr_binary_column_size(h->rows, h->value_size, h->flags);
+    size_t expected = sizeof(RRDR_BINARY_HEADER) +
+                      RRDR_BINARY_ALIGN((size_t)h->metadata_size) +
+                      RRDR_BINARY_ALIGN((size_t)h->ids_size) +
+                      RRDR_BINARY_ALIGN((size_t)h->rows * sizeof(int64_t)) +
+                      (size_t)h->columns * column_size;
+
+    if(size != expected)
+        return false;
+
+    const uint8_t *p = (const uint8_t *)data + sizeof(RRDR_BINARY_HEADER);
+
+    b->metadata = h->metadata_size ? (const char *)p : NULL;
+    p += RRDR_BINARY_ALIGN((size_t)h->metadata_size);
+
+    // there should be exactly one NUL per column, the last byte of the ids
+    size_t nuls = 0;
+    for(size_t i = 0; i < h->ids_size ;i++)
+        if(!p[i]) nuls++;
+
+    if(nuls != h->columns || (h->ids_size && p[h->ids_size - 1]))
+        return false;
+
+    b->ids = (const char *)p;
+    p += RRDR_BINARY_ALIGN((size_t)h->ids_size);
+
+    b->timestamps = (const int64_t *)p;
+    p += RRDR_BINARY_ALIGN((size_t)h->rows * sizeof(int64_t));
+
+    b->header = h;
+    b->columns = p;
+    b->column_size = column_size;
+    return true;
+}
+
+bool rrdr_binary_column(const RRDR_BINARY *b, size_t column, RRDR_BINARY_COLUMN *c) {
+    memset(c, 0, sizeof(*c));
+
+    if(!b->header || column >= b->header->columns)
+        return false;
+
+    const size_t rows = b->header->rows;
+    const size_t value_size = b->header->value_size;
+
+    c->id = b->ids;
+    for(size_t i = 0; i < column ;i++)
+        c->id += strlen(c->id) + 1;
+
+    const uint8_t *p = b->columns + column * b->column_size;
+
+    c->values = p;
+    p += RRDR_BINARY_ALIGN(rows * value_size);
+
+    c->anomaly_rates = (const float *)p;
+    p += RRDR_BINARY_ALIGN(rows * sizeof(float));
+
+    if(b->header->flags & RRDR_BINARY_FLAG_COUNT) {
+        c->counts = (const uint32_t *)p;
+        p += RRDR_BINARY_ALIGN(rows * sizeof(uint32_t));
+    }
+
+    if(b->header->flags & RRDR_BINARY_FLAG_HIDDEN) {
+        c->hidden = p;
+        p += RRDR_BINARY_ALIGN(rows * value_size);
+    }
+
+    for(size_t i = 0; i < RRDR_BINARY_BITMAP_MAX ;i++) {
+        c->bitmaps[i] = p;
+        p += rrdr_binary_bitmap_size(rows);
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// unittest and benchmark
+
+static RRDR *rrdr2binary_unittest_rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt, size_t dimensions, size_t rows) {
+    RRDR *r = rrdr_create(owa, qt, dimensions, rows);
+    r->rows = rows;
+    r->view.after = 1700000000;
+    r->view.before = (time_t)(r->view.after + rows - 1);
+    r->vh = onewayalloc_mallocz(owa, rows * dimensions * sizeof(NETDATA_DOUBLE));
+    r->gbc = onewayalloc_mallocz(owa, rows * dimensions * sizeof(uint32_t));
+
+    for(size_t d = 0; d < dimensions ; d++) {
+        char id[50];
+        snprintfz(id, sizeof(id), "dimension-%zu", d);
+        r->di[d] = string_strdupz(id);
+        r->dn[d] = string_strdupz(id);
+
+        // one hidden dimension, and one not queried, to check they are not exposed
+        if(d == 1)
+            r->od[d] = RRDR_DIMENSION_QUERIED | RRDR_DIMENSION_HIDDEN;
+        else if(d == 2)
+            r->od[d] = RRDR_DIMENSION_DEFAULT;
+        else
+            r->od[d] = RRDR_DIMENSION_QUERIED | RRDR_DIMENSION_NONZERO;
+    }
+
+    for(size_t i = 0; i < rows ; i++) {
+        r->t[i] = (time_t)(r->view.after + i);
+
+        for(size_t d = 0; d < dimensions ; d++) {
+            size_t slot = i * dimensions + d;
+            r->v[slot] = (NETDATA_DOUBLE)d * 1000.0 + (NETDATA_DOUBLE)i / 7.0 - 50.0;
+            r->vh[slot] = (NETDATA_DOUBLE)i / 3.0;
+            r->ar[slot] = (NETDATA_DOUBLE)((i + d) % 101);
+            r->gbc[slot] = (uint32_t)(d + i);
+
+            r->o[slot] = RRDR_VALUE_NOTHING;
+            if((i + d) % 5 == 0) r->o[slot] |= RRDR_VALUE_EMPTY;
+            if((i + d) % 7 == 0) r->o[slot] |= RRDR_VALUE_RESET;
+            if((i + d) % 11 == 0) r->o[slot] |= RRDR_VALUE_PARTIAL;
+        }
+    }
+
+    return r;
+}
+
+static bool rrdr2binary_unittest_same(NETDATA_DOUBLE expected, NETDATA_DOUBLE found, size_t value_size) {
+    if(value_size == sizeof(float))
+        expected = (float)expected;
+
+    if(isnan(expected) || isnan(found))
+        return isnan(expected) && isnan(found);
+
+    return expected == found;
+}
+
+static int rrdr2binary_unittest_one(size_t value_size, RRDR_OPTIONS options, bool percentage, bool with_metadata) {
+    int errors = 0;
+
+    ONEWAYALLOC *owa = onewayalloc_create(0);
+    QUERY_TARGET *qt = callocz(1, sizeof(QUERY_TARGET));
+    qt->window.options = options;
+    if(percentage) {
+        qt->request.group_by[0].group_by = RRDR_GROUP_BY_DIMENSION;
+        qt->request.group_by[0].aggregation = RRDR_GROUP_BY_FUNCTION_PERCENTAGE;
+    }
+
+    const size_t dimensions = 7, rows = 123;
+    RRDR *r = rrdr2binary_unittest_rrdr(owa, qt, dimensions, rows);
+
+    BUFFER *metadata = NULL;
+    if(with_metadata) {
+        metadata = buffer_create(0, NULL);
+        buffer_strcat(metadata, "{\"api\":2}");
+    }
+
+    BUFFER *wb = buffer_create(0, NULL);
+    rrdr2binary(r, wb, options, value_size, metadata);
+
+    RRDR_BINARY b;
+    if(!rrdr_binary_decode(wb->buffer, wb->len, &b)) {
+        fprintf(stderr, "RRDR BINARY: cannot decode the response\n");
+        errors++;
+        goto cleanup;
+    }
+
+    bool send_count = options & RRDR_OPTION_RETURN_RAW;
+    bool send_hidden = send_count && percentage;
+    if(b.header->rows != rows || b.header->value_size != value_size ||
+        !!(b.header->flags & RRDR_BINARY_FLAG_COUNT) != send_count ||
+        !!(b.header->flags & RRDR_BINARY_FLAG_HIDDEN) != send_hidden ||
+        !!(b.header->flags & RRDR_BINARY_FLAG_MILLISECONDS) != !!(options & RRDR_OPTION_MILLISECONDS) ||
+        b.header->after != r->view.after || b.header->before != r->view.before) {
+        fprintf(stderr, "RRDR BINARY: the header is wrong\n");
+        errors++;
+    }
+
+    if(with_metadata && (!b.metadata || b.header->metadata_size != buffer_strlen(metadata) ||
+        memcmp(b.metadata, buffer_tostring(metadata), buffer_strlen(metadata)) != 0)) {
+        fprintf(stderr, "RRDR BINARY: the metadata are wrong\n");
+        errors++;
+    }
+
+    long start = 0, end = (long)rows, step = 1;
+    if (!(options & RRDR_OPTION_REVERSED)) {
+        start = (long)rows - 1;
+        end = -1;
+        step = -1;
+    }
+
+    size_t row = 0;
+    for(long i = start; i != end; i += step, row++) {
+        int64_t t = (options & RRDR_OPTION_MILLISECONDS) ? (int64_t)r->t[i] * MSEC_PER_SEC : (int64_t)r->t[i];
+        if(b.timestamps[row] != t) {
+            fprintf(stderr, "RRDR BINARY: row %zu has timestamp %"PRId64", expected %"PRId64"\n", row, b.timestamps[row], t);
+            errors++;
+        }
+    }
+
+    size_t column = 0;
+    for(size_t d = 0; d < dimensions ; d++) {
+        if(!rrdr_dimension_should_be_exposed(r->od[d], options))
+            continue;
+
+        RRDR_BINARY_COLUMN c;
+        if(!rrdr_binary_column(&b, column++, &c)) {
+            fprintf(stderr, "RRDR BINARY: column %zu is missing\n", column - 1);
+            errors++;
+            continue;
+        }
+
+        if(strcmp(c.id, string2str(r->di[d])) != 0) {
+            fprintf(stderr, "RRDR BINARY: column %zu has id '%s', expected '%s'\n", column - 1, c.id, string2str(r->di[d]));
+            errors++;
+        }
+
+        row = 0;
+        for(long i = start; i != end; i += step, row++) {
+            size_t slot = i * dimensions + d;
+            RRDR_VALUE_FLAGS o = r->o[slot];
+
+            NETDATA_DOUBLE expected = r->v[slot];
+            if(o & RRDR_VALUE_EMPTY)
+                expected = (options & RRDR_OPTION_NULL2ZERO) ? 0.0 : NAN;
+
+            if(!rrdr2binary_unittest_same(expected, rrdr_binary_value(&b, c.values, row), value_size) ||
+                c.anomaly_rates[row] != (float)r->ar[slot] ||
+                (send_count && c.counts[row] != r->gbc[slot]) ||
+                (send_hidden && !rrdr2binary_unittest_same(r->vh[slot], rrdr_binary_value(&b, c.hidden, row), value_size)) ||
+                rrdr_binary_bitmap_get(c.bitmaps[RRDR_BINARY_BITMAP_EMPTY], row) != !!(o & RRDR_VALUE_EMPTY) ||
+                rrdr_binary_bitmap_get(c.bitmaps[RRDR_BINARY_BITMAP_RESET], row) != !!(o & RRDR_VALUE_RESET) ||
+                rrdr_binary_bitmap_get(c.bitmaps[RRDR_BINARY_BITMAP_PARTIAL], row) != !!(o & RRDR_VALUE_PARTIAL)) {
+                fprintf(stderr, "RRDR BINARY: column '%s', row %zu, does not match the query result\n", c.id, row);
+                errors++;
+            }
+        }
+    }
+
+    if(column != b.header->columns) {
+        fprintf(stderr, "RRDR BINARY: the response has %u columns, expected %zu\n", b.header->columns, column);
+        errors++;
+    }
+
+    // truncated and corrupted responses should be rejected
+    if(rrdr_binary_decode(wb->buffer, wb->len - 1, &b)) {
+        fprintf(stderr, "RRDR BINARY: a truncated response was decoded\n");
+        errors++;
+    }
+
+    wb->buffer[0] ^= 0xFF;
+    if(rrdr_binary_decode(wb->buffer, wb->len, &b)) {
+        fprintf(stderr, "RRDR BINARY: a response with a wrong magic was decoded\n");
+        errors++;
+    }
+
+cleanup:
+    buffer_free(wb);
+    buffer_free(metadata);
+    rrdr_free(owa, r);
+    freez(qt);
+    onewayalloc_destroy(owa);
+    return errors;
+}
+
+int rrdr2binary_unittest(void) {
+    fprintf(stderr, "\n%s() running...\n", __FUNCTION__);
+
+    int errors = 0;
+    const size_t value_sizes[] = { sizeof(double), sizeof(float) };
+    for(size_t v = 0; v < sizeof(value_sizes) / sizeof(value_sizes[0]) ;v++) {
+        errors += rrdr2binary_unittest_one(value_sizes[v], 0, false, false);
+        errors += rrdr2binary_unittest_one(value_sizes[v], RRDR_OPTION_JSON_WRAP, false, true);
+        errors += rrdr2binary_unittest_one(value_sizes[v], RRDR_OPTION_REVERSED | RRDR_OPTION_MILLISECONDS | RRDR_OPTION_NULL2ZERO, false, false);
+        errors += rrdr2binary_unittest_one(value_sizes[v], RRDR_OPTION_NONZERO | RRDR_OPTION_RETURN_RAW, false, false);
+        errors += rrdr2binary_unittest_one(value_sizes[v], RRDR_OPTION_RETURN_RAW, true, true);
+    }
+
+    fprintf(stderr, "RRDR BINARY: %s\n", errors ? "FAILED" : "OK");
+    return errors;
+}
+
+int rrdr2binary_benchmark(void) {
+    const struct {
+        size_t dimensions;
+        size_t rows;
+    } sizes[] = {
+        { 10, 300 },
+        { 100, 300 },
+        { 1000, 300 },
+        { 100, 3000 },
+    };
+
+    for(size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]) ;s++) {
+        ONEWAYALLOC *owa = onewayalloc_create(0);
+        QUERY_TARGET *qt = callocz(1, sizeof(QUERY_TARGET));
+        qt->window.options = RRDR_OPTION_JSON_WRAP | RRDR_OPTION_MINIFY;
+
+        RRDR *r = rrdr2binary_unittest_rrdr(owa, qt, sizes[s].dimensions, sizes[s].rows);
+
+        // about 10M points per format
+        size_t iterations = 10 * 1000 * 1000 / (sizes[s].dimensions * sizes[s].rows);
+        if(!iterations) iterations = 1;
+
+        BUFFER *wb = buffer_create(0, NULL);
+
+        struct {
+            const char *name;
+            usec_t ut;
+            size_t bytes;
+        } formats[] = {
+            { .name = "json2" },
+            { .name = "binary" },
+            { .name = "binary32" },
+        };
+
+        for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]) ;f++) {
+            usec_t started_ut = now_monotonic_usec();
+
+            for(size_t it = 0; it < iterations ;it++) {
+                buffer_flush(wb);
+
+                if(f == 0) {
+                    buffer_json_initialize(wb, "\"", "\"", 0, true, BUFFER_JSON_OPTIONS_MINIFY);
+                    rrdr2json_v2(r, wb);
+                    buffer_json_finalize(wb);
+                }
+                else
+                    rrdr2binary(r, wb, qt->window.options, f == 1 ? sizeof(double) : sizeof(float), NULL);
+            }
+
+            formats[f].ut = (now_monotonic_usec() - started_ut) / iterations;
+            formats[f].bytes = buffer_strlen(wb);
+        }
+
+        for(size_t f = 0; f < sizeof(formats) / sizeof(formats[0]) ;f++)
+            fprintf(stderr, "RRDR BINARY BENCHMARK: %4zu dimensions x %4zu rows: %-8s %8"PRIu64" us, %10zu bytes (%5.1f%% of json2 time, %5.1f%% of json2 size)\n",
+                    sizes[s].dimensions, sizes[s].rows, formats[f].name, formats[f].ut, formats[f].bytes,
+                    formats[0].ut ? (double)formats[f].ut * 100.0 / (double)formats[0].ut : 0.0,
+                    formats[0].bytes ? (double)formats[f].bytes * 100.0 / (double)formats[0].bytes : 0.0);
+
+        buffer_free(wb);
+        rrdr_free(owa, r);
+        freez(qt);
+        onewayalloc_destroy(owa);
+    }
+
+    return 0;
+}
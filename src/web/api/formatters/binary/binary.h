@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_API_FORMATTER_BINARY_H
+#define NETDATA_API_FORMATTER_BINARY_H
+
+#include "web/api/queries/rrdr.h"
+
+// the binary columnar format of query results (format=binary and format=binary32)
+//
+// all integers and floats are in the byte order of the agent - the magic number reveals it
+// every section starts at an 8 bytes boundary, so that typed arrays can be mapped on it
+//
+//  1. the header (RRDR_BINARY_HEADER)
+//  2. the JSON metadata (the same json wrapper the JSON formats send), when options=jsonwrap
+//  3. the ids of the columns, each terminated with a NUL
+//  4. the timestamps, rows x int64 (seconds, or milliseconds with options=ms)
+//  5. for each column, one after the other:
+//     - the values, rows x float64 (binary), or rows x float32 (binary32), NaN when empty
+//     - the anomaly rates, rows x float32 (0 - 100)
+//     - the group by counts, rows x uint32, when RRDR_BINARY_FLAG_COUNT is set
+//     - the hidden values, rows x float64 or float32, when RRDR_BINARY_FLAG_HIDDEN is set
+//     - 3 bitmaps, (rows + 7) / 8 bytes each, for RRDR_VALUE_EMPTY, RRDR_VALUE_RESET and RRDR_VALUE_PARTIAL
+//       bit (i % 8) of byte (i / 8) is the flag of row i
+//
+// the rows are ordered like in the JSON formats (newest first, unless options=flip)
+
+#define RRDR_BINARY_MAGIC   0x3142444EU     // "NDB1" in little endian
+#define RRDR_BINARY_VERSION 1
+
+typedef enum __attribute__ ((__packed__)) rrdr_binary_flags {
+    RRDR_BINARY_FLAG_MILLISECONDS   = (1 << 0), // the timestamps are in milliseconds
+    RRDR_BINARY_FLAG_COUNT          = (1 << 1), // the columns have group by counts
+    RRDR_BINARY_FLAG_HIDDEN         = (1 << 2), // the columns have hidden values
+} RRDR_BINARY_FLAGS;
+
+typedef enum __attribute__ ((__packed__)) rrdr_binary_bitmap {
+    RRDR_BINARY_BITMAP_EMPTY = 0,
+    RRDR_BINARY_BITMAP_RESET,
+    RRDR_BINARY_BITMAP_PARTIAL,
+
+    // terminator
+    RRDR_BINARY_BITMAP_MAX,
+} RRDR_BINARY_BITMAP;
+
+typedef struct __attribute__ ((__packed__)) rrdr_binary_header {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t value_size;                     // 8 for float64, 4 for float32
+    uint8_t flags;                          // RRDR_BINARY_FLAGS
+    uint32_t rows;
+    uint32_t columns;
+    uint32_t metadata_size;                 // the bytes of the JSON metadata, 0 when not sent
+    uint32_t ids_size;                      // the bytes of the column ids, including their NULs
+    int64_t after;
+    int64_t before;
+} RRDR_BINARY_HEADER;
+
+// a decoded response - all pointers point into the response
+typedef struct rrdr_binary {
+    const RRDR_BINARY_HEADER *header;
+    const char *metadata;                   // not NUL terminated, header->metadata_size bytes
+    const char *ids;
+    const int64_t *timestamps;
+    const uint8_t *columns;
+    size_t column_size;                     // the bytes of each column
+} RRDR_BINARY;
+
+typedef struct rrdr_binary_column {
+    const char *id;
+    const void *values;                     // float64 or float32, depending on header->value_size
+    const float *anomaly_rates;
+    const uint32_t *counts;                 // NULL without RRDR_BINARY_FLAG_COUNT
+    const void *hidden;                     // NULL without RRDR_BINARY_FLAG_HIDDEN
+    const uint8_t *bitmaps[RRDR_BINARY_BITMAP_MAX];
+} RRDR_BINARY_COLUMN;
+
+static inline bool rrdr_binary_bitmap_get(const uint8_t *bitmap, size_t row) {
+    return bitmap[row / 8] & (1 << (row % 8));
+}
+
+static inline NETDATA_DOUBLE rrdr_binary_value(const RRDR_BINARY *b, const void *values, size_t row) {
+    if(b->header->value_size == sizeof(float))
+        return ((const float *)values)[row];
+
+    return ((const double *)values)[row];
+}
+
+void rrdr2binary(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, size_t value_size, BUFFER *metadata);
+
+bool rrdr_binary_decode(const void *data, size_t size, RRDR_BINARY *b);
+bool rrdr_binary_column(const RRDR_BINARY *b, size_t column, RRDR_BINARY_COLUMN *c);
+
+int rrdr2binary_unittest(void);
+int rrdr2binary_benchmark(void);
+
+#include "../rrd2json.h"
+
+#endif //NETDATA_API_FORMATTER_BINARY_H
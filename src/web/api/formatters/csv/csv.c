@@ -100,7 +100,7 @@ void rrdr2csv(RRDR *r, BUFFER *wb, uint32_t format, RRDR_OPTIONS options, const
                     buffer_strcat(wb, "null");
             }
             else
-                buffer_print_netdata_double(wb, n);
+                rrdr_print_value(wb, n, options);
         }
 
         buffer_strcat(wb, endline);
@@ -233,7 +233,7 @@ void rrdr2json(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, int datatable) {
                     buffer_fast_strcat(wb, "null", 4);
             }
             else
-                buffer_print_netdata_double(wb, n);
+                rrdr_print_value(wb, n, options);
 
             buffer_fast_strcat(wb, post_value, post_value_len);
         }
@@ -323,10 +323,10 @@ void rrdr2json_v2(RRDR *r, BUFFER *wb) {
                         buffer_json_add_array_item_double(wb, NAN);
                 }
                 else
-                    buffer_json_add_array_item_double(wb, n);
+                    rrdr_json_add_array_item_value(wb, n, options);
 
                 // add the anomaly
-                buffer_json_add_array_item_double(wb, ar[d]);
+                rrdr_json_add_array_item_value(wb, ar[d], options);
 
                 // add the point annotations
                 buffer_json_add_array_item_uint64(wb, o);
@@ -335,7 +335,7 @@ void rrdr2json_v2(RRDR *r, BUFFER *wb) {
                 if(send_count)
                     buffer_json_add_array_item_uint64(wb, gbc[d]);
                 if(send_hidden)
-                    buffer_json_add_array_item_double(wb, ch[d]);
+                    rrdr_json_add_array_item_value(wb, ch[d], options);
 
                 buffer_json_array_close(wb); // point
             }
@@ -344,6 +344,23 @@ int data_query_execute(ONEWAYALLOC *owa, BUFFER *wb, QUERY_TARGET *qt, time_t *l
         rrdr2json_v2(r, wb);
         wrapper_end(r, wb);
         break;
+
+    case DATASOURCE_BINARY:
+    case DATASOURCE_BINARY32: {
+        wb->content_type = CT_APPLICATION_OCTET_STREAM;
+
+        // the json wrapper is sent as-is, ahead of the columns
+        BUFFER *metadata = NULL;
+        if(options & RRDR_OPTION_JSON_WRAP) {
+            metadata = buffer_create(0, NULL);
+            wrapper_begin(r, metadata);
+            wrapper_end(r, metadata);
+        }
+
+        rrdr2binary(r, wb, options, format == DATASOURCE_BINARY32 ? sizeof(float) : sizeof(double), metadata);
+        buffer_free(metadata);
+        break;
+    }
     }
 
     rrdr_free(owa, r);
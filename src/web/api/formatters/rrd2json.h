@@ -11,6 +11,7 @@
 #include "web/api/formatters/ssv/ssv.h"
 #include "web/api/formatters/json/json.h"
 #include "web/api/formatters/value/value.h"
+#include "web/api/formatters/binary/binary.h"
 
 #include "web/api/formatters/rrdset2json.h"
 #include "web/api/formatters/charts2json.h"
@@ -62,4 +63,19 @@ static inline bool rrdr_dimension_should_be_exposed(RRDR_DIMENSION_FLAGS rrdr_di
     return true;
 }
 
+// the values of the points - options=fixed-precision restores the 7 fractional digits output
+static inline void rrdr_print_value(BUFFER *wb, NETDATA_DOUBLE value, RRDR_OPTIONS options) {
+    if(unlikely(options & RRDR_OPTION_FIXED_PRECISION))
+        buffer_print_netdata_double_fixed(wb, value);
+    else
+        buffer_print_netdata_double(wb, value);
+}
+
+static inline void rrdr_json_add_array_item_value(BUFFER *wb, NETDATA_DOUBLE value, RRDR_OPTIONS options) {
+    if(unlikely(options & RRDR_OPTION_FIXED_PRECISION))
+        buffer_json_add_array_item_double_fixed(wb, value);
+    else
+        buffer_json_add_array_item_double(wb, value);
+}
+
 #endif /* NETDATA_RRD2JSON_H */
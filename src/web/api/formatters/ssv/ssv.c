@@ -38,7 +38,7 @@ void rrdr2ssv(RRDR *r, BUFFER *wb, RRDR_OPTIONS options, const char *prefix, con
                 buffer_strcat(wb, "null");
         }
         else
-            buffer_print_netdata_double(wb, v);
+            rrdr_print_value(wb, v, options);
     }
     buffer_strcat(wb, suffix);
     //netdata_log_info("RRD2SSV(): %s: END", r->st->id);
@@ -2,6 +2,14 @@
 
 #include "http_header.h"
 
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef ENABLE_BROTLI
+#include <brotli/encode.h>
+#endif
+
 static void web_client_enable_deflate(struct web_client *w, bool gzip) {
     if(gzip)
         web_client_flag_set(w, WEB_CLIENT_ENCODING_GZIP);
@@ -43,6 +51,7 @@ static void web_client_enable_deflate(struct web_client *w, bool gzip) {
         return;
     }
 
+    w->response.zencoding = WEB_RESPONSE_ENCODING_GZIP;
     w->response.zsent = 0;
     w->response.zoutput = true;
     w->response.zinitialized = true;
@@ -54,6 +63,129 @@ static void web_client_enable_deflate(struct web_client *w, bool gzip) {
     netdata_log_debug(D_DEFLATE, "%llu: Initialized compression.", w->id);
 }
 
+#if defined(ENABLE_ZSTD) || defined(ENABLE_BROTLI)
+// zstd and brotli are streamed to TCP and UNIX socket clients only
+// cloud queries compress the whole response with zlib
+static void web_client_enable_encoder(struct web_client *w, WEB_RESPONSE_ENCODING encoding, void *encoder) {
+    w->response.zencoding = encoding;
+    w->response.zencoder = encoder;
+    w->response.zin_offset = 0;
+    w->response.zin_end = 0;
+    w->response.zflushing = false;
+    w->response.zpending = true;    // the encoder has to be called at least once, to end its frame
+    w->response.ztotal_out = 0;
+    w->response.zcpu_ut = 0;
+
+    w->response.zhave = 0;
+    w->response.zsent = 0;
+    w->response.zoutput = true;
+    w->response.zinitialized = true;
+
+    web_client_flag_set(w, WEB_CLIENT_CHUNKED_TRANSFER);
+
+    netdata_log_debug(D_DEFLATE, "%llu: Initialized %s compression.", w->id, web_response_encoding_name(encoding));
+}
+
+static bool web_client_can_enable_encoder(struct web_client *w) {
+    if(!web_client_check_conn_unix(w) && !web_client_check_conn_tcp(w))
+        return false;
+
+    if(unlikely(w->response.zinitialized))
+        // compression has already been initialized for this client.
+        return false;
+
+    if(unlikely(w->response.sent)) {
+        netdata_log_error("%llu: Cannot enable compression in the middle of a conversation.", w->id);
+        return false;
+    }
+
+    return true;
+}
+#endif
+
+#ifdef ENABLE_ZSTD
+static bool web_client_enable_zstd(struct web_client *w) {
+    web_client_flag_set(w, WEB_CLIENT_ENCODING_ZSTD);
+
+    if(!web_client_can_enable_encoder(w))
+        return false;
+
+    ZSTD_CCtx *cctx = ZSTD_createCCtx();
+    if(!cctx) {
+        netdata_log_error("%llu: Failed to initialize zstd. Trying the next encoding.", w->id);
+        return false;
+    }
+
+    int level = web_zstd_level;
+    if(level < 1) level = 1;
+    if(level > ZSTD_maxCLevel()) level = ZSTD_maxCLevel();
+
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+
+    web_client_enable_encoder(w, WEB_RESPONSE_ENCODING_ZSTD, cctx);
+    return true;
+}
+#endif
+
+#ifdef ENABLE_BROTLI
+static bool web_client_enable_brotli(struct web_client *w) {
+    web_client_flag_set(w, WEB_CLIENT_ENCODING_BROTLI);
+
+    if(!web_client_can_enable_encoder(w))
+        return false;
+
+    BrotliEncoderState *state = BrotliEncoderCreateInstance(NULL, NULL, NULL);
+    if(!state) {
+        netdata_log_error("%llu: Failed to initialize brotli. Trying the next encoding.", w->id);
+        return false;
+    }
+
+    int level = web_brotli_level;
+    if(level < BROTLI_MIN_QUALITY) level = BROTLI_MIN_QUALITY;
+    if(level > BROTLI_MAX_QUALITY) level = BROTLI_MAX_QUALITY;
+
+    BrotliEncoderSetParameter(state, BROTLI_PARAM_QUALITY, (uint32_t)level);
+    BrotliEncoderSetParameter(state, BROTLI_PARAM_MODE, BROTLI_MODE_TEXT);
+
+    web_client_enable_encoder(w, WEB_RESPONSE_ENCODING_BROTLI, state);
+    return true;
+}
+#endif
+
+// true when the Accept-Encoding header lists the coding, without q=0
+static bool http_header_accepts_encoding(const char *v, const char *coding) {
+    size_t coding_len = strlen(coding);
+    const char *s = v;
+
+    while(*s) {
+        while(*s == ' ' || *s == '\t' || *s == ',') s++;
+
+        const char *token = s;
+        while(*s && *s != ',' && *s != ';' && *s != ' ' && *s != '\t') s++;
+        bool matches = ((size_t)(s - token) == coding_len && strncasecmp(token, coding, coding_len) == 0);
+
+        // the parameters of this coding
+        bool rejected = false;
+        while(*s && *s != ',') {
+            if(*s == ';') {
+                s++;
+                while(*s == ' ' || *s == '\t') s++;
+
+                if((*s == 'q' || *s == 'Q') && s[1] == '=')
+                    rejected = (strtod(&s[2], NULL) <= 0.0);
+
+                continue;
+            }
+            s++;
+        }
+
+        if(matches && !rejected)
+            return true;
+    }
+
+    return false;
+}
+
 static void http_header_origin(struct web_client *w, const char *v, size_t len __maybe_unused) {
     freez(w->origin);
     w->origin = strdupz(v);
@@ -91,8 +223,29 @@ static void http_header_host(struct web_client *w, const char *v, size_t len) {
 }
 
 static void http_header_accept_encoding(struct web_client *w, const char *v, size_t len __maybe_unused) {
+    // remember all the accepted encodings, for the precompressed static files
+    if(web_enable_gzip && http_header_accepts_encoding(v, "gzip"))
+        web_client_flag_set(w, WEB_CLIENT_ENCODING_GZIP);
+
+#ifdef ENABLE_BROTLI
+    if(web_enable_brotli && http_header_accepts_encoding(v, "br"))
+        web_client_flag_set(w, WEB_CLIENT_ENCODING_BROTLI);
+#endif
+
+    // prefer the encodings that compress JSON better, at a lower CPU cost
+
+#ifdef ENABLE_ZSTD
+    if(web_enable_zstd && http_header_accepts_encoding(v, "zstd") && web_client_enable_zstd(w))
+        return;
+#endif
+
+#ifdef ENABLE_BROTLI
+    if(web_enable_brotli && http_header_accepts_encoding(v, "br") && web_client_enable_brotli(w))
+        return;
+#endif
+
     if(web_enable_gzip) {
-        if(strcasestr(v, "gzip"))
+        if(http_header_accepts_encoding(v, "gzip"))
             web_client_enable_deflate(w, true);
 
         // does not seem to work
@@ -101,6 +254,11 @@ static void http_header_accept_encoding(struct web_client *w, const char *v, siz
     }
 }
 
+static void http_header_if_none_match(struct web_client *w, const char *v, size_t len __maybe_unused) {
+    freez(w->if_none_match);
+    w->if_none_match = strdupz(v);
+}
+
 static void http_header_x_forwarded_host(struct web_client *w, const char *v, size_t len) {
     char buffer[NI_MAXHOST];
     strncpyz(buffer, v, (len < sizeof(buffer) - 1 ? len : sizeof(buffer) - 1));
@@ -187,6 +345,7 @@ struct {
     { .hash = 0, .key = "X-Auth-Token",          .cb = http_header_x_auth_token },
     { .hash = 0, .key = "Host",                  .cb = http_header_host },
     { .hash = 0, .key = "Accept-Encoding",       .cb = http_header_accept_encoding },
+    { .hash = 0, .key = "If-None-Match",         .cb = http_header_if_none_match },
     { .hash = 0, .key = "X-Forwarded-Host",      .cb = http_header_x_forwarded_host },
     { .hash = 0, .key = "X-Forwarded-For",       .cb = http_header_x_forwarded_for },
     { .hash = 0, .key = "X-Transaction-Id",      .cb = http_header_x_transaction_id },
@@ -48,6 +48,7 @@ static struct {
     , {"minify"            , 0    , RRDR_OPTION_MINIFY}
     , {"group-by-labels"   , 0    , RRDR_OPTION_GROUP_BY_LABELS}
     , {"label-quotes"      , 0    , RRDR_OPTION_LABEL_QUOTES}
+    , {"fixed-precision"   , 0    , RRDR_OPTION_FIXED_PRECISION}
     , {NULL                , 0    , 0}
 };
 
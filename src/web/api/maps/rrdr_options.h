@@ -36,6 +36,7 @@ typedef enum rrdr_options {
     RRDR_OPTION_DEBUG           = (1 << 27), // v2 returns request description
     RRDR_OPTION_MINIFY          = (1 << 28), // remove JSON spaces and newlines from JSON output
     RRDR_OPTION_GROUP_BY_LABELS = (1 << 29), // v2 returns flattened labels per dimension of the chart
+    RRDR_OPTION_FIXED_PRECISION = (1 << 30), // print values with up to 7 fractional digits, instead of the shortest round-trip string
 
     // internal ones - not to be exposed to the API
     RRDR_OPTION_INTERNAL_AR              = (1 << 31), // internal use only, to let the formatters know we want to render the anomaly rate
@@ -57,6 +57,9 @@ static struct {
     NETDATA_DOUBLE (*flush)(struct rrdresult *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr);
 
     TIER_QUERY_FETCH tier_query_fetch;
+
+    // the time-grouping sorts its values, so it can use TIER_QUERY_FETCH_DISTRIBUTION when the query asks for it
+    bool tier_distribution;
 } api_v1_data_groups[] = {
         {.name = "average",
                 .hash  = 0,
@@ -104,7 +107,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean2",
                 .hash  = 0,
@@ -116,7 +120,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean3",
                 .hash  = 0,
@@ -128,7 +133,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean5",
                 .hash  = 0,
@@ -140,7 +146,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean10",
                 .hash  = 0,
@@ -152,7 +159,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean15",
                 .hash  = 0,
@@ -164,7 +172,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean20",
                 .hash  = 0,
@@ -176,7 +185,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean25",
                 .hash  = 0,
@@ -188,7 +198,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-mean",
                 .hash  = 0,
@@ -200,7 +211,8 @@ static struct {
                 .free  = tg_trimmed_mean_free,
                 .add   = tg_trimmed_mean_add,
                 .flush = tg_trimmed_mean_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name  = "incremental_sum",
                 .hash  = 0,
@@ -236,7 +248,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median1",
                 .hash  = 0,
@@ -248,7 +261,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median2",
                 .hash  = 0,
@@ -260,7 +274,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median3",
                 .hash  = 0,
@@ -272,7 +287,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median5",
                 .hash  = 0,
@@ -284,7 +300,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median10",
                 .hash  = 0,
@@ -296,7 +313,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median15",
                 .hash  = 0,
@@ -308,7 +326,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median20",
                 .hash  = 0,
@@ -320,7 +339,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median25",
                 .hash  = 0,
@@ -332,7 +352,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "trimmed-median",
                 .hash  = 0,
@@ -344,7 +365,8 @@ static struct {
                 .free  = tg_median_free,
                 .add   = tg_median_add,
                 .flush = tg_median_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile25",
                 .hash  = 0,
@@ -356,7 +378,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile50",
                 .hash  = 0,
@@ -368,7 +391,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile75",
                 .hash  = 0,
@@ -380,7 +404,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile80",
                 .hash  = 0,
@@ -392,7 +417,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile90",
                 .hash  = 0,
@@ -404,7 +430,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile95",
                 .hash  = 0,
@@ -416,7 +443,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile97",
                 .hash  = 0,
@@ -428,7 +456,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile98",
                 .hash  = 0,
@@ -440,7 +469,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile99",
                 .hash  = 0,
@@ -452,7 +482,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "percentile",
                 .hash  = 0,
@@ -464,7 +495,8 @@ static struct {
                 .free  = tg_percentile_free,
                 .add   = tg_percentile_add,
                 .flush = tg_percentile_flush,
-                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE
+                .tier_query_fetch = TIER_QUERY_FETCH_AVERAGE,
+                .tier_distribution = true
         },
         {.name = "min",
                 .hash  = 0,
@@ -676,7 +708,7 @@ const char *time_grouping_tostring(RRDR_TIME_GROUPING group) {
     return "unknown";
 }
 
-static void rrdr_set_grouping_function(RRDR *r, RRDR_TIME_GROUPING group_method) {
+static void rrdr_set_grouping_function(RRDR *r, RRDR_TIME_GROUPING group_method, bool tier_distribution) {
     int i, found = 0;
     for(i = 0; !found && api_v1_data_groups[i].name ;i++) {
         if(api_v1_data_groups[i].value == group_method) {
@@ -685,7 +717,8 @@ static void rrdr_set_grouping_function(RRDR *r, RRDR_TIME_GROUPING group_method)
             r->time_grouping.free    = api_v1_data_groups[i].free;
             r->time_grouping.add     = api_v1_data_groups[i].add;
             r->time_grouping.flush   = api_v1_data_groups[i].flush;
-            r->time_grouping.tier_query_fetch = api_v1_data_groups[i].tier_query_fetch;
+            r->time_grouping.tier_query_fetch = (tier_distribution && api_v1_data_groups[i].tier_distribution) ?
+                                                TIER_QUERY_FETCH_DISTRIBUTION : api_v1_data_groups[i].tier_query_fetch;
             r->time_grouping.add_flush = api_v1_data_groups[i].add_flush;
             found = 1;
         }
@@ -703,6 +736,37 @@ static void rrdr_set_grouping_function(RRDR *r, RRDR_TIME_GROUPING group_method)
     }
 }
 
+// "distribution" in the time-group options, alone or after the options of the time-grouping
+// (e.g. "95,distribution"), selects TIER_QUERY_FETCH_DISTRIBUTION for the time-groupings that
+// support it. The rest of the options are returned, for the time-grouping.
+#define TIME_GROUP_OPTION_TIER_DISTRIBUTION "distribution"
+
+static const char *time_group_options_parse(ONEWAYALLOC *owa, const char *options, bool *tier_distribution) {
+    *tier_distribution = false;
+
+    if(!options || !*options || !strstr(options, TIME_GROUP_OPTION_TIER_DISTRIBUTION))
+        return options;
+
+    char *s = onewayalloc_strdupz(owa, options);
+    char *rest = onewayalloc_mallocz(owa, strlen(options) + 1);
+    rest[0] = '\0';
+
+    char *token;
+    while((token = strsep(&s, ","))) {
+        if(strcmp(token, TIME_GROUP_OPTION_TIER_DISTRIBUTION) == 0)
+            *tier_distribution = true;
+
+        else if(*token) {
+            if(*rest)
+                strcat(rest, ",");
+
+            strcat(rest, token);
+        }
+    }
+
+    return rest;
+}
+
 static inline void time_grouping_add(RRDR *r, NETDATA_DOUBLE value, const RRDR_TIME_GROUPING add_flush) {
     switch(add_flush) {
         case RRDR_GROUPING_AVERAGE:
@@ -760,6 +824,42 @@ static inline void time_grouping_add(RRDR *r, NETDATA_DOUBLE value, const RRDR_T
     }
 }
 
+// A point of a higher tier summarizes many samples. With TIER_QUERY_FETCH_DISTRIBUTION, the
+// time-groupings that sort their values (median, percentile, trimmed-mean) get a few values for
+// it, instead of just its average. The samples are assumed to be spread evenly between the min
+// and the average, and between the average and the max, in the proportions that keep the
+// average of the point. The values added are the evenly spaced quantiles of this distribution,
+// so the min and the max of the point are never over-weighted.
+#define TIER_POINT_DISTRIBUTION_MAX_VALUES 16
+
+static inline void time_grouping_add_distribution(RRDR *r, STORAGE_POINT *sp, NETDATA_DOUBLE average, const RRDR_TIME_GROUPING add_flush) {
+    size_t values = MIN(sp->count, TIER_POINT_DISTRIBUTION_MAX_VALUES);
+
+    if(unlikely(sp->min >= sp->max || !netdata_double_isnumber(sp->min) || !netdata_double_isnumber(sp->max))) {
+        for(size_t i = 0; i < values ;i++)
+            time_grouping_add(r, average, add_flush);
+        return;
+    }
+
+    if(average < sp->min) average = sp->min;
+    if(average > sp->max) average = sp->max;
+
+    // the share of the samples that are below the average
+    NETDATA_DOUBLE below = (sp->max - average) / (sp->max - sp->min);
+
+    for(size_t i = 0; i < values ;i++) {
+        NETDATA_DOUBLE q = ((NETDATA_DOUBLE)i + 0.5) / (NETDATA_DOUBLE)values;
+
+        NETDATA_DOUBLE value;
+        if(q < below)
+            value = sp->min + (average - sp->min) * q / below;
+        else
+            value = average + (sp->max - average) * (q - below) / (1.0 - below);
+
+        time_grouping_add(r, value, add_flush);
+    }
+}
+
 static inline NETDATA_DOUBLE time_grouping_flush(RRDR *r, RRDR_VALUE_FLAGS *rrdr_value_options_ptr, const RRDR_TIME_GROUPING add_flush) {
     switch(add_flush) {
         case RRDR_GROUPING_AVERAGE:
@@ -1231,9 +1331,30 @@ static size_t query_planer_expand_duration_in_points(time_t this_update_every, t
     return points;
 }
 
+// min, max and sum give the same result when they are applied to pre-aggregated points,
+// so the storage engine may return one point for many, when they are all in the same group
+static bool query_planer_can_use_grouped_points(QUERY_ENGINE_OPS *ops) {
+    if(ops->r->internal.qt->window.options & (RRDR_OPTION_ABSOLUTE | RRDR_OPTION_ANOMALY_BIT))
+        return false;
+
+    switch(ops->r->time_grouping.add_flush) {
+        case RRDR_GROUPING_MIN:
+        case RRDR_GROUPING_MAX:
+        case RRDR_GROUPING_SUM:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
 static void query_planer_initialize_plans(QUERY_ENGINE_OPS *ops) {
     QUERY_METRIC *qm = ops->qm;
 
+    // the groups of the query, as the main loop of rrd2rrdr_query_execute() iterates them
+    time_t group_anchor_s = ops->r->internal.qt->window.after - ops->query_granularity;
+    time_t group_every_s = query_planer_can_use_grouped_points(ops) ? ops->view_update_every : 0;
+
     for(size_t p = 0; p < qm->plan.used ; p++) {
         size_t tier = qm->plan.array[p].tier;
         time_t update_every = qm->tiers[tier].db_update_every_s;
@@ -1272,8 +1393,9 @@ static void query_planer_initialize_plans(QUERY_ENGINE_OPS *ops) {
 
         struct query_metric_tier *tier_ptr = &qm->tiers[tier];
         STORAGE_ENGINE *eng = query_metric_storage_engine(ops->r->internal.qt, qm, tier);
-        storage_engine_query_init(eng->seb, tier_ptr->smh, &ops->plans[p].handle,
-                after, before, ops->r->internal.qt->request.priority);
+        storage_engine_query_init_grouped(eng->seb, tier_ptr->smh, &ops->plans[p].handle,
+                after, before, ops->r->internal.qt->request.priority,
+                group_anchor_s, group_every_s);
 
         ops->plans[p].initialized = true;
         ops->plans[p].finalized = false;
@@ -1515,7 +1637,10 @@ static bool query_plan(QUERY_ENGINE_OPS *ops, time_t after_wanted, time_t before
         if(unlikely((point).sp.flags & SN_FLAG_RESET))                  \
             (ops)->group_value_flags |= RRDR_VALUE_RESET;               \
                                                                         \
-        time_grouping_add(r, (point).value, add_flush);                 \
+        if(unlikely((ops)->tier_query_fetch == TIER_QUERY_FETCH_DISTRIBUTION && (point).sp.count > 1)) \
+            time_grouping_add_distribution(r, &(point).sp, (point).value, add_flush); \
+        else                                                            \
+            time_grouping_add(r, (point).value, add_flush);             \
                                                                         \
         storage_point_merge_to((ops)->group_point, (point).sp);         \
         if(!(point).added)                                              \
@@ -1564,7 +1689,8 @@ static QUERY_ENGINE_OPS *rrd2rrdr_query_ops_prep(RRDR *r, size_t query_metric_id
     *ops = (QUERY_ENGINE_OPS) {
             .r = r,
             .qm = query_metric(qt, query_metric_id),
-            .tier_query_fetch = r->time_grouping.tier_query_fetch,
+            .tier_query_fetch = (r->time_grouping.tier_query_fetch == TIER_QUERY_FETCH_DISTRIBUTION && (qt->window.options & RRDR_OPTION_ANOMALY_BIT)) ?
+                                TIER_QUERY_FETCH_AVERAGE : r->time_grouping.tier_query_fetch,
             .view_update_every = r->view.update_every,
             .query_granularity = (time_t)(r->view.update_every / r->view.group),
             .group_value_flags = RRDR_VALUE_NOTHING,
@@ -1720,6 +1846,7 @@ static void rrd2rrdr_query_execute(RRDR *r, size_t dim_id_in_rrdr, QUERY_ENGINE_
                         switch (ops->tier_query_fetch) {
                             default:
                             case TIER_QUERY_FETCH_AVERAGE:
+                            case TIER_QUERY_FETCH_DISTRIBUTION:
                                 new_point.value = sp.sum / (NETDATA_DOUBLE)sp.count;
                                 break;
 
@@ -3470,10 +3597,12 @@ RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
 
     // -------------------------------------------------------------------------
     // assign the processor functions
-    rrdr_set_grouping_function(r_tmp, qt->window.time_group_method);
+    bool tier_distribution;
+    const char *time_group_options = time_group_options_parse(r_tmp->internal.owa, qt->window.time_group_options, &tier_distribution);
+    rrdr_set_grouping_function(r_tmp, qt->window.time_group_method, tier_distribution);
 
     // allocate any memory required by the grouping method
-    r_tmp->time_grouping.create(r_tmp, qt->window.time_group_options);
+    r_tmp->time_grouping.create(r_tmp, time_group_options);
 
     // -------------------------------------------------------------------------
     // do the work for each dimension
@@ -3734,3 +3863,112 @@ RRDR *rrd2rrdr(ONEWAYALLOC *owa, QUERY_TARGET *qt) {
 
     return r;
 }
+
+// ----------------------------------------------------------------------------
+// unittest
+
+#define TIER_DISTRIBUTION_UNITTEST_SAMPLES 6000
+#define TIER_DISTRIBUTION_UNITTEST_SAMPLES_PER_POINT 60
+
+static NETDATA_DOUBLE tier_distribution_unittest_sample(size_t dataset, size_t i) {
+    switch(dataset) {
+        default:
+        case 0:
+            // uniform, 0 to 999
+            return (NETDATA_DOUBLE)((i * 379) % 1000);
+
+        case 1: {
+            // exponential, with an average of 100
+            double u = (double)i * 0.6180339887;
+            u -= floor(u);
+            return (NETDATA_DOUBLE)(-log(1.0 - u) * 100.0);
+        }
+
+        case 2:
+            // points alternating between 10-20 and 100-200
+            if((i / TIER_DISTRIBUTION_UNITTEST_SAMPLES_PER_POINT) % 2)
+                return (NETDATA_DOUBLE)(100 + (i * 7) % 11 * 10);
+
+            return (NETDATA_DOUBLE)(10 + (i * 7) % 11);
+    }
+}
+
+// the time-grouping of all the samples, of all the averages of the tier points,
+// or of the distributions of the tier points
+enum tier_distribution_unittest_input {
+    TIER_DISTRIBUTION_UNITTEST_SAMPLES_ALL,
+    TIER_DISTRIBUTION_UNITTEST_AVERAGES,
+    TIER_DISTRIBUTION_UNITTEST_DISTRIBUTIONS,
+};
+
+static NETDATA_DOUBLE tier_distribution_unittest_query(size_t dataset, RRDR_TIME_GROUPING group_method, enum tier_distribution_unittest_input input) {
+    ONEWAYALLOC *owa = onewayalloc_create(0);
+    RRDR r = {
+        .view.group = TIER_DISTRIBUTION_UNITTEST_SAMPLES,
+        .internal.owa = owa,
+    };
+
+    rrdr_set_grouping_function(&r, group_method, true);
+    r.time_grouping.create(&r, NULL);
+
+    for(size_t p = 0; p < TIER_DISTRIBUTION_UNITTEST_SAMPLES / TIER_DISTRIBUTION_UNITTEST_SAMPLES_PER_POINT; p++) {
+        STORAGE_POINT sp = STORAGE_POINT_UNSET;
+
+        for(size_t i = 0; i < TIER_DISTRIBUTION_UNITTEST_SAMPLES_PER_POINT; i++) {
+            NETDATA_DOUBLE n = tier_distribution_unittest_sample(dataset, p * TIER_DISTRIBUTION_UNITTEST_SAMPLES_PER_POINT + i);
+
+            if(input == TIER_DISTRIBUTION_UNITTEST_SAMPLES_ALL)
+                time_grouping_add(&r, n, r.time_grouping.add_flush);
+
+            STORAGE_POINT t = { .min = n, .max = n, .sum = n, .count = 1, .flags = SN_FLAG_NONE };
+            storage_point_merge_to(sp, t);
+        }
+
+        NETDATA_DOUBLE average = sp.sum / (NETDATA_DOUBLE)sp.count;
+
+        if(input == TIER_DISTRIBUTION_UNITTEST_AVERAGES)
+            time_grouping_add(&r, average, r.time_grouping.add_flush);
+
+        else if(input == TIER_DISTRIBUTION_UNITTEST_DISTRIBUTIONS)
+            time_grouping_add_distribution(&r, &sp, average, r.time_grouping.add_flush);
+    }
+
+    RRDR_VALUE_FLAGS flags = RRDR_VALUE_NOTHING;
+    NETDATA_DOUBLE value = time_grouping_flush(&r, &flags, r.time_grouping.add_flush);
+
+    r.time_grouping.free(&r);
+    onewayalloc_destroy(owa);
+    return value;
+}
+
+int tier_distribution_unittest(void) {
+    const char *datasets[] = { "uniform", "exponential", "alternating" };
+    RRDR_TIME_GROUPING methods[] = {
+        RRDR_GROUPING_MEDIAN,
+        RRDR_GROUPING_PERCENTILE50,
+        RRDR_GROUPING_PERCENTILE,
+        RRDR_GROUPING_TRIMMED_MEAN,
+    };
+
+    int errors = 0;
+    for(size_t d = 0; d < sizeof(datasets) / sizeof(datasets[0]); d++) {
+        for(size_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+            NETDATA_DOUBLE expected = tier_distribution_unittest_query(d, methods[m], TIER_DISTRIBUTION_UNITTEST_SAMPLES_ALL);
+            NETDATA_DOUBLE averages = tier_distribution_unittest_query(d, methods[m], TIER_DISTRIBUTION_UNITTEST_AVERAGES);
+            NETDATA_DOUBLE distributions = tier_distribution_unittest_query(d, methods[m], TIER_DISTRIBUTION_UNITTEST_DISTRIBUTIONS);
+
+            // within 10% of the time-grouping of all the samples
+            bool ok = fabsndd(distributions - expected) <= fabsndd(expected) * 0.1;
+
+            fprintf(stderr, "%s %s: samples " NETDATA_DOUBLE_FORMAT ", tier distributions " NETDATA_DOUBLE_FORMAT
+                            ", tier averages " NETDATA_DOUBLE_FORMAT " ... %s\n",
+                    datasets[d], time_grouping_id2txt(methods[m]), expected, distributions, averages,
+                    ok ? "OK" : "FAILED");
+
+            if(!ok)
+                errors++;
+        }
+    }
+
+    return errors;
+}
@@ -14,7 +14,8 @@ typedef enum tier_query_fetch {
     TIER_QUERY_FETCH_SUM,
     TIER_QUERY_FETCH_MIN,
     TIER_QUERY_FETCH_MAX,
-    TIER_QUERY_FETCH_AVERAGE
+    TIER_QUERY_FETCH_AVERAGE,
+    TIER_QUERY_FETCH_DISTRIBUTION,      // the average, and values spread between the min and the max of tier points for sorting
 } TIER_QUERY_FETCH;
 
 typedef enum __attribute__ ((__packed__)) rrdr_value_flag {
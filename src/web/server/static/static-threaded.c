@@ -159,7 +159,7 @@ static int web_server_file_read_callback(POLLINFO *pi, short int *events) {
         POLLINFO *wpi = pollinfo_from_slot(p, w->pollinfo_slot);  // POLLINFO of the client socket
 
         netdata_log_debug(D_WEB_CLIENT, "%llu: SIGNALING W TO SEND (iFD %d, oFD %d)", w->id, pi->fd, wpi->fd);
-        p->fds[wpi->slot].events |= POLLOUT;
+        poll_fd_events_add(wpi, POLLOUT);
     }
 
     if(unlikely(ret <= 0 || w->ifd == w->ofd)) {
@@ -1,6 +1,15 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "web_client.h"
+#include "web_static_cache.h"
+
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef ENABLE_BROTLI
+#include <brotli/encode.h>
+#endif
 
 // this is an async I/O implementation of the web server request parser
 // it is used by all netdata web servers
@@ -9,6 +18,56 @@ int respect_web_browser_do_not_track_policy = 0;
 char *web_x_frame_options = NULL;
 
 int web_enable_gzip = 1, web_gzip_level = 3, web_gzip_strategy = Z_DEFAULT_STRATEGY;
+int web_enable_zstd = 1, web_zstd_level = 3;
+int web_enable_brotli = 1, web_brotli_level = 3;
+
+static struct web_response_compression_statistics web_response_compression_statistics = { 0 };
+
+const char *web_response_encoding_name(WEB_RESPONSE_ENCODING encoding) {
+    switch(encoding) {
+        default:
+        case WEB_RESPONSE_ENCODING_GZIP:
+            return "gzip";
+
+        case WEB_RESPONSE_ENCODING_ZSTD:
+            return "zstd";
+
+        case WEB_RESPONSE_ENCODING_BROTLI:
+            return "br";
+    }
+}
+
+void web_response_compression_statistics_get(struct web_response_compression_statistics *stats) {
+    for(size_t i = 0; i < WEB_RESPONSE_ENCODING_MAX ;i++) {
+        stats->encodings[i].responses = __atomic_load_n(&web_response_compression_statistics.encodings[i].responses, __ATOMIC_RELAXED);
+        stats->encodings[i].bytes_in = __atomic_load_n(&web_response_compression_statistics.encodings[i].bytes_in, __ATOMIC_RELAXED);
+        stats->encodings[i].bytes_out = __atomic_load_n(&web_response_compression_statistics.encodings[i].bytes_out, __ATOMIC_RELAXED);
+        stats->encodings[i].cpu_ut = __atomic_load_n(&web_response_compression_statistics.encodings[i].cpu_ut, __ATOMIC_RELAXED);
+    }
+}
+
+static inline size_t web_client_compressed_bytes(struct web_client *w) {
+    if(w->response.zencoding == WEB_RESPONSE_ENCODING_GZIP)
+        return (size_t)w->response.zstream.total_out;
+
+    return w->response.ztotal_out;
+}
+
+static inline size_t web_client_compressed_input_bytes(struct web_client *w) {
+    if(w->response.zencoding == WEB_RESPONSE_ENCODING_GZIP)
+        return (size_t)w->response.zstream.total_in;
+
+    return w->response.zin_offset;
+}
+
+static void web_client_compression_statistics_update(struct web_client *w) {
+    size_t e = (w->response.zencoding < WEB_RESPONSE_ENCODING_MAX) ? w->response.zencoding : WEB_RESPONSE_ENCODING_GZIP;
+
+    __atomic_add_fetch(&web_response_compression_statistics.encodings[e].responses, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&web_response_compression_statistics.encodings[e].bytes_in, web_client_compressed_input_bytes(w), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&web_response_compression_statistics.encodings[e].bytes_out, web_client_compressed_bytes(w), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&web_response_compression_statistics.encodings[e].cpu_ut, w->response.zcpu_ut, __ATOMIC_RELAXED);
+}
 
 void web_client_set_conn_tcp(struct web_client *w) {
     web_client_flags_clear_conn(w);
@@ -196,9 +255,44 @@ static void web_client_reset_allocations(struct web_client *w, bool free_all) {
     freez(w->auth_bearer_token);
     w->auth_bearer_token = NULL;
 
+    freez(w->if_none_match);
+    w->if_none_match = NULL;
+
+    if(w->response.sendfile) {
+        close(w->response.sendfile_fd);
+        w->response.sendfile_fd = -1;
+        w->response.sendfile = false;
+    }
+
     // if we had enabled compression, release it
     if(w->response.zinitialized) {
-        deflateEnd(&w->response.zstream);
+        switch(w->response.zencoding) {
+            default:
+            case WEB_RESPONSE_ENCODING_GZIP:
+                deflateEnd(&w->response.zstream);
+                break;
+
+#ifdef ENABLE_ZSTD
+            case WEB_RESPONSE_ENCODING_ZSTD:
+                ZSTD_freeCCtx(w->response.zencoder);
+                break;
+#endif
+
+#ifdef ENABLE_BROTLI
+            case WEB_RESPONSE_ENCODING_BROTLI:
+                BrotliEncoderDestroyInstance(w->response.zencoder);
+                break;
+#endif
+        }
+
+        w->response.zencoding = WEB_RESPONSE_ENCODING_GZIP;
+        w->response.zencoder = NULL;
+        w->response.zin_offset = 0;
+        w->response.zin_end = 0;
+        w->response.zflushing = false;
+        w->response.zpending = false;
+        w->response.ztotal_out = 0;
+        w->response.zcpu_ut = 0;
         w->response.zsent = 0;
         w->response.zhave = 0;
         w->response.zstream.avail_in = 0;
@@ -213,7 +307,7 @@ static void web_client_reset_allocations(struct web_client *w, bool free_all) {
     memset(&w->auth, 0, sizeof(w->auth));
 
     web_client_reset_permissions(w);
-    web_client_flag_clear(w, WEB_CLIENT_ENCODING_GZIP|WEB_CLIENT_ENCODING_DEFLATE);
+    web_client_flag_clear(w, WEB_CLIENT_ENCODINGS);
     web_client_reset_path_flags(w);
 }
 
@@ -221,16 +315,20 @@ void web_client_log_completed_request(struct web_client *w, bool update_web_stat
     struct timeval tv;
     now_monotonic_high_precision_timeval(&tv);
 
-    size_t size = (w->mode == HTTP_REQUEST_MODE_FILECOPY) ? w->response.rlen : w->response.data->len;
-    size_t sent = w->response.zoutput ? (size_t)w->response.zstream.total_out : size;
+    size_t size = (w->mode == HTTP_REQUEST_MODE_FILECOPY || w->response.sendfile) ? w->response.rlen : w->response.data->len;
+    size_t sent = w->response.zoutput ? web_client_compressed_bytes(w) : size;
 
-    if(update_web_stats)
+    if(update_web_stats) {
         global_statistics_web_request_completed(dt_usec(&tv, &w->timings.tv_in),
                                                 w->statistics.received_bytes,
                                                 w->statistics.sent_bytes,
                                                 size,
                                                 sent);
 
+        if(w->response.zoutput)
+            web_client_compression_statistics_update(w);
+    }
+
     usec_t prep_ut = w->timings.tv_ready.tv_sec ? dt_usec(&w->timings.tv_ready, &w->timings.tv_in) : 0;
     usec_t sent_ut = w->timings.tv_ready.tv_sec ? dt_usec(&tv, &w->timings.tv_ready) : 0;
     usec_t total_ut = dt_usec(&tv, &w->timings.tv_in);
@@ -468,6 +566,102 @@ static bool find_filename_to_serve(const char *filename, char *dst, size_t dst_l
     return true;
 }
 
+static void web_client_disable_compression(struct web_client *w) {
+    w->response.zoutput = false;
+    web_client_flag_clear(w, WEB_CLIENT_CHUNKED_TRANSFER);
+}
+
+// true when the If-None-Match header has the etag, or it is *
+static bool web_client_etag_matches(const char *if_none_match, const char *etag) {
+    size_t etag_len = strlen(etag);
+
+    for(const char *s = if_none_match; *s ;) {
+        while(*s == ' ' || *s == '\t' || *s == ',') s++;
+
+        if(*s == '*')
+            return true;
+
+        // weak validators compare equal too
+        if(s[0] == 'W' && s[1] == '/')
+            s += 2;
+
+        if(*s == '"') {
+            s++;
+            if(strncmp(s, etag, etag_len) == 0 && s[etag_len] == '"')
+                return true;
+        }
+
+        while(*s && *s != ',') s++;
+    }
+
+    return false;
+}
+
+static int web_client_send_cached_file(struct web_client *w, WEB_STATIC_FILE *f) {
+    w->response.data->content_type = f->content_type;
+    w->response.data->date = f->mtime;
+    buffer_cacheable(w->response.data);
+    buffer_flush(w->response.data);
+
+    const uint8_t *data = f->data;
+    size_t size = f->size;
+    bool vary = false;
+    int encoding = -1;
+
+    if(web_client_check_conn_tcp(w) || web_client_check_conn_unix(w)) {
+        // the precompressed variants, in the order the streaming encoders are preferred
+        static const struct {
+            WEB_CLIENT_FLAGS flag;
+            WEB_RESPONSE_ENCODING encoding;
+        } encodings[] = {
+            { .flag = WEB_CLIENT_ENCODING_ZSTD,   .encoding = WEB_RESPONSE_ENCODING_ZSTD },
+            { .flag = WEB_CLIENT_ENCODING_BROTLI, .encoding = WEB_RESPONSE_ENCODING_BROTLI },
+            { .flag = WEB_CLIENT_ENCODING_GZIP,   .encoding = WEB_RESPONSE_ENCODING_GZIP },
+        };
+
+        for(size_t i = 0; i < sizeof(encodings) / sizeof(encodings[0]) ;i++) {
+            if(web_client_flag_check(w, encodings[i].flag) && f->variants[encodings[i].encoding].data) {
+                encoding = encodings[i].encoding;
+                data = f->variants[encoding].data;
+                size = f->variants[encoding].size;
+                break;
+            }
+        }
+
+        vary = true;
+
+        // the file is either precompressed, or it does not compress
+        web_client_disable_compression(w);
+    }
+
+    // each content-coding is a different representation, with its own strong ETag
+    char etag[sizeof(f->etag) + 20];
+    if(encoding != -1)
+        snprintfz(etag, sizeof(etag) - 1, "%s-%s", f->etag, web_response_encoding_name(encoding));
+    else
+        strncpyz(etag, f->etag, sizeof(etag) - 1);
+
+    buffer_sprintf(w->response.header, "ETag: \"%s\"\r\n", etag);
+
+    if(vary)
+        buffer_strcat(w->response.header, "Vary: Accept-Encoding\r\n");
+
+    if(w->if_none_match && web_client_etag_matches(w->if_none_match, etag)) {
+        web_static_cache_count_not_modified();
+        web_client_disable_compression(w);
+        return HTTP_RESP_NOT_MODIFIED;
+    }
+
+    if(encoding != -1)
+        buffer_sprintf(w->response.header, "Content-Encoding: %s\r\n", web_response_encoding_name(encoding));
+
+    buffer_need_bytes(w->response.data, size);
+    memcpy(w->response.data->buffer, data, size);
+    w->response.data->len = size;
+
+    return HTTP_RESP_OK;
+}
+
 static int mysendfile(struct web_client *w, char *filename) {
     netdata_log_debug(D_WEB_CLIENT, "%llu: Looking for file '%s/%s'", w->id, netdata_configured_web_dir, filename);
 
@@ -512,6 +706,41 @@ static int mysendfile(struct web_client *w, char *filename) {
     if(is_dir && !web_client_flag_check(w, WEB_CLIENT_FLAG_PATH_HAS_TRAILING_SLASH))
         return append_slash_to_url_and_redirect(w);
 
+    // serve it from memory, when it is cached
+    WEB_STATIC_FILE *f = NULL;
+    const DICTIONARY_ITEM *item = web_static_cache_acquire(web_filename, &statbuf, &f);
+    if(item) {
+        int code = web_client_send_cached_file(w, f);
+        web_static_cache_release(item);
+        return code;
+    }
+
+#ifdef HAVE_SYS_SENDFILE_H
+    // the kernel copies the file to the socket, when it does not have to be compressed
+    if(!w->response.zoutput && !SSL_connection(&w->ssl) && (web_client_check_conn_tcp(w) || web_client_check_conn_unix(w))) {
+        int fd = open(web_filename, O_RDONLY | O_CLOEXEC);
+        if(fd != -1) {
+            w->response.sendfile = true;
+            w->response.sendfile_fd = fd;
+
+            w->response.data->content_type = contenttype_for_filename(web_filename);
+            netdata_log_debug(D_WEB_CLIENT_ACCESS, "%llu: Sending file '%s' (%"PRId64" bytes) with sendfile().", w->id, web_filename, (int64_t)statbuf.st_size);
+
+            buffer_flush(w->response.data);
+            w->response.rlen = (size_t)statbuf.st_size;
+#ifdef __APPLE__
+            w->response.data->date = statbuf.st_mtimespec.tv_sec;
+#else
+            w->response.data->date = statbuf.st_mtim.tv_sec;
+#endif
+            buffer_cacheable(w->response.data);
+
+            web_static_cache_count_sendfile();
+            return HTTP_RESP_OK;
+        }
+    }
+#endif
+
     // open the file
     w->ifd = open(web_filename, O_NONBLOCK, O_RDONLY | O_CLOEXEC);
     if(w->ifd == -1) {
@@ -554,6 +783,183 @@ static int mysendfile(struct web_client *w, char *filename) {
 
     return HTTP_RESP_OK;
 }
+
+// ----------------------------------------------------------------------------
+// unittest for serving static files
+
+#define WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE (64 * 1024)
+
+static void web_client_static_files_unittest_contents(char *buf, size_t size) {
+    for(size_t i = 0; i < size ;i++)
+        buf[i] = "0123456789abcdef\n"[(i / 7) % 17];
+}
+
+static void web_client_static_files_unittest_write(const char *dir, const char *name, size_t size) {
+    char path[FILENAME_MAX + 1];
+    snprintfz(path, sizeof(path) - 1, "%s/%s", dir, name);
+
+    char *buf = mallocz(size);
+    web_client_static_files_unittest_contents(buf, size);
+
+    FILE *fp = fopen(path, "w");
+    if(!fp || fwrite(buf, 1, size, fp) != size)
+        fatal("WEB CLIENT: cannot write '%s'", path);
+
+    fclose(fp);
+    freez(buf);
+}
+
+static void web_client_static_files_unittest_reset(struct web_client *w, WEB_CLIENT_FLAGS encoding, const char *if_none_match) {
+    buffer_flush(w->response.header);
+    buffer_flush(w->response.data);
+
+    freez(w->if_none_match);
+    w->if_none_match = if_none_match ? strdupz(if_none_match) : NULL;
+
+    web_client_flag_clear(w, WEB_CLIENT_ENCODING_GZIP | WEB_CLIENT_ENCODING_ZSTD | WEB_CLIENT_ENCODING_BROTLI);
+    web_client_flag_set(w, encoding);
+}
+
+// copies the ETag of the response, with its quotes
+static bool web_client_static_files_unittest_etag(struct web_client *w, char *dst, size_t size) {
+    const char *s = strstr(buffer_tostring(w->response.header), "ETag: ");
+    if(!s)
+        return false;
+
+    s += strlen("ETag: ");
+    const char *e = strchr(s, '\r');
+    if(!e || (size_t)(e - s) >= size)
+        return false;
+
+    strncpyz(dst, s, e - s);
+    return true;
+}
+
+int web_client_static_files_unittest(void) {
+    int errors = 0;
+
+    char dir[] = "/tmp/netdata-web-client-unittest-XXXXXX";
+    if(!mkdtemp(dir))
+        fatal("WEB CLIENT: cannot create a temporary directory");
+
+    char *web_dir = netdata_configured_web_dir;
+    netdata_configured_web_dir = dir;
+
+    bool cache_enabled = web_static_cache_enabled;
+    size_t cache_max_file_size = web_static_cache_max_file_size;
+    web_static_cache_enabled = true;
+    web_static_cache_max_file_size = WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE;
+
+    web_client_static_files_unittest_write(dir, "cached.js", WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE);
+    web_client_static_files_unittest_write(dir, "large.js", 4 * WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE);
+
+    size_t memory = 0;
+    struct web_client *w = web_client_create(&memory);
+    w->acl = HTTP_ACL_DASHBOARD;
+    web_client_set_conn_tcp(w);
+
+    // a cached file, in its gzip variant
+    char etag_gzip[100] = "", etag_identity[100] = "";
+    web_client_static_files_unittest_reset(w, WEB_CLIENT_ENCODING_GZIP, NULL);
+    int code = mysendfile(w, "cached.js");
+    if(code != HTTP_RESP_OK || w->response.data->len >= WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE ||
+        !strstr(buffer_tostring(w->response.header), "Content-Encoding: gzip\r\n") ||
+        !web_client_static_files_unittest_etag(w, etag_gzip, sizeof(etag_gzip)) || !strstr(etag_gzip, "-gzip\"")) {
+        fprintf(stderr, "WEB CLIENT: the gzip variant of the cached file has not been sent (code %d, headers:\n%s)\n",
+                code, buffer_tostring(w->response.header));
+        errors++;
+    }
+
+    // the same representation is not modified
+    web_client_static_files_unittest_reset(w, WEB_CLIENT_ENCODING_GZIP, etag_gzip);
+    code = mysendfile(w, "cached.js");
+    if(code != HTTP_RESP_NOT_MODIFIED) {
+        fprintf(stderr, "WEB CLIENT: the ETag %s of the gzip variant did not match (code %d)\n", etag_gzip, code);
+        errors++;
+    }
+
+    // the uncompressed file is another representation, with another ETag
+    web_client_static_files_unittest_reset(w, 0, etag_gzip);
+    code = mysendfile(w, "cached.js");
+    if(code != HTTP_RESP_OK || w->response.data->len != WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE ||
+        strstr(buffer_tostring(w->response.header), "Content-Encoding:") ||
+        !web_client_static_files_unittest_etag(w, etag_identity, sizeof(etag_identity)) ||
+        strcmp(etag_identity, etag_gzip) == 0) {
+        fprintf(stderr, "WEB CLIENT: the uncompressed cached file has not been sent with its own ETag (code %d, headers:\n%s)\n",
+                code, buffer_tostring(w->response.header));
+        errors++;
+    }
+    else {
+        char *expected = mallocz(WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE);
+        web_client_static_files_unittest_contents(expected, WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE);
+        if(memcmp(w->response.data->buffer, expected, WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE) != 0) {
+            fprintf(stderr, "WEB CLIENT: the cached file has been sent with the wrong contents\n");
+            errors++;
+        }
+        freez(expected);
+    }
+
+#ifdef HAVE_SYS_SENDFILE_H
+    // files not cached are copied by the kernel
+    web_client_static_files_unittest_reset(w, 0, NULL);
+    code = mysendfile(w, "large.js");
+    if(code != HTTP_RESP_OK || !w->response.sendfile || w->response.rlen != 4 * WEB_CLIENT_STATIC_FILES_UNITTEST_SIZE) {
+        fprintf(stderr, "WEB CLIENT: the large file is not sent with sendfile() (code %d)\n", code);
+        errors++;
+    }
+    else {
+        int sv[2];
+        if(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+            fatal("WEB CLIENT: cannot create a socket pair");
+
+        sock_setnonblock(sv[0]);
+        sock_setnonblock(sv[1]);
+        w->ofd = sv[0];
+
+        size_t size = w->response.rlen, received = 0;
+        char *data = mallocz(size);
+        while(received < size) {
+            if(w->response.sent < size && web_client_send(w) < 0)
+                break;
+
+            ssize_t bytes = read(sv[1], &data[received], size - received);
+            if(bytes > 0)
+                received += bytes;
+            else if(bytes == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                break;
+        }
+
+        char *expected = mallocz(size);
+        web_client_static_files_unittest_contents(expected, size);
+        if(received != size || memcmp(data, expected, size) != 0) {
+            fprintf(stderr, "WEB CLIENT: sendfile() sent %zu of %zu bytes, or the wrong contents\n", received, size);
+            errors++;
+        }
+
+        freez(expected);
+        freez(data);
+        close(sv[0]);
+        close(sv[1]);
+        w->ofd = -1;
+    }
+#endif
+
+    web_client_free(w);
+
+    char path[FILENAME_MAX + 1];
+    snprintfz(path, sizeof(path) - 1, "%s/cached.js", dir);
+    unlink(path);
+    snprintfz(path, sizeof(path) - 1, "%s/large.js", dir);
+    unlink(path);
+    rmdir(dir);
+
+    web_static_cache_enabled = cache_enabled;
+    web_static_cache_max_file_size = cache_max_file_size;
+    netdata_configured_web_dir = web_dir;
+
+    fprintf(stderr, "WEB CLIENT: static files, %d errors\n", errors);
+    return errors;
+}
 #endif
 
 static inline int check_host_and_call(RRDHOST *host, struct web_client *w, char *url, int (*func)(RRDHOST *, struct web_client *, char *)) {
@@ -921,7 +1327,7 @@ void web_client_build_http_header(struct web_client *w) {
 
     // headers related to the transfer method
     if(likely(w->response.zoutput))
-        buffer_strcat(w->response.header_output, "Content-Encoding: gzip\r\n");
+        buffer_sprintf(w->response.header_output, "Content-Encoding: %s\r\n", web_response_encoding_name(w->response.zencoding));
 
     if(likely(w->flags & WEB_CLIENT_CHUNKED_TRANSFER))
         buffer_strcat(w->response.header_output, "Transfer-Encoding: chunked\r\n");
@@ -930,7 +1336,7 @@ void web_client_build_http_header(struct web_client *w) {
             // we know the content length, put it
             buffer_sprintf(w->response.header_output, "Content-Length: %zu\r\n", w->response.data->len? w->response.data->len: w->response.rlen);
         }
-        else {
+        else if(w->response.code != HTTP_RESP_NOT_MODIFIED) {
             // we don't know the content length, disable keep-alive
             web_client_disable_keepalive(w);
         }
@@ -1486,7 +1892,8 @@ void web_client_process_request_from_web_server(struct web_client *w) {
     web_client_send_http_header(w);
 
     // enable sending immediately if we have data
-    if(w->response.data->len) web_client_enable_wait_send(w);
+    // a file sent by the kernel, or a 304, has no data, but they complete in web_client_send()
+    if(w->response.data->len || w->response.sendfile || w->response.code == HTTP_RESP_NOT_MODIFIED) web_client_enable_wait_send(w);
     else web_client_disable_wait_send(w);
 
     switch(w->mode) {
@@ -1602,6 +2009,110 @@ ssize_t web_client_send_chunk_finalize(struct web_client *w)
     return bytes;
 }
 
+// true when all the response data have been passed through the encoder and all its output has been sent
+static inline bool web_client_compression_drained(struct web_client *w) {
+    if(w->response.data->len - w->response.sent != 0 || w->response.zhave != w->response.zsent)
+        return false;
+
+    if(w->response.zencoding == WEB_RESPONSE_ENCODING_GZIP)
+        return w->response.zstream.avail_in == 0 && w->response.zstream.avail_out != 0;
+
+    return !w->response.zpending;
+}
+
+// compress the response data not passed through the encoder yet, into zbuffer
+// returns false when the encoder failed
+static bool web_client_compress(struct web_client *w, bool finish) {
+    usec_t started_ut = now_usec(CLOCK_THREAD_CPUTIME_ID);
+    bool ok = true;
+
+    switch(w->response.zencoding) {
+        default:
+        case WEB_RESPONSE_ENCODING_GZIP:
+            // give the compressor all the data not passed through the compressor yet
+            if(w->response.data->len > w->response.sent) {
+                w->response.zstream.next_in = (Bytef *)&w->response.data->buffer[w->response.sent - w->response.zstream.avail_in];
+                w->response.zstream.avail_in += (uInt) (w->response.data->len - w->response.sent);
+            }
+
+            // reset the compressor output buffer
+            w->response.zstream.next_out = w->response.zbuffer;
+            w->response.zstream.avail_out = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE;
+
+            if(deflate(&w->response.zstream, finish ? Z_FINISH : Z_SYNC_FLUSH) == Z_STREAM_ERROR)
+                ok = false;
+
+            w->response.zhave = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE - w->response.zstream.avail_out;
+            w->response.sent = w->response.data->len;
+            break;
+
+#ifdef ENABLE_ZSTD
+        case WEB_RESPONSE_ENCODING_ZSTD: {
+            // the input of a flush cannot be extended until the flush completes
+            if(!w->response.zflushing)
+                w->response.zin_end = w->response.data->len;
+
+            ZSTD_inBuffer in = {
+                    .src = w->response.data->buffer,
+                    .size = w->response.zin_end,
+                    .pos = w->response.zin_offset,
+            };
+
+            ZSTD_outBuffer out = {
+                    .dst = w->response.zbuffer,
+                    .size = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE,
+                    .pos = 0,
+            };
+
+            size_t remaining = ZSTD_compressStream2(w->response.zencoder, &out, &in, finish ? ZSTD_e_end : ZSTD_e_flush);
+            if(ZSTD_isError(remaining)) {
+                netdata_log_error("%llu: ZSTD_compressStream2() failed: %s", w->id, ZSTD_getErrorName(remaining));
+                ok = false;
+                break;
+            }
+
+            w->response.zin_offset = in.pos;
+            w->response.zflushing = w->response.zpending = (remaining != 0 || in.pos < in.size);
+            w->response.zhave = out.pos;
+            w->response.ztotal_out += out.pos;
+            w->response.sent = w->response.zin_end;
+            break;
+        }
+#endif
+
+#ifdef ENABLE_BROTLI
+        case WEB_RESPONSE_ENCODING_BROTLI: {
+            // the input of a flush cannot be extended until the flush completes
+            if(!w->response.zflushing)
+                w->response.zin_end = w->response.data->len;
+
+            size_t avail_in = w->response.zin_end - w->response.zin_offset;
+            const uint8_t *next_in = (const uint8_t *)&w->response.data->buffer[w->response.zin_offset];
+            size_t avail_out = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE;
+            uint8_t *next_out = w->response.zbuffer;
+
+            if(!BrotliEncoderCompressStream(w->response.zencoder,
+                                            finish ? BROTLI_OPERATION_FINISH : BROTLI_OPERATION_FLUSH,
+                                            &avail_in, &next_in, &avail_out, &next_out, NULL)) {
+                netdata_log_error("%llu: BrotliEncoderCompressStream() failed", w->id);
+                ok = false;
+                break;
+            }
+
+            w->response.zin_offset = w->response.zin_end - avail_in;
+            w->response.zflushing = w->response.zpending = (avail_in || BrotliEncoderHasMoreOutput(w->response.zencoder));
+            w->response.zhave = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE - avail_out;
+            w->response.ztotal_out += w->response.zhave;
+            w->response.sent = w->response.zin_end;
+            break;
+        }
+#endif
+    }
+
+    w->response.zcpu_ut += now_usec(CLOCK_THREAD_CPUTIME_ID) - started_ut;
+    return ok;
+}
+
 ssize_t web_client_send_deflate(struct web_client *w)
 {
     ssize_t len = 0, t = 0;
@@ -1612,13 +2123,13 @@ ssize_t web_client_send_deflate(struct web_client *w)
     netdata_log_debug(D_DEFLATE, "%llu: web_client_send_deflate(): w->response.data->len = %zu, w->response.sent = %zu, w->response.zhave = %zu, w->response.zsent = %zu, w->response.zstream.avail_in = %u, w->response.zstream.avail_out = %u, w->response.zstream.total_in = %lu, w->response.zstream.total_out = %lu.",
         w->id, w->response.data->len, w->response.sent, w->response.zhave, w->response.zsent, w->response.zstream.avail_in, w->response.zstream.avail_out, w->response.zstream.total_in, w->response.zstream.total_out);
 
-    if(w->response.data->len - w->response.sent == 0 && w->response.zstream.avail_in == 0 && w->response.zhave == w->response.zsent && w->response.zstream.avail_out != 0) {
+    if(web_client_compression_drained(w)) {
         // there is nothing to send
 
         netdata_log_debug(D_WEB_CLIENT, "%llu: Out of output data.", w->id);
 
         // finalize the chunk
-        if(w->response.sent != 0) {
+        if(web_client_compressed_bytes(w) != 0) {
             t = web_client_send_chunk_finalize(w);
             if(t < 0) return t;
         }
@@ -1646,49 +2157,40 @@ ssize_t web_client_send_deflate(struct web_client *w)
         // compress more input data
 
         // close the previous open chunk
-        if(w->response.sent != 0) {
+        if(web_client_compressed_bytes(w) != 0) {
             t = web_client_send_chunk_close(w);
             if(t < 0) return t;
         }
 
-        netdata_log_debug(D_DEFLATE, "%llu: Compressing %zu new bytes starting from %zu (and %u left behind).", w->id, (w->response.data->len - w->response.sent), w->response.sent, w->response.zstream.avail_in);
-
-        // give the compressor all the data not passed through the compressor yet
-        if(w->response.data->len > w->response.sent) {
-            w->response.zstream.next_in = (Bytef *)&w->response.data->buffer[w->response.sent - w->response.zstream.avail_in];
-            w->response.zstream.avail_in += (uInt) (w->response.data->len - w->response.sent);
-        }
-
-        // reset the compressor output buffer
-        w->response.zstream.next_out = w->response.zbuffer;
-        w->response.zstream.avail_out = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE;
+        netdata_log_debug(D_DEFLATE, "%llu: Compressing %zu new bytes starting from %zu (%s).", w->id, (w->response.data->len - w->response.sent), w->response.sent, web_response_encoding_name(w->response.zencoding));
 
         // ask for FINISH if we have all the input
-        int flush = Z_SYNC_FLUSH;
+        bool finish = false;
         if((w->mode == HTTP_REQUEST_MODE_GET || w->mode == HTTP_REQUEST_MODE_POST || w->mode == HTTP_REQUEST_MODE_PUT || w->mode == HTTP_REQUEST_MODE_DELETE)
             || (w->mode == HTTP_REQUEST_MODE_FILECOPY && !web_client_has_wait_receive(w) && w->response.data->len == w->response.rlen)) {
-            flush = Z_FINISH;
-            netdata_log_debug(D_DEFLATE, "%llu: Requesting Z_FINISH, if possible.", w->id);
+            finish = true;
+            netdata_log_debug(D_DEFLATE, "%llu: Requesting FINISH, if possible.", w->id);
         }
         else {
-            netdata_log_debug(D_DEFLATE, "%llu: Requesting Z_SYNC_FLUSH.", w->id);
+            netdata_log_debug(D_DEFLATE, "%llu: Requesting FLUSH.", w->id);
         }
 
-        // compress
-        if(deflate(&w->response.zstream, flush) == Z_STREAM_ERROR) {
+        // compress - this also keeps track of the bytes passed through the compressor
+        if(!web_client_compress(w, finish)) {
             netdata_log_error("%llu: Compression failed. Closing down client.", w->id);
             web_client_request_done(w);
             return(-1);
         }
 
-        w->response.zhave = NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE - w->response.zstream.avail_out;
         w->response.zsent = 0;
 
-        // keep track of the bytes passed through the compressor
-        w->response.sent = w->response.data->len;
-
         netdata_log_debug(D_DEFLATE, "%llu: Compression produced %zu bytes.", w->id, w->response.zhave);
 
+        if(!w->response.zhave) {
+            // a flush without new input, a zero length chunk would terminate the response
+            return t;
+        }
+
         // open a new chunk
         ssize_t t2 = web_client_send_chunk_header(w, w->response.zhave);
         if(t2 < 0) return t2;
@@ -1717,9 +2219,51 @@ ssize_t web_client_send_deflate(struct web_client *w)
     return(len);
 }
 
+#ifdef HAVE_SYS_SENDFILE_H
+static ssize_t web_client_send_file(struct web_client *w) {
+    if(unlikely(w->response.sent >= w->response.rlen)) {
+        // there is nothing to send
+
+        if(unlikely(!web_client_has_keepalive(w))) {
+            netdata_log_debug(D_WEB_CLIENT, "%llu: Closing (keep-alive is not enabled). %zu bytes sent.", w->id, w->response.sent);
+            WEB_CLIENT_IS_DEAD(w);
+            return 0;
+        }
+
+        web_client_request_done(w);
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Done sending the file on socket. Waiting for next request on the same socket.", w->id);
+        return 0;
+    }
+
+    off_t offset = (off_t)w->response.sent;
+    ssize_t bytes = sendfile(w->ofd, w->response.sendfile_fd, &offset, w->response.rlen - w->response.sent);
+    if(likely(bytes > 0)) {
+        w->statistics.sent_bytes += bytes;
+        w->response.sent += bytes;
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Sent %zd bytes with sendfile().", w->id, bytes);
+    }
+    else if(bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        netdata_log_debug(D_WEB_CLIENT, "%llu: Did not send any bytes to the client.", w->id);
+        bytes = 0;
+    }
+    else {
+        // the file has been truncated, or the socket failed
+        netdata_log_debug(D_WEB_CLIENT, "%llu: sendfile() failed.", w->id);
+        WEB_CLIENT_IS_DEAD(w);
+        bytes = -1;
+    }
+
+    return bytes;
+}
+#endif
+
 ssize_t web_client_send(struct web_client *w) {
     if(likely(w->response.zoutput)) return web_client_send_deflate(w);
 
+#ifdef HAVE_SYS_SENDFILE_H
+    if(unlikely(w->response.sendfile)) return web_client_send_file(w);
+#endif
+
     ssize_t bytes;
 
     if(unlikely(w->response.data->len - w->response.sent == 0)) {
@@ -8,6 +8,8 @@
 struct web_client;
 
 extern int web_enable_gzip, web_gzip_level, web_gzip_strategy;
+extern int web_enable_zstd, web_zstd_level;
+extern int web_enable_brotli, web_brotli_level;
 
 #define HTTP_REQ_MAX_HEADER_FETCH_TRIES 100
 
@@ -66,8 +68,14 @@ typedef enum __attribute__((packed)) {
 
     // transient settings
     WEB_CLIENT_FLAG_PROGRESS_TRACKING       = (1 << 24), // flag to avoid redoing progress work
+
+    // compression
+    WEB_CLIENT_ENCODING_ZSTD                = (1 << 25),
+    WEB_CLIENT_ENCODING_BROTLI              = (1 << 26),
 } WEB_CLIENT_FLAGS;
 
+#define WEB_CLIENT_ENCODINGS (WEB_CLIENT_ENCODING_GZIP|WEB_CLIENT_ENCODING_DEFLATE|WEB_CLIENT_ENCODING_ZSTD|WEB_CLIENT_ENCODING_BROTLI)
+
 #define WEB_CLIENT_FLAG_PATH_WITH_VERSION (WEB_CLIENT_FLAG_PATH_IS_V0|WEB_CLIENT_FLAG_PATH_IS_V1|WEB_CLIENT_FLAG_PATH_IS_V2)
 #define web_client_reset_path_flags(w) (w)->flags &= ~(WEB_CLIENT_FLAG_PATH_WITH_VERSION|WEB_CLIENT_FLAG_PATH_HAS_TRAILING_SLASH|WEB_CLIENT_FLAG_PATH_HAS_FILE_EXTENSION)
 
@@ -136,6 +144,28 @@ void web_client_set_conn_webrtc(struct web_client *w);
 
 #define CLOUD_CLIENT_NAME_LENGTH 64
 
+typedef enum __attribute__((packed)) {
+    WEB_RESPONSE_ENCODING_GZIP = 0,
+    WEB_RESPONSE_ENCODING_ZSTD,
+    WEB_RESPONSE_ENCODING_BROTLI,
+
+    // terminator
+    WEB_RESPONSE_ENCODING_MAX,
+} WEB_RESPONSE_ENCODING;
+
+const char *web_response_encoding_name(WEB_RESPONSE_ENCODING encoding);
+
+struct web_response_compression_statistics {
+    struct {
+        uint64_t responses;             // the compressed responses completed
+        uint64_t bytes_in;              // the uncompressed bytes passed through the encoder
+        uint64_t bytes_out;             // the compressed bytes the encoder produced
+        uint64_t cpu_ut;                // the CPU time spent in the encoder
+    } encodings[WEB_RESPONSE_ENCODING_MAX];
+};
+
+void web_response_compression_statistics_get(struct web_response_compression_statistics *stats);
+
 struct response {
     BUFFER *header;         // our response header
     BUFFER *header_output;  // internal use
@@ -149,8 +179,19 @@ struct response {
 
     bool zoutput; // if set to 1, web_client_send() will send compressed data
 
+    bool sendfile;          // the kernel sends rlen bytes of sendfile_fd after the header
+    int sendfile_fd;
+
     bool zinitialized;
+    WEB_RESPONSE_ENCODING zencoding;                     // the Content-Encoding of the compressed output
     z_stream zstream;                                    // zlib stream for sending compressed output to client
+    void *zencoder;                                      // the zstd or brotli encoder, when zencoding is not gzip
+    size_t zin_offset;                                   // zstd, brotli: the response bytes consumed by the encoder
+    size_t zin_end;                                      // zstd, brotli: the response bytes given to the current flush
+    bool zflushing;                                      // zstd, brotli: the current flush needs more calls to complete
+    bool zpending;                                       // zstd, brotli: the encoder has more output to give
+    size_t ztotal_out;                                   // zstd, brotli: the compressed bytes produced
+    usec_t zcpu_ut;                                      // the CPU time spent compressing this response
     size_t zsent;                                        // the compressed bytes we have sent to the client
     size_t zhave;                                        // the compressed bytes that we have received from zlib
     Bytef zbuffer[NETDATA_WEB_RESPONSE_ZLIB_CHUNK_SIZE]; // temporary buffer for storing compressed output
@@ -193,6 +234,7 @@ struct web_client {
     char *forwarded_for;                // the X-Forwarded-For: header
     char *origin;                       // the Origin: header
     char *user_agent;                   // the User-Agent: header
+    char *if_none_match;                // the If-None-Match: header
 
     BUFFER *payload;                    // when this request is a POST, this has the payload
 
@@ -250,6 +292,7 @@ void web_client_build_http_header(struct web_client *w);
 
 void web_client_reuse_from_cache(struct web_client *w);
 struct web_client *web_client_create(size_t *statistics_memory_accounting);
+int web_client_static_files_unittest(void);
 void web_client_free(struct web_client *w);
 
 #include "web/api/web_api_v1.h"
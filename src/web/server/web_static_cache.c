@@ -0,0 +1,558 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "web_static_cache.h"
+
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef ENABLE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+// the files are compressed once, so the levels favor the ratio
+#define WEB_STATIC_CACHE_GZIP_LEVEL 9
+#define WEB_STATIC_CACHE_ZSTD_LEVEL 12
+#define WEB_STATIC_CACHE_BROTLI_QUALITY 9
+
+bool web_static_cache_enabled = true;
+size_t web_static_cache_max_size = 64 * 1024 * 1024;
+size_t web_static_cache_max_file_size = 8 * 1024 * 1024;
+
+// concurrent requests for the same file wait for it to be compressed once,
+// requests for other files are not blocked
+// there is one for each file ever loaded, so they are never deleted
+struct web_static_file_loading {
+    netdata_mutex_t mutex;
+};
+
+static struct {
+    SPINLOCK spinlock;
+    DICTIONARY *files;
+    DICTIONARY *loading;
+
+    // serializes the evictions and the additions of files, to keep the memory within the limit
+    // it is held only while updating the dictionary, never while loading or compressing files
+    netdata_mutex_t admission;
+
+    struct web_static_cache_statistics stats;
+} web_static_cache = {
+        .spinlock = NETDATA_SPINLOCK_INITIALIZER,
+        .files = NULL,
+        .loading = NULL,
+        .admission = NETDATA_MUTEX_INITIALIZER,
+};
+
+// ----------------------------------------------------------------------------
+// the compressed variants
+
+static void web_static_file_compress_gzip(WEB_STATIC_FILE *f) {
+    z_stream zs = { 0 };
+    if(deflateInit2(&zs, WEB_STATIC_CACHE_GZIP_LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return;
+
+    size_t bound = deflateBound(&zs, f->size);
+    uint8_t *dst = mallocz(bound);
+
+    zs.next_in = f->data;
+    zs.avail_in = f->size;
+    zs.next_out = dst;
+    zs.avail_out = bound;
+
+    if(deflate(&zs, Z_FINISH) != Z_STREAM_END || zs.total_out >= f->size) {
+        deflateEnd(&zs);
+        freez(dst);
+        return;
+    }
+
+    f->variants[WEB_RESPONSE_ENCODING_GZIP].data = reallocz(dst, zs.total_out);
+    f->variants[WEB_RESPONSE_ENCODING_GZIP].size = zs.total_out;
+    deflateEnd(&zs);
+}
+
+static void web_static_file_compress_zstd(WEB_STATIC_FILE *f __maybe_unused) {
+#ifdef ENABLE_ZSTD
+    size_t bound = ZSTD_compressBound(f->size);
+    uint8_t *dst = mallocz(bound);
+
+    size_t size = ZSTD_compress(dst, bound, f->data, f->size, WEB_STATIC_CACHE_ZSTD_LEVEL);
+    if(ZSTD_isError(size) || size >= f->size) {
+        freez(dst);
+        return;
+    }
+
+    f->variants[WEB_RESPONSE_ENCODING_ZSTD].data = reallocz(dst, size);
+    f->variants[WEB_RESPONSE_ENCODING_ZSTD].size = size;
+#endif
+}
+
+static void web_static_file_compress_brotli(WEB_STATIC_FILE *f __maybe_unused) {
+#ifdef ENABLE_BROTLI
+    size_t size = BrotliEncoderMaxCompressedSize(f->size);
+    if(!size)
+        return;
+
+    uint8_t *dst = mallocz(size);
+
+    BrotliEncoderMode mode = (f->content_type == CT_IMAGE_PNG || f->content_type == CT_IMAGE_JPG ||
+                              f->content_type == CT_IMAGE_GIF || f->content_type == CT_IMAGE_XICON ||
+                              f->content_type == CT_IMAGE_ICNS ||
+                              f->content_type == CT_IMAGE_BMP || f->content_type == CT_APPLICATION_FONT_WOFF ||
+                              f->content_type == CT_APPLICATION_FONT_WOFF2) ? BROTLI_MODE_GENERIC : BROTLI_MODE_TEXT;
+
+    if(!BrotliEncoderCompress(WEB_STATIC_CACHE_BROTLI_QUALITY, BROTLI_DEFAULT_WINDOW, mode,
+                              f->size, f->data, &size, dst) || size >= f->size) {
+        freez(dst);
+        return;
+    }
+
+    f->variants[WEB_RESPONSE_ENCODING_BROTLI].data = reallocz(dst, size);
+    f->variants[WEB_RESPONSE_ENCODING_BROTLI].size = size;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// loading files
+
+static inline uint64_t web_static_file_mtime_ns(struct stat *statbuf) {
+#ifdef __APPLE__
+    return (uint64_t)statbuf->st_mtimespec.tv_sec * NSEC_PER_SEC + (uint64_t)statbuf->st_mtimespec.tv_nsec;
+#else
+    return (uint64_t)statbuf->st_mtim.tv_sec * NSEC_PER_SEC + (uint64_t)statbuf->st_mtim.tv_nsec;
+#endif
+}
+
+static void web_static_file_free(WEB_STATIC_FILE *f) {
+    for(size_t e = 0; e < WEB_RESPONSE_ENCODING_MAX ;e++) {
+        freez(f->variants[e].data);
+        f->variants[e].data = NULL;
+    }
+
+    freez(f->data);
+    f->data = NULL;
+}
+
+static bool web_static_file_load(const char *filename, struct stat *statbuf, WEB_STATIC_FILE *f) {
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+        return false;
+
+    // the file should be the one the caller found
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size != statbuf->st_size ||
+        web_static_file_mtime_ns(&st) != web_static_file_mtime_ns(statbuf)) {
+        close(fd);
+        return false;
+    }
+
+    f->size = (size_t)st.st_size;
+    f->data = mallocz(f->size);
+
+    size_t loaded = 0;
+    while(loaded < f->size) {
+        ssize_t bytes = read(fd, &f->data[loaded], f->size - loaded);
+        if(bytes <= 0) {
+            if(bytes == -1 && errno == EINTR)
+                continue;
+
+            close(fd);
+            web_static_file_free(f);
+            return false;
+        }
+
+        loaded += bytes;
+    }
+    close(fd);
+
+    f->st_size = st.st_size;
+    f->st_mtime_ns = web_static_file_mtime_ns(&st);
+    f->mtime = (time_t)(f->st_mtime_ns / NSEC_PER_SEC);
+    f->content_type = contenttype_for_filename(filename);
+    snprintfz(f->etag, sizeof(f->etag), "%llx-%llx", (unsigned long long)f->st_size, (unsigned long long)f->st_mtime_ns);
+
+    web_static_file_compress_gzip(f);
+    web_static_file_compress_zstd(f);
+    web_static_file_compress_brotli(f);
+
+    f->memory = f->size;
+    for(size_t e = 0; e < WEB_RESPONSE_ENCODING_MAX ;e++)
+        f->memory += f->variants[e].size;
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// the dictionary of files
+
+static void web_static_file_insert_callback(const DICTIONARY_ITEM *item __maybe_unused, void *value, void *data __maybe_unused) {
+    WEB_STATIC_FILE *f = value;
+    __atomic_add_fetch(&web_static_cache.stats.memory, f->memory, __ATOMIC_RELAXED);
+}
+
+static bool web_static_file_conflict_callback(const DICTIONARY_ITEM *item __maybe_unused, void *old_value __maybe_unused, void *new_value, void *data __maybe_unused) {
+    // the existing entry is kept, the new one has not been accounted
+    web_static_file_free(new_value);
+    return false;
+}
+
+static void web_static_file_delete_callback(const DICTIONARY_ITEM *item __maybe_unused, void *value, void *data __maybe_unused) {
+    WEB_STATIC_FILE *f = value;
+    __atomic_sub_fetch(&web_static_cache.stats.memory, f->memory, __ATOMIC_RELAXED);
+    web_static_file_free(f);
+}
+
+static void web_static_file_loading_insert_callback(const DICTIONARY_ITEM *item __maybe_unused, void *value, void *data __maybe_unused) {
+    struct web_static_file_loading *l = value;
+    netdata_mutex_init(&l->mutex);
+}
+
+static DICTIONARY *web_static_cache_files(void) {
+    DICTIONARY *files = __atomic_load_n(&web_static_cache.files, __ATOMIC_ACQUIRE);
+    if(likely(files))
+        return files;
+
+    spinlock_lock(&web_static_cache.spinlock);
+    if(!web_static_cache.files) {
+        web_static_cache.loading = dictionary_create_advanced(DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_FIXED_SIZE, NULL, sizeof(struct web_static_file_loading));
+        dictionary_register_insert_callback(web_static_cache.loading, web_static_file_loading_insert_callback, NULL);
+
+        files = dictionary_create_advanced(DICT_OPTION_DONT_OVERWRITE_VALUE | DICT_OPTION_FIXED_SIZE, NULL, sizeof(WEB_STATIC_FILE));
+        dictionary_register_insert_callback(files, web_static_file_insert_callback, NULL);
+        dictionary_register_conflict_callback(files, web_static_file_conflict_callback, NULL);
+        dictionary_register_delete_callback(files, web_static_file_delete_callback, NULL);
+        __atomic_store_n(&web_static_cache.files, files, __ATOMIC_RELEASE);
+    }
+    spinlock_unlock(&web_static_cache.spinlock);
+
+    return web_static_cache.files;
+}
+
+// returns the entry of the file, when it is still the same file
+static const DICTIONARY_ITEM *web_static_cache_get(DICTIONARY *files, const char *filename, off_t st_size, uint64_t st_mtime_ns, WEB_STATIC_FILE **file) {
+    const DICTIONARY_ITEM *item = dictionary_get_and_acquire_item(files, filename);
+    if(!item)
+        return NULL;
+
+    WEB_STATIC_FILE *f = dictionary_acquired_item_value(item);
+    if(f->st_size == st_size && f->st_mtime_ns == st_mtime_ns) {
+        __atomic_store_n(&f->last_used_ut, now_monotonic_usec(), __ATOMIC_RELAXED);
+        *file = f;
+        return item;
+    }
+
+    // the file has changed - the entry is freed when its last user releases it
+    dictionary_acquired_item_release(files, item);
+    dictionary_del(files, filename);
+    return NULL;
+}
+
+struct web_static_cache_victim {
+    char *filename;
+    usec_t last_used_ut;
+    size_t memory;
+};
+
+static int web_static_cache_victim_compar(const void *a, const void *b) {
+    const struct web_static_cache_victim *va = a, *vb = b;
+
+    if(va->last_used_ut < vb->last_used_ut) return -1;
+    if(va->last_used_ut > vb->last_used_ut) return 1;
+    return 0;
+}
+
+// evict the least recently used files, until the cache has room for the given bytes
+// the caller holds the admission mutex, so no files are added meanwhile
+static bool web_static_cache_make_room(DICTIONARY *files, size_t memory) {
+    if(memory > web_static_cache_max_size)
+        return false;
+
+    size_t used = __atomic_load_n(&web_static_cache.stats.memory, __ATOMIC_RELAXED);
+    if(used + memory <= web_static_cache_max_size)
+        return true;
+
+    size_t entries = dictionary_entries(files), count = 0;
+    struct web_static_cache_victim *victims = callocz(entries ? entries : 1, sizeof(*victims));
+
+    // files cannot be deleted while traversing with a read lock
+    WEB_STATIC_FILE *f;
+    dfe_start_read(files, f) {
+        if(count >= entries)
+            break;
+
+        victims[count].filename = strdupz(f_dfe.name);
+        victims[count].last_used_ut = __atomic_load_n(&f->last_used_ut, __ATOMIC_RELAXED);
+        victims[count].memory = f->memory;
+        count++;
+    }
+    dfe_done(f);
+
+    qsort(victims, count, sizeof(*victims), web_static_cache_victim_compar);
+
+    // the memory of evicted files still in use is released by their last user,
+    // so we count the bytes we evict, instead of watching the memory of the cache
+    size_t evicted = 0;
+    for(size_t i = 0; i < count ;i++) {
+        if(used - evicted + memory > web_static_cache_max_size &&
+            dictionary_del(files, victims[i].filename)) {
+            evicted += victims[i].memory;
+            __atomic_add_fetch(&web_static_cache.stats.evicted, 1, __ATOMIC_RELAXED);
+        }
+
+        freez(victims[i].filename);
+    }
+    freez(victims);
+
+    return used - evicted + memory <= web_static_cache_max_size;
+}
+
+const DICTIONARY_ITEM *web_static_cache_acquire(const char *filename, struct stat *statbuf, WEB_STATIC_FILE **file) {
+    if(!web_static_cache_enabled)
+        return NULL;
+
+    if(statbuf->st_size <= 0 || (size_t)statbuf->st_size > web_static_cache_max_file_size) {
+        __atomic_add_fetch(&web_static_cache.stats.uncached, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    DICTIONARY *files = web_static_cache_files();
+    uint64_t st_mtime_ns = web_static_file_mtime_ns(statbuf);
+
+    const DICTIONARY_ITEM *item = web_static_cache_get(files, filename, statbuf->st_size, st_mtime_ns, file);
+    if(item) {
+        __atomic_add_fetch(&web_static_cache.stats.hits, 1, __ATOMIC_RELAXED);
+        return item;
+    }
+
+    struct web_static_file_loading tmp = { 0 };
+    const DICTIONARY_ITEM *loading_item = dictionary_set_and_acquire_item(web_static_cache.loading, filename, &tmp, sizeof(tmp));
+    struct web_static_file_loading *loading = dictionary_acquired_item_value(loading_item);
+    netdata_mutex_lock(&loading->mutex);
+
+    // another request may have loaded it, while we were waiting
+    item = web_static_cache_get(files, filename, statbuf->st_size, st_mtime_ns, file);
+    if(item) {
+        netdata_mutex_unlock(&loading->mutex);
+        dictionary_acquired_item_release(web_static_cache.loading, loading_item);
+        __atomic_add_fetch(&web_static_cache.stats.hits, 1, __ATOMIC_RELAXED);
+        return item;
+    }
+
+    // the compressed variants are smaller than the file, so it needs at least its size
+    WEB_STATIC_FILE f = { 0 };
+    bool loaded = (size_t)statbuf->st_size <= web_static_cache_max_size && web_static_file_load(filename, statbuf, &f);
+
+    if(loaded) {
+        f.last_used_ut = now_monotonic_usec();
+
+        // the limit applies to the file and all its compressed variants
+        netdata_mutex_lock(&web_static_cache.admission);
+        if(web_static_cache_make_room(files, f.memory))
+            item = dictionary_set_and_acquire_item(files, filename, &f, sizeof(f));
+        netdata_mutex_unlock(&web_static_cache.admission);
+
+        if(!item)
+            web_static_file_free(&f);
+    }
+
+    netdata_mutex_unlock(&loading->mutex);
+    dictionary_acquired_item_release(web_static_cache.loading, loading_item);
+
+    if(!item) {
+        __atomic_add_fetch(&web_static_cache.stats.uncached, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    __atomic_add_fetch(&web_static_cache.stats.loads, 1, __ATOMIC_RELAXED);
+
+    *file = dictionary_acquired_item_value(item);
+    return item;
+}
+
+void web_static_cache_release(const DICTIONARY_ITEM *item) {
+    if(item)
+        dictionary_acquired_item_release(web_static_cache.files, item);
+}
+
+// ----------------------------------------------------------------------------
+// statistics
+
+void web_static_cache_count_sendfile(void) {
+    __atomic_add_fetch(&web_static_cache.stats.sendfile, 1, __ATOMIC_RELAXED);
+}
+
+void web_static_cache_count_not_modified(void) {
+    __atomic_add_fetch(&web_static_cache.stats.not_modified, 1, __ATOMIC_RELAXED);
+}
+
+void web_static_cache_statistics_get(struct web_static_cache_statistics *stats) {
+    stats->hits = __atomic_load_n(&web_static_cache.stats.hits, __ATOMIC_RELAXED);
+    stats->loads = __atomic_load_n(&web_static_cache.stats.loads, __ATOMIC_RELAXED);
+    stats->not_modified = __atomic_load_n(&web_static_cache.stats.not_modified, __ATOMIC_RELAXED);
+    stats->uncached = __atomic_load_n(&web_static_cache.stats.uncached, __ATOMIC_RELAXED);
+    stats->evicted = __atomic_load_n(&web_static_cache.stats.evicted, __ATOMIC_RELAXED);
+    stats->sendfile = __atomic_load_n(&web_static_cache.stats.sendfile, __ATOMIC_RELAXED);
+    stats->memory = __atomic_load_n(&web_static_cache.stats.memory, __ATOMIC_RELAXED);
+}
+
+// ----------------------------------------------------------------------------
+// unittest
+
+#define WEB_STATIC_CACHE_UNITTEST_FILE_SIZE (64 * 1024)
+
+static void web_static_cache_unittest_file_write(const char *dir, const char *name, size_t size, size_t variant) {
+    char path[FILENAME_MAX + 1];
+    snprintfz(path, sizeof(path) - 1, "%s/%s", dir, name);
+
+    FILE *fp = fopen(path, "w");
+    if(!fp)
+        fatal("WEB STATIC CACHE: cannot create '%s'", path);
+
+    // text that compresses well
+    for(size_t written = 0, line = 0; written < size ; line++) {
+        char buf[100];
+        size_t len = snprintfz(buf, sizeof(buf) - 1, "/* line %zu of variant %zu of %s */\n", line, variant, name);
+        len = MIN(len, size - written);
+        fwrite(buf, 1, len, fp);
+        written += len;
+    }
+
+    fclose(fp);
+}
+
+static const DICTIONARY_ITEM *web_static_cache_unittest_acquire(const char *dir, const char *name, WEB_STATIC_FILE **f) {
+    char path[FILENAME_MAX + 1];
+    snprintfz(path, sizeof(path) - 1, "%s/%s", dir, name);
+
+    struct stat statbuf;
+    if(stat(path, &statbuf) != 0)
+        fatal("WEB STATIC CACHE: cannot stat '%s'", path);
+
+    return web_static_cache_acquire(path, &statbuf, f);
+}
+
+// the statistics changed by the given amounts since the last call
+static int web_static_cache_unittest_check(const char *what, struct web_static_cache_statistics *last, uint64_t loads, uint64_t hits, uint64_t uncached, uint64_t evicted) {
+    struct web_static_cache_statistics now;
+    web_static_cache_statistics_get(&now);
+
+    int errors = 0;
+    if(now.loads - last->loads != loads || now.hits - last->hits != hits ||
+        now.uncached - last->uncached != uncached || now.evicted - last->evicted != evicted) {
+        fprintf(stderr, "WEB STATIC CACHE: %s: got %"PRIu64" loads, %"PRIu64" hits, %"PRIu64" uncached, %"PRIu64" evicted, "
+                        "expected %"PRIu64" loads, %"PRIu64" hits, %"PRIu64" uncached, %"PRIu64" evicted\n",
+                what, now.loads - last->loads, now.hits - last->hits, now.uncached - last->uncached, now.evicted - last->evicted,
+                loads, hits, uncached, evicted);
+        errors++;
+    }
+
+    if(now.memory > web_static_cache_max_size) {
+        fprintf(stderr, "WEB STATIC CACHE: %s: the cache uses %"PRIu64" bytes, more than its limit of %zu bytes\n",
+                what, now.memory, web_static_cache_max_size);
+        errors++;
+    }
+
+    *last = now;
+    return errors;
+}
+
+int web_static_cache_unittest(void) {
+    int errors = 0;
+
+    bool enabled = web_static_cache_enabled;
+    size_t max_size = web_static_cache_max_size;
+    size_t max_file_size = web_static_cache_max_file_size;
+
+    web_static_cache_enabled = true;
+    web_static_cache_max_size = 64 * 1024 * 1024;
+    web_static_cache_max_file_size = 2 * WEB_STATIC_CACHE_UNITTEST_FILE_SIZE;
+
+    char dir[] = "/tmp/netdata-web-static-cache-unittest-XXXXXX";
+    if(!mkdtemp(dir))
+        fatal("WEB STATIC CACHE: cannot create a temporary directory");
+
+    const char *names[] = { "a.js", "b.js", "c.js", "big.js" };
+    web_static_cache_unittest_file_write(dir, names[0], WEB_STATIC_CACHE_UNITTEST_FILE_SIZE, 0);
+    web_static_cache_unittest_file_write(dir, names[1], WEB_STATIC_CACHE_UNITTEST_FILE_SIZE, 0);
+    web_static_cache_unittest_file_write(dir, names[2], WEB_STATIC_CACHE_UNITTEST_FILE_SIZE, 0);
+    web_static_cache_unittest_file_write(dir, names[3], 4 * WEB_STATIC_CACHE_UNITTEST_FILE_SIZE, 0);
+
+    struct web_static_cache_statistics last;
+    web_static_cache_statistics_get(&last);
+
+    // the first request loads and compresses the file
+    WEB_STATIC_FILE *f = NULL;
+    const DICTIONARY_ITEM *item = web_static_cache_unittest_acquire(dir, names[0], &f);
+    if(!item || f->size != WEB_STATIC_CACHE_UNITTEST_FILE_SIZE || f->content_type != CT_APPLICATION_X_JAVASCRIPT ||
+        !f->variants[WEB_RESPONSE_ENCODING_GZIP].data || f->variants[WEB_RESPONSE_ENCODING_GZIP].size >= f->size) {
+        fprintf(stderr, "WEB STATIC CACHE: the file has not been loaded and compressed\n");
+        errors++;
+    }
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("first request", &last, 1, 0, 0, 0);
+
+    // the next ones are served from memory
+    item = web_static_cache_unittest_acquire(dir, names[0], &f);
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("second request", &last, 0, 1, 0, 0);
+
+    // a changed file is loaded again
+    web_static_cache_unittest_file_write(dir, names[0], WEB_STATIC_CACHE_UNITTEST_FILE_SIZE - 1, 1);
+    item = web_static_cache_unittest_acquire(dir, names[0], &f);
+    if(!item || f->size != WEB_STATIC_CACHE_UNITTEST_FILE_SIZE - 1) {
+        fprintf(stderr, "WEB STATIC CACHE: the changed file has not been loaded again\n");
+        errors++;
+    }
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("changed file", &last, 1, 0, 0, 0);
+
+    // files larger than the limit are not cached
+    item = web_static_cache_unittest_acquire(dir, names[3], &f);
+    if(item) {
+        fprintf(stderr, "WEB STATIC CACHE: a file larger than the limit has been cached\n");
+        web_static_cache_release(item);
+        errors++;
+    }
+    errors += web_static_cache_unittest_check("large file", &last, 0, 0, 1, 0);
+
+    // room for two files: loading a third one evicts the least recently used
+    web_static_cache_max_size = last.memory * 2 + last.memory / 2;
+
+    sleep_usec(10 * USEC_PER_MS);
+    item = web_static_cache_unittest_acquire(dir, names[1], &f);
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("second file", &last, 1, 0, 0, 0);
+
+    sleep_usec(10 * USEC_PER_MS);
+    item = web_static_cache_unittest_acquire(dir, names[0], &f);
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("first file again", &last, 0, 1, 0, 0);
+
+    sleep_usec(10 * USEC_PER_MS);
+    item = web_static_cache_unittest_acquire(dir, names[2], &f);
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("third file", &last, 1, 0, 0, 1);
+
+    item = web_static_cache_unittest_acquire(dir, names[0], &f);
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("the recently used file is kept", &last, 0, 1, 0, 0);
+
+    item = web_static_cache_unittest_acquire(dir, names[1], &f);
+    web_static_cache_release(item);
+    errors += web_static_cache_unittest_check("the least recently used file is evicted", &last, 1, 0, 0, 1);
+
+    dictionary_flush(web_static_cache.files);
+
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]) ;i++) {
+        char path[FILENAME_MAX + 1];
+        snprintfz(path, sizeof(path) - 1, "%s/%s", dir, names[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+
+    web_static_cache_enabled = enabled;
+    web_static_cache_max_size = max_size;
+    web_static_cache_max_file_size = max_file_size;
+
+    fprintf(stderr, "WEB STATIC CACHE: %d errors\n", errors);
+    return errors;
+}
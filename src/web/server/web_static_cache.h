@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NETDATA_WEB_STATIC_CACHE_H
+#define NETDATA_WEB_STATIC_CACHE_H
+
+#include "libnetdata/libnetdata.h"
+#include "web_client.h"
+
+// the dashboard files, kept in memory with their compressed variants
+// an entry is valid for as long as the size and the modification time of its file are the same
+// when the cache is full, the least recently used files are evicted to make room for new ones
+
+extern bool web_static_cache_enabled;
+extern size_t web_static_cache_max_size;        // the total bytes of all the cached variants
+extern size_t web_static_cache_max_file_size;   // larger files are not cached
+
+typedef struct web_static_file {
+    char etag[50];                          // the ETag of the file, without the quotes
+    HTTP_CONTENT_TYPE content_type;
+    time_t mtime;
+
+    struct {
+        uint8_t *data;                      // NULL when the variant is not available or not smaller than the file
+        size_t size;
+    } variants[WEB_RESPONSE_ENCODING_MAX];
+
+    uint8_t *data;                          // the file itself
+    size_t size;
+
+    // to detect changes of the file
+    off_t st_size;
+    uint64_t st_mtime_ns;
+
+    size_t memory;                          // the bytes of all the variants
+    usec_t last_used_ut;                    // atomic - for evicting the least recently used files
+} WEB_STATIC_FILE;
+
+struct web_static_cache_statistics {
+    uint64_t hits;                          // responses served from the cache
+    uint64_t loads;                         // files loaded and compressed
+    uint64_t not_modified;                  // 304 responses for matching ETags
+    uint64_t uncached;                      // files too big, or they could not be loaded
+    uint64_t evicted;                       // files evicted to make room for others
+    uint64_t sendfile;                      // responses sent with sendfile()
+    uint64_t memory;                        // the bytes the cache uses
+};
+
+// returns the cache entry of the file, loading it when needed
+// returns NULL when the file is not cached - the caller should serve it from disk
+const DICTIONARY_ITEM *web_static_cache_acquire(const char *filename, struct stat *statbuf, WEB_STATIC_FILE **file);
+void web_static_cache_release(const DICTIONARY_ITEM *item);
+
+void web_static_cache_statistics_get(struct web_static_cache_statistics *stats);
+void web_static_cache_count_sendfile(void);
+void web_static_cache_count_not_modified(void);
+
+int web_static_cache_unittest(void);
+
+#endif //NETDATA_WEB_STATIC_CACHE_H